@@ -0,0 +1,83 @@
+#!/bin/sh
+# accuracy check of a LAMMPS build with -DSPH_SINGLE against double precision
+#
+# usage: sh compare.sh lmp_single [lmp_double]
+#   runs shock_tube.lmp and water_collapse.lmp with the single precision
+#   executable and compares their thermo output to the double precision
+#   reference logs log.*.double
+#   if lmp_double is given, the reference logs are regenerated first
+#
+# the largest relative difference of each thermo column over all output
+#   steps must be below the tolerance given for it, see README for the
+#   differences seen with gcc -O2 on x86-64
+# exit status is 0 if all checks pass, 1 if not
+
+if [ $# -lt 1 ]; then
+  echo "usage: sh compare.sh lmp_single [lmp_double]"
+  exit 1
+fi
+
+for prec in double single; do
+  if [ $prec = double ]; then
+    [ $# -lt 2 ] && continue
+    exe=$2
+  else
+    exe=$1
+  fi
+  for name in shock_tube water_collapse; do
+    $exe -log log.$name.$prec -screen none -in $name.lmp > /dev/null 2>&1 ||
+      { echo "$name $prec run failed"; exit 1; }
+  done
+done
+
+# thermo lines of a log, between the Step header and Loop time
+
+thermo () {
+  awk '/^Loop time/ {on = 0} on {print} /^Step/ {on = 1}' $1
+}
+
+# compare thermo of log.name.single and log.name.double column by column
+# args after name are the tolerances of the columns after Step
+
+status=0
+
+check () {
+  name=$1
+  shift
+  thermo log.$name.single > single.tmp
+  thermo log.$name.double > double.tmp
+  header=`awk '/^Step/ {print; exit}' log.$name.double`
+  paste single.tmp double.tmp | awk -v tol="$*" -v header="$header" \
+    -v name=$name '
+    BEGIN {ntol = split(tol,t," "); split(header,h," ")}
+    {
+      if (NF != 2*(ntol+1)) bad = 1
+      for (i = 2; i <= ntol+1; i++) {
+        a = $(i); b = $(i+ntol+1)
+        d = a - b; if (d < 0) d = -d
+        s = (b < 0 ? -b : b); if (s > 0.0) d /= s
+        if (d > max[i]) max[i] = d
+      }
+    }
+    END {
+      if (NR == 0 || bad) {print name ": thermo output differs in form"; exit 1}
+      fail = 0
+      for (i = 2; i <= ntol+1; i++) {
+        ok = (max[i] < t[i-1])
+        if (!ok) fail = 1
+        printf "%s %s: max rel. diff %g, tolerance %g %s\n",
+          name, h[i], max[i], t[i-1], ok ? "" : "FAILED"
+      }
+      exit fail
+    }' || status=1
+  rm -f single.tmp double.tmp
+}
+
+# shock_tube: KinEng, emeso, etot, max density, sum of density^2
+# water_collapse: KinEng, esph, etot, max density, center of mass x,y
+
+check shock_tube 1.0e-5 1.0e-6 1.0e-9 1.0e-7 1.0e-6
+check water_collapse 1.0e-3 3.0e-3 3.0e-8 5.0e-2 1.0e-4 2.0e-4
+
+if [ $status = 0 ]; then echo "PASSED"; else echo "FAILED"; fi
+exit $status
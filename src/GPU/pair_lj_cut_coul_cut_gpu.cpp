@@ -70,6 +70,7 @@ using namespace LAMMPS_NS;
 PairLJCutCoulCutGPU::PairLJCutCoulCutGPU(LAMMPS *lmp) : PairLJCutCoulCut(lmp), gpu_mode(GPU_PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
   cpu_time = 0.0;
 }
 
@@ -65,6 +65,7 @@ using namespace LAMMPS_NS;
 PairLJCutGPU::PairLJCutGPU(LAMMPS *lmp) : PairLJCut(lmp), gpu_mode(GPU_PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
   cpu_time = 0.0;
 }
 
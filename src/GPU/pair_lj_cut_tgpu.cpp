@@ -64,6 +64,7 @@ using namespace LAMMPS_NS;
 PairLJCutTGPU::PairLJCutTGPU(LAMMPS *lmp) : PairLJCut(lmp), gpu_mode(GPU_PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
   cpu_time = 0.0;
   
   omp = new PairOMPGPU(lmp);
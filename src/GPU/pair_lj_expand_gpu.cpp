@@ -66,6 +66,7 @@ using namespace LAMMPS_NS;
 PairLJExpandGPU::PairLJExpandGPU(LAMMPS *lmp) : PairLJExpand(lmp), gpu_mode(GPU_PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
   cpu_time = 0.0;
 }
 
@@ -64,6 +64,7 @@ using namespace LAMMPS_NS;
 
 PairMorseGPU::PairMorseGPU(LAMMPS *lmp) : PairMorse(lmp), gpu_mode(GPU_PAIR)
 {
+  overlap_enable = 0;
   cpu_time = 0.0;
 }
 
@@ -464,11 +464,11 @@ void FixPour::pre_exchange()
 	coord[1] >= sublo[1] && coord[1] < subhi[1] &&
 	coord[2] >= sublo[2] && coord[2] < subhi[2]) flag = 1;
     else if (domain->dimension == 3 && coord[2] >= domain->boxhi[2] &&
-	     comm->myloc[2] == comm->procgrid[2]-1 &&
+	     comm->mysplit[2][1] == 1.0 &&
 	     coord[0] >= sublo[0] && coord[0] < subhi[0] &&
 	     coord[1] >= sublo[1] && coord[1] < subhi[1]) flag = 1;
     else if (domain->dimension == 2 && coord[1] >= domain->boxhi[1] &&
-	     comm->myloc[1] == comm->procgrid[1]-1 &&
+	     comm->mysplit[1][1] == 1.0 &&
 	     coord[0] >= sublo[0] && coord[0] < subhi[0]) flag = 1;
 
     if (flag) {
@@ -117,6 +117,11 @@ void PPPM::init()
     error->all(FLERR,"Cannot (yet) use PPPM with triclinic box");
   if (domain->dimension == 2) error->all(FLERR,"Cannot use PPPM with 2d simulation");
 
+  // FFT bricks are set up from the uniform processor grid
+
+  if (comm->uniform == 0 || comm->tiled)
+    error->all(FLERR,"Cannot use PPPM with balanced or tiled sub-domains");
+
   if (!atom->q_flag) error->all(FLERR,"Kspace style requires atom attribute q");
 
   if (slabflag == 0 && domain->nonperiodic > 0)
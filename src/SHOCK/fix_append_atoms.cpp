@@ -389,7 +389,7 @@ void FixAppendAtoms::pre_exchange()
 
   if (ntimestep % freq == 0) {
     if (spatflag==1) if (get_spatial()==0) return; 
-    if (comm->myloc[2] == comm->procgrid[2]-1) {
+    if (comm->mysplit[2][1] == 1.0) {
       if (domain->lattice) {
 	nbasis = domain->lattice->nbasis;
 	basistype = new int[nbasis];
@@ -458,7 +458,7 @@ void FixAppendAtoms::pre_exchange()
 		  x[1] >= sublo[1] && x[1] < subhi[1] &&
 		  x[2] >= subhi[2] && x[2] < subhi[2]+size) flag = 1;
 	      else if (domain->dimension == 2 && x[1] >= domain->boxhi[1] &&
-		       comm->myloc[1] == comm->procgrid[1]-1 &&
+		       comm->mysplit[1][1] == 1.0 &&
 		       x[0] >= sublo[0] && x[0] < subhi[0]) flag = 1;
 
 	      if (flag) {
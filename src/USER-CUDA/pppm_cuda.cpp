@@ -214,6 +214,11 @@ void PPPMCuda::init()
     error->all(FLERR,"Cannot (yet) use PPPMCuda with triclinic box");
   if (domain->dimension == 2) error->all(FLERR,"Cannot use PPPMCuda with 2d simulation");
 
+  // FFT bricks are set up from the uniform processor grid
+
+  if (comm->uniform == 0 || comm->tiled)
+    error->all(FLERR,"Cannot use PPPMCuda with balanced or tiled sub-domains");
+
   if (!atom->q_flag) error->all(FLERR,"Kspace style requires atom attribute q");
 
   if (slabflag == 0 && domain->nonperiodic > 0)
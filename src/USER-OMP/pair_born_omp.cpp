@@ -28,6 +28,7 @@ PairBornOMP::PairBornOMP(LAMMPS *lmp) :
   PairBorn(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
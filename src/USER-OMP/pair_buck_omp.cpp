@@ -28,6 +28,7 @@ PairBuckOMP::PairBuckOMP(LAMMPS *lmp) :
   PairBuck(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
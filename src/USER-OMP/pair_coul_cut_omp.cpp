@@ -28,6 +28,7 @@ PairCoulCutOMP::PairCoulCutOMP(LAMMPS *lmp) :
   PairCoulCut(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -28,6 +28,7 @@ PairLJ96CutOMP::PairLJ96CutOMP(LAMMPS *lmp) :
   PairLJ96Cut(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
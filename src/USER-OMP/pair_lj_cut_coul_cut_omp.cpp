@@ -28,6 +28,7 @@ PairLJCutCoulCutOMP::PairLJCutCoulCutOMP(LAMMPS *lmp) :
   PairLJCutCoulCut(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
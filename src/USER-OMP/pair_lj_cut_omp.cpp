@@ -28,6 +28,7 @@ PairLJCutOMP::PairLJCutOMP(LAMMPS *lmp) :
   PairLJCut(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
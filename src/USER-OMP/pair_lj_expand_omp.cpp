@@ -28,6 +28,7 @@ PairLJExpandOMP::PairLJExpandOMP(LAMMPS *lmp) :
   PairLJExpand(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -28,6 +28,7 @@ PairMorseOMP::PairMorseOMP(LAMMPS *lmp) :
   PairMorse(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -0,0 +1,298 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "pair_sdpd_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "domain.h"
+#include "update.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "error.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSDPDOMP::PairSDPDOMP(LAMMPS *lmp) :
+  PairSDPD(lmp), ThrOMP(lmp, PAIR)
+{
+  respa_enable = 0;
+  overlap_enable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSDPDOMP::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) {
+    ev_setup(eflag,vflag);
+    ev_setup_thr(this);
+  } else evflag = vflag_fdotr = 0;
+
+  const int nall = atom->nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+  const int inum = list->inum;
+
+  // check consistency of pair coefficients
+
+  if (first) {
+    char str[256];
+    for (int i = 1; i <= atom->ntypes; i++)
+      for (int j = 1; j <= atom->ntypes; j++)
+        if (cutsq[i][j] > 1.e-32 && (!setflag[i][i] || !setflag[j][j]) &&
+            comm->me == 0) {
+          sprintf(str,"SPH particle types %d and %d interact with cutoff=%g, "
+                  "but not all of their single particle properties are set",
+                  i,j,sqrt(cutsq[i][j]));
+          error->warning(FLERR,str);
+        }
+    first = 0;
+  }
+
+  // the random stress of a pair only depends on seed, step and atom IDs,
+  // so all threads can share the generator
+
+  random_setup();
+  if (implicit) viscous_setup();
+
+  // kernel values shared with other SPH sub-styles of pair hybrid,
+  // each thread stores those of the atoms it loops over
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(Pair::lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared)
+#endif
+  {
+    int ifrom, ito, tid;
+    double **f, *drho, *de;
+
+    f = loop_setup_thr(atom->f, ifrom, ito, tid, inum, nall, nthreads);
+    drho = atom->drho + tid*nall;
+    de = atom->de + tid*nall;
+
+    SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel,
+                        (f, drho, de, ifrom, ito, tid));
+
+    // reduce per thread forces, density and energy rates into global arrays.
+    data_reduce_thr(&(atom->f[0][0]), nall, nthreads, 3, tid);
+    data_reduce_thr(atom->drho, nall, nthreads, 1, tid);
+    data_reduce_thr(atom->de, nall, nthreads, 1, tid);
+  } // end of omp parallel region
+
+  if (kc && kfill) kc->validate();
+
+  // reduce per thread energy and virial, if requested.
+  if (evflag) ev_reduce_thr(this);
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSDPDOMP::eval_kernel(double **f, double *drho, double *de,
+                              int iifrom, int iito, int tid)
+{
+  if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>(f, drho, de, iifrom, iito, tid);
+    else eval<KERNEL,DIM,1,0>(f, drho, de, iifrom, iito, tid);
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>(f, drho, de, iifrom, iito, tid);
+    else eval<KERNEL,DIM,0,0>(f, drho, de, iifrom, iito, tid);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSDPDOMP::eval(double **f, double *drho, double *de,
+                       int iifrom, int iito, int tid)
+{
+  int i, j, ii, jj, jnum, itype, jtype, di;
+  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double r, *kr, *kwfd, *wv;
+  double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, h;
+  double velx, vely, velz, rsq, rinv, tmp, wfd, delVdotDelR, deltaE;
+  double fvisc, Ti, Aij;
+  double fxtmp, fytmp, fztmp, drhotmp, detmp;
+  double eij[3], random_force[3], _dUi[3];
+
+  double **v = atom->vest;
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *tag = atom->tag;
+  int nlocal = atom->nlocal;
+  const double isqrtdt = 1.0 / sqrt(dtrand);
+  const uint32_t step = (uint32_t) update->ntimestep;
+
+  /// Boltzmann constant
+  const double k_bltz = 1.3806503e-23;
+
+  _dUi[2] = 0.0;
+
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+  wv = NULL;
+
+  // loop over neighbors of my atoms
+
+  for (ii = iifrom; ii < iito; ++ii) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    vxtmp = v[i][0];
+    vytmp = v[i][1];
+    vztmp = v[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
+    if (implicit) wv = wvisc + voffset[ii];
+    fxtmp = fytmp = fztmp = drhotmp = detmp = 0.0;
+
+    imass = mass[itype];
+
+    // compute pressure of atom i with Tait EOS
+    tmp = rho[i] / rho0[itype];
+    fi = tmp * tmp * tmp;
+    fi = B[itype] * (fi * fi * tmp - 1.0) / (rho[i] * rho[i]);
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      jmass = mass[jtype];
+
+      if (rsq < cutsq[itype][jtype]) {
+        h = cut[itype][jtype];
+        if (kread) {
+          r = kr[jj];
+          wfd = kwfd[jj];
+        } else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
+        }
+
+        // compute pressure  of atom j with Tait EOS
+        tmp = rho[j] / rho0[jtype];
+        fj = tmp * tmp * tmp;
+        fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[j] * rho[j]);
+
+        velx = vxtmp - v[j][0];
+        vely = vytmp - v[j][1];
+        velz = vztmp - v[j][2];
+
+        // dot product of velocity delta and distance vector
+        delVdotDelR = delx * velx + dely * vely + delz * velz;
+
+        // Morris Viscosity (Morris, 1996)
+
+        rinv = 1.0 / r;
+        eij[0] = delx * rinv;
+        eij[1] = dely * rinv;
+        eij[2] = delz * rinv;
+
+        fvisc = viscosity[itype][jtype] / (rho[i] * rho[j]) * imass * jmass * wfd;
+
+        // random force from the symmetric traceless Wiener increment,
+        // which has variance dt, divided by dt
+
+        Ti = sdpd_temp[itype][jtype];
+        if (Ti > 0) {
+          Aij = sqrt(-4.0 * k_bltz * Ti * fvisc) * isqrtdt;
+          random_stress(step, tag[i], tag[j], DIM, eij, random_force);
+          for (di = 0; di < DIM; di++)
+            _dUi[di] = random_force[di] * Aij;
+        } else {
+          for (di = 0; di < DIM; di++) _dUi[di] = 0.0;
+        }
+
+        // the viscous force is left to the implicit step of fix meso/visc
+
+        if (wv) {
+          wv[jj] = fvisc;
+          fvisc = 0.0;
+        }
+
+        fpair = -imass * jmass * (fi + fj) * wfd;
+        deltaE = -0.5 *(fpair * delVdotDelR + fvisc * (velx*velx + vely*vely + velz*velz));
+
+        fxtmp += delx * fpair + velx * fvisc + _dUi[0];
+        fytmp += dely * fpair + vely * fvisc + _dUi[1];
+        if (DIM == 3) fztmp += delz * fpair + velz * fvisc + _dUi[2];
+
+        // and change in density
+        drhotmp += jmass * delVdotDelR * wfd;
+
+        // change in thermal energy
+        detmp += deltaE;
+
+        if (NEWTON_PAIR || j < nlocal) {
+          f[j][0] -= delx * fpair + velx * fvisc + _dUi[0];
+          f[j][1] -= dely * fpair + vely * fvisc + _dUi[1];
+          if (DIM == 3) f[j][2] -= delz * fpair + velz * fvisc + _dUi[2];
+          de[j] += deltaE;
+          drho[j] += imass * delVdotDelR * wfd;
+        }
+
+        if (EVFLAG) ev_tally_thr(this, i, j, nlocal, NEWTON_PAIR,
+                                 0.0, 0.0, fpair, delx, dely, delz, tid);
+      } else if (wv) wv[jj] = 0.0;
+    }
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+    drho[i] += drhotmp;
+    de[i] += detmp;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSDPDOMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairSDPD::memory_usage();
+
+  return bytes;
+}
@@ -32,6 +32,7 @@ PairSoftOMP::PairSoftOMP(LAMMPS *lmp) :
   PairSoft(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
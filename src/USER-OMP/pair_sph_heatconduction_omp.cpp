@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "pair_sph_heatconduction_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "domain.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHHeatConductionOMP::PairSPHHeatConductionOMP(LAMMPS *lmp) :
+  PairSPHHeatConduction(lmp), ThrOMP(lmp, PAIR)
+{
+  respa_enable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHHeatConductionOMP::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) {
+    ev_setup(eflag,vflag);
+    ev_setup_thr(this);
+  } else evflag = vflag_fdotr = 0;
+
+  const int nall = atom->nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+  const int inum = list->inum;
+
+  // kernel values shared with other SPH sub-styles of pair hybrid,
+  // each thread stores those of the atoms it loops over
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(Pair::lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared)
+#endif
+  {
+    int ifrom, ito, tid;
+    double *de;
+
+    loop_setup_thr(atom->f, ifrom, ito, tid, inum, nall, nthreads);
+    de = atom->de + tid*nall;
+
+    SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel,
+                        (de, ifrom, ito));
+
+    // reduce per thread energy rates into global array.
+    data_reduce_thr(atom->de, nall, nthreads, 1, tid);
+  } // end of omp parallel region
+
+  if (kc && kfill) kc->validate();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHHeatConductionOMP::eval_kernel(double *de, int iifrom, int iito)
+{
+  if (force->newton_pair) eval<KERNEL,DIM,1>(de, iifrom, iito);
+  else eval<KERNEL,DIM,0>(de, iifrom, iito);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int NEWTON_PAIR>
+void PairSPHHeatConductionOMP::eval(double *de, int iifrom, int iito)
+{
+  int i, j, ii, jj, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double r, *kr, *kwfd;
+  double imass, jmass, h;
+  double rsq, wfd, D, deltaE, detmp;
+
+  double **x = atom->x;
+  double *e = atom->e;
+  double *mass = atom->mass;
+  double *rho = atom->rho;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
+  // loop over neighbors of my atoms and do heat diffusion
+
+  for (ii = iifrom; ii < iito; ++ii) {
+    i = ilist[ii];
+    itype = type[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
+    detmp = 0.0;
+
+    imass = mass[itype];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      jmass = mass[jtype];
+
+      if (rsq < cutsq[itype][jtype]) {
+        h = cut[itype][jtype];
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
+        }
+
+        D = alpha[itype][jtype]; // diffusion coefficient
+
+        deltaE = 2.0 * imass * jmass / (imass+jmass);
+        deltaE *= (rho[i] + rho[j]) / (rho[i] * rho[j]);
+        deltaE *= D * (e[i] - e[j]) * wfd;
+
+        detmp += deltaE;
+
+        if (NEWTON_PAIR || j < nlocal) {
+          de[j] -= deltaE;
+        }
+      }
+    }
+    de[i] += detmp;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSPHHeatConductionOMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairSPHHeatConduction::memory_usage();
+
+  return bytes;
+}
@@ -0,0 +1,46 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(sph/heatconduction/omp,PairSPHHeatConductionOMP)
+
+#else
+
+#ifndef LMP_PAIR_SPH_HEATCONDUCTION_OMP_H
+#define LMP_PAIR_SPH_HEATCONDUCTION_OMP_H
+
+#include "pair_sph_heatconduction.h"
+#include "thr_omp.h"
+
+namespace LAMMPS_NS {
+
+class PairSPHHeatConductionOMP : public PairSPHHeatConduction, public ThrOMP {
+
+ public:
+  PairSPHHeatConductionOMP(class LAMMPS *);
+
+  virtual void compute(int, int);
+  virtual double memory_usage();
+
+ private:
+  template <int KERNEL, int DIM>
+  void eval_kernel(double *de, int ifrom, int ito);
+  template <int KERNEL, int DIM, int NEWTON_PAIR>
+  void eval(double *de, int ifrom, int ito);
+};
+
+}
+
+#endif
+#endif
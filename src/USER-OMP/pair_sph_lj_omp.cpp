@@ -0,0 +1,245 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "pair_sph_lj_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "domain.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHLJOMP::PairSPHLJOMP(LAMMPS *lmp) :
+  PairSPHLJ(lmp), ThrOMP(lmp, PAIR)
+{
+  respa_enable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHLJOMP::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) {
+    ev_setup(eflag,vflag);
+    ev_setup_thr(this);
+  } else evflag = vflag_fdotr = 0;
+
+  const int nall = atom->nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+  const int inum = list->inum;
+
+  // kernel values shared with other SPH sub-styles of pair hybrid,
+  // each thread stores those of the atoms it loops over
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(Pair::lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared)
+#endif
+  {
+    int ifrom, ito, tid;
+    double **f, *drho, *de;
+
+    f = loop_setup_thr(atom->f, ifrom, ito, tid, inum, nall, nthreads);
+    drho = atom->drho + tid*nall;
+    de = atom->de + tid*nall;
+
+    SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel,
+                        (f, drho, de, ifrom, ito, tid));
+
+    // reduce per thread forces, density and energy rates into global arrays.
+    data_reduce_thr(&(atom->f[0][0]), nall, nthreads, 3, tid);
+    data_reduce_thr(atom->drho, nall, nthreads, 1, tid);
+    data_reduce_thr(atom->de, nall, nthreads, 1, tid);
+  } // end of omp parallel region
+
+  if (kc && kfill) kc->validate();
+
+  // reduce per thread energy and virial, if requested.
+  if (evflag) ev_reduce_thr(this);
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHLJOMP::eval_kernel(double **f, double *drho, double *de,
+                               int iifrom, int iito, int tid)
+{
+  if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>(f, drho, de, iifrom, iito, tid);
+    else eval<KERNEL,DIM,1,0>(f, drho, de, iifrom, iito, tid);
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>(f, drho, de, iifrom, iito, tid);
+    else eval<KERNEL,DIM,0,0>(f, drho, de, iifrom, iito, tid);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHLJOMP::eval(double **f, double *drho, double *de,
+                        int iifrom, int iito, int tid)
+{
+  int i, j, ii, jj, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double r, *kr, *kwfd;
+  double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, fvisc, h, ih, ihsq, ihcub;
+  double rsq, wfd, delVdotDelR, mu, deltaE, ci, cj, lrc;
+  double fxtmp, fytmp, fztmp, drhotmp, detmp;
+
+  double **v = atom->vest;
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *e = atom->e;
+  double *cv = atom->cv;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
+  // loop over neighbors of my atoms
+
+  for (ii = iifrom; ii < iito; ++ii) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    vxtmp = v[i][0];
+    vytmp = v[i][1];
+    vztmp = v[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
+    fxtmp = fytmp = fztmp = drhotmp = detmp = 0.0;
+
+    imass = mass[itype];
+
+    // compute pressure of particle i with LJ EOS
+    LJEOS2(rho[i], e[i], cv[i], &fi, &ci);
+    fi /= (rho[i] * rho[i]);
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      jmass = mass[jtype];
+
+      if (rsq < cutsq[itype][jtype]) {
+        h = cut[itype][jtype];
+        ih = 1.0 / h;
+        ihsq = ih * ih;
+        ihcub = ihsq * ih;
+
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
+        }
+
+        // function call to LJ EOS
+        LJEOS2(rho[j], e[j], cv[j], &fj, &cj);
+        fj /= (rho[j] * rho[j]);
+
+        // apply long-range correction to model a LJ fluid with cutoff
+        // this implies that the modelled LJ fluid has cutoff == SPH cutoff
+        lrc = - 11.1701 * (ihcub * ihcub * ihcub - 1.5 * ihcub);
+        fi += lrc;
+        fj += lrc;
+
+        // dot product of velocity delta and distance vector
+        delVdotDelR = delx * (vxtmp - v[j][0]) + dely * (vytmp - v[j][1])
+            + delz * (vztmp - v[j][2]);
+
+        // artificial viscosity (Monaghan 1992)
+        if (delVdotDelR < 0.) {
+          mu = h * delVdotDelR / (rsq + 0.01 * h * h);
+          fvisc = -viscosity[itype][jtype] * (ci + cj) * mu / (rho[i] + rho[j]);
+        } else {
+          fvisc = 0.;
+        }
+
+        // total pair force & thermal energy increment
+        fpair = -imass * jmass * (fi + fj + fvisc) * wfd;
+        deltaE = -0.5 * fpair * delVdotDelR;
+
+        fxtmp += delx * fpair;
+        fytmp += dely * fpair;
+        fztmp += delz * fpair;
+
+        // and change in density
+        drhotmp += jmass * delVdotDelR * wfd;
+
+        // change in thermal energy
+        detmp += deltaE;
+
+        if (NEWTON_PAIR || j < nlocal) {
+          f[j][0] -= delx * fpair;
+          f[j][1] -= dely * fpair;
+          f[j][2] -= delz * fpair;
+          de[j] += deltaE;
+          drho[j] += imass * delVdotDelR * wfd;
+        }
+
+        if (EVFLAG) ev_tally_thr(this, i, j, nlocal, NEWTON_PAIR,
+                                 0.0, 0.0, fpair, delx, dely, delz, tid);
+      }
+    }
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+    drho[i] += drhotmp;
+    de[i] += detmp;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSPHLJOMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairSPHLJ::memory_usage();
+
+  return bytes;
+}
@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "pair_sph_rhosum_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "domain.h"
+#include "update.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "error.h"
+#include "sph_kernel.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHRhoSumOMP::PairSPHRhoSumOMP(LAMMPS *lmp) :
+  PairSPHRhoSum(lmp), ThrOMP(lmp, PAIR)
+{
+  respa_enable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHRhoSumOMP::compute(int eflag, int vflag)
+{
+  // the per-atom smoothing length of fix meso/hsml is not threaded
+
+  if (adaptive) {
+    PairSPHRhoSum::compute(eflag,vflag);
+    return;
+  }
+
+  if (eflag || vflag) {
+    ev_setup(eflag,vflag);
+    ev_setup_thr(this);
+  } else evflag = vflag_fdotr = 0;
+
+  const int nall = atom->nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+  const int inum = list->inum;
+
+  // check consistency of pair coefficients
+
+  if (first) {
+    char str[256];
+    for (int i = 1; i <= atom->ntypes; i++)
+      for (int j = 1; j <= atom->ntypes; j++)
+        if (cutsq[i][j] > 0.0 && (!setflag[i][i] || !setflag[j][j]) &&
+            comm->me == 0) {
+          sprintf(str,"SPH particle types %d and %d interact, "
+                  "but not all of their single particle properties are set",
+                  i,j);
+          error->warning(FLERR,str);
+        }
+    first = 0;
+  }
+
+  // recompute density
+  // with a full neighbor list each thread only writes to its own atoms,
+  // so no per thread density arrays are needed
+
+  if (nstep != 0) {
+    if ((update->ntimestep % nstep) == 0) {
+#if defined(_OPENMP)
+#pragma omp parallel default(shared)
+#endif
+      {
+        int ifrom, ito, tid;
+
+        loop_setup_thr(atom->f, ifrom, ito, tid, inum, nall, nthreads);
+        SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval, (ifrom, ito));
+      } // end of omp parallel region
+    }
+  }
+
+  // communicate densities
+  comm->forward_comm_pair(this);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHRhoSumOMP::eval(int iifrom, int iito)
+{
+  int i, j, ii, jj, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz;
+  double rsq, h, wf, rhotmp;
+  int *ilist, *jlist, *numneigh, **firstneigh;
+
+  double **x = atom->x;
+  double *rho = atom->rho;
+  int *type = atom->type;
+  double *mass = atom->mass;
+
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  for (ii = iifrom; ii < iito; ++ii) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    // initialize density with self-contribution
+
+    h = cut[itype][itype];
+    wf = SPHKernel::Kernel<KERNEL,DIM>::w(0.0, h);
+    rhotmp = mass[itype] * wf;
+
+    // add density at each atom via kernel function overlap
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      jtype = type[j];
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+
+      if (rsq < cutsq[itype][jtype]) {
+        h = cut[itype][jtype];
+        wf = SPHKernel::Kernel<KERNEL,DIM>::w(sqrt(rsq), h);
+        rhotmp += mass[jtype] * wf;
+      }
+    }
+    rho[i] = rhotmp;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSPHRhoSumOMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairSPHRhoSum::memory_usage();
+
+  return bytes;
+}
@@ -0,0 +1,264 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   This software is distributed under the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "pair_sph_taitwater_morris_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "domain.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "error.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHTaitwaterMorrisOMP::PairSPHTaitwaterMorrisOMP(LAMMPS *lmp) :
+  PairSPHTaitwaterMorris(lmp), ThrOMP(lmp, PAIR)
+{
+  respa_enable = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHTaitwaterMorrisOMP::compute(int eflag, int vflag)
+{
+  if (eflag || vflag) {
+    ev_setup(eflag,vflag);
+    ev_setup_thr(this);
+  } else evflag = vflag_fdotr = 0;
+
+  const int nall = atom->nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+  const int inum = list->inum;
+
+  // check consistency of pair coefficients
+
+  if (first) {
+    char str[256];
+    for (int i = 1; i <= atom->ntypes; i++)
+      for (int j = 1; j <= atom->ntypes; j++)
+        if (cutsq[i][j] > 1.e-32 && (!setflag[i][i] || !setflag[j][j]) &&
+            comm->me == 0) {
+          sprintf(str,"SPH particle types %d and %d interact with cutoff=%g, "
+                  "but not all of their single particle properties are set",
+                  i,j,sqrt(cutsq[i][j]));
+          error->warning(FLERR,str);
+        }
+    first = 0;
+  }
+
+  // kernel values shared with other SPH sub-styles of pair hybrid,
+  // each thread stores those of the atoms it loops over
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(Pair::lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared)
+#endif
+  {
+    int ifrom, ito, tid;
+    double **f, *drho, *de;
+
+    f = loop_setup_thr(atom->f, ifrom, ito, tid, inum, nall, nthreads);
+    drho = atom->drho + tid*nall;
+    de = atom->de + tid*nall;
+
+    SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel,
+                        (f, drho, de, ifrom, ito, tid));
+
+    // reduce per thread forces, density and energy rates into global arrays.
+    data_reduce_thr(&(atom->f[0][0]), nall, nthreads, 3, tid);
+    data_reduce_thr(atom->drho, nall, nthreads, 1, tid);
+    data_reduce_thr(atom->de, nall, nthreads, 1, tid);
+  } // end of omp parallel region
+
+  if (kc && kfill) kc->validate();
+
+  // reduce per thread energy and virial, if requested.
+  if (evflag) ev_reduce_thr(this);
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHTaitwaterMorrisOMP::eval_kernel(double **f, double *drho, double *de,
+                                            int iifrom, int iito, int tid)
+{
+  if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>(f, drho, de, iifrom, iito, tid);
+    else eval<KERNEL,DIM,1,0>(f, drho, de, iifrom, iito, tid);
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>(f, drho, de, iifrom, iito, tid);
+    else eval<KERNEL,DIM,0,0>(f, drho, de, iifrom, iito, tid);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHTaitwaterMorrisOMP::eval(double **f, double *drho, double *de,
+                                     int iifrom, int iito, int tid)
+{
+  int i, j, ii, jj, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, vxtmp, vytmp, vztmp, tmpi, pi;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double *kr, *kwfd;
+  double fxtmp, fytmp, fztmp, drhotmp, detmp;
+
+  // per-pair math in the precision selected by SPH_SCALAR,
+  // distances are taken in double precision before the conversion
+
+  SPH_SCALAR delx, dely, delz, rsq, r, h, wfd, velx, vely, velz;
+  SPH_SCALAR delVdotDelR, tmp, rhoi, rhoj, imass, jmass, fi, fj;
+  SPH_SCALAR cvisc, fvisc, fpair, deltaE;
+
+  double **v = atom->vest;
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
+  // loop over neighbors of my atoms
+
+  for (ii = iifrom; ii < iito; ++ii) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    vxtmp = v[i][0];
+    vytmp = v[i][1];
+    vztmp = v[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
+    fxtmp = fytmp = fztmp = drhotmp = detmp = 0.0;
+
+    imass = mass[itype];
+
+    // compute pressure of atom i with Tait EOS
+    tmpi = rho[i] / rho0[itype];
+    pi = tmpi * tmpi * tmpi;
+    fi = B[itype] * (pi * pi * tmpi - 1.0) / (rho[i] * rho[i]);
+    rhoi = rho[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      jmass = mass[jtype];
+
+      if (rsq < cutsq[itype][jtype]) {
+        h = cut[itype][jtype];
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM,SPH_SCALAR>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
+        }
+
+        // compute pressure  of atom j with Tait EOS
+        rhoj = rho[j];
+        tmp = rhoj / SPH_SCALAR(rho0[jtype]);
+        fj = tmp * tmp * tmp;
+        fj = SPH_SCALAR(B[jtype]) * (fj * fj * tmp - SPH_SCALAR(1.0)) /
+          (rhoj * rhoj);
+
+        velx = vxtmp - v[j][0];
+        vely = vytmp - v[j][1];
+        velz = vztmp - v[j][2];
+
+        // dot product of velocity delta and distance vector
+        delVdotDelR = delx * velx + dely * vely + delz * velz;
+
+        // Morris Viscosity (Morris, 1996)
+
+        cvisc = viscosity[itype][jtype];
+        fvisc = SPH_SCALAR(2.0) * cvisc / (rhoi * rhoj);
+
+        fvisc *= imass * jmass * wfd;
+
+        // total pair force & thermal energy increment
+        fpair = -imass * jmass * (fi + fj) * wfd;
+        deltaE = SPH_SCALAR(-0.5) * (fpair * delVdotDelR + fvisc *
+                                     (velx*velx + vely*vely + velz*velz));
+
+        fxtmp += delx * fpair + velx * fvisc;
+        fytmp += dely * fpair + vely * fvisc;
+        fztmp += delz * fpair + velz * fvisc;
+
+        // and change in density
+        drhotmp += jmass * delVdotDelR * wfd;
+
+        // change in thermal energy
+        detmp += deltaE;
+
+        if (NEWTON_PAIR || j < nlocal) {
+          f[j][0] -= delx * fpair + velx * fvisc;
+          f[j][1] -= dely * fpair + vely * fvisc;
+          f[j][2] -= delz * fpair + velz * fvisc;
+          de[j] += deltaE;
+          drho[j] += imass * delVdotDelR * wfd;
+        }
+
+        if (EVFLAG) ev_tally_thr(this, i, j, nlocal, NEWTON_PAIR,
+                                 0.0, 0.0, fpair, delx, dely, delz, tid);
+      }
+    }
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+    drho[i] += drhotmp;
+    de[i] += detmp;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSPHTaitwaterMorrisOMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairSPHTaitwaterMorris::memory_usage();
+
+  return bytes;
+}
@@ -28,6 +28,7 @@ PairYukawaOMP::PairYukawaOMP(LAMMPS *lmp) :
   PairYukawa(lmp), ThrOMP(lmp, PAIR)
 {
   respa_enable = 0;
+  overlap_enable = 0;
 }
 
 /* ---------------------------------------------------------------------- */
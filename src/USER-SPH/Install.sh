@@ -3,7 +3,6 @@
 if (test $1 = 1) then
 
   cp -p pair_sdpd.cpp ..
-  cp -p wiener.cpp .. 
   cp -p atom_vec_meso.cpp ..
   cp -p pair_sph_heatconduction.cpp ..
   cp -p pair_sph_idealgas.cpp ..
@@ -11,14 +10,26 @@ if (test $1 = 1) then
   cp -p pair_sph_rhosum.cpp ..
   cp -p pair_sph_taitwater.cpp ..
   cp -p pair_sph_taitwater_morris.cpp ..
+  cp -p pair_sph_taitwater_rhosum.cpp ..
+  cp -p sph_kernel_cache.cpp ..
   cp -p compute_meso_e_atom.cpp ..
   cp -p compute_meso_rho_atom.cpp ..
   cp -p compute_meso_t_atom.cpp ..
   cp -p fix_meso.cpp ..
   cp -p fix_meso_stationary.cpp ..
+  cp -p fix_meso_hsml.cpp ..
+  cp -p fix_meso_dt.cpp ..
+  cp -p fix_meso_block.cpp ..
+  cp -p fix_meso_visc.cpp ..
+  cp -p fix_meso_grid.cpp ..
+  cp -p fix_meso_split.cpp ..
+  cp -p pair_sph_isph.cpp ..
+  cp -p fix_isph.cpp ..
 
   cp -p pair_sdpd.h ..
-  cp -p wiener.h .. 
+  cp -p random_philox.h ..
+  cp -p sph_kernel.h ..
+  cp -p sph_kernel_cache.h ..
   cp -p atom_vec_meso.h ..
   cp -p pair_sph_heatconduction.h ..
   cp -p pair_sph_idealgas.h ..
@@ -26,15 +37,23 @@ if (test $1 = 1) then
   cp -p pair_sph_rhosum.h ..
   cp -p pair_sph_taitwater.h ..
   cp -p pair_sph_taitwater_morris.h ..
+  cp -p pair_sph_taitwater_rhosum.h ..
   cp -p compute_meso_e_atom.h ..
   cp -p compute_meso_rho_atom.h ..
   cp -p compute_meso_t_atom.h ..
   cp -p fix_meso.h ..
   cp -p fix_meso_stationary.h ..
+  cp -p fix_meso_hsml.h ..
+  cp -p fix_meso_dt.h ..
+  cp -p fix_meso_block.h ..
+  cp -p fix_meso_visc.h ..
+  cp -p fix_meso_grid.h ..
+  cp -p fix_meso_split.h ..
+  cp -p pair_sph_isph.h ..
+  cp -p fix_isph.h ..
 
 elif (test $1 = 0) then
   rm -f ../pair_sdpd.cpp
-  rm -f ../wiener.cpp 
   rm -f ../atom_vec_meso.cpp
   rm -f ../pair_sph_heatconduction.cpp
   rm -f ../pair_sph_idealgas.cpp
@@ -42,14 +61,26 @@ elif (test $1 = 0) then
   rm -f ../pair_sph_rhosum.cpp
   rm -f ../pair_sph_taitwater.cpp
   rm -f ../pair_sph_taitwater_morris.cpp
+  rm -f ../pair_sph_taitwater_rhosum.cpp
+  rm -f ../sph_kernel_cache.cpp
   rm -f ../compute_meso_e_atom.cpp
   rm -f ../compute_meso_rho_atom.cpp
   rm -f ../compute_meso_t_atom.cpp
   rm -f ../fix_meso.cpp
   rm -f ../fix_meso_stationary.cpp
+  rm -f ../fix_meso_hsml.cpp
+  rm -f ../fix_meso_dt.cpp
+  rm -f ../fix_meso_block.cpp
+  rm -f ../fix_meso_visc.cpp
+  rm -f ../fix_meso_grid.cpp
+  rm -f ../fix_meso_split.cpp
+  rm -f ../pair_sph_isph.cpp
+  rm -f ../fix_isph.cpp
 
   rm -f ../pair_sdpd.h
-  rm -f ../wiener.h
+  rm -f ../random_philox.h
+  rm -f ../sph_kernel.h
+  rm -f ../sph_kernel_cache.h
   rm -f ../atom_vec_meso.h
   rm -f ../pair_sph_heatconduction.h
   rm -f ../pair_sph_idealgas.h
@@ -57,10 +88,19 @@ elif (test $1 = 0) then
   rm -f ../pair_sph_rhosum.h
   rm -f ../pair_sph_taitwater.h
   rm -f ../pair_sph_taitwater_morris.h
+  rm -f ../pair_sph_taitwater_rhosum.h
   rm -f ../compute_meso_e_atom.h
   rm -f ../compute_meso_rho_atom.h
   rm -f ../compute_meso_t_atom.h
   rm -f ../fix_meso.h
   rm -f ../fix_meso_stationary.h
+  rm -f ../fix_meso_hsml.h
+  rm -f ../fix_meso_dt.h
+  rm -f ../fix_meso_block.h
+  rm -f ../fix_meso_visc.h
+  rm -f ../fix_meso_grid.h
+  rm -f ../fix_meso_split.h
+  rm -f ../pair_sph_isph.h
+  rm -f ../fix_isph.h
 
 fi
@@ -12,6 +12,7 @@
  ------------------------------------------------------------------------- */
 
 #include "stdlib.h"
+#include "lmptype.h"
 #include "atom_vec_meso.h"
 #include "atom.h"
 #include "comm.h"
@@ -34,9 +35,9 @@ AtomVecMeso::AtomVecMeso(LAMMPS *lmp, int narg, char **arg) :
 
 	comm_x_only = 0; // we communicate not only x forward but also vest ...
 	comm_f_only = 0; // we also communicate de and drho in reverse direction
-	size_forward = 8; // 3 + rho + e + vest[3], that means we may only communicate 5 in hybrid
+	size_forward = 9; // 3 + rho + e + vest[3] + hsml, that means we may only communicate 6 in hybrid
 	size_reverse = 5; // 3 + drho + de
-	size_border = 12; // 6 + rho + e + vest[3] + cv
+	size_border = 14; // 6 + rho + e + vest[3] + cv + hsml + radius
 	size_velocity = 3;
 	size_data_atom = 8;
 	size_data_vel = 4;
@@ -46,6 +47,16 @@ AtomVecMeso::AtomVecMeso(LAMMPS *lmp, int narg, char **arg) :
 	atom->rho_flag = 1;
 	atom->cv_flag = 1;
 	atom->vest_flag = 1;
+
+	soa = NULL;
+	nmax_soa = 0;
+	xs = ys = zs = vxs = vys = vzs = rhos = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+AtomVecMeso::~AtomVecMeso() {
+	memory->sfree(soa);
 }
 
 /* ----------------------------------------------------------------------
@@ -77,12 +88,60 @@ void AtomVecMeso::grow(int n) {
 	de = memory->grow(atom->de, nmax*comm->nthreads, "atom:de");
 	vest = memory->grow(atom->vest, nmax, 3, "atom:vest");
 	cv = memory->grow(atom->cv, nmax, "atom:cv");
+	hsml = memory->grow(atom->hsml, nmax, "atom:hsml");
+	gradh = memory->grow(atom->gradh, nmax, "atom:gradh");
+	radius = memory->grow(atom->radius, nmax, "atom:radius");
+
+	if (soa) grow_soa();
 
 	if (atom->nextra_grow)
 		for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
 			modify->fix[atom->extra_grow[iextra]]->grow_arrays(nmax);
 }
 
+/* ----------------------------------------------------------------------
+ grow SoA streams to nmax, contents are not preserved
+ all streams share one allocation, each starts at a 64-byte boundary
+ ------------------------------------------------------------------------- */
+
+void AtomVecMeso::grow_soa() {
+	if (nmax_soa >= nmax) return;
+	nmax_soa = (nmax + 7) & ~7;
+
+	memory->sfree(soa);
+	soa = (double *) memory->smalloc((7*(bigint) nmax_soa + 8) * sizeof(double),
+					 "atom:soa");
+
+	double *ptr = (double *) (((uintptr_t) soa + 63) & ~((uintptr_t) 63));
+	xs = ptr;
+	ys = xs + nmax_soa;
+	zs = ys + nmax_soa;
+	vxs = zs + nmax_soa;
+	vys = vxs + nmax_soa;
+	vzs = vys + nmax_soa;
+	rhos = vzs + nmax_soa;
+}
+
+/* ----------------------------------------------------------------------
+ copy x, vest and rho of atoms lo to hi-1 into the SoA streams
+ called by pair styles before their pair loop, since fixes update
+   the per-atom arrays directly
+ ------------------------------------------------------------------------- */
+
+void AtomVecMeso::soa_update(int lo, int hi) {
+	if (soa == NULL || nmax_soa < nmax) grow_soa();
+
+	for (int i = lo; i < hi; i++) {
+		xs[i] = x[i][0];
+		ys[i] = x[i][1];
+		zs[i] = x[i][2];
+		vxs[i] = vest[i][0];
+		vys[i] = vest[i][1];
+		vzs[i] = vest[i][2];
+		rhos[i] = rho[i];
+	}
+}
+
 /* ----------------------------------------------------------------------
  reset local array ptrs
  ------------------------------------------------------------------------- */
@@ -101,6 +160,9 @@ void AtomVecMeso::grow_reset() {
 	de = atom->de;
 	vest = atom->vest;
 	cv = atom->cv;
+	hsml = atom->hsml;
+	gradh = atom->gradh;
+	radius = atom->radius;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -126,6 +188,9 @@ void AtomVecMeso::copy(int i, int j, int delflag) {
 	vest[j][0] = vest[i][0];
 	vest[j][1] = vest[i][1];
 	vest[j][2] = vest[i][2];
+	hsml[j] = hsml[i];
+	gradh[j] = gradh[i];
+	radius[j] = radius[i];
 
 	if (atom->nextra_grow)
 		for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
@@ -146,6 +211,7 @@ int AtomVecMeso::pack_comm_hybrid(int n, int *list, double *buf) {
 		buf[m++] = vest[j][0];
 		buf[m++] = vest[j][1];
 		buf[m++] = vest[j][2];
+		buf[m++] = hsml[j];
 	}
 	return m;
 }
@@ -164,6 +230,7 @@ int AtomVecMeso::unpack_comm_hybrid(int n, int first, double *buf) {
 		vest[i][0] = buf[m++];
 		vest[i][1] = buf[m++];
 		vest[i][2] = buf[m++];
+		hsml[i] = buf[m++];
 	}
 	return m;
 }
@@ -182,6 +249,8 @@ int AtomVecMeso::pack_border_hybrid(int n, int *list, double *buf) {
 		buf[m++] = vest[j][0];
 		buf[m++] = vest[j][1];
 		buf[m++] = vest[j][2];
+		buf[m++] = hsml[j];
+		buf[m++] = radius[j];
 	}
 	return m;
 }
@@ -200,6 +269,8 @@ int AtomVecMeso::unpack_border_hybrid(int n, int first, double *buf) {
 		vest[i][0] = buf[m++];
 		vest[i][1] = buf[m++];
 		vest[i][2] = buf[m++];
+		hsml[i] = buf[m++];
+		radius[i] = buf[m++];
 	}
 	return m;
 }
@@ -254,6 +325,7 @@ int AtomVecMeso::pack_comm(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
 		}
 	} else {
 		if (domain->triclinic == 0) {
@@ -275,6 +347,7 @@ int AtomVecMeso::pack_comm(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
 		}
 	}
 	return m;
@@ -303,6 +376,7 @@ int AtomVecMeso::pack_comm_vel(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
 		}
 	} else {
 		if (domain->triclinic == 0) {
@@ -327,6 +401,7 @@ int AtomVecMeso::pack_comm_vel(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
 		}
 	}
 	return m;
@@ -349,6 +424,7 @@ void AtomVecMeso::unpack_comm(int n, int first, double *buf) {
 		vest[i][0] = buf[m++];
 		vest[i][1] = buf[m++];
 		vest[i][2] = buf[m++];
+		hsml[i] = buf[m++];
 	}
 }
 
@@ -372,6 +448,7 @@ void AtomVecMeso::unpack_comm_vel(int n, int first, double *buf) {
 		vest[i][0] = buf[m++];
 		vest[i][1] = buf[m++];
 		vest[i][2] = buf[m++];
+		hsml[i] = buf[m++];
 	}
 }
 
@@ -434,6 +511,8 @@ int AtomVecMeso::pack_border(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
+			buf[m++] = radius[j];
 		}
 	} else {
 		if (domain->triclinic == 0) {
@@ -459,6 +538,8 @@ int AtomVecMeso::pack_border(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
+			buf[m++] = radius[j];
 		}
 	}
 	return m;
@@ -491,6 +572,8 @@ int AtomVecMeso::pack_border_vel(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
+			buf[m++] = radius[j];
 		}
 	} else {
 		if (domain->triclinic == 0) {
@@ -519,6 +602,8 @@ int AtomVecMeso::pack_border_vel(int n, int *list, double *buf, int pbc_flag,
 			buf[m++] = vest[j][0];
 			buf[m++] = vest[j][1];
 			buf[m++] = vest[j][2];
+			buf[m++] = hsml[j];
+			buf[m++] = radius[j];
 		}
 	}
 	return m;
@@ -547,6 +632,8 @@ void AtomVecMeso::unpack_border(int n, int first, double *buf) {
 		vest[i][0] = buf[m++];
 		vest[i][1] = buf[m++];
 		vest[i][2] = buf[m++];
+		hsml[i] = buf[m++];
+		radius[i] = buf[m++];
 	}
 }
 
@@ -576,6 +663,8 @@ void AtomVecMeso::unpack_border_vel(int n, int first, double *buf) {
 		vest[i][0] = buf[m++];
 		vest[i][1] = buf[m++];
 		vest[i][2] = buf[m++];
+		hsml[i] = buf[m++];
+		radius[i] = buf[m++];
 	}
 }
 
@@ -603,6 +692,8 @@ int AtomVecMeso::pack_exchange(int i, double *buf) {
 	buf[m++] = vest[i][0];
 	buf[m++] = vest[i][1];
 	buf[m++] = vest[i][2];
+	buf[m++] = hsml[i];
+	buf[m++] = radius[i];
 
 	if (atom->nextra_grow)
 		for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
@@ -637,6 +728,8 @@ int AtomVecMeso::unpack_exchange(double *buf) {
 	vest[nlocal][0] = buf[m++];
 	vest[nlocal][1] = buf[m++];
 	vest[nlocal][2] = buf[m++];
+	hsml[nlocal] = buf[m++];
+	radius[nlocal] = buf[m++];
 
 	if (atom->nextra_grow)
 		for (int iextra = 0; iextra < atom->nextra_grow; iextra++)
@@ -656,7 +749,7 @@ int AtomVecMeso::size_restart() {
 	int i;
 
 	int nlocal = atom->nlocal;
-	int n = 17 * nlocal; // 11 + rho + e + cv + vest[3]
+	int n = 19 * nlocal; // 11 + rho + e + cv + vest[3] + hsml + radius
 
 	if (atom->nextra_restart)
 		for (int iextra = 0; iextra < atom->nextra_restart; iextra++)
@@ -690,6 +783,8 @@ int AtomVecMeso::pack_restart(int i, double *buf) {
 	buf[m++] = vest[i][0];
 	buf[m++] = vest[i][1];
 	buf[m++] = vest[i][2];
+	buf[m++] = hsml[i];
+	buf[m++] = radius[i];
 
 	if (atom->nextra_restart)
 		for (int iextra = 0; iextra < atom->nextra_restart; iextra++)
@@ -728,6 +823,8 @@ int AtomVecMeso::unpack_restart(double *buf) {
 	vest[nlocal][0] = buf[m++];
 	vest[nlocal][1] = buf[m++];
 	vest[nlocal][2] = buf[m++];
+	hsml[nlocal] = buf[m++];
+	radius[nlocal] = buf[m++];
 
 	double **extra = atom->extra;
 	if (atom->nextra_store) {
@@ -768,6 +865,9 @@ void AtomVecMeso::create_atom(int itype, double *coord) {
 	vest[nlocal][2] = 0.0;
 	de[nlocal] = 0.0;
 	drho[nlocal] = 0.0;
+	hsml[nlocal] = 0.0;
+	gradh[nlocal] = 1.0;
+	radius[nlocal] = 0.0;
 
 	atom->nlocal++;
 }
@@ -813,6 +913,9 @@ void AtomVecMeso::data_atom(double *coord, int imagetmp, char **values) {
 
 	de[nlocal] = 0.0;
 	drho[nlocal] = 0.0;
+	hsml[nlocal] = 0.0;
+	gradh[nlocal] = 1.0;
+	radius[nlocal] = 0.0;
 
 	atom->nlocal++;
 }
@@ -828,6 +931,10 @@ int AtomVecMeso::data_atom_hybrid(int nlocal, char **values) {
 	e[nlocal] = atof(values[1]);
 	cv[nlocal] = atof(values[2]);
 
+	hsml[nlocal] = 0.0;
+	gradh[nlocal] = 1.0;
+	radius[nlocal] = 0.0;
+
 	return 3;
 }
 
@@ -864,6 +971,14 @@ bigint AtomVecMeso::memory_usage() {
 		bytes += memory->usage(cv, nmax);
 	if (atom->memcheck("vest"))
 		bytes += memory->usage(vest, nmax);
+	if (atom->memcheck("hsml"))
+		bytes += memory->usage(hsml, nmax);
+	if (atom->memcheck("gradh"))
+		bytes += memory->usage(gradh, nmax);
+	if (atom->memcheck("radius"))
+		bytes += memory->usage(radius, nmax);
+	if (soa)
+		bytes += (7*(bigint) nmax_soa + 8) * sizeof(double);
 
 	return bytes;
 }
@@ -27,7 +27,7 @@ namespace LAMMPS_NS {
 class AtomVecMeso : public AtomVec {
  public:
   AtomVecMeso(class LAMMPS *, int, char **);
-  ~AtomVecMeso() {}
+  ~AtomVecMeso();
   void grow(int);
   void grow_reset();
   void copy(int, int, int);
@@ -61,11 +61,27 @@ class AtomVecMeso : public AtomVec {
   int data_atom_hybrid(int, char **);
   bigint memory_usage();
 
+  // structure-of-arrays copy of the per-atom data read by SPH pair loops
+  // each stream is 64-byte aligned, valid after soa_update()
+
+  double *xs,*ys,*zs;
+  double *vxs,*vys,*vzs;       // estimated velocity vest
+  double *rhos;
+
+  void soa_update(int, int);
+
  private:
   int *tag,*type,*mask,*image;
   double **x,**v,**f;
   double *rho, *drho, *e, *de, *cv;
   double **vest; // estimated velocity during force computation
+  double *hsml, *gradh; // smoothing length and its grad-h correction
+  double *radius; // neighbor radius, set by fix meso/hsml
+
+  double *soa;                 // storage of all SoA streams
+  int nmax_soa;                // length of each stream
+
+  void grow_soa();
 };
 
 }
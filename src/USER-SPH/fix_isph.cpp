@@ -0,0 +1,583 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_isph.h"
+#include "pair_sph_isph.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{VSTAR,SCALAR,REV_DIV,REV_SCALAR,REV_GRAD};
+
+/* ---------------------------------------------------------------------- */
+
+FixISPH::FixISPH(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if ((atom->e_flag != 1) || (atom->rho_flag != 1))
+    error->all(FLERR,
+        "fix isph command requires atom_style with both energy and density");
+
+  tolerance = 1.0e-6;
+  maxiter = 500;
+  surface = 0.0;
+
+  int iarg = 3;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal fix isph command");
+    if (strcmp(arg[iarg],"tol") == 0) tolerance = atof(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"maxiter") == 0) maxiter = atoi(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"surface") == 0) surface = atof(arg[iarg+1]);
+    else error->all(FLERR,"Illegal fix isph command");
+    iarg += 2;
+  }
+
+  if (tolerance <= 0.0 || maxiter <= 0 || surface < 0.0)
+    error->all(FLERR,"Illegal fix isph command");
+
+  time_integrate = 1;
+  vector_flag = 1;
+  size_vector = 2;
+  global_freq = 1;
+  extvector = 0;
+  peratom_flag = 1;
+  size_peratom_cols = 0;
+  peratom_freq = 1;
+
+  // v* and scalars of ghost atoms, partial sums of ghost atoms
+
+  comm_forward = 3;
+  comm_reverse = 3;
+
+  // perform initial allocation of atom-based arrays
+  // register with Atom class
+
+  pressure = NULL;
+  grow_arrays(atom->nmax);
+  atom->add_callback(0);
+
+  for (int i = 0; i < atom->nlocal; i++) pressure[i] = 0.0;
+
+  nmax = 0;
+  div = divr = diag = NULL;
+  rhs = res = zvec = dir = adir = NULL;
+  grad = NULL;
+  fixed = NULL;
+
+  pair = NULL;
+  niter = 0;
+  resnorm = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixISPH::~FixISPH()
+{
+  // unregister callbacks to this fix from Atom class
+
+  atom->delete_callback(id,0);
+
+  memory->destroy(pressure);
+  memory->destroy(div);
+  memory->destroy(divr);
+  memory->destroy(diag);
+  memory->destroy(rhs);
+  memory->destroy(res);
+  memory->destroy(zvec);
+  memory->destroy(dir);
+  memory->destroy(adir);
+  memory->destroy(grad);
+  memory->destroy(fixed);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixISPH::setmask()
+{
+  int mask = 0;
+  mask |= INITIAL_INTEGRATE;
+  mask |= FINAL_INTEGRATE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixISPH::init()
+{
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+
+  if (strstr(update->integrate_style,"respa"))
+    error->all(FLERR,"Fix isph does not support run_style respa");
+
+  pair = (PairSPHISPH *) force->pair_match("sph/isph",1);
+  if (pair == NULL) error->all(FLERR,"Fix isph requires pair style sph/isph");
+}
+
+/* ----------------------------------------------------------------------
+   drift with the divergence-free velocity of the last step
+   vest carries it to the ghost atoms for the viscous forces
+------------------------------------------------------------------------- */
+
+void FixISPH::initial_integrate(int vflag)
+{
+  double **x = atom->x;
+  double **v = atom->v;
+  double **vest = atom->vest;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  if (igroup == atom->firstgroup) nlocal = atom->nfirst;
+
+  for (int i = 0; i < nlocal; i++) {
+    vest[i][0] = v[i][0];
+    vest[i][1] = v[i][1];
+    vest[i][2] = v[i][2];
+
+    if (mask[i] & groupbit) {
+      x[i][0] += dtv * v[i][0];
+      x[i][1] += dtv * v[i][1];
+      x[i][2] += dtv * v[i][2];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   projection step (Cummins and Rudman, 1999)
+   v* = v + dt f/m with the viscous and external forces
+   solve -div(grad p / rho) = -div v* / dt for the pressure
+   v = v* - dt grad p / rho, and x moves with the mean of the old and
+     new v over the step
+   atoms outside the group, e.g. walls, keep their velocity, but take
+     part in the pressure solve
+------------------------------------------------------------------------- */
+
+void FixISPH::final_integrate()
+{
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double **vest = atom->vest;
+  double *e = atom->e;
+  double *de = atom->de;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int rmass_flag = atom->rmass_flag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  int i;
+
+  if (atom->nmax > nmax) {
+    nmax = atom->nmax;
+    memory->destroy(div);
+    memory->destroy(divr);
+    memory->destroy(diag);
+    memory->destroy(rhs);
+    memory->destroy(res);
+    memory->destroy(zvec);
+    memory->destroy(dir);
+    memory->destroy(adir);
+    memory->destroy(grad);
+    memory->destroy(fixed);
+    memory->create(div,nmax,"isph:div");
+    memory->create(divr,nmax,"isph:divr");
+    memory->create(diag,nmax,"isph:diag");
+    memory->create(rhs,nmax,"isph:rhs");
+    memory->create(res,nmax,"isph:res");
+    memory->create(zvec,nmax,"isph:zvec");
+    memory->create(dir,nmax,"isph:dir");
+    memory->create(adir,nmax,"isph:adir");
+    memory->create(grad,nmax,3,"isph:grad");
+    memory->create(fixed,nmax,"isph:fixed");
+  }
+
+  // intermediate velocity v*
+
+  double dtfm;
+  for (i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) {
+      if (rmass_flag) dtfm = 2.0 * dtf / rmass[i];
+      else dtfm = 2.0 * dtf / mass[type[i]];
+      vest[i][0] = v[i][0] + dtfm * f[i][0];
+      vest[i][1] = v[i][1] + dtfm * f[i][1];
+      vest[i][2] = v[i][2] + dtfm * f[i][2];
+    }
+  }
+
+  commflag = VSTAR;
+  comm->forward_comm_fix(this);
+
+  for (i = 0; i < nall; i++) div[i] = divr[i] = diag[i] = 0.0;
+  pair->divergence(vest,div,divr,diag);
+  if (force->newton_pair) {
+    commflag = REV_DIV;
+    comm->reverse_comm_fix(this);
+  }
+
+  solve();
+
+  // pressure correction
+
+  for (i = 0; i < nall; i++) grad[i][0] = grad[i][1] = grad[i][2] = 0.0;
+  commflag = SCALAR;
+  cvec = pressure;
+  comm->forward_comm_fix(this);
+  pair->gradient(pressure,grad);
+  if (force->newton_pair) {
+    commflag = REV_GRAD;
+    comm->reverse_comm_fix(this);
+  }
+
+  double vnew[3];
+  for (i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) {
+      vnew[0] = vest[i][0] - dtv * grad[i][0];
+      vnew[1] = vest[i][1] - dtv * grad[i][1];
+      vnew[2] = vest[i][2] - dtv * grad[i][2];
+
+      x[i][0] += 0.5 * dtv * (vnew[0] - v[i][0]);
+      x[i][1] += 0.5 * dtv * (vnew[1] - v[i][1]);
+      x[i][2] += 0.5 * dtv * (vnew[2] - v[i][2]);
+
+      v[i][0] = vnew[0];
+      v[i][1] = vnew[1];
+      v[i][2] = vnew[2];
+
+      e[i] += 2.0 * dtf * de[i];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   solve A p = b with the Jacobi preconditioned conjugate gradient method
+   A is the mass weighted SPH Laplacian of PairSPHISPH::laplacian(),
+     b_i = -m_i div v*_i / dt
+   the pressure of surface atoms is 0, as are rows of atoms without
+     neighbors in the pair style
+   without surface atoms A is singular, b is then shifted to zero mean
+   the solve starts from the pressure of the last step
+------------------------------------------------------------------------- */
+
+void FixISPH::solve()
+{
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  int i;
+
+  int nfixed = 0;
+  int nfree = 0;
+  double bsum = 0.0;
+  double massone;
+
+  for (i = 0; i < nlocal; i++) {
+    fixed[i] = (diag[i] <= 0.0);
+    if (surface > 0.0 && divr[i] < surface) {
+      fixed[i] = 1;
+      nfixed++;
+    }
+    if (fixed[i]) {
+      rhs[i] = pressure[i] = 0.0;
+      continue;
+    }
+    massone = rmass ? rmass[i] : mass[type[i]];
+    rhs[i] = -massone * div[i] / dtv;
+    bsum += rhs[i];
+    nfree++;
+  }
+
+  int nfixed_all,nfree_all;
+  MPI_Allreduce(&nfixed,&nfixed_all,1,MPI_INT,MPI_SUM,world);
+
+  if (nfixed_all == 0) {
+    double bsum_all;
+    MPI_Allreduce(&bsum,&bsum_all,1,MPI_DOUBLE,MPI_SUM,world);
+    MPI_Allreduce(&nfree,&nfree_all,1,MPI_INT,MPI_SUM,world);
+    if (nfree_all) {
+      double bmean = bsum_all/nfree_all;
+      for (i = 0; i < nlocal; i++)
+        if (!fixed[i]) rhs[i] -= bmean;
+    }
+  }
+
+  double bnorm = sqrt(dot(rhs,rhs));
+  niter = 0;
+  resnorm = 0.0;
+  if (bnorm == 0.0) {
+    for (i = 0; i < nlocal; i++) pressure[i] = 0.0;
+    return;
+  }
+
+  // r = b - A p, z = r / diag, d = z
+
+  matvec(pressure,adir);
+  for (i = 0; i < nlocal; i++) {
+    if (fixed[i]) res[i] = zvec[i] = dir[i] = 0.0;
+    else {
+      res[i] = rhs[i] - adir[i];
+      zvec[i] = res[i] / diag[i];
+      dir[i] = zvec[i];
+    }
+  }
+
+  double rz = dot(res,zvec);
+  double alpha,beta,rz_new,one[2],all[2];
+
+  resnorm = sqrt(dot(res,res)) / bnorm;
+
+  while (resnorm > tolerance && niter < maxiter) {
+    matvec(dir,adir);
+    alpha = rz / dot(dir,adir);
+
+    one[0] = one[1] = 0.0;
+    for (i = 0; i < nlocal; i++) {
+      if (fixed[i]) continue;
+      pressure[i] += alpha * dir[i];
+      res[i] -= alpha * adir[i];
+      zvec[i] = res[i] / diag[i];
+      one[0] += res[i]*res[i];
+      one[1] += res[i]*zvec[i];
+    }
+    MPI_Allreduce(one,all,2,MPI_DOUBLE,MPI_SUM,world);
+
+    niter++;
+    resnorm = sqrt(all[0]) / bnorm;
+    rz_new = all[1];
+    beta = rz_new / rz;
+    rz = rz_new;
+
+    for (i = 0; i < nlocal; i++)
+      if (!fixed[i]) dir[i] = zvec[i] + beta * dir[i];
+  }
+
+  if (resnorm > tolerance && comm->me == 0)
+    error->warning(FLERR,"Fix isph pressure solve did not converge");
+}
+
+/* ----------------------------------------------------------------------
+   out = A in, halo exchange of in and of the partial sums of ghosts
+------------------------------------------------------------------------- */
+
+void FixISPH::matvec(double *in, double *out)
+{
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+
+  commflag = SCALAR;
+  cvec = in;
+  comm->forward_comm_fix(this);
+
+  for (int i = 0; i < nall; i++) out[i] = 0.0;
+  pair->laplacian(in,out);
+
+  if (force->newton_pair) {
+    commflag = REV_SCALAR;
+    cvec = out;
+    comm->reverse_comm_fix(this);
+  }
+
+  for (int i = 0; i < nlocal; i++)
+    if (fixed[i]) out[i] = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixISPH::dot(double *a, double *b)
+{
+  int nlocal = atom->nlocal;
+  double one = 0.0;
+  for (int i = 0; i < nlocal; i++)
+    if (!fixed[i]) one += a[i]*b[i];
+
+  double all;
+  MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
+  return all;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixISPH::reset_dt()
+{
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+}
+
+/* ----------------------------------------------------------------------
+   iterations and relative residual of the last pressure solve
+------------------------------------------------------------------------- */
+
+double FixISPH::compute_vector(int n)
+{
+  if (n == 0) return niter;
+  return resnorm;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixISPH::pack_comm(int n, int *list, double *buf,
+                       int pbc_flag, int *pbc)
+{
+  int i,j,m;
+
+  m = 0;
+  if (commflag == VSTAR) {
+    double **vest = atom->vest;
+    for (i = 0; i < n; i++) {
+      j = list[i];
+      buf[m++] = vest[j][0];
+      buf[m++] = vest[j][1];
+      buf[m++] = vest[j][2];
+    }
+    return 3;
+  }
+
+  for (i = 0; i < n; i++) buf[m++] = cvec[list[i]];
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixISPH::unpack_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  if (commflag == VSTAR) {
+    double **vest = atom->vest;
+    for (i = first; i < last; i++) {
+      vest[i][0] = buf[m++];
+      vest[i][1] = buf[m++];
+      vest[i][2] = buf[m++];
+    }
+  } else {
+    for (i = first; i < last; i++) cvec[i] = buf[m++];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixISPH::pack_reverse_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  if (commflag == REV_DIV) {
+    for (i = first; i < last; i++) {
+      buf[m++] = div[i];
+      buf[m++] = divr[i];
+      buf[m++] = diag[i];
+    }
+    return 3;
+  } else if (commflag == REV_GRAD) {
+    for (i = first; i < last; i++) {
+      buf[m++] = grad[i][0];
+      buf[m++] = grad[i][1];
+      buf[m++] = grad[i][2];
+    }
+    return 3;
+  }
+
+  for (i = first; i < last; i++) buf[m++] = cvec[i];
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixISPH::unpack_reverse_comm(int n, int *list, double *buf)
+{
+  int i,j,m;
+
+  m = 0;
+  if (commflag == REV_DIV) {
+    for (i = 0; i < n; i++) {
+      j = list[i];
+      div[j] += buf[m++];
+      divr[j] += buf[m++];
+      diag[j] += buf[m++];
+    }
+  } else if (commflag == REV_GRAD) {
+    for (i = 0; i < n; i++) {
+      j = list[i];
+      grad[j][0] += buf[m++];
+      grad[j][1] += buf[m++];
+      grad[j][2] += buf[m++];
+    }
+  } else {
+    for (i = 0; i < n; i++) cvec[list[i]] += buf[m++];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local atom-based arrays and solver vectors
+------------------------------------------------------------------------- */
+
+double FixISPH::memory_usage()
+{
+  double bytes = atom->nmax * sizeof(double);
+  bytes += nmax*8 * sizeof(double);
+  bytes += nmax*3 * sizeof(double);
+  bytes += nmax * sizeof(int);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   allocate local atom-based arrays
+   nmax includes ghost atoms, whose pressure is set in the solve
+------------------------------------------------------------------------- */
+
+void FixISPH::grow_arrays(int nmax_new)
+{
+  memory->grow(pressure,nmax_new,"isph:pressure");
+  vector_atom = pressure;
+}
+
+/* ----------------------------------------------------------------------
+   copy values within local atom-based arrays
+------------------------------------------------------------------------- */
+
+void FixISPH::copy_arrays(int i, int j)
+{
+  pressure[j] = pressure[i];
+}
+
+/* ----------------------------------------------------------------------
+   pack values in local atom-based arrays for exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixISPH::pack_exchange(int i, double *buf)
+{
+  buf[0] = pressure[i];
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   unpack values in local atom-based arrays from exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixISPH::unpack_exchange(int nlocal, double *buf)
+{
+  pressure[nlocal] = buf[0];
+  return 1;
+}
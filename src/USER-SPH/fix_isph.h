@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(isph,FixISPH)
+
+#else
+
+#ifndef LMP_FIX_ISPH_H
+#define LMP_FIX_ISPH_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixISPH : public Fix {
+ public:
+  FixISPH(class LAMMPS *, int, char **);
+  ~FixISPH();
+  int setmask();
+  void init();
+  void initial_integrate(int);
+  void final_integrate();
+  void reset_dt();
+  double compute_vector(int);
+
+  double memory_usage();
+  void grow_arrays(int);
+  void copy_arrays(int, int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+  int pack_comm(int, int *, double *, int, int *);
+  void unpack_comm(int, int, double *);
+  int pack_reverse_comm(int, int, double *);
+  void unpack_reverse_comm(int, int *, double *);
+
+ private:
+  double dtv,dtf;
+  double tolerance;             // relative residual of the pressure solve
+  int maxiter;
+  double surface;               // free surface threshold of div x, 0 if none
+
+  double *pressure;             // per-atom pressure, start of the next solve
+  class PairSPHISPH *pair;
+
+  int nmax;                     // size of work arrays, incl. ghosts
+  double *div,*divr,*diag;      // divergence of v*, of x, Jacobi diagonal
+  double *rhs,*res,*zvec,*dir,*adir;
+  double **grad;
+  int *fixed;                   // 1 for surface atoms with p = 0
+
+  int commflag;                 // data exchanged by forward/reverse comm
+  double *cvec;                 // scalar vector exchanged
+
+  int niter;                    // stats of the last solve
+  double resnorm;
+
+  void matvec(double *, double *);
+  double dot(double *, double *);
+  void solve();
+};
+
+}
+
+#endif
+#endif
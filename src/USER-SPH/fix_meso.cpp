@@ -26,6 +26,8 @@
 #include "update.h"
 #include "integrate.h"
 #include "respa.h"
+#include "fix_respa.h"
+#include "modify.h"
 #include "memory.h"
 #include "error.h"
 #include "pair.h"
@@ -45,6 +47,13 @@ FixMeso::FixMeso(LAMMPS *lmp, int narg, char **arg) :
     error->all(FLERR,"Illegal number of arguments for fix meso command");
 
   time_integrate = 1;
+
+  // vest of ghost atoms at outer rRESPA levels
+
+  comm_forward = 3;
+  step_respa = NULL;
+  fix_respa = NULL;
+  level_pair = -1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -53,6 +62,9 @@ int FixMeso::setmask() {
   int mask = 0;
   mask |= INITIAL_INTEGRATE;
   mask |= FINAL_INTEGRATE;
+  mask |= INITIAL_INTEGRATE_RESPA;
+  mask |= FINAL_INTEGRATE_RESPA;
+  mask |= PRE_FORCE_RESPA;
   return mask;
 }
 
@@ -61,6 +73,17 @@ int FixMeso::setmask() {
 void FixMeso::init() {
   dtv = update->dt;
   dtf = 0.5 * update->dt * force->ftm2v;
+
+  if (strstr(update->integrate_style,"respa")) {
+    Respa *respa = (Respa *) update->integrate;
+    step_respa = respa->step;
+    level_pair = respa->level_pair;
+    int ifix = modify->find_fix("RESPA");
+    fix_respa = (ifix >= 0) ? (FixRespa *) modify->fix[ifix] : NULL;
+  } else {
+    level_pair = -1;
+    fix_respa = NULL;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -158,6 +181,99 @@ void FixMeso::final_integrate() {
   }
 }
 
+/* ----------------------------------------------------------------------
+   x, vest and the rho and e of the innermost level are updated at the
+     innermost level, all other levels kick v and update rho and e
+     with their own drho and de, as restored by Respa
+------------------------------------------------------------------------- */
+
+void FixMeso::initial_integrate_respa(int vflag, int ilevel, int iloop) {
+  dtv = step_respa[ilevel];
+  dtf = 0.5 * step_respa[ilevel] * force->ftm2v;
+
+  if (ilevel == 0) initial_integrate(vflag);
+  else final_integrate();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMeso::final_integrate_respa(int ilevel, int iloop) {
+  dtf = 0.5 * step_respa[ilevel] * force->ftm2v;
+  final_integrate();
+}
+
+/* ----------------------------------------------------------------------
+   before SPH pair forces at an outer level, extrapolate vest to the end
+     of that level's step with its force of the previous step, since
+     the innermost level only extrapolated with the innermost force
+------------------------------------------------------------------------- */
+
+void FixMeso::pre_force_respa(int vflag, int ilevel, int iloop) {
+  if (ilevel == 0 || ilevel != level_pair || fix_respa == NULL) return;
+
+  double ***f_level = fix_respa->f_level;
+  double **v = atom->v;
+  double **vest = atom->vest;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int rmass_flag = atom->rmass_flag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  if (igroup == atom->firstgroup)
+    nlocal = atom->nfirst;
+  double dtfm;
+
+  double dtfl = 0.5 * step_respa[ilevel] * force->ftm2v;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) {
+      if (rmass_flag) {
+        dtfm = dtfl / rmass[i];
+      } else {
+        dtfm = dtfl / mass[type[i]];
+      }
+      vest[i][0] = v[i][0] + dtfm * f_level[i][ilevel][0];
+      vest[i][1] = v[i][1] + dtfm * f_level[i][ilevel][1];
+      vest[i][2] = v[i][2] + dtfm * f_level[i][ilevel][2];
+    }
+  }
+
+  comm->forward_comm_fix(this);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMeso::pack_comm(int n, int *list, double *buf, int pbc_flag,
+    int *pbc) {
+  int i, j, m;
+  double **vest = atom->vest;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = vest[j][0];
+    buf[m++] = vest[j][1];
+    buf[m++] = vest[j][2];
+  }
+  return 3;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMeso::unpack_comm(int n, int first, double *buf) {
+  int i, m, last;
+  double **vest = atom->vest;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    vest[i][0] = buf[m++];
+    vest[i][1] = buf[m++];
+    vest[i][2] = buf[m++];
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixMeso::reset_dt() {
@@ -31,6 +31,11 @@ class FixMeso : public Fix {
   virtual void init();
   virtual void initial_integrate(int);
   virtual void final_integrate();
+  void initial_integrate_respa(int, int, int);
+  void final_integrate_respa(int, int);
+  void pre_force_respa(int, int, int);
+  int pack_comm(int, int *, double *, int, int *);
+  void unpack_comm(int, int, double *);
   void reset_dt();
 
  private:
@@ -39,6 +44,8 @@ class FixMeso : public Fix {
   double dtv,dtf;
   double *step_respa;
   int mass_require;
+  int level_pair;               // rRESPA level the SPH pair forces are at
+  class FixRespa *fix_respa;    // rRESPA per-level force storage
 
   class Pair *pair;
 };
@@ -0,0 +1,623 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_meso_block.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "pair.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_request.h"
+#include "update.h"
+#include "modify.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define MAXLEVEL 30
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoBlock::FixMesoBlock(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if ((atom->e_flag != 1) || (atom->rho_flag != 1))
+    error->all(FLERR,
+        "fix meso/block command requires atom_style with both energy and density");
+
+  if (narg < 4) error->all(FLERR,"Illegal fix meso/block command");
+
+  maxlevel = atoi(arg[3]);
+  if (maxlevel < 0 || maxlevel > MAXLEVEL)
+    error->all(FLERR,"Illegal fix meso/block command");
+
+  cfl = 0.25;
+  visc = 0.125;
+  fcoeff = 0.25;
+
+  int iarg = 4;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/block command");
+    if (strcmp(arg[iarg],"cfl") == 0) cfl = atof(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"visc") == 0) visc = atof(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"force") == 0) fcoeff = atof(arg[iarg+1]);
+    else error->all(FLERR,"Illegal fix meso/block command");
+    iarg += 2;
+  }
+
+  if (cfl <= 0.0 || visc < 0.0 || fcoeff < 0.0)
+    error->all(FLERR,"Illegal fix meso/block command");
+
+  time_integrate = 1;
+  vector_flag = 1;
+  size_vector = maxlevel + 1;
+  global_freq = 1;
+  extvector = 1;
+
+  // active flags of ghost atoms
+
+  comm_forward = 1;
+
+  // perform initial allocation of atom-based arrays
+  // register with Atom class
+
+  level = NULL;
+  fold = NULL;
+  grow_arrays(atom->nmax);
+  atom->add_callback(0);
+
+  for (int i = 0; i < atom->nlocal; i++) {
+    level[i] = 0;
+    fold[i][0] = fold[i][1] = fold[i][2] = 0.0;
+  }
+
+  active = NULL;
+  nmax_active = 0;
+
+  nfilter = 0;
+  filters = NULL;
+  swapped = 0;
+
+  rho0 = soundspeed = NULL;
+  cut = mu = NULL;
+  step0 = update->ntimestep;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoBlock::~FixMesoBlock()
+{
+  // unregister callbacks to this fix from Atom class
+
+  atom->delete_callback(id,0);
+
+  memory->destroy(level);
+  memory->destroy(fold);
+  memory->destroy(active);
+
+  for (int m = 0; m < nfilter; m++) {
+    memory->destroy(filters[m].ilist_f);
+    memory->destroy(filters[m].numneigh_f);
+    memory->sfree(filters[m].firstneigh_f);
+    memory->destroy(filters[m].neighs);
+  }
+  delete [] filters;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoBlock::setmask()
+{
+  int mask = 0;
+  mask |= INITIAL_INTEGRATE;
+  mask |= PRE_FORCE;
+  mask |= POST_FORCE;
+  mask |= FINAL_INTEGRATE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoBlock::init()
+{
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+  ftm2v = force->ftm2v;
+
+  if (strstr(update->integrate_style,"respa"))
+    error->all(FLERR,"Fix meso/block does not support run_style respa");
+
+  // rungs are multiples of a fixed base timestep
+
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"meso/dt") == 0)
+      error->all(FLERR,"Fix meso/block cannot be used with fix meso/dt");
+
+  // same per-type coefficients as fix meso/dt
+
+  if (force->pair == NULL)
+    error->all(FLERR,"Fix meso/block requires an SPH pair style");
+
+  int dim;
+  char str_rho0[] = "rho0";
+  char str_c[] = "soundspeed";
+  char str_cut[] = "cut";
+  char str_mu[] = "mu";
+
+  rho0 = (double *) force->pair->extract(str_rho0,dim);
+  soundspeed = (double *) force->pair->extract(str_c,dim);
+  if (soundspeed == NULL || dim != 1)
+    error->all(FLERR,"Pair style does not support fix meso/block");
+  cut = (double **) force->pair->extract(str_cut,dim);
+  if (cut == NULL || dim != 2)
+    error->all(FLERR,"Pair style does not support fix meso/block");
+  mu = (double **) force->pair->extract(str_mu,dim);
+  if (mu && dim != 2) mu = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   all atoms start a step on rung 0 at the start of a run
+   the pair neighbor lists exist now, neighbor->init() runs after fixes
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::setup(int vflag)
+{
+  // the kernel cache is indexed by the unreduced lists
+
+  char str_cache[] = "sph_kernel_cache";
+  int dim;
+  if (force->pair->extract(str_cache,dim))
+    error->all(FLERR,"Fix meso/block cannot be used with a pair style cache");
+
+  step0 = update->ntimestep;
+
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) level[i] = 0;
+
+  for (int m = 0; m < nfilter; m++) {
+    memory->destroy(filters[m].ilist_f);
+    memory->destroy(filters[m].numneigh_f);
+    memory->sfree(filters[m].firstneigh_f);
+    memory->destroy(filters[m].neighs);
+  }
+  delete [] filters;
+
+  // all perpetual half and full lists of pair styles
+  // granular, rRESPA and ghost lists are not used with SPH
+  // neighbor->init() has moved the requests of this run to old_requests
+
+  NeighRequest **requests = neighbor->old_requests;
+  NeighList **lists = neighbor->lists;
+
+  nfilter = 0;
+  for (int m = 0; m < neighbor->nlist; m++)
+    if (requests[m]->pair && !requests[m]->occasional &&
+        !requests[m]->gran && !requests[m]->granhistory &&
+        !requests[m]->respainner && !requests[m]->respamiddle &&
+        !requests[m]->respaouter && !lists[m]->ghostflag) nfilter++;
+
+  filters = new Filter[nfilter];
+
+  nfilter = 0;
+  for (int m = 0; m < neighbor->nlist; m++)
+    if (requests[m]->pair && !requests[m]->occasional &&
+        !requests[m]->gran && !requests[m]->granhistory &&
+        !requests[m]->respainner && !requests[m]->respamiddle &&
+        !requests[m]->respaouter && !lists[m]->ghostflag) {
+      Filter &f = filters[nfilter++];
+      f.list = lists[m];
+      f.full = requests[m]->full;
+      f.ilist_f = f.numneigh_f = f.neighs = NULL;
+      f.firstneigh_f = NULL;
+      f.maxatom = f.maxneigh = 0;
+    }
+
+  swapped = 0;
+}
+
+/* ----------------------------------------------------------------------
+   largest stable timestep of atom i, as in fix meso/dt
+------------------------------------------------------------------------- */
+
+double FixMesoBlock::dt_one(int i)
+{
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *hsml = atom->hsml;
+  int itype = atom->type[i];
+  double h,c,tmp,vsq,fsq,massinv,dt;
+
+  if (atom->rmass) massinv = 1.0/atom->rmass[i];
+  else massinv = 1.0/atom->mass[itype];
+
+  if (hsml && hsml[i] > 0.0) h = hsml[i];
+  else h = cut[itype][itype];
+
+  c = soundspeed[itype];
+  if (rho0 && rho0[itype] > 0.0) {
+    tmp = rho[i]/rho0[itype];
+    c *= tmp*tmp*tmp;
+  }
+
+  vsq = v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
+  dt = cfl * h / (c + sqrt(vsq));
+
+  if (mu && visc > 0.0 && mu[itype][itype] > 0.0)
+    dt = MIN(dt,visc * h*h * rho[i] / mu[itype][itype]);
+
+  fsq = f[i][0]*f[i][0] + f[i][1]*f[i][1] + f[i][2]*f[i][2];
+  if (fcoeff > 0.0 && fsq > 0.0)
+    dt = MIN(dt,fcoeff * sqrt(h / (ftm2v*sqrt(fsq)*massinv)));
+
+  return dt;
+}
+
+/* ----------------------------------------------------------------------
+   substep s covers timesteps step0+s to step0+s+1
+   an atom on rung L steps n = 2^L substeps, its steps start at
+     multiples of n, where it gets a new rung and its first half kick
+   all atoms drift every substep with their half-step v
+   vest is v extrapolated to the end of the substep with the force
+     at the start of the atom's step, rho and e stay at their half-step
+     value, as with fix meso
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::initial_integrate(int vflag)
+{
+  double **x = atom->x;
+  double **v = atom->v;
+  double **f = atom->f;
+  double **vest = atom->vest;
+  double *rho = atom->rho;
+  double *drho = atom->drho;
+  double *e = atom->e;
+  double *de = atom->de;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int rmass_flag = atom->rmass_flag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  if (igroup == atom->firstgroup) nlocal = atom->nfirst;
+
+  bigint s = update->ntimestep - 1 - step0;
+  double dtmax = dtv * (1 << maxlevel);
+  double massinv,dt,dtfl,dtfm,coeff;
+  int n,k;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) {
+      if (rmass_flag) massinv = 1.0/rmass[i];
+      else massinv = 1.0/mass[type[i]];
+
+      n = 1 << level[i];
+      k = s % n;
+
+      if (k == 0) {
+        dt = dt_one(i);
+        n = 1;
+        while (2*n*dtv <= dt && 2*n*dtv <= dtmax && s % (2*n) == 0) n *= 2;
+        level[i] = 0;
+        while ((1 << level[i]) < n) level[i]++;
+
+        dtfl = n * dtf;
+        dtfm = dtfl * massinv;
+
+        e[i] += dtfl * de[i];
+        rho[i] += dtfl * drho[i];
+
+        v[i][0] += dtfm * f[i][0];
+        v[i][1] += dtfm * f[i][1];
+        v[i][2] += dtfm * f[i][2];
+
+        fold[i][0] = f[i][0];
+        fold[i][1] = f[i][1];
+        fold[i][2] = f[i][2];
+      }
+
+      x[i][0] += dtv * v[i][0];
+      x[i][1] += dtv * v[i][1];
+      x[i][2] += dtv * v[i][2];
+
+      coeff = dtf * (2*(k+1) - n) * massinv;
+      vest[i][0] = v[i][0] + coeff * fold[i][0];
+      vest[i][1] = v[i][1] + coeff * fold[i][1];
+      vest[i][2] = v[i][2] + coeff * fold[i][2];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   flag atoms that end their step on this substep, incl. ghosts,
+     atoms outside the group are always active
+   then reduce the pair neighbor lists to pairs with an active atom
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::pre_force(int vflag)
+{
+  if (atom->nmax > nmax_active) {
+    nmax_active = atom->nmax;
+    memory->grow(active,nmax_active,"meso/block:active");
+  }
+
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  bigint s = update->ntimestep - 1 - step0;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) active[i] = ((s+1) % (1 << level[i]) == 0);
+    else active[i] = 1;
+  }
+
+  comm->forward_comm_fix(this);
+
+  for (int m = 0; m < nfilter; m++) build_filter(filters[m]);
+  swapped = 1;
+}
+
+/* ----------------------------------------------------------------------
+   full lists keep the rows of active atoms
+   half lists keep the pairs with at least one active atom, so the
+     forces, drho and de of active atoms are complete
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::build_filter(Filter &f)
+{
+  NeighList *list = f.list;
+
+  f.inum = list->inum;
+  f.ilist = list->ilist;
+  f.numneigh = list->numneigh;
+  f.firstneigh = list->firstneigh;
+
+  int inum = f.inum;
+  int *ilist = f.ilist;
+  int *numneigh = f.numneigh;
+  int **firstneigh = f.firstneigh;
+
+  if (inum > f.maxatom || atom->nmax > f.maxatom) {
+    f.maxatom = MAX(inum,atom->nmax);
+    memory->destroy(f.ilist_f);
+    memory->destroy(f.numneigh_f);
+    memory->sfree(f.firstneigh_f);
+    memory->create(f.ilist_f,f.maxatom,"meso/block:ilist");
+    memory->create(f.numneigh_f,f.maxatom,"meso/block:numneigh");
+    f.firstneigh_f = (int **)
+      memory->smalloc(f.maxatom*sizeof(int *),"meso/block:firstneigh");
+  }
+
+  int i,ii,j,jj,jnum,n;
+  int *jlist;
+  int inum_f = 0;
+
+  if (f.full) {
+    for (ii = 0; ii < inum; ii++) {
+      i = ilist[ii];
+      if (active[i]) f.ilist_f[inum_f++] = i;
+    }
+    list->inum = inum_f;
+    list->ilist = f.ilist_f;
+    return;
+  }
+
+  int npair = 0;
+  for (ii = 0; ii < inum; ii++) npair += numneigh[ilist[ii]];
+  if (npair > f.maxneigh) {
+    f.maxneigh = npair + npair/10;
+    memory->destroy(f.neighs);
+    memory->create(f.neighs,f.maxneigh,"meso/block:neighs");
+  }
+
+  int *neighs = f.neighs;
+  npair = 0;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    n = 0;
+    if (active[i]) {
+      for (jj = 0; jj < jnum; jj++) neighs[npair+n++] = jlist[jj];
+    } else {
+      for (jj = 0; jj < jnum; jj++) {
+        j = jlist[jj] & NEIGHMASK;
+        if (active[j]) neighs[npair+n++] = jlist[jj];
+      }
+    }
+    if (n == 0) continue;
+
+    f.ilist_f[inum_f++] = i;
+    f.numneigh_f[i] = n;
+    f.firstneigh_f[i] = &neighs[npair];
+    npair += n;
+  }
+
+  list->inum = inum_f;
+  list->ilist = f.ilist_f;
+  list->numneigh = f.numneigh_f;
+  list->firstneigh = f.firstneigh_f;
+}
+
+/* ----------------------------------------------------------------------
+   restore the lists as built before anything else uses them
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::post_force(int vflag)
+{
+  if (!swapped) return;
+
+  for (int m = 0; m < nfilter; m++) {
+    NeighList *list = filters[m].list;
+    list->inum = filters[m].inum;
+    list->ilist = filters[m].ilist;
+    list->numneigh = filters[m].numneigh;
+    list->firstneigh = filters[m].firstneigh;
+  }
+  swapped = 0;
+}
+
+/* ----------------------------------------------------------------------
+   second half kick of the atoms that end their step
+   forces, drho and de of inactive atoms are incomplete and not used
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::final_integrate()
+{
+  double **v = atom->v;
+  double **f = atom->f;
+  double *e = atom->e;
+  double *de = atom->de;
+  double *rho = atom->rho;
+  double *drho = atom->drho;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int rmass_flag = atom->rmass_flag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  if (igroup == atom->firstgroup) nlocal = atom->nfirst;
+
+  double dtfl,dtfm;
+
+  for (int i = 0; i < nlocal; i++) {
+    if ((mask[i] & groupbit) && active[i]) {
+      dtfl = (1 << level[i]) * dtf;
+      if (rmass_flag) dtfm = dtfl / rmass[i];
+      else dtfm = dtfl / mass[type[i]];
+
+      v[i][0] += dtfm * f[i][0];
+      v[i][1] += dtfm * f[i][1];
+      v[i][2] += dtfm * f[i][2];
+
+      e[i] += dtfl * de[i];
+      rho[i] += dtfl * drho[i];
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoBlock::reset_dt()
+{
+  dtv = update->dt;
+  dtf = 0.5 * update->dt * force->ftm2v;
+}
+
+/* ----------------------------------------------------------------------
+   number of atoms in group on rung n
+------------------------------------------------------------------------- */
+
+double FixMesoBlock::compute_vector(int n)
+{
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  double one = 0.0;
+  for (int i = 0; i < nlocal; i++)
+    if ((mask[i] & groupbit) && level[i] == n) one += 1.0;
+
+  double all;
+  MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
+  return all;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoBlock::pack_comm(int n, int *list, double *buf,
+                            int pbc_flag, int *pbc)
+{
+  int m = 0;
+  for (int i = 0; i < n; i++) buf[m++] = active[list[i]];
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoBlock::unpack_comm(int n, int first, double *buf)
+{
+  int m = 0;
+  int last = first + n;
+  for (int i = first; i < last; i++) active[i] = static_cast<int> (buf[m++]);
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of local atom-based arrays and reduced lists
+------------------------------------------------------------------------- */
+
+double FixMesoBlock::memory_usage()
+{
+  double bytes = atom->nmax * sizeof(int);
+  bytes += atom->nmax*3 * sizeof(double);
+  bytes += nmax_active * sizeof(int);
+  for (int m = 0; m < nfilter; m++) {
+    bytes += 2*filters[m].maxatom * sizeof(int);
+    bytes += filters[m].maxatom * sizeof(int *);
+    bytes += filters[m].maxneigh * sizeof(int);
+  }
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   allocate local atom-based arrays
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::grow_arrays(int nmax)
+{
+  memory->grow(level,nmax,"meso/block:level");
+  memory->grow(fold,nmax,3,"meso/block:fold");
+}
+
+/* ----------------------------------------------------------------------
+   copy values within local atom-based arrays
+------------------------------------------------------------------------- */
+
+void FixMesoBlock::copy_arrays(int i, int j)
+{
+  level[j] = level[i];
+  fold[j][0] = fold[i][0];
+  fold[j][1] = fold[i][1];
+  fold[j][2] = fold[i][2];
+}
+
+/* ----------------------------------------------------------------------
+   pack values in local atom-based arrays for exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixMesoBlock::pack_exchange(int i, double *buf)
+{
+  buf[0] = level[i];
+  buf[1] = fold[i][0];
+  buf[2] = fold[i][1];
+  buf[3] = fold[i][2];
+  return 4;
+}
+
+/* ----------------------------------------------------------------------
+   unpack values in local atom-based arrays from exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixMesoBlock::unpack_exchange(int nlocal, double *buf)
+{
+  level[nlocal] = static_cast<int> (buf[0]);
+  fold[nlocal][0] = buf[1];
+  fold[nlocal][1] = buf[2];
+  fold[nlocal][2] = buf[3];
+  return 4;
+}
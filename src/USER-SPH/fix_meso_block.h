@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(meso/block,FixMesoBlock)
+
+#else
+
+#ifndef LMP_FIX_MESO_BLOCK_H
+#define LMP_FIX_MESO_BLOCK_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixMesoBlock : public Fix {
+ public:
+  FixMesoBlock(class LAMMPS *, int, char **);
+  ~FixMesoBlock();
+  int setmask();
+  void init();
+  void setup(int);
+  void initial_integrate(int);
+  void pre_force(int);
+  void post_force(int);
+  void final_integrate();
+  void reset_dt();
+  double compute_vector(int);
+
+  double memory_usage();
+  void grow_arrays(int);
+  void copy_arrays(int, int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+  int pack_comm(int, int *, double *, int, int *);
+  void unpack_comm(int, int, double *);
+
+ private:
+  int maxlevel;                 // coarsest rung, steps of 2^maxlevel dt
+  double cfl,visc,fcoeff;
+  double dtv,dtf,ftm2v;
+  bigint step0;                 // timestep the rungs are aligned to
+
+  int *level;                   // rung of each owned atom
+  double **fold;                // force at the start of the atom's step
+  int *active;                  // 1 if the atom ends its step this substep
+  int nmax_active;
+
+  double *rho0,*soundspeed;     // coefficients of the SPH pair style
+  double **cut,**mu;
+
+  // pair neighbor lists reduced to the pairs with an active atom
+  // the pair styles see the reduced lists between pre_force and post_force
+
+  struct Filter {
+    class NeighList *list;
+    int full;                   // 1 if full list, else half list
+    int inum;                   // values of the list as built
+    int *ilist,*numneigh;
+    int **firstneigh;
+    int *ilist_f,*numneigh_f;   // reduced list
+    int **firstneigh_f;
+    int *neighs;                // neighbors of the reduced half list
+    int maxatom,maxneigh;
+  };
+  int nfilter;
+  Filter *filters;
+  int swapped;
+
+  double dt_one(int);
+  void build_filter(Filter &);
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,236 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_meso_dt.h"
+#include "atom.h"
+#include "update.h"
+#include "integrate.h"
+#include "force.h"
+#include "pair.h"
+#include "modify.h"
+#include "output.h"
+#include "dump.h"
+#include "comm.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define BIG 1.0e20
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoDt::FixMesoDt(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if ((atom->e_flag != 1) || (atom->rho_flag != 1))
+    error->all(FLERR,
+        "fix meso/dt command requires atom_style with both energy and density");
+
+  if (narg < 6) error->all(FLERR,"Illegal fix meso/dt command");
+
+  time_depend = 1;
+  scalar_flag = 1;
+  vector_flag = 1;
+  size_vector = 1;
+  global_freq = 1;
+  extscalar = 0;
+  extvector = 0;
+
+  nevery = atoi(arg[3]);
+  if (nevery <= 0) error->all(FLERR,"Illegal fix meso/dt command");
+
+  minbound = maxbound = 1;
+  tmin = tmax = 0.0;
+  if (strcmp(arg[4],"NULL") == 0) minbound = 0;
+  else tmin = atof(arg[4]);
+  if (strcmp(arg[5],"NULL") == 0) maxbound = 0;
+  else tmax = atof(arg[5]);
+
+  if (minbound && tmin < 0.0) error->all(FLERR,"Illegal fix meso/dt command");
+  if (maxbound && tmax < 0.0) error->all(FLERR,"Illegal fix meso/dt command");
+  if (minbound && maxbound && tmin >= tmax)
+    error->all(FLERR,"Illegal fix meso/dt command");
+
+  cfl = 0.25;
+  visc = 0.125;
+  fcoeff = 0.25;
+
+  int iarg = 6;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/dt command");
+    if (strcmp(arg[iarg],"cfl") == 0) cfl = atof(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"visc") == 0) visc = atof(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"force") == 0) fcoeff = atof(arg[iarg+1]);
+    else error->all(FLERR,"Illegal fix meso/dt command");
+    iarg += 2;
+  }
+
+  if (cfl <= 0.0 || visc < 0.0 || fcoeff < 0.0)
+    error->all(FLERR,"Illegal fix meso/dt command");
+
+  // initializations
+
+  rho0 = soundspeed = NULL;
+  cut = mu = NULL;
+  t_elapsed = 0.0;
+  laststep = update->ntimestep;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoDt::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoDt::init()
+{
+  // set rRESPA flag
+
+  respaflag = 0;
+  if (strstr(update->integrate_style,"respa")) respaflag = 1;
+
+  // check for DCD or XTC dumps
+
+  for (int i = 0; i < output->ndump; i++)
+    if ((strcmp(output->dump[i]->style,"dcd") == 0 ||
+	strcmp(output->dump[i]->style,"xtc") == 0) && comm->me == 0)
+      error->warning(FLERR,"Dump dcd/xtc timestamp may be wrong with fix meso/dt");
+
+  ftm2v = force->ftm2v;
+
+  // per-type sound speed, rest density, kernel cutoff and viscosity
+  // mu is only held by styles with a physical viscosity, e.g. sdpd
+
+  if (force->pair == NULL)
+    error->all(FLERR,"Fix meso/dt requires an SPH pair style");
+
+  int dim;
+  char str_rho0[] = "rho0";
+  char str_c[] = "soundspeed";
+  char str_cut[] = "cut";
+  char str_mu[] = "mu";
+
+  rho0 = (double *) force->pair->extract(str_rho0,dim);
+  soundspeed = (double *) force->pair->extract(str_c,dim);
+  if (soundspeed == NULL || dim != 1)
+    error->all(FLERR,"Pair style does not support fix meso/dt");
+  cut = (double **) force->pair->extract(str_cut,dim);
+  if (cut == NULL || dim != 2)
+    error->all(FLERR,"Pair style does not support fix meso/dt");
+  mu = (double **) force->pair->extract(str_mu,dim);
+  if (mu && dim != 2) mu = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoDt::setup(int vflag)
+{
+  end_of_step();
+}
+
+/* ----------------------------------------------------------------------
+   largest stable SPH timestep of atoms in group, as the minimum of
+     CFL limit      cfl * h / (c + |v|)
+     viscous limit  visc * h^2 rho / mu
+     force limit    force * sqrt(h / |a|)
+   with the Tait sound speed c = c0 (rho/rho0)^3 and the per-atom
+     smoothing length of fix meso/hsml, if set
+------------------------------------------------------------------------- */
+
+void FixMesoDt::end_of_step()
+{
+  double dt,h,c,tmp,vsq,fsq,massinv;
+
+  // accumulate total time based on previous timestep
+
+  t_elapsed += (update->ntimestep - laststep) * update->dt;
+
+  double **v = atom->v;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *hsml = atom->hsml;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int itype;
+
+  double dtmin = BIG;
+
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      itype = type[i];
+      if (rmass) massinv = 1.0/rmass[i];
+      else massinv = 1.0/mass[itype];
+
+      if (hsml && hsml[i] > 0.0) h = hsml[i];
+      else h = cut[itype][itype];
+
+      c = soundspeed[itype];
+      if (rho0 && rho0[itype] > 0.0) {
+        tmp = rho[i]/rho0[itype];
+        c *= tmp*tmp*tmp;
+      }
+
+      vsq = v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
+      dt = cfl * h / (c + sqrt(vsq));
+
+      if (mu && visc > 0.0 && mu[itype][itype] > 0.0)
+        dt = MIN(dt,visc * h*h * rho[i] / mu[itype][itype]);
+
+      fsq = f[i][0]*f[i][0] + f[i][1]*f[i][1] + f[i][2]*f[i][2];
+      if (fcoeff > 0.0 && fsq > 0.0)
+        dt = MIN(dt,fcoeff * sqrt(h / (ftm2v*sqrt(fsq)*massinv)));
+
+      dtmin = MIN(dtmin,dt);
+    }
+
+  MPI_Allreduce(&dtmin,&dt,1,MPI_DOUBLE,MPI_MIN,world);
+
+  if (minbound) dt = MAX(dt,tmin);
+  if (maxbound) dt = MIN(dt,tmax);
+
+  // reset update->dt and other classes that depend on it
+  // rRESPA, pair style, fixes incl. fix meso
+
+  laststep = update->ntimestep;
+  if (dt == update->dt || dt == BIG) return;
+
+  update->dt = dt;
+  if (respaflag) update->integrate->reset_dt();
+  if (force->pair) force->pair->reset_dt();
+  for (int i = 0; i < modify->nfix; i++) modify->fix[i]->reset_dt();
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixMesoDt::compute_scalar()
+{
+  return update->dt;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixMesoDt::compute_vector(int n)
+{
+  return t_elapsed;
+}
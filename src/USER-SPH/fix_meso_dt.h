@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(meso/dt,FixMesoDt)
+
+#else
+
+#ifndef LMP_FIX_MESO_DT_H
+#define LMP_FIX_MESO_DT_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixMesoDt : public Fix {
+ public:
+  FixMesoDt(class LAMMPS *, int, char **);
+  ~FixMesoDt() {}
+  int setmask();
+  void init();
+  void setup(int);
+  void end_of_step();
+  double compute_scalar();
+  double compute_vector(int);
+
+ private:
+  bigint laststep;
+  int minbound,maxbound;
+  double tmin,tmax;
+  double cfl,visc,fcoeff;       // safety factors of the three limits
+  double ftm2v;
+  double t_elapsed;
+  int respaflag;
+
+  double *rho0,*soundspeed;     // per-type values of the pair style
+  double **cut,**mu;
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,754 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "lmptype.h"
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_meso_grid.h"
+#include "atom.h"
+#include "update.h"
+#include "domain.h"
+#include "group.h"
+#include "neighbor.h"
+#include "modify.h"
+#include "compute.h"
+#include "input.h"
+#include "variable.h"
+#include "sph_kernel.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{RHO,E,V,COMPUTE,FIX,VARIABLE};
+enum{WEIGHT,MASS,SHEPARD,VOLUME};
+enum{ONE,RUNNING};
+
+#define INVOKED_PERATOM 8
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoGrid::FixMesoGrid(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (narg < 11) error->all(FLERR,"Illegal fix meso/grid command");
+
+  if (atom->rho_flag != 1)
+    error->all(FLERR,"Fix meso/grid requires atom_style with density");
+
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  nevery = atoi(arg[3]);
+  nrepeat = atoi(arg[4]);
+  nfreq = atoi(arg[5]);
+  ngrid[0] = atoi(arg[6]);
+  ngrid[1] = atoi(arg[7]);
+  ngrid[2] = atoi(arg[8]);
+  cut = atof(arg[9]);
+
+  global_freq = nfreq;
+  time_depend = 1;
+
+  // parse values until one isn't recognized
+  // stress ID expands into the 6 columns of a compute stress/atom
+
+  which = new int[6*(narg-10)];
+  argindex = new int[6*(narg-10)];
+  ids = new char*[6*(narg-10)];
+  value2index = new int[6*(narg-10)];
+  colkind = new int[6*(narg-10)+1];
+  colkind[0] = WEIGHT;
+
+  int len = strlen("weight") + 1;
+  for (int iarg = 10; iarg < narg; iarg++) len += strlen(arg[iarg]) + 8;
+  columns = new char[len];
+  strcpy(columns,"weight");
+
+  nvalues = 0;
+  int iarg = 10;
+  while (iarg < narg) {
+    ids[nvalues] = NULL;
+    argindex[nvalues] = 0;
+    colkind[nvalues+1] = SHEPARD;
+
+    if (strcmp(arg[iarg],"rho") == 0) {
+      which[nvalues] = RHO;
+      colkind[nvalues+1] = MASS;
+    } else if (strcmp(arg[iarg],"e") == 0) {
+      if (atom->e_flag != 1)
+        error->all(FLERR,"Fix meso/grid e requires atom_style with energy");
+      which[nvalues] = E;
+    } else if (strcmp(arg[iarg],"vx") == 0) {
+      which[nvalues] = V;
+    } else if (strcmp(arg[iarg],"vy") == 0) {
+      which[nvalues] = V;
+      argindex[nvalues] = 1;
+    } else if (strcmp(arg[iarg],"vz") == 0) {
+      which[nvalues] = V;
+      argindex[nvalues] = 2;
+
+    } else if (strcmp(arg[iarg],"stress") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/grid command");
+      iarg++;
+      for (int k = 0; k < 6; k++) {
+        which[nvalues] = COMPUTE;
+        argindex[nvalues] = k+1;
+        ids[nvalues] = new char[strlen(arg[iarg])+1];
+        strcpy(ids[nvalues],arg[iarg]);
+        colkind[nvalues+1] = VOLUME;
+        sprintf(&columns[strlen(columns)]," c_%s[%d]",arg[iarg],k+1);
+        nvalues++;
+      }
+      iarg++;
+      continue;
+
+    } else if (strncmp(arg[iarg],"c_",2) == 0 ||
+               strncmp(arg[iarg],"f_",2) == 0 ||
+               strncmp(arg[iarg],"v_",2) == 0) {
+      if (arg[iarg][0] == 'c') which[nvalues] = COMPUTE;
+      else if (arg[iarg][0] == 'f') which[nvalues] = FIX;
+      else if (arg[iarg][0] == 'v') which[nvalues] = VARIABLE;
+
+      int n = strlen(arg[iarg]);
+      char *suffix = new char[n];
+      strcpy(suffix,&arg[iarg][2]);
+
+      char *ptr = strchr(suffix,'[');
+      if (ptr) {
+        if (suffix[strlen(suffix)-1] != ']')
+          error->all(FLERR,"Illegal fix meso/grid command");
+        argindex[nvalues] = atoi(ptr+1);
+        *ptr = '\0';
+      } else argindex[nvalues] = 0;
+
+      n = strlen(suffix) + 1;
+      ids[nvalues] = new char[n];
+      strcpy(ids[nvalues],suffix);
+      delete [] suffix;
+
+    } else break;
+
+    strcat(columns," ");
+    strcat(columns,arg[iarg]);
+    nvalues++;
+    iarg++;
+  }
+  ncol = nvalues + 1;
+
+  // optional args
+
+  kernel = SPHKernel::LUCY;
+  ave = ONE;
+  filename = NULL;
+  fp = NULL;
+  binary = multifile = 0;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/grid command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0) error->all(FLERR,"Unknown kernel in fix meso/grid command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"ave") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/grid command");
+      if (strcmp(arg[iarg+1],"one") == 0) ave = ONE;
+      else if (strcmp(arg[iarg+1],"running") == 0) ave = RUNNING;
+      else error->all(FLERR,"Illegal fix meso/grid command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"file") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/grid command");
+      delete [] filename;
+      filename = new char[strlen(arg[iarg+1])+1];
+      strcpy(filename,arg[iarg+1]);
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix meso/grid command");
+  }
+
+  // setup and error check
+
+  if (nevery <= 0 || nrepeat <= 0 || nfreq <= 0)
+    error->all(FLERR,"Illegal fix meso/grid command");
+  if (nfreq % nevery || (nrepeat-1)*nevery >= nfreq)
+    error->all(FLERR,"Illegal fix meso/grid command");
+  if (ngrid[0] <= 0 || ngrid[1] <= 0 || ngrid[2] <= 0 || cut <= 0.0)
+    error->all(FLERR,"Illegal fix meso/grid command");
+  if (domain->dimension == 2 && ngrid[2] != 1)
+    error->all(FLERR,"Fix meso/grid Nz must be 1 for 2d simulation");
+  if (domain->triclinic)
+    error->all(FLERR,"Fix meso/grid does not support triclinic boxes");
+  if (filename == NULL)
+    error->all(FLERR,"Fix meso/grid requires the file keyword");
+
+  for (int i = 0; i < nvalues; i++) {
+    if (which[i] == COMPUTE) {
+      int icompute = modify->find_compute(ids[i]);
+      if (icompute < 0)
+        error->all(FLERR,"Compute ID for fix meso/grid does not exist");
+      if (modify->compute[icompute]->peratom_flag == 0)
+        error->all(FLERR,"Fix meso/grid compute does not "
+                   "calculate per-atom values");
+      if (argindex[i] == 0 &&
+          modify->compute[icompute]->size_peratom_cols != 0)
+        error->all(FLERR,"Fix meso/grid compute does not "
+                   "calculate a per-atom vector");
+      if (argindex[i] && modify->compute[icompute]->size_peratom_cols == 0)
+        error->all(FLERR,"Fix meso/grid compute does not "
+                   "calculate a per-atom array");
+      if (argindex[i] &&
+          argindex[i] > modify->compute[icompute]->size_peratom_cols)
+        error->all(FLERR,"Fix meso/grid compute vector is accessed out-of-range");
+
+    } else if (which[i] == FIX) {
+      int ifix = modify->find_fix(ids[i]);
+      if (ifix < 0)
+        error->all(FLERR,"Fix ID for fix meso/grid does not exist");
+      if (modify->fix[ifix]->peratom_flag == 0)
+        error->all(FLERR,"Fix meso/grid fix does not calculate per-atom values");
+      if (argindex[i] == 0 && modify->fix[ifix]->size_peratom_cols != 0)
+        error->all(FLERR,"Fix meso/grid fix does not calculate a per-atom vector");
+      if (argindex[i] && modify->fix[ifix]->size_peratom_cols == 0)
+        error->all(FLERR,"Fix meso/grid fix does not calculate a per-atom array");
+      if (argindex[i] && argindex[i] > modify->fix[ifix]->size_peratom_cols)
+        error->all(FLERR,"Fix meso/grid fix vector is accessed out-of-range");
+
+    } else if (which[i] == VARIABLE) {
+      int ivariable = input->variable->find(ids[i]);
+      if (ivariable < 0)
+        error->all(FLERR,"Variable name for fix meso/grid does not exist");
+      if (input->variable->atomstyle(ivariable) == 0)
+        error->all(FLERR,"Fix meso/grid variable is not atom-style variable");
+    }
+  }
+
+  // a '*' in the file name writes one file per output, as for dumps
+  // a ".bin" suffix selects binary output
+
+  if (strchr(filename,'*')) multifile = 1;
+  char *suffix = filename + strlen(filename) - strlen(".bin");
+  if (suffix > filename && strcmp(suffix,".bin") == 0) binary = 1;
+
+  if (me == 0 && !multifile) {
+    if (binary) fp = fopen(filename,"wb");
+    else fp = fopen(filename,"w");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open fix meso/grid file %s",filename);
+      error->one(FLERR,str);
+    }
+  }
+
+  // initializations
+
+  nnode = ngrid[0]*ngrid[1]*ngrid[2];
+  irepeat = 0;
+  nsample = 0;
+
+  blo[0] = blo[1] = blo[2] = 0;
+  nblock[0] = nblock[1] = nblock[2] = 0;
+  sum = NULL;
+  total = NULL;
+  buf = NULL;
+  maxbuf = 0;
+  maxatom = 0;
+  vatom = NULL;
+
+  if (me == 0) {
+    memory->create(total,nnode,ncol,"meso/grid:total");
+    for (int m = 0; m < nnode; m++)
+      for (int k = 0; k < ncol; k++) total[m][k] = 0.0;
+  }
+
+  // nvalid = next step on which end_of_step does something
+  // add nvalid to all computes that store invocation times
+  // since don't know a priori which are invoked by this fix
+  // once in end_of_step() can set timestep for ones actually invoked
+
+  nvalid = nextvalid();
+  modify->addstep_compute_all(nvalid);
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoGrid::~FixMesoGrid()
+{
+  delete [] which;
+  delete [] argindex;
+  for (int i = 0; i < nvalues; i++) delete [] ids[i];
+  delete [] ids;
+  delete [] value2index;
+  delete [] colkind;
+  delete [] columns;
+  delete [] filename;
+
+  if (fp && me == 0) fclose(fp);
+
+  memory->destroy(sum);
+  memory->destroy(total);
+  memory->destroy(buf);
+  memory->destroy(vatom);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoGrid::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoGrid::init()
+{
+  // set indices and check validity of all computes,fixes,variables
+  // check that fix frequency is acceptable
+
+  for (int m = 0; m < nvalues; m++) {
+    if (which[m] == COMPUTE) {
+      int icompute = modify->find_compute(ids[m]);
+      if (icompute < 0)
+        error->all(FLERR,"Compute ID for fix meso/grid does not exist");
+      value2index[m] = icompute;
+
+    } else if (which[m] == FIX) {
+      int ifix = modify->find_fix(ids[m]);
+      if (ifix < 0)
+        error->all(FLERR,"Fix ID for fix meso/grid does not exist");
+      value2index[m] = ifix;
+
+      if (nevery % modify->fix[ifix]->peratom_freq)
+        error->all(FLERR,"Fix for fix meso/grid not computed at compatible time");
+
+    } else if (which[m] == VARIABLE) {
+      int ivariable = input->variable->find(ids[m]);
+      if (ivariable < 0)
+        error->all(FLERR,"Variable name for fix meso/grid does not exist");
+      value2index[m] = ivariable;
+
+    } else value2index[m] = -1;
+  }
+
+  // need to reset nvalid if nvalid < ntimestep b/c minimize was performed
+
+  if (nvalid < update->ntimestep) {
+    irepeat = 0;
+    nvalid = nextvalid();
+    modify->addstep_compute_all(nvalid);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   only does sampling if nvalid = current timestep
+------------------------------------------------------------------------- */
+
+void FixMesoGrid::setup(int vflag)
+{
+  end_of_step();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoGrid::end_of_step()
+{
+  int i,j,m,n;
+
+  // skip if not step which requires doing something
+
+  bigint ntimestep = update->ntimestep;
+  if (ntimestep != nvalid) return;
+
+  // grid and block of my nodes are set at the 1st sample of an output
+
+  if (irepeat == 0) setup_block();
+
+  // per-atom values of atoms in the group
+  // compute/fix/variable may invoke computes so wrap with clear/add
+
+  int nlocal = atom->nlocal;
+
+  // allocate at least one row so &vatom[0][m] is valid on an empty proc
+
+  if (nlocal > maxatom || vatom == NULL) {
+    maxatom = MAX(atom->nmax,1);
+    memory->destroy(vatom);
+    memory->create(vatom,maxatom,nvalues > 0 ? nvalues : 1,"meso/grid:vatom");
+  }
+
+  modify->clearstep_compute();
+
+  for (m = 0; m < nvalues; m++) {
+    n = value2index[m];
+    j = argindex[m];
+
+    if (which[m] == RHO) {
+      for (i = 0; i < nlocal; i++) vatom[i][m] = 0.0;
+
+    } else if (which[m] == E) {
+      double *e = atom->e;
+      for (i = 0; i < nlocal; i++) vatom[i][m] = e[i];
+
+    } else if (which[m] == V) {
+      double **v = atom->v;
+      for (i = 0; i < nlocal; i++) vatom[i][m] = v[i][j];
+
+    // invoke compute if not previously invoked
+
+    } else if (which[m] == COMPUTE) {
+      Compute *compute = modify->compute[n];
+      if (!(compute->invoked_flag & INVOKED_PERATOM)) {
+        compute->compute_peratom();
+        compute->invoked_flag |= INVOKED_PERATOM;
+      }
+      if (j == 0) {
+        double *vector = compute->vector_atom;
+        for (i = 0; i < nlocal; i++) vatom[i][m] = vector[i];
+      } else {
+        double **array = compute->array_atom;
+        for (i = 0; i < nlocal; i++) vatom[i][m] = array[i][j-1];
+      }
+
+    // access fix fields, guaranteed to be ready
+
+    } else if (which[m] == FIX) {
+      if (j == 0) {
+        double *vector = modify->fix[n]->vector_atom;
+        for (i = 0; i < nlocal; i++) vatom[i][m] = vector[i];
+      } else {
+        double **array = modify->fix[n]->array_atom;
+        for (i = 0; i < nlocal; i++) vatom[i][m] = array[i][j-1];
+      }
+
+    // evaluate atom-style variable into column m
+
+    } else if (which[m] == VARIABLE) {
+      input->variable->compute_atom(n,igroup,&vatom[0][m],nvalues,0);
+    }
+  }
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, sample, ());
+
+  // done if irepeat < nrepeat
+  // else reset irepeat and nvalid
+
+  irepeat++;
+  if (irepeat < nrepeat) {
+    nvalid += nevery;
+    modify->addstep_compute(nvalid);
+    return;
+  }
+
+  irepeat = 0;
+  nvalid = ntimestep+nfreq - (nrepeat-1)*nevery;
+  modify->addstep_compute(nvalid);
+
+  // sum blocks of all procs into the global grid and write it
+
+  if (me == 0 && ave == ONE) {
+    for (m = 0; m < nnode; m++)
+      for (i = 0; i < ncol; i++) total[m][i] = 0.0;
+    nsample = 0;
+  }
+  nsample += nrepeat;
+
+  gather();
+  if (me == 0) write(ntimestep);
+}
+
+/* ----------------------------------------------------------------------
+   grid nodes are the centers of Nx by Ny by Nz cells of the box
+   my block holds the nodes within the kernel cutoff plus the skin
+     of my sub-domain, those of periodic dimensions may be images of
+     nodes on the other side of the box
+------------------------------------------------------------------------- */
+
+void FixMesoGrid::setup_block()
+{
+  int dimension = domain->dimension;
+  int *periodicity = domain->periodicity;
+  double rc = cut + neighbor->skin;
+  int lo,hi;
+
+  for (int d = 0; d < 3; d++) {
+    boxlo[d] = domain->boxlo[d];
+    delta[d] = domain->prd[d] / ngrid[d];
+    if (d == 2 && dimension == 2) {
+      blo[d] = 0;
+      nblock[d] = 1;
+      continue;
+    }
+    lo = static_cast<int>
+      (ceil((domain->sublo[d] - rc - boxlo[d]) / delta[d] - 0.5));
+    hi = static_cast<int>
+      (floor((domain->subhi[d] + rc - boxlo[d]) / delta[d] - 0.5));
+    if (!periodicity[d]) {
+      lo = MAX(lo,0);
+      hi = MIN(hi,ngrid[d]-1);
+    }
+    blo[d] = lo;
+    nblock[d] = MAX(hi-lo+1,0);
+  }
+
+  int nblocknode = nblock[0]*nblock[1]*nblock[2];
+  memory->destroy(sum);
+  memory->create(sum,MAX(nblocknode,1),ncol,"meso/grid:sum");
+  for (int m = 0; m < nblocknode; m++)
+    for (int k = 0; k < ncol; k++) sum[m][k] = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   add the kernel weighted values of my atoms to the nodes of my block
+   weight = sum_j V_j W_ij with V_j = m_j / rho_j, the Shepard sum
+   rho is interpolated as sum_j m_j W_ij, stress as sum_j s_j W_ij with
+     the stress*volume s_j of compute stress/atom, and all other values
+     A as sum_j V_j A_j W_ij, which is divided by the weight on output
+------------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void FixMesoGrid::sample()
+{
+  int i,m,ix,iy,iz,lo[3],hi[3];
+  double massone,vol,w,dx,dy,dz,rsq,*s;
+
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double cutsq = cut*cut;
+
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit) || rho[i] <= 0.0) continue;
+
+    for (int d = 0; d < DIM; d++) {
+      lo[d] = static_cast<int>
+        (ceil((x[i][d] - cut - boxlo[d]) / delta[d] - 0.5));
+      hi[d] = static_cast<int>
+        (floor((x[i][d] + cut - boxlo[d]) / delta[d] - 0.5));
+      lo[d] = MAX(lo[d],blo[d]);
+      hi[d] = MIN(hi[d],blo[d]+nblock[d]-1);
+    }
+    if (DIM == 2) lo[2] = hi[2] = 0;
+
+    massone = rmass ? rmass[i] : mass[type[i]];
+    vol = massone / rho[i];
+
+    for (iz = lo[2]; iz <= hi[2]; iz++) {
+      dz = (DIM == 3) ? x[i][2] - boxlo[2] - (iz+0.5)*delta[2] : 0.0;
+      for (iy = lo[1]; iy <= hi[1]; iy++) {
+        dy = x[i][1] - boxlo[1] - (iy+0.5)*delta[1];
+        for (ix = lo[0]; ix <= hi[0]; ix++) {
+          dx = x[i][0] - boxlo[0] - (ix+0.5)*delta[0];
+          rsq = dx*dx + dy*dy + dz*dz;
+          if (rsq >= cutsq) continue;
+
+          w = SPHKernel::Kernel<KERNEL,DIM>::w(sqrt(rsq),cut);
+          s = sum[((iz-blo[2])*nblock[1] + iy-blo[1])*nblock[0] + ix-blo[0]];
+          s[0] += vol * w;
+          for (m = 0; m < nvalues; m++) {
+            if (colkind[m+1] == MASS) s[m+1] += massone * w;
+            else if (colkind[m+1] == VOLUME) s[m+1] += vatom[i][m] * w;
+            else s[m+1] += vol * vatom[i][m] * w;
+          }
+        }
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   proc 0 adds the blocks of all procs to the global grid
+   nodes of periodic images are mapped back into the box, nodes outside
+     a non-periodic box were already clipped
+------------------------------------------------------------------------- */
+
+void FixMesoGrid::gather()
+{
+  int header[6],ix,iy,iz,jx,jy,jz,k,n;
+  double *data,*t;
+  MPI_Status status;
+
+  int nblocknode = nblock[0]*nblock[1]*nblock[2];
+
+  if (me != 0) {
+    header[0] = blo[0]; header[1] = blo[1]; header[2] = blo[2];
+    header[3] = nblock[0]; header[4] = nblock[1]; header[5] = nblock[2];
+    MPI_Send(header,6,MPI_INT,0,0,world);
+    if (nblocknode)
+      MPI_Send(&sum[0][0],nblocknode*ncol,MPI_DOUBLE,0,0,world);
+    return;
+  }
+
+  int *periodicity = domain->periodicity;
+
+  for (int iproc = 0; iproc < nprocs; iproc++) {
+    if (iproc == 0) {
+      header[0] = blo[0]; header[1] = blo[1]; header[2] = blo[2];
+      header[3] = nblock[0]; header[4] = nblock[1]; header[5] = nblock[2];
+      data = nblocknode ? &sum[0][0] : NULL;
+    } else {
+      MPI_Recv(header,6,MPI_INT,iproc,0,world,&status);
+      n = header[3]*header[4]*header[5];
+      if (n == 0) continue;
+      if (n*ncol > maxbuf) {
+        maxbuf = n*ncol;
+        memory->destroy(buf);
+        memory->create(buf,maxbuf,"meso/grid:buf");
+      }
+      MPI_Recv(buf,n*ncol,MPI_DOUBLE,iproc,0,world,&status);
+      data = buf;
+    }
+
+    for (iz = 0; iz < header[5]; iz++) {
+      jz = header[2] + iz;
+      if (periodicity[2]) jz = ((jz % ngrid[2]) + ngrid[2]) % ngrid[2];
+      else if (jz < 0 || jz >= ngrid[2]) continue;
+      for (iy = 0; iy < header[4]; iy++) {
+        jy = header[1] + iy;
+        if (periodicity[1]) jy = ((jy % ngrid[1]) + ngrid[1]) % ngrid[1];
+        else if (jy < 0 || jy >= ngrid[1]) continue;
+        for (ix = 0; ix < header[3]; ix++) {
+          jx = header[0] + ix;
+          if (periodicity[0]) jx = ((jx % ngrid[0]) + ngrid[0]) % ngrid[0];
+          else if (jx < 0 || jx >= ngrid[0]) continue;
+          t = total[(jz*ngrid[1] + jy)*ngrid[0] + jx];
+          n = ((iz*header[4] + iy)*header[3] + ix) * ncol;
+          for (k = 0; k < ncol; k++) t[k] += data[n+k];
+        }
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   write the time-averaged grid, called by proc 0
+   binary record: timestep, Nx Ny Nz, number of columns, box bounds of
+     the grid, then each column as Nx*Ny*Nz doubles, x varying fastest
+   text record: timestep and number of nodes, then one line per node
+------------------------------------------------------------------------- */
+
+void FixMesoGrid::write(bigint ntimestep)
+{
+  int m,k;
+
+  if (multifile) {
+    char *file = new char[strlen(filename) + 16];
+    char *ptr = strchr(filename,'*');
+    *ptr = '\0';
+    sprintf(file,"%s" BIGINT_FORMAT "%s",filename,ntimestep,ptr+1);
+    *ptr = '*';
+    if (binary) fp = fopen(file,"wb");
+    else fp = fopen(file,"w");
+    if (fp == NULL) {
+      char str[128];
+      sprintf(str,"Cannot open fix meso/grid file %s",file);
+      error->one(FLERR,str);
+    }
+    delete [] file;
+  }
+
+  // normalize a copy of the sums, column by column
+
+  double norm = 1.0/nsample;
+  double *value;
+  memory->create(value,nnode,"meso/grid:value");
+
+  if (binary) {
+    double bounds[6];
+    for (k = 0; k < 3; k++) {
+      bounds[k] = boxlo[k];
+      bounds[3+k] = boxlo[k] + ngrid[k]*delta[k];
+    }
+    fwrite(&ntimestep,sizeof(bigint),1,fp);
+    fwrite(ngrid,sizeof(int),3,fp);
+    fwrite(&ncol,sizeof(int),1,fp);
+    fwrite(bounds,sizeof(double),6,fp);
+  } else {
+    if (multifile || ftell(fp) == 0) {
+      fprintf(fp,"# SPH grid data for fix %s and group %s\n",
+              id,group->names[igroup]);
+      fprintf(fp,"# Timestep Number-of-nodes\n");
+      fprintf(fp,"# Node ix iy iz x y z %s\n",columns);
+    }
+    fprintf(fp,BIGINT_FORMAT " %d\n",ntimestep,nnode);
+  }
+
+  double **out;
+  memory->create(out,binary ? 1 : nnode,ncol,"meso/grid:out");
+
+  for (k = 0; k < ncol; k++) {
+    for (m = 0; m < nnode; m++) {
+      if (colkind[k] == SHEPARD)
+        value[m] = total[m][0] > 0.0 ? total[m][k]/total[m][0] : 0.0;
+      else value[m] = total[m][k]*norm;
+    }
+    if (binary) fwrite(value,sizeof(double),nnode,fp);
+    else for (m = 0; m < nnode; m++) out[m][k] = value[m];
+  }
+
+  if (!binary) {
+    int ix,iy,iz;
+    for (m = 0; m < nnode; m++) {
+      ix = m % ngrid[0];
+      iy = (m / ngrid[0]) % ngrid[1];
+      iz = m / (ngrid[0]*ngrid[1]);
+      fprintf(fp,"  %d %d %d %d %g %g %g",m+1,ix,iy,iz,
+              boxlo[0]+(ix+0.5)*delta[0],boxlo[1]+(iy+0.5)*delta[1],
+              boxlo[2]+(iz+0.5)*delta[2]);
+      for (k = 0; k < ncol; k++) fprintf(fp," %g",out[m][k]);
+      fprintf(fp,"\n");
+    }
+  }
+
+  memory->destroy(out);
+  memory->destroy(value);
+
+  if (multifile) {
+    fclose(fp);
+    fp = NULL;
+  } else fflush(fp);
+}
+
+/* ----------------------------------------------------------------------
+   calculate nvalid = next step on which end_of_step does something
+   can be this timestep if multiple of nfreq and nrepeat = 1
+   else backup from next multiple of nfreq
+------------------------------------------------------------------------- */
+
+bigint FixMesoGrid::nextvalid()
+{
+  bigint nvalid = (update->ntimestep/nfreq)*nfreq + nfreq;
+  if (nvalid-nfreq == update->ntimestep && nrepeat == 1)
+    nvalid = update->ntimestep;
+  else
+    nvalid -= (nrepeat-1)*nevery;
+  if (nvalid < update->ntimestep) nvalid += nfreq;
+  return nvalid;
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of per-atom values and grid blocks
+------------------------------------------------------------------------- */
+
+double FixMesoGrid::memory_usage()
+{
+  double bytes = maxatom*nvalues * sizeof(double);
+  bytes += nblock[0]*nblock[1]*nblock[2]*ncol * sizeof(double);
+  bytes += maxbuf * sizeof(double);
+  if (me == 0) bytes += nnode*ncol * sizeof(double);
+  return bytes;
+}
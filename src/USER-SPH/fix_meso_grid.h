@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(meso/grid,FixMesoGrid)
+
+#else
+
+#ifndef LMP_FIX_MESO_GRID_H
+#define LMP_FIX_MESO_GRID_H
+
+#include "stdio.h"
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixMesoGrid : public Fix {
+ public:
+  FixMesoGrid(class LAMMPS *, int, char **);
+  ~FixMesoGrid();
+  int setmask();
+  void init();
+  void setup(int);
+  void end_of_step();
+  double memory_usage();
+
+ private:
+  int me,nprocs;
+  int nrepeat,nfreq,irepeat;
+  bigint nvalid;
+  int nvalues,ncol;             // per-atom values, grid columns incl. weight
+  int *which,*argindex,*value2index;
+  char **ids;
+  int *colkind;                 // interpolation of each grid column
+  int kernel;                   // SPH kernel, see sph_kernel.h
+  double cut;                   // kernel support radius
+
+  char *filename,*columns;
+  int binary,multifile;
+  FILE *fp;
+  int ave,nsample;
+
+  int ngrid[3];                 // global grid size
+  double boxlo[3],delta[3];     // grid origin and spacing, box at 1st sample
+  int blo[3],nblock[3];         // grid nodes of my block, may be periodic
+  int nnode;                    // nodes of the global grid
+  double **sum;                 // my block, accumulated over Nrepeat samples
+
+  int maxatom;
+  double **vatom;               // per-atom values of one sample
+  double **total;               // global grid on proc 0
+  double *buf;                  // receive buffer on proc 0
+  int maxbuf;
+
+  void setup_block();
+  template <int KERNEL, int DIM> void sample();
+  void gather();
+  void write(bigint);
+  bigint nextvalid();
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_meso_hsml.h"
+#include "atom.h"
+#include "force.h"
+#include "pair.h"
+#include "domain.h"
+#include "update.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoHsml::FixMesoHsml(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg) {
+
+  if (atom->hsml == NULL || atom->rho_flag != 1)
+    error->all(FLERR,"Fix meso/hsml requires atom style meso");
+
+  if (narg < 6)
+    error->all(FLERR,"Illegal fix meso/hsml command");
+
+  eta = force->numeric(arg[3]);
+  hmin = force->numeric(arg[4]);
+  hmax = force->numeric(arg[5]);
+  margin = 0.1;
+
+  int iarg = 6;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"margin") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/hsml command");
+      margin = force->numeric(arg[iarg+1]);
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix meso/hsml command");
+  }
+
+  if (eta <= 0.0 || hmin <= 0.0 || hmax < hmin || margin < 0.0)
+    error->all(FLERR,"Illegal fix meso/hsml command");
+
+  nevery = 1;
+
+  // neighbor lists are rebuilt when a smoothing length outgrows its radius
+
+  force_reneighbor = 1;
+  next_reneighbor = -1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoHsml::setmask() {
+  int mask = 0;
+  mask |= PRE_EXCHANGE;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoHsml::init() {
+  if (force->pair == NULL)
+    error->all(FLERR,"Fix meso/hsml requires a pair style");
+
+  int dim;
+  char str[] = "hsml";
+  if (force->pair->extract(str,dim) == NULL)
+    error->all(FLERR,"Pair style does not support fix meso/hsml");
+
+  if (hmax > force->pair->cutforce)
+    error->all(FLERR,"Fix meso/hsml hmax exceeds pair cutoff");
+}
+
+/* ----------------------------------------------------------------------
+   set smoothing length of atoms that have none yet and radius of all atoms
+   all atoms need one, also those not in the group
+------------------------------------------------------------------------- */
+
+void FixMesoHsml::setup_pre_exchange() {
+  double *hsml = atom->hsml;
+  double *gradh = atom->gradh;
+  int nlocal = atom->nlocal;
+
+  for (int i = 0; i < nlocal; i++)
+    if (hsml[i] <= 0.0) {
+      hsml[i] = hsml_one(i);
+      gradh[i] = 1.0;
+    }
+
+  pre_exchange();
+}
+
+/* ----------------------------------------------------------------------
+   set neighbor radius of owned atoms before ghosts are acquired
+------------------------------------------------------------------------- */
+
+void FixMesoHsml::pre_exchange() {
+  double *hsml = atom->hsml;
+  double *radius = atom->radius;
+  int nlocal = atom->nlocal;
+
+  for (int i = 0; i < nlocal; i++)
+    radius[i] = MIN(hsml[i] * (1.0 + margin), hmax);
+}
+
+/* ----------------------------------------------------------------------
+   adapt smoothing length of atoms in group to their density
+   force a neighbor list rebuild on the next step if one outgrew its radius
+------------------------------------------------------------------------- */
+
+void FixMesoHsml::end_of_step() {
+  double *hsml = atom->hsml;
+  double *radius = atom->radius;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  int flag = 0;
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit) {
+      hsml[i] = hsml_one(i);
+      if (hsml[i] > radius[i]) flag = 1;
+    }
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) next_reneighbor = update->ntimestep + 1;
+}
+
+/* ----------------------------------------------------------------------
+   smoothing length of atom i from its density, bounded by hmin and hmax
+------------------------------------------------------------------------- */
+
+double FixMesoHsml::hsml_one(int i) {
+  double *rho = atom->rho;
+  double m;
+
+  if (rho[i] <= 0.0) return hmax;
+
+  if (atom->rmass_flag) m = atom->rmass[i];
+  else m = atom->mass[atom->type[i]];
+
+  double h;
+  if (domain->dimension == 3) h = eta * pow(m/rho[i],1.0/3.0);
+  else h = eta * sqrt(m/rho[i]);
+
+  return MAX(hmin,MIN(h,hmax));
+}
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(meso/hsml,FixMesoHsml)
+
+#else
+
+#ifndef LMP_FIX_MESO_HSML_H
+#define LMP_FIX_MESO_HSML_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixMesoHsml : public Fix {
+ public:
+  FixMesoHsml(class LAMMPS *, int, char **);
+  int setmask();
+  void init();
+  void setup_pre_exchange();
+  void pre_exchange();
+  void end_of_step();
+
+ private:
+  double eta;                   // h = eta * (m/rho)^(1/dim)
+  double hmin,hmax;             // bounds of h
+  double margin;                // neighbor radius = h * (1 + margin)
+
+  double hsml_one(int);
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,526 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_meso_split.h"
+#include "atom.h"
+#include "atom_vec.h"
+#include "update.h"
+#include "domain.h"
+#include "region.h"
+#include "force.h"
+#include "modify.h"
+#include "input.h"
+#include "variable.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define BIG 1.0e20
+#define MAXCAND 64              // merge candidates kept around one atom
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoSplit::FixMesoSplit(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if ((atom->e_flag != 1) || (atom->rho_flag != 1) || (atom->cv_flag != 1))
+    error->all(FLERR,"Fix meso/split requires atom attributes rho, e, cv");
+
+  if (narg < 9) error->all(FLERR,"Illegal fix meso/split command");
+
+  vector_flag = 1;
+  size_vector = 2;
+  global_freq = 1;
+  extvector = 1;
+
+  nevery = atoi(arg[3]);
+  ctype = atoi(arg[4]);
+  ftype = atoi(arg[5]);
+  cutoff = atof(arg[6]);
+
+  if (nevery <= 0 || cutoff <= 0.0)
+    error->all(FLERR,"Illegal fix meso/split command");
+  if (ctype <= 0 || ctype > atom->ntypes ||
+      ftype <= 0 || ftype > atom->ntypes || ctype == ftype)
+    error->all(FLERR,"Invalid atom type in fix meso/split command");
+
+  // optional args
+
+  iregion = -1;
+  idregion = NULL;
+  idvar = NULL;
+  spacing = 0.5;
+
+  int iarg = 7;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"region") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/split command");
+      iregion = domain->find_region(arg[iarg+1]);
+      if (iregion == -1)
+        error->all(FLERR,"Region ID for fix meso/split does not exist");
+      int n = strlen(arg[iarg+1]) + 1;
+      idregion = new char[n];
+      strcpy(idregion,arg[iarg+1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"var") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/split command");
+      int n = strlen(arg[iarg+1]) + 1;
+      idvar = new char[n];
+      strcpy(idvar,arg[iarg+1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"spacing") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/split command");
+      spacing = atof(arg[iarg+1]);
+      if (spacing <= 0.0 || spacing >= 1.0)
+        error->all(FLERR,"Illegal fix meso/split command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix meso/split command");
+  }
+
+  if ((idregion == NULL) == (idvar == NULL))
+    error->all(FLERR,"Fix meso/split requires either a region or a variable");
+
+  nchild = (domain->dimension == 3) ? 8 : 4;
+
+  // set up reneighboring
+
+  force_reneighbor = 1;
+  next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
+
+  nsplit_total = nmerge_total = 0;
+
+  maxatom = 0;
+  fine = NULL;
+  mark = NULL;
+  maxbin = maxnext = 0;
+  binhead = next = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoSplit::~FixMesoSplit()
+{
+  delete [] idregion;
+  delete [] idvar;
+  memory->destroy(fine);
+  memory->destroy(mark);
+  memory->destroy(binhead);
+  memory->destroy(next);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoSplit::setmask()
+{
+  int mask = 0;
+  mask |= PRE_EXCHANGE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoSplit::init()
+{
+  if (idregion) {
+    iregion = domain->find_region(idregion);
+    if (iregion == -1)
+      error->all(FLERR,"Region ID for fix meso/split does not exist");
+  }
+
+  if (idvar) {
+    ivar = input->variable->find(idvar);
+    if (ivar < 0)
+      error->all(FLERR,"Variable name for fix meso/split does not exist");
+    if (input->variable->atomstyle(ivar) == 0)
+      error->all(FLERR,"Fix meso/split variable is not atom-style variable");
+  }
+
+  // a coarse atom must carry the mass of its daughters
+
+  double *mass = atom->mass;
+  if (mass == NULL || !atom->mass_setflag[ctype] || !atom->mass_setflag[ftype])
+    error->all(FLERR,"Fix meso/split requires masses of both atom types");
+  if (fabs(mass[ctype] - nchild*mass[ftype]) > 1.0e-10*mass[ctype])
+    error->all(FLERR,"Fix meso/split coarse mass must be 2^dim fine masses");
+
+  if (cutoff >= domain->xprd_half || cutoff >= domain->yprd_half ||
+      (domain->dimension == 3 && cutoff >= domain->zprd_half))
+    error->all(FLERR,"Fix meso/split cutoff is larger than half the box");
+}
+
+/* ----------------------------------------------------------------------
+   split and merge atoms before they migrate, new and moved atoms are
+     wrapped and sent to their owners by the following exchange
+------------------------------------------------------------------------- */
+
+void FixMesoSplit::pre_exchange()
+{
+  if (next_reneighbor != update->ntimestep) return;
+
+  int nlocal = atom->nlocal;
+  if (nlocal > maxatom) {
+    maxatom = atom->nmax;
+    memory->destroy(fine);
+    memory->destroy(mark);
+    memory->create(fine,maxatom,"meso/split:fine");
+    memory->create(mark,maxatom,"meso/split:mark");
+  }
+  for (int i = 0; i < nlocal; i++) mark[i] = 0;
+
+  indicator();
+
+  // merges only mark the atoms they remove, so the indices of the
+  // atoms existing before this step stay valid until they are deleted
+  // split atoms append their daughters after them
+
+  bigint nmerge = merge();
+  bigint nsplit = split();
+
+  AtomVec *avec = atom->avec;
+  for (int i = nlocal-1; i >= 0; i--) {
+    if (mark[i] == 1) {
+      avec->copy(atom->nlocal-1,i,1);
+      atom->nlocal--;
+    }
+  }
+
+  bigint counts[2],all[2];
+  counts[0] = nsplit;
+  counts[1] = nmerge;
+  MPI_Allreduce(counts,all,2,MPI_LMP_BIGINT,MPI_SUM,world);
+  nsplit_total += all[0];
+  nmerge_total += all[1];
+
+  // reset global natoms and tags of the daughters
+  // if global map exists, reset it now instead of waiting for comm
+  // since adding and deleting atoms messes up ghosts
+
+  atom->natoms += (nchild-1) * (all[0] - all[1]);
+  if (all[0] && atom->tag_enable) {
+    if (atom->natoms > MAXTAGINT)
+      error->all(FLERR,"Too many atoms created by fix meso/split");
+    atom->tag_extend();
+  }
+  if ((all[0] || all[1]) && atom->map_style) {
+    atom->nghost = 0;
+    atom->map_init();
+    atom->map_set();
+  }
+
+  next_reneighbor = update->ntimestep + nevery;
+}
+
+/* ----------------------------------------------------------------------
+   resolution wanted for each owned atom, > 0 for fine, else coarse
+------------------------------------------------------------------------- */
+
+void FixMesoSplit::indicator()
+{
+  double **x = atom->x;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  if (idvar) {
+    modify->clearstep_compute();
+    input->variable->compute_atom(ivar,igroup,fine,1,0);
+    modify->addstep_compute(update->ntimestep + nevery);
+  } else {
+    Region *region = domain->regions[iregion];
+    for (int i = 0; i < nlocal; i++)
+      if ((mask[i] & groupbit) && region->match(x[i][0],x[i][1],x[i][2]))
+        fine[i] = 1.0;
+      else fine[i] = 0.0;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   replace each coarse atom in the group that wants fine resolution by
+     2^dim fine atoms on the corners of a square or cube
+   the edge of the cube is spacing times the spacing of coarse atoms,
+     (m/rho)^(1/dim), so fine atoms fill the volume of the coarse atom
+   daughters inherit v, vest and rho, and share e and cv, which are per
+     atom quantities, so mass, momentum and energy are conserved
+------------------------------------------------------------------------- */
+
+int FixMesoSplit::split()
+{
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *e = atom->e;
+  double *cv = atom->cv;
+  double *hsml = atom->hsml;
+  double *radius = atom->radius;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int dim = domain->dimension;
+
+  AtomVec *avec = atom->avec;
+  double hscale = pow((double) nchild,-1.0/dim);
+  double xold[3],delta;
+  int i,k,m;
+
+  int n = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit) || type[i] != ctype || mark[i]) continue;
+    if (fine[i] <= 0.0 || rho[i] <= 0.0) continue;
+
+    delta = 0.5 * spacing * pow(mass[ctype]/rho[i],1.0/dim);
+
+    type[i] = ftype;
+    e[i] /= nchild;
+    cv[i] /= nchild;
+    if (hsml[i] > 0.0) hsml[i] *= hscale;
+    if (radius[i] > 0.0) radius[i] *= hscale;
+    xold[0] = x[i][0];
+    xold[1] = x[i][1];
+    xold[2] = x[i][2];
+
+    // atom i becomes the 1st daughter, the others are copies of it
+    // arrays may be reallocated by grow()
+
+    for (k = 1; k < nchild; k++) {
+      m = atom->nlocal;
+      if (m == atom->nmax) avec->grow(0);
+      avec->copy(i,m,0);
+      atom->nlocal++;
+
+      x = atom->x;
+      atom->tag[m] = 0;
+      atom->x[m][0] = xold[0] + ((k & 1) ? delta : -delta);
+      atom->x[m][1] = xold[1] + ((k & 2) ? delta : -delta);
+      if (dim == 3) atom->x[m][2] = xold[2] + ((k & 4) ? delta : -delta);
+    }
+
+    x = atom->x;
+    rho = atom->rho;
+    e = atom->e;
+    cv = atom->cv;
+    hsml = atom->hsml;
+    radius = atom->radius;
+    type = atom->type;
+    mask = atom->mask;
+
+    x[i][0] -= delta;
+    x[i][1] -= delta;
+    if (dim == 3) x[i][2] -= delta;
+    n++;
+  }
+
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   merge groups of 2^dim fine atoms in the group that want coarse
+     resolution into one coarse atom, each atom is merged with its
+     nearest unmerged neighbors within cutoff, if it has enough of them
+   position, v and vest are mass averages, e and cv are summed and the
+     kinetic energy lost by averaging v is added to e
+   only owned atoms are merged, so atoms on different procs never are
+------------------------------------------------------------------------- */
+
+int FixMesoSplit::merge()
+{
+  double **x = atom->x;
+  double **v = atom->v;
+  double **vest = atom->vest;
+  double *rho = atom->rho;
+  double *e = atom->e;
+  double *cv = atom->cv;
+  double *hsml = atom->hsml;
+  double *radius = atom->radius;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int dim = domain->dimension;
+
+  // bin the candidates, bins cover their bounding box
+
+  int i,j,k,ibin,ix,iy,iz,jx,jy,jz;
+  double lo[3],hi[3];
+  lo[0] = lo[1] = lo[2] = BIG;
+  hi[0] = hi[1] = hi[2] = -BIG;
+
+  int ncand = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit) || type[i] != ftype || fine[i] > 0.0) continue;
+    for (k = 0; k < 3; k++) {
+      lo[k] = MIN(lo[k],x[i][k]);
+      hi[k] = MAX(hi[k],x[i][k]);
+    }
+    ncand++;
+  }
+  if (ncand < nchild) return 0;
+
+  bininv = 1.0/cutoff;
+  for (k = 0; k < 3; k++) binlo[k] = lo[k];
+  nbinx = static_cast<int> ((hi[0]-lo[0])*bininv) + 1;
+  nbiny = static_cast<int> ((hi[1]-lo[1])*bininv) + 1;
+  nbinz = static_cast<int> ((hi[2]-lo[2])*bininv) + 1;
+  if ((bigint) nbinx*nbiny*nbinz > MAXSMALLINT)
+    error->one(FLERR,"Too many bins in fix meso/split");
+  nbins = nbinx*nbiny*nbinz;
+
+  if (nbins > maxbin) {
+    maxbin = nbins;
+    memory->destroy(binhead);
+    memory->create(binhead,maxbin,"meso/split:binhead");
+  }
+  if (nlocal > maxnext) {
+    maxnext = atom->nmax;
+    memory->destroy(next);
+    memory->create(next,maxnext,"meso/split:next");
+  }
+
+  for (ibin = 0; ibin < nbins; ibin++) binhead[ibin] = -1;
+  for (i = nlocal-1; i >= 0; i--) {
+    if (!(mask[i] & groupbit) || type[i] != ftype || fine[i] > 0.0) continue;
+    ibin = coord2bin(x[i]);
+    next[i] = binhead[ibin];
+    binhead[ibin] = i;
+  }
+
+  // greedy grouping, candidates already merged are marked
+  // with 1 if they are deleted, with 2 if they are the coarse atom
+
+  int jcand[MAXCAND];
+  double rcand[MAXCAND];
+  double cutsq = cutoff*cutoff;
+  double delx,dely,delz,rsq,tmp;
+  int ncount,itmp;
+
+  double hscale = pow((double) nchild,1.0/dim);
+  double vfrac = 1.0/nchild;
+  double mvv2e = force->mvv2e;
+
+  int n = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit) || type[i] != ftype || fine[i] > 0.0) continue;
+    if (mark[i]) continue;
+
+    ix = static_cast<int> ((x[i][0]-binlo[0])*bininv);
+    iy = static_cast<int> ((x[i][1]-binlo[1])*bininv);
+    iz = static_cast<int> ((x[i][2]-binlo[2])*bininv);
+
+    ncount = 0;
+    for (jz = MAX(iz-1,0); jz <= MIN(iz+1,nbinz-1); jz++)
+      for (jy = MAX(iy-1,0); jy <= MIN(iy+1,nbiny-1); jy++)
+        for (jx = MAX(ix-1,0); jx <= MIN(ix+1,nbinx-1); jx++)
+          for (j = binhead[(jz*nbiny + jy)*nbinx + jx]; j >= 0; j = next[j]) {
+            if (j == i || mark[j]) continue;
+            delx = x[j][0] - x[i][0];
+            dely = x[j][1] - x[i][1];
+            delz = x[j][2] - x[i][2];
+            rsq = delx*delx + dely*dely + delz*delz;
+            if (rsq >= cutsq || ncount == MAXCAND) continue;
+            jcand[ncount] = j;
+            rcand[ncount++] = rsq;
+          }
+
+    if (ncount < nchild-1) continue;
+
+    // move the nchild-1 nearest candidates to the front
+
+    for (k = 0; k < nchild-1; k++)
+      for (j = k+1; j < ncount; j++)
+        if (rcand[j] < rcand[k]) {
+          tmp = rcand[j]; rcand[j] = rcand[k]; rcand[k] = tmp;
+          itmp = jcand[j]; jcand[j] = jcand[k]; jcand[k] = itmp;
+        }
+
+    // atom i becomes the coarse atom, all fine atoms have equal mass
+
+    double xsum[3],vsum[3],vestsum[3];
+    double vsq = v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2];
+    double rhosum = rho[i];
+    double hsum = hsml[i];
+    double radsum = radius[i];
+    xsum[0] = xsum[1] = xsum[2] = 0.0;
+    for (k = 0; k < 3; k++) {
+      vsum[k] = v[i][k];
+      vestsum[k] = vest[i][k];
+    }
+
+    for (k = 0; k < nchild-1; k++) {
+      j = jcand[k];
+      xsum[0] += x[j][0] - x[i][0];
+      xsum[1] += x[j][1] - x[i][1];
+      xsum[2] += x[j][2] - x[i][2];
+      vsq += v[j][0]*v[j][0] + v[j][1]*v[j][1] + v[j][2]*v[j][2];
+      vsum[0] += v[j][0];
+      vsum[1] += v[j][1];
+      vsum[2] += v[j][2];
+      vestsum[0] += vest[j][0];
+      vestsum[1] += vest[j][1];
+      vestsum[2] += vest[j][2];
+      rhosum += rho[j];
+      e[i] += e[j];
+      cv[i] += cv[j];
+      hsum += hsml[j];
+      radsum += radius[j];
+      mark[j] = 1;
+    }
+
+    for (k = 0; k < 3; k++) {
+      x[i][k] += vfrac*xsum[k];
+      v[i][k] = vfrac*vsum[k];
+      vest[i][k] = vfrac*vestsum[k];
+    }
+    e[i] += 0.5 * mvv2e * mass[ftype] *
+      (vsq - nchild*(v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]));
+    rho[i] = vfrac*rhosum;
+    if (hsum > 0.0) hsml[i] = hscale*vfrac*hsum;
+    if (radsum > 0.0) radius[i] = hscale*vfrac*radsum;
+    type[i] = ctype;
+    mark[i] = 2;
+    n++;
+  }
+
+  return n;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoSplit::coord2bin(double *x)
+{
+  int ix = static_cast<int> ((x[0]-binlo[0])*bininv);
+  int iy = static_cast<int> ((x[1]-binlo[1])*bininv);
+  int iz = static_cast<int> ((x[2]-binlo[2])*bininv);
+  return (iz*nbiny + iy)*nbinx + ix;
+}
+
+/* ----------------------------------------------------------------------
+   number of coarse atoms split and of fine atom groups merged so far
+------------------------------------------------------------------------- */
+
+double FixMesoSplit::compute_vector(int n)
+{
+  if (n == 0) return (double) nsplit_total;
+  return (double) nmerge_total;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixMesoSplit::memory_usage()
+{
+  double bytes = maxatom * sizeof(double);
+  bytes += maxatom * sizeof(int);
+  bytes += (maxbin + maxnext) * sizeof(int);
+  return bytes;
+}
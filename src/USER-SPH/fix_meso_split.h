@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(meso/split,FixMesoSplit)
+
+#else
+
+#ifndef LMP_FIX_MESO_SPLIT_H
+#define LMP_FIX_MESO_SPLIT_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixMesoSplit : public Fix {
+ public:
+  FixMesoSplit(class LAMMPS *, int, char **);
+  ~FixMesoSplit();
+  int setmask();
+  void init();
+  void pre_exchange();
+  double compute_vector(int);
+  double memory_usage();
+
+ private:
+  int ctype,ftype;              // coarse and fine atom types
+  int nchild;                   // fine atoms per coarse atom, 2^dim
+  double cutoff;                // max distance of atoms merged into one
+  double spacing;               // daughter offset / coarse atom spacing
+  int iregion;                  // region of fine resolution, or -1
+  char *idregion;
+  char *idvar;                  // atom-style variable > 0 for fine, or NULL
+  int ivar;
+
+  bigint nsplit_total,nmerge_total;
+
+  int maxatom;
+  double *fine;                 // resolution indicator of each atom
+  int *mark;                    // 1 for atoms deleted by a merge, 2 for
+                                //   the coarse atoms they merged into
+
+  int nbins,nbinx,nbiny,nbinz;  // bins of the merge candidates
+  double binlo[3],bininv;
+  int maxbin,maxnext;
+  int *binhead,*next;
+
+  void indicator();
+  int split();
+  int merge();
+  int coord2bin(double *);
+};
+
+}
+
+#endif
+#endif
@@ -41,10 +41,35 @@ FixMesoStationary::FixMesoStationary(LAMMPS *lmp, int narg, char **arg) :
     error->all(FLERR,
         "fix meso/stationary command requires atom_style with both energy and density, e.g. meso");
 
-  if (narg != 3)
+  if (narg != 3 && narg != 5)
     error->all(FLERR,"Illegal number of arguments for fix meso/stationary command");
 
+  exclude = 0;
+  if (narg == 5) {
+    if (strcmp(arg[3],"exclude") != 0)
+      error->all(FLERR,"Illegal fix meso/stationary command");
+    if (strcmp(arg[4],"yes") == 0) exclude = 1;
+    else if (strcmp(arg[4],"no") == 0) exclude = 0;
+    else error->all(FLERR,"Illegal fix meso/stationary command");
+  }
+
   time_integrate = 0;
+
+  // pairs of two stationary particles are not built into neighbor lists
+  // their forces are not used, and their drho and de vanish unless
+  //   the particles are given different velocities or temperatures
+
+  if (exclude) {
+    if (igroup == 0)
+      error->all(FLERR,"Fix meso/stationary exclude cannot be used with group all");
+    neighbor->exclusion_group_group(igroup,igroup);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoStationary::~FixMesoStationary() {
+  if (exclude) neighbor->exclusion_group_group_delete(igroup,igroup);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -53,6 +78,8 @@ int FixMesoStationary::setmask() {
   int mask = 0;
   mask |= INITIAL_INTEGRATE;
   mask |= FINAL_INTEGRATE;
+  mask |= INITIAL_INTEGRATE_RESPA;
+  mask |= FINAL_INTEGRATE_RESPA;
   return mask;
 }
 
@@ -61,6 +88,9 @@ int FixMesoStationary::setmask() {
 void FixMesoStationary::init() {
   dtv = update->dt;
   dtf = 0.5 * update->dt * force->ftm2v;
+
+  if (strstr(update->integrate_style,"respa"))
+    step_respa = ((Respa *) update->integrate)->step;
 }
 
 /* ----------------------------------------------------------------------
@@ -113,6 +143,23 @@ void FixMesoStationary::final_integrate() {
   }
 }
 
+/* ----------------------------------------------------------------------
+   rho and e change by the drho and de of each level, restored by Respa
+------------------------------------------------------------------------- */
+
+void FixMesoStationary::initial_integrate_respa(int vflag, int ilevel,
+                                                int iloop) {
+  dtf = 0.5 * step_respa[ilevel] * force->ftm2v;
+  initial_integrate(vflag);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoStationary::final_integrate_respa(int ilevel, int iloop) {
+  dtf = 0.5 * step_respa[ilevel] * force->ftm2v;
+  final_integrate();
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixMesoStationary::reset_dt() {
@@ -27,10 +27,13 @@ namespace LAMMPS_NS {
 class FixMesoStationary : public Fix {
  public:
   FixMesoStationary(class LAMMPS *, int, char **);
+  ~FixMesoStationary();
   int setmask();
   virtual void init();
   virtual void initial_integrate(int);
   virtual void final_integrate();
+  void initial_integrate_respa(int, int, int);
+  void final_integrate_respa(int, int);
   void reset_dt();
 
  private:
@@ -39,6 +42,7 @@ class FixMesoStationary : public Fix {
   double dtv,dtf;
   double *step_respa;
   int mass_require;
+  int exclude;                  // 1 if stationary-stationary pairs excluded
 
   class Pair *pair;
 };
@@ -0,0 +1,460 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_meso_visc.h"
+#include "pair_sdpd.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "modify.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{VEC,REV_VEC,REV_SCALAR};
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoVisc::FixMesoVisc(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if ((atom->e_flag != 1) || (atom->rho_flag != 1))
+    error->all(FLERR,
+        "fix meso/visc command requires atom_style with both energy and density");
+
+  tolerance = 1.0e-8;
+  maxiter = 200;
+  theta = 1.0;
+
+  int iarg = 3;
+  while (iarg < narg) {
+    if (iarg+2 > narg) error->all(FLERR,"Illegal fix meso/visc command");
+    if (strcmp(arg[iarg],"tol") == 0) tolerance = atof(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"maxiter") == 0) maxiter = atoi(arg[iarg+1]);
+    else if (strcmp(arg[iarg],"theta") == 0) theta = atof(arg[iarg+1]);
+    else error->all(FLERR,"Illegal fix meso/visc command");
+    iarg += 2;
+  }
+
+  if (tolerance <= 0.0 || maxiter <= 0 || theta < 0.5 || theta > 1.0)
+    error->all(FLERR,"Illegal fix meso/visc command");
+
+  nevery = 1;
+  vector_flag = 1;
+  size_vector = 2;
+  global_freq = 1;
+  extvector = 0;
+
+  // velocities of ghost atoms, partial sums of ghost atoms
+
+  comm_forward = 3;
+  comm_reverse = 3;
+
+  nmax = 0;
+  diag = heat = NULL;
+  vsol = rhs = res = zvec = dir = adir = NULL;
+
+  pair = NULL;
+  niter = 0;
+  resnorm = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixMesoVisc::~FixMesoVisc()
+{
+  memory->destroy(diag);
+  memory->destroy(heat);
+  memory->destroy(vsol);
+  memory->destroy(rhs);
+  memory->destroy(res);
+  memory->destroy(zvec);
+  memory->destroy(dir);
+  memory->destroy(adir);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoVisc::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoVisc::init()
+{
+  if (strstr(update->integrate_style,"respa"))
+    error->all(FLERR,"Fix meso/visc does not support run_style respa");
+
+  // the viscous weights are stored for the unfiltered neighbor list
+
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"meso/block") == 0)
+      error->all(FLERR,"Fix meso/visc cannot be used with fix meso/block");
+
+  pair = (PairSDPD *) force->pair_match("sdpd",0);
+  if (pair == NULL) error->all(FLERR,"Fix meso/visc requires pair style sdpd");
+
+  int dim;
+  char str_implicit[] = "implicit";
+  int *implicit = (int *) pair->extract(str_implicit,dim);
+  if (implicit == NULL || *implicit == 0)
+    error->all(FLERR,"Fix meso/visc requires pair style sdpd with implicit yes");
+}
+
+/* ----------------------------------------------------------------------
+   viscous step after the velocity update of the integrator
+   solve (M - theta dt L) v' = M v + (1 - theta) dt L v for the atoms in
+     the group, with L v = sum_j w_ij (v_i - v_j) the Morris viscous force
+     of PairSDPD, whose weights w_ij <= 0 make M - theta dt L symmetric
+     positive definite
+   atoms outside the group, e.g. walls, keep their velocity and enter
+     the solve as boundary values
+   the kinetic energy lost is added to e of both atoms of each pair as
+     viscous heating, evaluated with theta v' + (1 - theta) v, which is
+     exact for theta = 1/2
+------------------------------------------------------------------------- */
+
+void FixMesoVisc::end_of_step()
+{
+  double **v = atom->v;
+  double *e = atom->e;
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  double dtv = update->dt;
+  double dtc = dtv * force->ftm2v;
+  double massone;
+  int i;
+
+  if (atom->nmax > nmax) {
+    nmax = atom->nmax;
+    memory->destroy(diag);
+    memory->destroy(heat);
+    memory->destroy(vsol);
+    memory->destroy(rhs);
+    memory->destroy(res);
+    memory->destroy(zvec);
+    memory->destroy(dir);
+    memory->destroy(adir);
+    memory->create(diag,nmax,"meso/visc:diag");
+    memory->create(heat,nmax,"meso/visc:heat");
+    memory->create(vsol,nmax,3,"meso/visc:vsol");
+    memory->create(rhs,nmax,3,"meso/visc:rhs");
+    memory->create(res,nmax,3,"meso/visc:res");
+    memory->create(zvec,nmax,3,"meso/visc:zvec");
+    memory->create(dir,nmax,3,"meso/visc:dir");
+    memory->create(adir,nmax,3,"meso/visc:adir");
+  }
+
+  // Jacobi preconditioner, diag = m - theta dt L_ii
+
+  for (i = 0; i < nall; i++) diag[i] = 0.0;
+  pair->viscous_diagonal(diag);
+  if (force->newton_pair) {
+    commflag = REV_SCALAR;
+    cscalar = diag;
+    comm->reverse_comm_fix(this);
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    massone = rmass ? rmass[i] : mass[type[i]];
+    diag[i] = massone + theta * dtc * diag[i];
+    vsol[i][0] = v[i][0];
+    vsol[i][1] = v[i][1];
+    vsol[i][2] = v[i][2];
+  }
+
+  // right-hand side, explicit part of the viscous force if theta < 1
+
+  if (theta < 1.0) {
+    commflag = VEC;
+    cvec = vsol;
+    comm->forward_comm_fix(this);
+    for (i = 0; i < nall; i++) adir[i][0] = adir[i][1] = adir[i][2] = 0.0;
+    pair->viscous_apply(vsol,adir);
+    if (force->newton_pair) {
+      commflag = REV_VEC;
+      cvec = adir;
+      comm->reverse_comm_fix(this);
+    }
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) {
+      rhs[i][0] = rhs[i][1] = rhs[i][2] = 0.0;
+      continue;
+    }
+    massone = rmass ? rmass[i] : mass[type[i]];
+    rhs[i][0] = massone * v[i][0];
+    rhs[i][1] = massone * v[i][1];
+    rhs[i][2] = massone * v[i][2];
+    if (theta < 1.0) {
+      rhs[i][0] += (1.0-theta) * dtc * adir[i][0];
+      rhs[i][1] += (1.0-theta) * dtc * adir[i][1];
+      rhs[i][2] += (1.0-theta) * dtc * adir[i][2];
+    }
+  }
+
+  double bnorm = sqrt(dot(rhs,rhs));
+  niter = 0;
+  resnorm = 0.0;
+  if (bnorm == 0.0) return;
+
+  // Jacobi preconditioned conjugate gradient, starting from v
+  // r = b - A v, z = r / diag, d = z
+
+  matvec(vsol,adir);
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) {
+      res[i][0] = res[i][1] = res[i][2] = 0.0;
+      zvec[i][0] = zvec[i][1] = zvec[i][2] = 0.0;
+      dir[i][0] = dir[i][1] = dir[i][2] = 0.0;
+      continue;
+    }
+    for (int k = 0; k < 3; k++) {
+      res[i][k] = rhs[i][k] - adir[i][k];
+      zvec[i][k] = res[i][k] / diag[i];
+      dir[i][k] = zvec[i][k];
+    }
+  }
+
+  double rz = dot(res,zvec);
+  double alpha,beta,rz_new,one[2],all[2];
+
+  resnorm = sqrt(dot(res,res)) / bnorm;
+
+  while (resnorm > tolerance && niter < maxiter) {
+    matvec(dir,adir);
+    alpha = rz / dot(dir,adir);
+
+    one[0] = one[1] = 0.0;
+    for (i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) continue;
+      for (int k = 0; k < 3; k++) {
+        vsol[i][k] += alpha * dir[i][k];
+        res[i][k] -= alpha * adir[i][k];
+        zvec[i][k] = res[i][k] / diag[i];
+        one[0] += res[i][k]*res[i][k];
+        one[1] += res[i][k]*zvec[i][k];
+      }
+    }
+    MPI_Allreduce(one,all,2,MPI_DOUBLE,MPI_SUM,world);
+
+    niter++;
+    resnorm = sqrt(all[0]) / bnorm;
+    rz_new = all[1];
+    beta = rz_new / rz;
+    rz = rz_new;
+
+    for (i = 0; i < nlocal; i++) {
+      if (!(mask[i] & groupbit)) continue;
+      dir[i][0] = zvec[i][0] + beta * dir[i][0];
+      dir[i][1] = zvec[i][1] + beta * dir[i][1];
+      dir[i][2] = zvec[i][2] + beta * dir[i][2];
+    }
+  }
+
+  if (resnorm > tolerance && comm->me == 0)
+    error->warning(FLERR,"Fix meso/visc velocity solve did not converge");
+
+  // viscous heating with the velocity the force was evaluated with
+
+  for (i = 0; i < nlocal; i++) {
+    res[i][0] = theta * vsol[i][0] + (1.0-theta) * v[i][0];
+    res[i][1] = theta * vsol[i][1] + (1.0-theta) * v[i][1];
+    res[i][2] = theta * vsol[i][2] + (1.0-theta) * v[i][2];
+  }
+  commflag = VEC;
+  cvec = res;
+  comm->forward_comm_fix(this);
+
+  for (i = 0; i < nall; i++) heat[i] = 0.0;
+  pair->viscous_heat(res,heat);
+  if (force->newton_pair) {
+    commflag = REV_SCALAR;
+    cscalar = heat;
+    comm->reverse_comm_fix(this);
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    if (mask[i] & groupbit) {
+      v[i][0] = vsol[i][0];
+      v[i][1] = vsol[i][1];
+      v[i][2] = vsol[i][2];
+    }
+    e[i] += dtv * heat[i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   out = (M - theta dt L) in for the atoms in the group, 0 for the others
+   halo exchange of in and of the partial sums of ghosts
+------------------------------------------------------------------------- */
+
+void FixMesoVisc::matvec(double **in, double **out)
+{
+  double *mass = atom->mass;
+  double *rmass = atom->rmass;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  double tdtc = theta * update->dt * force->ftm2v;
+  double massone;
+  int i;
+
+  commflag = VEC;
+  cvec = in;
+  comm->forward_comm_fix(this);
+
+  for (i = 0; i < nall; i++) out[i][0] = out[i][1] = out[i][2] = 0.0;
+  pair->viscous_apply(in,out);
+
+  if (force->newton_pair) {
+    commflag = REV_VEC;
+    cvec = out;
+    comm->reverse_comm_fix(this);
+  }
+
+  for (i = 0; i < nlocal; i++) {
+    if (!(mask[i] & groupbit)) {
+      out[i][0] = out[i][1] = out[i][2] = 0.0;
+      continue;
+    }
+    massone = rmass ? rmass[i] : mass[type[i]];
+    out[i][0] = massone * in[i][0] - tdtc * out[i][0];
+    out[i][1] = massone * in[i][1] - tdtc * out[i][1];
+    out[i][2] = massone * in[i][2] - tdtc * out[i][2];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double FixMesoVisc::dot(double **a, double **b)
+{
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  double one = 0.0;
+  for (int i = 0; i < nlocal; i++)
+    if (mask[i] & groupbit)
+      one += a[i][0]*b[i][0] + a[i][1]*b[i][1] + a[i][2]*b[i][2];
+
+  double all;
+  MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
+  return all;
+}
+
+/* ----------------------------------------------------------------------
+   iterations and relative residual of the last velocity solve
+------------------------------------------------------------------------- */
+
+double FixMesoVisc::compute_vector(int n)
+{
+  if (n == 0) return niter;
+  return resnorm;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoVisc::pack_comm(int n, int *list, double *buf,
+                           int pbc_flag, int *pbc)
+{
+  int i,j,m;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = cvec[j][0];
+    buf[m++] = cvec[j][1];
+    buf[m++] = cvec[j][2];
+  }
+  return 3;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoVisc::unpack_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    cvec[i][0] = buf[m++];
+    cvec[i][1] = buf[m++];
+    cvec[i][2] = buf[m++];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixMesoVisc::pack_reverse_comm(int n, int first, double *buf)
+{
+  int i,m,last;
+
+  m = 0;
+  last = first + n;
+  if (commflag == REV_VEC) {
+    for (i = first; i < last; i++) {
+      buf[m++] = cvec[i][0];
+      buf[m++] = cvec[i][1];
+      buf[m++] = cvec[i][2];
+    }
+    return 3;
+  }
+
+  for (i = first; i < last; i++) buf[m++] = cscalar[i];
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixMesoVisc::unpack_reverse_comm(int n, int *list, double *buf)
+{
+  int i,j,m;
+
+  m = 0;
+  if (commflag == REV_VEC) {
+    for (i = 0; i < n; i++) {
+      j = list[i];
+      cvec[j][0] += buf[m++];
+      cvec[j][1] += buf[m++];
+      cvec[j][2] += buf[m++];
+    }
+  } else {
+    for (i = 0; i < n; i++) cscalar[list[i]] += buf[m++];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of solver vectors
+------------------------------------------------------------------------- */
+
+double FixMesoVisc::memory_usage()
+{
+  double bytes = nmax*2 * sizeof(double);
+  bytes += nmax*18 * sizeof(double);
+  return bytes;
+}
@@ -0,0 +1,67 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(meso/visc,FixMesoVisc)
+
+#else
+
+#ifndef LMP_FIX_MESO_VISC_H
+#define LMP_FIX_MESO_VISC_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixMesoVisc : public Fix {
+ public:
+  FixMesoVisc(class LAMMPS *, int, char **);
+  ~FixMesoVisc();
+  int setmask();
+  void init();
+  void end_of_step();
+  double compute_vector(int);
+  double memory_usage();
+
+  int pack_comm(int, int *, double *, int, int *);
+  void unpack_comm(int, int, double *);
+  int pack_reverse_comm(int, int, double *);
+  void unpack_reverse_comm(int, int *, double *);
+
+ private:
+  double tolerance;             // relative residual of the velocity solve
+  int maxiter;
+  double theta;                 // 1 for backward Euler, 0.5 for Crank-Nicolson
+
+  class PairSDPD *pair;
+
+  int nmax;                     // size of work arrays, incl. ghosts
+  double *diag,*heat;
+  double **vsol,**rhs,**res,**zvec,**dir,**adir;
+
+  int commflag;                 // data exchanged by forward/reverse comm
+  double **cvec;                // vector exchanged
+  double *cscalar;              // scalar exchanged
+
+  int niter;                    // stats of the last solve
+  double resnorm;
+
+  void matvec(double **, double **);
+  double dot(double **, double **);
+};
+
+}
+
+#endif
+#endif
@@ -10,20 +10,25 @@
 
    See the README file in the top-level LAMMPS directory.
    ------------------------------------------------------------------------- */
-#include <fenv.h>
 #include "math.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_sdpd.h"
 #include "atom.h"
+#include "atom_vec_meso.h"
 #include "force.h"
 #include "comm.h"
+#include "neighbor.h"
 #include "neigh_list.h"
 #include "memory.h"
 #include "error.h"
 #include "domain.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
 #include "update.h"
-#include "wiener.h"
-#include <iostream>
+#include "respa.h"
+#include "modify.h"
+#include "fix.h"
 
 using namespace LAMMPS_NS;
 
@@ -31,7 +36,25 @@ using namespace LAMMPS_NS;
 
 PairSDPD::PairSDPD(LAMMPS *lmp) :
   Pair(lmp) {
+  overlap_enable = 1;
+
   first = 1;
+  seed = 1;
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+  kcache = kc = NULL;
+  kfill = 0;
+  avec = NULL;
+  pfac = NULL;
+  maxpfac = 0;
+  respaflag = 0;
+  dtrand = 0.0;
+  laststep = -1;
+  nsub = 0;
+  implicit = 0;
+  voffset = NULL;
+  wvisc = NULL;
+  maxvoffset = maxvisc = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -45,45 +68,27 @@ PairSDPD::~PairSDPD() {
     memory->destroy(soundspeed);
     memory->destroy(B);
     memory->destroy(viscosity);
+    memory->destroy(sdpd_temp);
   }
+
+  delete kcache;
+  memory->destroy(pfac);
+  memory->destroy(voffset);
+  memory->destroy(wvisc);
 }
 
 /* ---------------------------------------------------------------------- */
 
 void PairSDPD::compute(int eflag, int vflag) {
-  int i, j, ii, jj, inum, jnum, itype, jtype;
-  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
-
-  int *ilist, *jlist, *numneigh, **firstneigh;
-  double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, h, ih, ihsq, velx, vely, velz;
-  double rsq, tmp, wfd, delVdotDelR, deltaE;
+  int i, j;
 
   if (eflag || vflag)
     ev_setup(eflag, vflag);
   else
     evflag = vflag_fdotr = 0;
 
-  double **v = atom->vest;
-  double **x = atom->x;
-  double **f = atom->f;
-  double *rho = atom->rho;
-  double *mass = atom->mass;
-  double *de = atom->de;
-  double *drho = atom->drho;
-  int *type = atom->type;
-  int nlocal = atom->nlocal;
-  int newton_pair = force->newton_pair;
-  const int ndim = domain->dimension;
-  Wiener wiener(ndim);
-  const double sqrtdt = sqrt(update->dt);
-  
-  double smimj, smjmi;
-  /// Boltzmann constant
-  const double k_bltz= 1.3806503e-23;
-  double eij[ndim];
-  double _dUi[ndim];
-  double random_force[ndim];
-  
+  // check consistency of pair coefficients
+
   if (first) {
     for (i = 1; i <= atom->ntypes; i++) {
       for (j = 1; i <= atom->ntypes; i++) {
@@ -101,115 +106,200 @@ void PairSDPD::compute(int eflag, int vflag) {
     first = 0;
   }
 
+  random_setup();
+  if (implicit) viscous_setup();
+
+  // kernel values shared with other SPH sub-styles of pair hybrid
+  // not used when called on a subset of the list, see Verlet::force_overlap(),
+  //   since they are stored in the order of the whole list
+
+  if (cacheflag && kc == NULL)
+    kc = SPHKernelCache::find(lmp,this,list,kernel,setflag,cut,kcache);
+  SPHKernelCache *kc_list = kc;
+  if (overlap_phase) kc = NULL;
+  else if (kc) kfill = kc->setup(kc == kcache);
+
+  // contiguous copies of positions, velocities and densities
+  // and the pressure term of each owned and ghost atom
+  // when called on subsets of the list, owned atoms are done before
+  //   ghosts are received and ghosts on the 1st call after they are
+
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  int lo = 0;
+  int hi = nall;
+  if (overlap_phase == 1) hi = nlocal;
+  else if (overlap_phase == 2) lo = nlocal;
+  else if (overlap_phase == 3) lo = nall;
+  avec->soa_update(lo,hi);
+
+  if (nall > maxpfac) {
+    maxpfac = atom->nmax;
+    memory->destroy(pfac);
+    memory->create(pfac, maxpfac, "pair:pfac");
+  }
+
+  double *rho = avec->rhos;
+  int *type = atom->type;
+  double tmp, p;
+  for (i = lo; i < hi; i++) {
+    tmp = rho[i] / rho0[type[i]];
+    p = tmp * tmp * tmp;
+    pfac[i] = B[type[i]] * (p * p * tmp - 1.0) / (rho[i] * rho[i]);
+  }
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel, ());
+
+  if (kc && kfill) kc->validate();
+  kc = kc_list;
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSDPD::eval_kernel() {
+  if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>();
+    else eval<KERNEL,DIM,1,0>();
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>();
+    else eval<KERNEL,DIM,0,0>();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSDPD::eval() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double r, *kr, *kwfd, *wv;
+  double vxtmp, vytmp, vztmp, rhoi, imass, jmass, fi, h, velx, vely, velz;
+  double rsq, rinv, wfd, delVdotDelR, deltaE, fvisc;
+
+  const double * const xs = avec->xs;
+  const double * const ys = avec->ys;
+  const double * const zs = avec->zs;
+  const double * const vxs = avec->vxs;
+  const double * const vys = avec->vys;
+  const double * const vzs = avec->vzs;
+  const double * const rhos = avec->rhos;
+  const double * const p = pfac;
+
+  double **f = atom->f;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  double *drho = atom->drho;
+  int *type = atom->type;
+  int *tag = atom->tag;
+  int nlocal = atom->nlocal;
+  const double isqrtdt = 1.0 / sqrt(dtrand);
+  const uint32_t step = (uint32_t) update->ntimestep;
+
+  /// Boltzmann constant
+  const double k_bltz= 1.3806503e-23;
+  double eij[3];
+  double _dUi[3];
+  double random_force[3];
+
   inum = list->inum;
   ilist = list->ilist;
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+  wv = NULL;
+
   // loop over neighbors of my atoms
   for (ii = 0; ii < inum; ii++) {
     i = ilist[ii];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    vxtmp = v[i][0];
-    vytmp = v[i][1];
-    vztmp = v[i][2];
+    xtmp = xs[i];
+    ytmp = ys[i];
+    ztmp = zs[i];
+    vxtmp = vxs[i];
+    vytmp = vys[i];
+    vztmp = vzs[i];
+    rhoi = rhos[i];
     itype = type[i];
     jlist = firstneigh[i];
     jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
+    if (implicit) wv = wvisc + voffset[ii];
 
     imass = mass[itype];
-
-    // compute pressure of atom i with Tait EOS
-    tmp = rho[i] / rho0[itype];
-
-    fi = tmp * tmp * tmp;
-    fi = B[itype] * (fi * fi * tmp - 1.0) / (rho[i] * rho[i]);
+    fi = p[i];
 
     for (jj = 0; jj < jnum; jj++) {
       j = jlist[jj];
       j &= NEIGHMASK;
 
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
+      delx = xtmp - xs[j];
+      dely = ytmp - ys[j];
+      delz = ztmp - zs[j];
       rsq = delx * delx + dely * dely + delz * delz;
       jtype = type[j];
-      jmass = mass[jtype];
       if (rsq < cutsq[itype][jtype]) {
+        jmass = mass[jtype];
         h = cut[itype][jtype];
-        ih = 1.0 / h;
-        ihsq = ih * ih;
-
-        wfd = h - sqrt(rsq);
-        if (ndim == 3) {
-          // Lucy Kernel, 3d
-          // Note that wfd, the derivative of the weight function with respect to r,
-          // is lacking a factor of r.
-          // The missing factor of r is recovered by
-          // (1) using delV . delX instead of delV . (delX/r) and
-          // (2) using f[i][0] += delx * fpair instead of f[i][0] += (delx/r) * fpair
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
+        if (kread) {
+          r = kr[jj];
+          wfd = kwfd[jj];
         } else {
-          // Lucy Kernel, 2d
-          wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
         }
 
-        // compute pressure  of atom j with Tait EOS
-        tmp = rho[j] / rho0[jtype];
-        fj = tmp * tmp * tmp;
-        fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[j] * rho[j]);
-
-        velx=vxtmp - v[j][0];
-        vely=vytmp - v[j][1];
-        velz=vztmp - v[j][2];
+        velx=vxtmp - vxs[j];
+        vely=vytmp - vys[j];
+        velz=vztmp - vzs[j];
 
         // dot product of velocity delta and distance vector
         delVdotDelR = delx * velx + dely * vely + delz * velz;
        
 	// Morris Viscosity (Morris, 1996)
 
-        if (ndim==2)
-	  {
-	    eij[0]= delx/sqrt(rsq); 
-	    eij[1]= dely/sqrt(rsq);    
-	  }
-        else
-	  {
-	    eij[0]= delx/sqrt(rsq);
-	    eij[1]= dely/sqrt(rsq);
-	    eij[2]= delz/sqrt(rsq);
-	  }
- 
-        const double Fij=-wfd;
-        smimj = sqrt(imass/jmass); smjmi = 1.0/smimj;
-        wiener.get_wiener_Espanol(sqrtdt);
-        const double fvisc = viscosity[itype][jtype] / (rho[i] * rho[j]) * imass * jmass * wfd;
-
-        //define random force
-        for (int di=0;di<ndim;di++) {
-           random_force[di]=0;          
-         for (int dj=0;dj<ndim;dj++)
-            random_force[di]+=wiener.sym_trclss[di][dj]*eij[dj];
-        }
+        rinv = 1.0 / r;
+        eij[0] = delx * rinv;
+        eij[1] = dely * rinv;
+        eij[2] = delz * rinv;
+
+        fvisc = viscosity[itype][jtype] / (rhoi * rhos[j]) * imass * jmass * wfd;
+
+        // random force from the symmetric traceless Wiener increment,
+        // which has variance dt, divided by dt
         const double Ti= sdpd_temp[itype][jtype];
-        for (int di=0;di<ndim;di++) {
-          if (Ti>0) {
-            const double Zij = -4.0*k_bltz*Ti*fvisc;
-          //  const double b  = ndim;
-            //const double b  = (ndim+2.0)/3.0;
-            //const double Aij = sqrt(Zij * a);
-            // const double Bij = sqrt(Zij*ndim/2.0*(b+a*(2.0/ndim -1.0)));
-            const  double Aij = sqrt(Zij);
-            const double Bij = 0.0;
-            _dUi[di] = (random_force[di]*Aij + Bij*wiener.trace_d*eij[di])  / update->dt;
-          } else {
+        if (Ti>0) {
+          const double Zij = -4.0*k_bltz*Ti*fvisc;
+          const double Aij = sqrt(Zij) * isqrtdt;
+          random_stress(step, tag[i], tag[j], DIM, eij, random_force);
+          for (int di=0;di<DIM;di++)
+            _dUi[di] = random_force[di]*Aij;
+        } else {
+          for (int di=0;di<DIM;di++)
             _dUi[di] = 0.0;
-          }
         }
 
-        fpair = -imass * jmass * (fi + fj) * wfd;
+        // the viscous force is left to the implicit step of fix meso/visc
+        if (wv) {
+          wv[jj] = fvisc;
+          fvisc = 0.0;
+        }
+
+        fpair = -imass * jmass * (fi + p[j]) * wfd;
         /// TODO: energy is wrong
         deltaE = -0.5 *(fpair * delVdotDelR + fvisc * (velx*velx + vely*vely + velz*velz));
 
@@ -217,7 +307,7 @@ void PairSDPD::compute(int eflag, int vflag) {
 
 	f[i][0] += delx * fpair + velx * fvisc+_dUi[0];
 	f[i][1] += dely * fpair + vely * fvisc+_dUi[1];
-	if (domain->dimension ==3 ) {
+	if (DIM == 3) {
 
 	  f[i][2] += delz * fpair + velz * fvisc +_dUi[2];
 	  // and change in density
@@ -229,11 +319,11 @@ void PairSDPD::compute(int eflag, int vflag) {
         de[i] += deltaE;
 
 
-	if (newton_pair || j < nlocal) {
+	if (NEWTON_PAIR || j < nlocal) {
 
 	  f[j][0] -= delx*fpair + velx*fvisc + _dUi[0];
 	  f[j][1] -= dely*fpair + vely*fvisc + _dUi[1];
-	  if (domain->dimension ==3 ) {
+	  if (DIM == 3) {
 
 	    f[j][2] -= delz*fpair + velz*fvisc + _dUi[2];
 	  }
@@ -243,12 +333,156 @@ void PairSDPD::compute(int eflag, int vflag) {
           drho[j] += imass * delVdotDelR * wfd;
         }
         //modify until this line
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
+        if (EVFLAG)
+          ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
+      } else if (wv) wv[jj] = 0.0;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   offsets and storage of the viscous weights of the implicit step
+   compute() stores the Morris weight
+     w_ij = mu m_i m_j wfd / (rho_i rho_j) <= 0
+   of pair jj of atom ilist[ii] at wvisc[voffset[ii]+jj], 0 outside the
+     cutoff, and omits the viscous force and heating
+   the viscous force on i is then sum_j w_ij (v_i - v_j)
+------------------------------------------------------------------------- */
+
+void PairSDPD::viscous_setup() {
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+
+  if (inum+1 > maxvoffset) {
+    maxvoffset = atom->nmax + 1;
+    memory->destroy(voffset);
+    memory->create(voffset, maxvoffset, "pair:voffset");
+  }
+
+  int npair = 0;
+  for (int ii = 0; ii < inum; ii++) {
+    voffset[ii] = npair;
+    npair += numneigh[ilist[ii]];
+  }
+  voffset[inum] = npair;
+
+  if (npair > maxvisc) {
+    maxvisc = npair + npair/10;
+    memory->destroy(wvisc);
+    memory->create(wvisc, maxvisc, "pair:wvisc");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   diag_i += -sum_j w_ij, the diagonal of the viscous operator
+------------------------------------------------------------------------- */
+
+void PairSDPD::viscous_diagonal(double *diag) {
+  int i, j, ii, jj, jnum;
+  int *jlist;
+  double w;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  double *wv = wvisc;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    for (jj = 0; jj < jnum; jj++) {
+      w = wv[jj];
+      if (w == 0.0) continue;
+      j = jlist[jj] & NEIGHMASK;
+      diag[i] -= w;
+      if (newton_pair || j < nlocal) diag[j] -= w;
+    }
+    wv += jnum;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   y_i += sum_j w_ij (u_i - u_j), the viscous force of velocities u
+   u must be current on ghost atoms
+------------------------------------------------------------------------- */
+
+void PairSDPD::viscous_apply(double **u, double **y) {
+  int i, j, ii, jj, jnum;
+  int *jlist;
+  double w, dx, dy, dz;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  double *wv = wvisc;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    for (jj = 0; jj < jnum; jj++) {
+      w = wv[jj];
+      if (w == 0.0) continue;
+      j = jlist[jj] & NEIGHMASK;
+      dx = w * (u[i][0] - u[j][0]);
+      dy = w * (u[i][1] - u[j][1]);
+      dz = w * (u[i][2] - u[j][2]);
+      y[i][0] += dx;
+      y[i][1] += dy;
+      y[i][2] += dz;
+      if (newton_pair || j < nlocal) {
+        y[j][0] -= dx;
+        y[j][1] -= dy;
+        y[j][2] -= dz;
       }
     }
+    wv += jnum;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   q_i += -1/2 sum_j w_ij |u_i - u_j|^2, the viscous heating rate
+   u must be current on ghost atoms
+------------------------------------------------------------------------- */
+
+void PairSDPD::viscous_heat(double **u, double *q) {
+  int i, j, ii, jj, jnum;
+  int *jlist;
+  double w, dx, dy, dz, dq;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  double *wv = wvisc;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    for (jj = 0; jj < jnum; jj++) {
+      w = wv[jj];
+      if (w == 0.0) continue;
+      j = jlist[jj] & NEIGHMASK;
+      dx = u[i][0] - u[j][0];
+      dy = u[i][1] - u[j][1];
+      dz = u[i][2] - u[j][2];
+      dq = -0.5 * w * (dx*dx + dy*dy + dz*dz);
+      q[i] += dq;
+      if (newton_pair || j < nlocal) q[j] += dq;
+    }
+    wv += jnum;
   }
-  if (vflag_fdotr) virial_fdotr_compute();
 }
 
 /* ----------------------------------------------------------------------
@@ -272,13 +506,143 @@ void PairSDPD::allocate() {
   memory->create(sdpd_temp, n + 1, n + 1, "pair:sdpd_temp");
 }
 
+/* ----------------------------------------------------------------------
+   neighbor callback to inform pair style of neighbor list to use
+   the kernel cache is looked up again on the next compute
+------------------------------------------------------------------------- */
+
+void PairSDPD::init_list(int id, NeighList *ptr) {
+  list = ptr;
+  kc = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   offer own kernel cache to other SPH sub-styles of pair hybrid
+   per-type EOS parameters and cutoffs for fix meso/dt, and the
+     dynamic viscosity mu, unless viscosity is integrated implicitly
+------------------------------------------------------------------------- */
+
+void *PairSDPD::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"sph_kernel_cache") == 0 && kc == kcache)
+    return (void *) kcache;
+  if (strcmp(str,"rho0") == 0) {
+    dim = 1;
+    return (void *) rho0;
+  }
+  if (strcmp(str,"soundspeed") == 0) {
+    dim = 1;
+    return (void *) soundspeed;
+  }
+  if (strcmp(str,"cut") == 0) {
+    dim = 2;
+    return (void *) cut;
+  }
+  if (strcmp(str,"mu") == 0 && !implicit) {
+    dim = 2;
+    return (void *) viscosity;
+  }
+  if (strcmp(str,"implicit") == 0) return (void *) &implicit;
+  return NULL;
+}
+
 /* ----------------------------------------------------------------------
    global settings
    ------------------------------------------------------------------------- */
 void PairSDPD::settings(int narg, char **arg) {
-  if (narg != 0)
-    error->all(FLERR,
-               "Illegal number of setting arguments for pair_style sdpd");
+  seed = 1;
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+  implicit = 0;
+
+  // optional seed of the random stress, numeric so it works with hybrid
+
+  int iarg = 0;
+  if (narg > 0 && strcmp(arg[0],"kernel") != 0 &&
+      strcmp(arg[0],"cache") != 0 && strcmp(arg[0],"implicit") != 0) {
+    seed = force->inumeric(arg[0]);
+    if (seed <= 0) error->all(FLERR,"Illegal pair_style sdpd command");
+    iarg = 1;
+  }
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sdpd command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sdpd command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cache") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sdpd command");
+      if (strcmp(arg[iarg+1],"yes") == 0) cacheflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) cacheflag = 0;
+      else error->all(FLERR,"Illegal pair_style sdpd command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"implicit") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sdpd command");
+      if (strcmp(arg[iarg+1],"yes") == 0) implicit = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) implicit = 0;
+      else error->all(FLERR,"Illegal pair_style sdpd command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sdpd command");
+  }
+
+  // the implicit viscous weights are stored in the order of the whole list,
+  //   so compute() cannot then be called on subsets of it
+
+  if (implicit) overlap_enable = 0;
+}
+
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+   ------------------------------------------------------------------------- */
+
+void PairSDPD::init_style() {
+  if (atom->tag_enable == 0)
+    error->all(FLERR,"Pair style sdpd requires atom IDs");
+
+  avec = (AtomVecMeso *) atom->style_match("meso");
+  if (!avec) error->all(FLERR,"Pair style sdpd requires atom style meso");
+
+  respaflag = (strstr(update->integrate_style,"respa") != NULL);
+  laststep = -1;
+
+  // with implicit viscosity the viscous force is applied by fix meso/visc
+
+  if (implicit) {
+    int ifix;
+    for (ifix = 0; ifix < modify->nfix; ifix++)
+      if (strcmp(modify->fix[ifix]->style,"meso/visc") == 0) break;
+    if (ifix == modify->nfix)
+      error->all(FLERR,"Pair style sdpd implicit yes requires fix meso/visc");
+  }
+
+  neighbor->request(this);
+}
+
+/* ----------------------------------------------------------------------
+   the random stress of a pair only depends on seed, step, rRESPA
+     sub-step and atom IDs
+   at an inner rRESPA level this style is computed several times per step
+     with a smaller timestep, each call gets its own increment
+------------------------------------------------------------------------- */
+
+void PairSDPD::random_setup() {
+  rng.set_key(seed, (uint32_t) (update->ntimestep >> 32));
+
+  dtrand = update->dt;
+  if (respaflag) {
+    Respa *respa = (Respa *) update->integrate;
+    if (respa->level_pair >= 0) dtrand = respa->step[respa->level_pair];
+  }
+
+  if (update->ntimestep != laststep) {
+    laststep = update->ntimestep;
+    nsub = 0;
+  } else if (respaflag) nsub++;
 }
 
 /* ----------------------------------------------------------------------
@@ -340,3 +704,13 @@ double PairSDPD::single(int i, int j, int itype, int jtype,
   fforce = 0.0;
   return 0.0;
 }
+
+/* ---------------------------------------------------------------------- */
+
+double PairSDPD::memory_usage() {
+  double bytes = Pair::memory_usage();
+  bytes += maxpfac * sizeof(double);
+  bytes += maxvoffset * sizeof(int);
+  bytes += maxvisc * sizeof(double);
+  return bytes;
+}
@@ -21,6 +21,7 @@ PairStyle(sdpd,PairSDPD)
 #define LMP_PAIR_SDPD_H
 
 #include "pair.h"
+#include "random_philox.h"
 
 namespace LAMMPS_NS {
 
@@ -33,6 +34,18 @@ class PairSDPD : public Pair {
   void coeff(int, char **);
   virtual double init_one(int, int);
   virtual double single(int, int, int, int, double, double, double, double &);
+  void init_list(int, class NeighList *);
+  void *extract(char *, int &);
+  void init_style();
+  virtual double memory_usage();
+
+  // implicit viscous step of fix meso/visc, see viscous_setup()
+  // results are accumulated into owned and ghost atoms, ghost values
+  //   must be summed into their owners by a reverse comm if newton_pair
+
+  void viscous_diagonal(double *);
+  void viscous_apply(double **, double **);
+  void viscous_heat(double **, double *);
 
  protected:
   double *rho0, *soundspeed, *B;
@@ -40,10 +53,74 @@ class PairSDPD : public Pair {
   // SDPD temperature
   double **sdpd_temp;
   int first;
+  int seed;
+  int kernel;                   // SPH kernel, see sph_kernel.h
+  int cacheflag;                // 1 to use a shared kernel cache
+  class SPHKernelCache *kcache; // own cache, NULL if none
+  class SPHKernelCache *kc;     // cache in use, own or of other style
+  int kfill;                    // 1 if this style stores the cache values
+  RanPhilox rng;                // counter-based RNG for the random stress
+  class AtomVecMeso *avec;      // SoA copy of per-atom data
+  double *pfac;                 // pressure / rho^2 of each atom
+  int maxpfac;
+  int respaflag;                // 1 if run with rRESPA
+  double dtrand;                // timestep the random stress scales with
+  bigint laststep;              // step of the previous compute
+  uint32_t nsub;                // compute calls on this step before this one
+  int implicit;                 // 1 if fix meso/visc integrates viscosity
+  int *voffset;                 // index of 1st pair of ilist[ii] in wvisc
+  double *wvisc;                // viscous weight of each pair in the list
+  int maxvoffset,maxvisc;
 
   void allocate();
+  void random_setup();
+  void viscous_setup();
+  inline void random_stress(uint32_t, int, int, int, const double *,
+                            double *) const;
+
+ private:
+  template <int KERNEL, int DIM> void eval_kernel();
+  template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR> void eval();
 };
 
+/* ----------------------------------------------------------------------
+   apply the symmetric traceless part of the Wiener increment of pair
+   (itag,jtag) with unit variance to the unit vector eij
+   the increment is drawn for the ordered pair of atom IDs at the given
+   step and rRESPA sub-step, so every proc and thread that owns the pair
+   sees the same one,
+   and the result flips sign with eij as required by momentum conservation
+------------------------------------------------------------------------- */
+
+void PairSDPD::random_stress(uint32_t step, int itag, int jtag, int ndim,
+                             const double *eij, double *dw) const
+{
+  const uint32_t tlo = (itag < jtag) ? itag : jtag;
+  const uint32_t thi = (itag < jtag) ? jtag : itag;
+  double g[8],tr,s01,s02,s12;
+
+  // diagonal entries are N(0,1), off-diagonal entries of the symmetric
+  // part 0.5*(W + W^T) are N(0,1/2)
+
+  rng.gaussian4(tlo,thi,step,2*nsub,g);
+  if (ndim == 3) {
+    rng.gaussian4(tlo,thi,step,2*nsub+1,&g[4]);
+    tr = (g[0] + g[1] + g[2]) / 3.0;
+    s01 = 0.70710678118654752440 * g[3];
+    s02 = 0.70710678118654752440 * g[4];
+    s12 = 0.70710678118654752440 * g[5];
+    dw[0] = (g[0]-tr)*eij[0] + s01*eij[1] + s02*eij[2];
+    dw[1] = s01*eij[0] + (g[1]-tr)*eij[1] + s12*eij[2];
+    dw[2] = s02*eij[0] + s12*eij[1] + (g[2]-tr)*eij[2];
+  } else {
+    tr = 0.5 * (g[0] + g[1]);
+    s01 = 0.70710678118654752440 * g[2];
+    dw[0] = (g[0]-tr)*eij[0] + s01*eij[1];
+    dw[1] = s01*eij[0] + (g[1]-tr)*eij[1];
+    dw[2] = 0.0;
+  }
+}
+
 }
 
 #endif
@@ -13,6 +13,7 @@
 
 #include "math.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_sph_heatconduction.h"
 #include "atom.h"
 #include "force.h"
@@ -21,6 +22,8 @@
 #include "error.h"
 #include "neigh_list.h"
 #include "domain.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
 
 using namespace LAMMPS_NS;
 
@@ -29,6 +32,10 @@ using namespace LAMMPS_NS;
 PairSPHHeatConduction::PairSPHHeatConduction(LAMMPS *lmp) : Pair(lmp)
 {
   restartinfo = 0;
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+  kcache = kc = NULL;
+  kfill = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -40,23 +47,51 @@ PairSPHHeatConduction::~PairSPHHeatConduction() {
     memory->destroy(cut);
     memory->destroy(alpha);
   }
+
+  delete kcache;
 }
 
 /* ---------------------------------------------------------------------- */
 
 void PairSPHHeatConduction::compute(int eflag, int vflag) {
+  if (eflag || vflag)
+    ev_setup(eflag, vflag);
+  else
+    evflag = vflag_fdotr = 0;
+
+  // kernel values shared with other SPH sub-styles of pair hybrid
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel, ());
+
+  if (kc && kfill) kc->validate();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHHeatConduction::eval_kernel() {
+  if (force->newton_pair) eval<KERNEL,DIM,1>();
+  else eval<KERNEL,DIM,0>();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int NEWTON_PAIR>
+void PairSPHHeatConduction::eval() {
   int i, j, ii, jj, inum, jnum, itype, jtype;
   double xtmp, ytmp, ztmp, delx, dely, delz;
 
   int *ilist, *jlist, *numneigh, **firstneigh;
-  double imass, jmass, h, ih, ihsq;
+  double r, *kr, *kwfd;
+  double imass, jmass, h;
   double rsq, wfd, D, deltaE;
 
-  if (eflag || vflag)
-    ev_setup(eflag, vflag);
-  else
-    evflag = vflag_fdotr = 0;
-
   double **x = atom->x;
   double *e = atom->e;
   double *de = atom->de;
@@ -64,13 +99,17 @@ void PairSPHHeatConduction::compute(int eflag, int vflag) {
   double *rho = atom->rho;
   int *type = atom->type;
   int nlocal = atom->nlocal;
-  int newton_pair = force->newton_pair;
 
   inum = list->inum;
   ilist = list->ilist;
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
   // loop over neighbors of my atoms and do heat diffusion
 
   for (ii = 0; ii < inum; ii++) {
@@ -83,6 +122,10 @@ void PairSPHHeatConduction::compute(int eflag, int vflag) {
 
     jlist = firstneigh[i];
     jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
 
     imass = mass[itype];
 
@@ -99,21 +142,14 @@ void PairSPHHeatConduction::compute(int eflag, int vflag) {
 
       if (rsq < cutsq[itype][jtype]) {
         h = cut[itype][jtype];
-        ih = 1.0 / h;
-        ihsq = ih * ih;
-
-        // kernel function
-        wfd = h - sqrt(rsq);
-        if (domain->dimension == 3) {
-          // Lucy Kernel, 3d
-          // Note that wfd, the derivative of the weight function with respect to r,
-          // is lacking a factor of r.
-          // The missing factor of r is recovered by
-          // deltaE, which is missing a factor of 1/r
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
-        } else {
-          // Lucy Kernel, 2d
-          wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
         }
 
         jmass = mass[jtype];
@@ -124,7 +160,7 @@ void PairSPHHeatConduction::compute(int eflag, int vflag) {
         deltaE *= D * (e[i] - e[j]) * wfd;
 
         de[i] += deltaE;
-        if (newton_pair || j < nlocal) {
+        if (NEWTON_PAIR || j < nlocal) {
           de[j] -= deltaE;
         }
 
@@ -151,14 +187,53 @@ void PairSPHHeatConduction::allocate() {
   memory->create(alpha, n + 1, n + 1, "pair:alpha");
 }
 
+/* ----------------------------------------------------------------------
+   neighbor callback to inform pair style of neighbor list to use
+   the kernel cache is looked up again on the next compute
+------------------------------------------------------------------------- */
+
+void PairSPHHeatConduction::init_list(int id, NeighList *ptr) {
+  list = ptr;
+  kc = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   offer own kernel cache to other SPH sub-styles of pair hybrid
+------------------------------------------------------------------------- */
+
+void *PairSPHHeatConduction::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"sph_kernel_cache") == 0 && kc == kcache)
+    return (void *) kcache;
+  return NULL;
+}
+
 /* ----------------------------------------------------------------------
  global settings
  ------------------------------------------------------------------------- */
 
 void PairSPHHeatConduction::settings(int narg, char **arg) {
-  if (narg != 0)
-    error->all(FLERR,
-        "Illegal number of setting arguments for pair_style sph/heatconduction");
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/heatconduction command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sph/heatconduction command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cache") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/heatconduction command");
+      if (strcmp(arg[iarg+1],"yes") == 0) cacheflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) cacheflag = 0;
+      else error->all(FLERR,"Illegal pair_style sph/heatconduction command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/heatconduction command");
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -13,14 +13,21 @@
 
 #include "math.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_sph_idealgas.h"
 #include "atom.h"
 #include "force.h"
 #include "comm.h"
+#include "neighbor.h"
 #include "neigh_list.h"
+#include "neigh_request.h"
+#include "modify.h"
+#include "fix.h"
 #include "memory.h"
 #include "error.h"
 #include "domain.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
 
 using namespace LAMMPS_NS;
 
@@ -29,6 +36,11 @@ using namespace LAMMPS_NS;
 PairSPHIdealGas::PairSPHIdealGas(LAMMPS *lmp) : Pair(lmp)
 {
   restartinfo = 0;
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+  kcache = kc = NULL;
+  kfill = 0;
+  adaptive = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -41,23 +53,71 @@ PairSPHIdealGas::~PairSPHIdealGas() {
     memory->destroy(cut);
     memory->destroy(viscosity);
   }
+
+  delete kcache;
 }
 
 /* ---------------------------------------------------------------------- */
 
 void PairSPHIdealGas::compute(int eflag, int vflag) {
-  int i, j, ii, jj, inum, jnum, itype, jtype;
-  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
-
-  int *ilist, *jlist, *numneigh, **firstneigh;
-  double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, fvisc, h, ih, ihsq;
-  double rsq, wfd, delVdotDelR, mu, deltaE, ci, cj;
-
   if (eflag || vflag)
     ev_setup(eflag, vflag);
   else
     evflag = vflag_fdotr = 0;
 
+  // kernel values shared with other SPH sub-styles of pair hybrid
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel, ());
+
+  if (kc && kfill) kc->validate();
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHIdealGas::eval_kernel() {
+  if (adaptive) {
+    if (evflag) {
+      if (force->newton_pair) eval_adaptive<KERNEL,DIM,1,1>();
+      else eval_adaptive<KERNEL,DIM,1,0>();
+    } else {
+      if (force->newton_pair) eval_adaptive<KERNEL,DIM,0,1>();
+      else eval_adaptive<KERNEL,DIM,0,0>();
+    }
+  } else if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>();
+    else eval<KERNEL,DIM,1,0>();
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>();
+    else eval<KERNEL,DIM,0,0>();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHIdealGas::eval() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, vxtmp, vytmp, vztmp;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double *kr, *kwfd;
+
+  // per-pair math in the precision selected by SPH_SCALAR,
+  // distances are taken in double precision before the conversion
+
+  SPH_SCALAR delx, dely, delz, rsq, r, h, wfd, delvx, delvy, delvz;
+  SPH_SCALAR delVdotDelR, mu, rhoi, rhoj, ej, imass, jmass, fi, fj, ci, cj;
+  SPH_SCALAR cvisc, fvisc, fpair, deltaE;
+
   double **v = atom->vest;
   double **x = atom->x;
   double **f = atom->f;
@@ -68,13 +128,17 @@ void PairSPHIdealGas::compute(int eflag, int vflag) {
   double *drho = atom->drho;
   int *type = atom->type;
   int nlocal = atom->nlocal;
-  int newton_pair = force->newton_pair;
 
   inum = list->inum;
   ilist = list->ilist;
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
   // loop over neighbors of my atoms
 
   for (ii = 0; ii < inum; ii++) {
@@ -88,8 +152,13 @@ void PairSPHIdealGas::compute(int eflag, int vflag) {
     itype = type[i];
     jlist = firstneigh[i];
     jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
 
     imass = mass[itype];
+    rhoi = rho[i];
 
     fi = 0.4 * e[i] / imass / rho[i]; // ideal gas EOS; this expression is fi = pressure / rho^2
     ci = sqrt(0.4*e[i]/imass); // speed of sound with heat capacity ratio gamma=1.4
@@ -107,41 +176,39 @@ void PairSPHIdealGas::compute(int eflag, int vflag) {
 
       if (rsq < cutsq[itype][jtype]) {
         h = cut[itype][jtype];
-        ih = 1. / h;
-        ihsq = ih * ih;
-
-        wfd = h - sqrt(rsq);
-        if (domain->dimension == 3) {
-          // Lucy Kernel, 3d
-          // Note that wfd, the derivative of the weight function with respect to r,
-          // is lacking a factor of r.
-          // The missing factor of r is recovered by
-          // (1) using delV . delX instead of delV . (delX/r) and
-          // (2) using f[i][0] += delx * fpair instead of f[i][0] += (delx/r) * fpair
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
-        } else {
-          // Lucy Kernel, 2d
-          wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM,SPH_SCALAR>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
         }
 
-        fj = 0.4 * e[j] / jmass / rho[j];
+        ej = e[j];
+        rhoj = rho[j];
+        fj = SPH_SCALAR(0.4) * ej / jmass / rhoj;
 
         // dot product of velocity delta and distance vector
-        delVdotDelR = delx * (vxtmp - v[j][0]) + dely * (vytmp - v[j][1])
-            + delz * (vztmp - v[j][2]);
+        delvx = vxtmp - v[j][0];
+        delvy = vytmp - v[j][1];
+        delvz = vztmp - v[j][2];
+        delVdotDelR = delx * delvx + dely * delvy + delz * delvz;
 
         // artificial viscosity (Monaghan 1992)
         if (delVdotDelR < 0.) {
-          cj = sqrt(0.4*e[j]/jmass);
-          mu = h * delVdotDelR / (rsq + 0.01 * h * h);
-          fvisc = -viscosity[itype][jtype] * (ci + cj) * mu / (rho[i] + rho[j]);
+          cj = sqrt(SPH_SCALAR(0.4) * ej / jmass);
+          mu = h * delVdotDelR / (rsq + SPH_SCALAR(0.01) * h * h);
+          cvisc = viscosity[itype][jtype];
+          fvisc = -cvisc * (ci + cj) * mu / (rhoi + rhoj);
         } else {
           fvisc = 0.;
         }
 
         // total pair force & thermal energy increment
         fpair = -imass * jmass * (fi + fj + fvisc) * wfd;
-        deltaE = -0.5 * fpair * delVdotDelR;
+        deltaE = SPH_SCALAR(-0.5) * fpair * delVdotDelR;
 
         f[i][0] += delx * fpair;
         f[i][1] += dely * fpair;
@@ -153,7 +220,7 @@ void PairSPHIdealGas::compute(int eflag, int vflag) {
         // change in thermal energy
         de[i] += deltaE;
 
-        if (newton_pair || j < nlocal) {
+        if (NEWTON_PAIR || j < nlocal) {
           f[j][0] -= delx * fpair;
           f[j][1] -= dely * fpair;
           f[j][2] -= delz * fpair;
@@ -161,17 +228,120 @@ void PairSPHIdealGas::compute(int eflag, int vflag) {
           drho[j] += imass * delVdotDelR * wfd;
         }
 
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
-
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely,
-              delz);
+        if (EVFLAG)
+          ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
       }
     }
   }
+}
 
-  if (vflag_fdotr) virial_fdotr_compute();
+/* ----------------------------------------------------------------------
+   pair forces with the per-atom smoothing length h of fix meso/hsml
+   pressure terms use the kernel of each atom and its grad-h factor,
+     artificial viscosity the mean of both kernels and of both h
+   Springel and Hernquist, MNRAS, 333, 649 (2002)
+------------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHIdealGas::eval_adaptive() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double r, rsq, vxtmp, vytmp, vztmp, imass, jmass, fi, fj, fvisc;
+  double hi, hj, h, wfdi, wfdj, wfd, delVdotDelR, mu, ci, cj;
+
+  double **v = atom->vest;
+  double **x = atom->x;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  double *e = atom->e;
+  double *drho = atom->drho;
+  double *hsml = atom->hsml;
+  double *gradh = atom->gradh;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    vxtmp = v[i][0];
+    vytmp = v[i][1];
+    vztmp = v[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    imass = mass[itype];
+    hi = hsml[i];
+
+    fi = gradh[i] * 0.4 * e[i] / imass / rho[i];
+    ci = sqrt(0.4*e[i]/imass);
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      r = sqrt(rsq);
+      hj = hsml[j];
+      if (r >= hi && r >= hj) continue;
+
+      jtype = type[j];
+      jmass = mass[jtype];
+
+      wfdi = (r < hi) ? SPHKernel::Kernel<KERNEL,DIM>::wfd(r, hi) : 0.0;
+      wfdj = (r < hj) ? SPHKernel::Kernel<KERNEL,DIM>::wfd(r, hj) : 0.0;
+      wfd = 0.5 * (wfdi + wfdj);
+
+      fj = gradh[j] * 0.4 * e[j] / jmass / rho[j];
+
+      delVdotDelR = delx * (vxtmp - v[j][0]) + dely * (vytmp - v[j][1])
+          + delz * (vztmp - v[j][2]);
+
+      if (delVdotDelR < 0.) {
+        cj = sqrt(0.4*e[j]/jmass);
+        h = 0.5 * (hi + hj);
+        mu = h * delVdotDelR / (rsq + 0.01 * h * h);
+        fvisc = -viscosity[itype][jtype] * (ci + cj) * mu / (rho[i] + rho[j]);
+      } else {
+        fvisc = 0.;
+      }
+
+      // pressure work goes to the atom whose kernel it came from
+
+      fpair = -imass * jmass * (fi * wfdi + fj * wfdj + fvisc * wfd);
+
+      f[i][0] += delx * fpair;
+      f[i][1] += dely * fpair;
+      f[i][2] += delz * fpair;
+      drho[i] += jmass * delVdotDelR * gradh[i] * wfdi;
+      de[i] += imass * jmass * (fi * wfdi + 0.5 * fvisc * wfd) * delVdotDelR;
+
+      if (NEWTON_PAIR || j < nlocal) {
+        f[j][0] -= delx * fpair;
+        f[j][1] -= dely * fpair;
+        f[j][2] -= delz * fpair;
+        drho[j] += imass * delVdotDelR * gradh[j] * wfdj;
+        de[j] += imass * jmass * (fj * wfdj + 0.5 * fvisc * wfd) * delVdotDelR;
+      }
+
+      if (EVFLAG)
+        ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
+    }
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -193,14 +363,73 @@ void PairSPHIdealGas::allocate() {
   memory->create(viscosity, n + 1, n + 1, "pair:viscosity");
 }
 
+/* ----------------------------------------------------------------------
+ init specific to this pair style
+ ------------------------------------------------------------------------- */
+
+void PairSPHIdealGas::init_style() {
+  // per-atom smoothing length if fix meso/hsml is defined
+
+  adaptive = 0;
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"meso/hsml") == 0) adaptive = 1;
+
+  if (adaptive && cacheflag)
+    error->all(FLERR,"Pair sph/idealgas cache cannot be used with fix meso/hsml");
+
+  int irequest = neighbor->request(this);
+  if (adaptive) neighbor->requests[irequest]->size = 1;
+}
+
+/* ----------------------------------------------------------------------
+   neighbor callback to inform pair style of neighbor list to use
+   the kernel cache is looked up again on the next compute
+------------------------------------------------------------------------- */
+
+void PairSPHIdealGas::init_list(int id, NeighList *ptr) {
+  list = ptr;
+  kc = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   offer own kernel cache to other SPH sub-styles of pair hybrid
+   non-NULL hsml if this style supports the per-atom h of fix meso/hsml
+------------------------------------------------------------------------- */
+
+void *PairSPHIdealGas::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"sph_kernel_cache") == 0 && kc == kcache)
+    return (void *) kcache;
+  if (strcmp(str,"hsml") == 0) return (void *) &adaptive;
+  return NULL;
+}
+
 /* ----------------------------------------------------------------------
  global settings
  ------------------------------------------------------------------------- */
 
 void PairSPHIdealGas::settings(int narg, char **arg) {
-  if (narg != 0)
-    error->all(FLERR,
-        "Illegal number of setting arguments for pair_style sph/idealgas");
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/idealgas command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sph/idealgas command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cache") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/idealgas command");
+      if (strcmp(arg[iarg+1],"yes") == 0) cacheflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) cacheflag = 0;
+      else error->all(FLERR,"Illegal pair_style sph/idealgas command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/idealgas command");
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -0,0 +1,455 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdlib.h"
+#include "string.h"
+#include "pair_sph_isph.h"
+#include "atom.h"
+#include "force.h"
+#include "comm.h"
+#include "neigh_list.h"
+#include "memory.h"
+#include "error.h"
+#include "domain.h"
+#include "sph_kernel.h"
+
+using namespace LAMMPS_NS;
+
+enum{DIVERGENCE,GRADIENT};
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHISPH::PairSPHISPH(LAMMPS *lmp) : Pair(lmp)
+{
+  restartinfo = 0;
+  kernel = SPHKernel::LUCY;
+  opin = opout1 = opout2 = opout3 = NULL;
+  opvin = opvout = NULL;
+  wlap = NULL;
+  maxlap = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHISPH::~PairSPHISPH() {
+  if (allocated) {
+    memory->destroy(setflag);
+    memory->destroy(cutsq);
+
+    memory->destroy(cut);
+    memory->destroy(rho0);
+    memory->destroy(viscosity);
+  }
+
+  memory->destroy(wlap);
+}
+
+/* ----------------------------------------------------------------------
+   viscous forces only, the pressure is applied by fix isph
+------------------------------------------------------------------------- */
+
+void PairSPHISPH::compute(int eflag, int vflag) {
+  if (eflag || vflag)
+    ev_setup(eflag, vflag);
+  else
+    evflag = vflag_fdotr = 0;
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel, ());
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHISPH::eval_kernel() {
+  if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>();
+    else eval<KERNEL,DIM,1,0>();
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>();
+    else eval<KERNEL,DIM,0,0>();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHISPH::eval() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz;
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double vxtmp, vytmp, vztmp, imass, jmass, fvisc, velx, vely, velz;
+  double rsq, wfd, deltaE;
+
+  double **v = atom->vest;
+  double **x = atom->x;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // loop over neighbors of my atoms
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    vxtmp = v[i][0];
+    vytmp = v[i][1];
+    vztmp = v[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    imass = mass[itype];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      jmass = mass[jtype];
+
+      if (rsq < cutsq[itype][jtype]) {
+        wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(sqrt(rsq), cut[itype][jtype]);
+
+        velx = vxtmp - v[j][0];
+        vely = vytmp - v[j][1];
+        velz = vztmp - v[j][2];
+
+        // Morris viscosity (Morris, 1996)
+
+        fvisc = 2 * viscosity[itype][jtype] / (rho[i] * rho[j]);
+        fvisc *= imass * jmass * wfd;
+        deltaE = -0.5 * fvisc * (velx*velx + vely*vely + velz*velz);
+
+        f[i][0] += velx * fvisc;
+        f[i][1] += vely * fvisc;
+        f[i][2] += velz * fvisc;
+        de[i] += deltaE;
+
+        if (NEWTON_PAIR || j < nlocal) {
+          f[j][0] -= velx * fvisc;
+          f[j][1] -= vely * fvisc;
+          f[j][2] -= velz * fvisc;
+          de[j] += deltaE;
+        }
+
+        if (EVFLAG)
+          ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, 0.0, delx, dely, delz);
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   divergence of the velocity vs and SPH estimate of the divergence of
+     the position, which is close to the dimension inside the fluid and
+     smaller at a free surface
+     div vs_i = -1/rho_i sum_j m_j vs_ij . gradW_ij
+     div x_i  = -sum_j m_j/rho_j x_ij . gradW_ij
+   also the diagonal of the matrix of laplacian() and its weights, which
+     are stored in neighbor list order for the laplacian() calls until
+     the next divergence()
+------------------------------------------------------------------------- */
+
+void PairSPHISPH::divergence(double **vs, double *div, double *divr,
+                             double *diag) {
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+
+  int npair = 0;
+  for (int ii = 0; ii < inum; ii++) npair += numneigh[ilist[ii]];
+  if (npair > maxlap) {
+    maxlap = npair + npair/10;
+    memory->destroy(wlap);
+    memory->create(wlap,maxlap,"pair:wlap");
+  }
+
+  op = DIVERGENCE;
+  opvin = vs;
+  opout1 = div;
+  opout2 = divr;
+  opout3 = diag;
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_op, ());
+}
+
+/* ----------------------------------------------------------------------
+   y = A p with the SPH Laplacian of Cummins and Rudman (1999)
+     multiplied by the atom mass, which makes A symmetric
+     (A p)_i = sum_j w_ij (p_i - p_j)
+     w_ij = m_i m_j 8/(rho_i+rho_j)^2 (-r_ij gradW_ij)/(r_ij^2 + 0.01 h^2)
+   A p = -m_i div(grad p / rho) is positive semi-definite
+------------------------------------------------------------------------- */
+
+void PairSPHISPH::laplacian(double *p, double *y) {
+  int i,j,ii,jj,jnum;
+  int *jlist;
+  double pi,tmp;
+
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  double *w = wlap;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    pi = p[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj] & NEIGHMASK;
+      tmp = w[jj] * (pi - p[j]);
+      y[i] += tmp;
+      if (newton_pair || j < nlocal) y[j] -= tmp;
+    }
+    w += jnum;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   symmetric SPH pressure gradient divided by the density
+     g_i = sum_j m_j (p_i/rho_i^2 + p_j/rho_j^2) gradW_ij
+------------------------------------------------------------------------- */
+
+void PairSPHISPH::gradient(double *p, double **g) {
+  op = GRADIENT;
+  opin = p;
+  opvout = g;
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_op, ());
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHISPH::eval_op() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, rsq, h, wfd, w, tmp;
+  double imass, jmass, rhoi, rhoj, rsum;
+  int *ilist, *jlist, *numneigh, **firstneigh;
+
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+  int newton_pair = force->newton_pair;
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  double **vs = opvin;
+  double *p = opin;
+  double *out1 = opout1;
+  double *out2 = opout2;
+  double *out3 = opout3;
+  double **g = opvout;
+  double *wl = wlap;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    imass = mass[itype];
+    rhoi = rho[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+
+      if (rsq >= cutsq[itype][jtype]) {
+        if (op == DIVERGENCE) wl[jj] = 0.0;
+        continue;
+      }
+
+      h = cut[itype][jtype];
+      wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(sqrt(rsq), h);
+      jmass = mass[jtype];
+      rhoj = rho[j];
+
+      if (op == DIVERGENCE) {
+        tmp = -wfd * ((vs[i][0]-vs[j][0])*delx + (vs[i][1]-vs[j][1])*dely +
+                      (vs[i][2]-vs[j][2])*delz);
+        rsum = rhoi + rhoj;
+        w = imass * jmass * 8.0 / (rsum*rsum) * (-rsq*wfd) / (rsq + 0.01*h*h);
+        wl[jj] = w;
+        out1[i] += jmass / rhoi * tmp;
+        out2[i] -= jmass / rhoj * rsq * wfd;
+        out3[i] += w;
+        if (newton_pair || j < nlocal) {
+          out1[j] += imass / rhoj * tmp;
+          out2[j] -= imass / rhoi * rsq * wfd;
+          out3[j] += w;
+        }
+
+      } else {
+        tmp = (p[i]/(rhoi*rhoi) + p[j]/(rhoj*rhoj)) * wfd;
+        g[i][0] += jmass * tmp * delx;
+        g[i][1] += jmass * tmp * dely;
+        g[i][2] += jmass * tmp * delz;
+        if (newton_pair || j < nlocal) {
+          g[j][0] -= imass * tmp * delx;
+          g[j][1] -= imass * tmp * dely;
+          g[j][2] -= imass * tmp * delz;
+        }
+      }
+    }
+    if (op == DIVERGENCE) wl += jnum;
+  }
+}
+
+/* ----------------------------------------------------------------------
+ allocate all arrays
+ ------------------------------------------------------------------------- */
+
+void PairSPHISPH::allocate() {
+  allocated = 1;
+  int n = atom->ntypes;
+
+  memory->create(setflag, n + 1, n + 1, "pair:setflag");
+  for (int i = 1; i <= n; i++)
+    for (int j = i; j <= n; j++)
+      setflag[i][j] = 0;
+
+  memory->create(cutsq, n + 1, n + 1, "pair:cutsq");
+
+  memory->create(rho0, n + 1, "pair:rho0");
+  memory->create(cut, n + 1, n + 1, "pair:cut");
+  memory->create(viscosity, n + 1, n + 1, "pair:viscosity");
+}
+
+/* ----------------------------------------------------------------------
+   per-type rest density and cutoffs, and the dynamic viscosity mu
+------------------------------------------------------------------------- */
+
+void *PairSPHISPH::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"rho0") == 0) {
+    dim = 1;
+    return (void *) rho0;
+  }
+  if (strcmp(str,"cut") == 0) {
+    dim = 2;
+    return (void *) cut;
+  }
+  if (strcmp(str,"mu") == 0) {
+    dim = 2;
+    return (void *) viscosity;
+  }
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+ global settings
+ ------------------------------------------------------------------------- */
+
+void PairSPHISPH::settings(int narg, char **arg) {
+  kernel = SPHKernel::LUCY;
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/isph command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sph/isph command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/isph command");
+  }
+}
+
+/* ----------------------------------------------------------------------
+ set coeffs for one or more type pairs
+ ------------------------------------------------------------------------- */
+
+void PairSPHISPH::coeff(int narg, char **arg) {
+  if (narg != 5)
+    error->all(FLERR,"Incorrect args for pair_style sph/isph coefficients");
+  if (!allocated)
+    allocate();
+
+  int ilo, ihi, jlo, jhi;
+  force->bounds(arg[0], atom->ntypes, ilo, ihi);
+  force->bounds(arg[1], atom->ntypes, jlo, jhi);
+
+  double rho0_one = force->numeric(arg[2]);
+  double viscosity_one = force->numeric(arg[3]);
+  double cut_one = force->numeric(arg[4]);
+
+  int count = 0;
+  for (int i = ilo; i <= ihi; i++) {
+    rho0[i] = rho0_one;
+    for (int j = MAX(jlo,i); j <= jhi; j++) {
+      viscosity[i][j] = viscosity_one;
+      cut[i][j] = cut_one;
+      setflag[i][j] = 1;
+      count++;
+    }
+  }
+
+  if (count == 0)
+    error->all(FLERR,"Incorrect args for pair coefficients");
+}
+
+/* ----------------------------------------------------------------------
+ init for one type pair i,j and corresponding j,i
+ ------------------------------------------------------------------------- */
+
+double PairSPHISPH::init_one(int i, int j) {
+  if (setflag[i][j] == 0)
+    error->all(FLERR,"All pair sph/isph coeffs are not set");
+
+  cut[j][i] = cut[i][j];
+  viscosity[j][i] = viscosity[i][j];
+
+  return cut[i][j];
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSPHISPH::single(int i, int j, int itype, int jtype,
+    double rsq, double factor_coul, double factor_lj, double &fforce) {
+  fforce = 0.0;
+
+  return 0.0;
+}
@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(sph/isph,PairSPHISPH)
+
+#else
+
+#ifndef LMP_PAIR_SPH_ISPH_H
+#define LMP_PAIR_SPH_ISPH_H
+
+#include "pair.h"
+
+namespace LAMMPS_NS {
+
+class PairSPHISPH : public Pair {
+ public:
+  PairSPHISPH(class LAMMPS *);
+  virtual ~PairSPHISPH();
+  virtual void compute(int, int);
+  void settings(int, char **);
+  void coeff(int, char **);
+  virtual double init_one(int, int);
+  virtual double single(int, int, int, int, double, double, double, double &);
+  void *extract(char *, int &);
+
+  // SPH operators used by the pressure projection of fix isph
+  // results are accumulated into owned and ghost atoms, ghost values
+  //   must be summed into their owners by a reverse comm if newton_pair
+
+  void divergence(double **, double *, double *, double *);
+  void laplacian(double *, double *);
+  void gradient(double *, double **);
+
+ protected:
+  double *rho0;
+  double **cut,**viscosity;
+  int kernel;                   // SPH kernel, see sph_kernel.h
+
+  void allocate();
+
+ private:
+  int op;                       // operator evaluated by eval_op()
+  double *wlap;                 // Laplacian weight of each pair in the list
+  int maxlap;
+  double *opin,*opout1,*opout2,*opout3;
+  double **opvin,**opvout;
+
+  template <int KERNEL, int DIM> void eval_kernel();
+  template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR> void eval();
+  template <int KERNEL, int DIM> void eval_op();
+};
+
+}
+
+#endif
+#endif
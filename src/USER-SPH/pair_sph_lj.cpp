@@ -13,6 +13,7 @@
 
 #include "math.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_sph_lj.h"
 #include "atom.h"
 #include "force.h"
@@ -21,6 +22,8 @@
 #include "memory.h"
 #include "error.h"
 #include "domain.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
 
 using namespace LAMMPS_NS;
 
@@ -29,6 +32,10 @@ using namespace LAMMPS_NS;
 PairSPHLJ::PairSPHLJ(LAMMPS *lmp) : Pair(lmp)
 {
   restartinfo = 0;
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+  kcache = kc = NULL;
+  kfill = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -41,23 +48,58 @@ PairSPHLJ::~PairSPHLJ() {
     memory->destroy(cut);
     memory->destroy(viscosity);
   }
+
+  delete kcache;
 }
 
 /* ---------------------------------------------------------------------- */
 
 void PairSPHLJ::compute(int eflag, int vflag) {
+  if (eflag || vflag)
+    ev_setup(eflag, vflag);
+  else
+    evflag = vflag_fdotr = 0;
+
+  // kernel values shared with other SPH sub-styles of pair hybrid
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel, ());
+
+  if (kc && kfill) kc->validate();
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHLJ::eval_kernel() {
+  if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>();
+    else eval<KERNEL,DIM,1,0>();
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>();
+    else eval<KERNEL,DIM,0,0>();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHLJ::eval() {
   int i, j, ii, jj, inum, jnum, itype, jtype;
   double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
 
   int *ilist, *jlist, *numneigh, **firstneigh;
+  double r, *kr, *kwfd;
   double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, fvisc, h, ih, ihsq, ihcub;
   double rsq, wfd, delVdotDelR, mu, deltaE, ci, cj, lrc;
 
-  if (eflag || vflag)
-    ev_setup(eflag, vflag);
-  else
-    evflag = vflag_fdotr = 0;
-
   double **v = atom->vest;
   double **x = atom->x;
   double **f = atom->f;
@@ -69,13 +111,17 @@ void PairSPHLJ::compute(int eflag, int vflag) {
   double *drho = atom->drho;
   int *type = atom->type;
   int nlocal = atom->nlocal;
-  int newton_pair = force->newton_pair;
 
   inum = list->inum;
   ilist = list->ilist;
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
   // loop over neighbors of my atoms
 
   for (ii = 0; ii < inum; ii++) {
@@ -89,6 +135,10 @@ void PairSPHLJ::compute(int eflag, int vflag) {
     itype = type[i];
     jlist = firstneigh[i];
     jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
 
     imass = mass[itype];
 
@@ -114,18 +164,14 @@ void PairSPHLJ::compute(int eflag, int vflag) {
         ihsq = ih * ih;
         ihcub = ihsq * ih;
 
-        wfd = h - sqrt(rsq);
-        if (domain->dimension == 3) {
-          // Lucy Kernel, 3d
-          // Note that wfd, the derivative of the weight function with respect to r,
-          // is lacking a factor of r.
-          // The missing factor of r is recovered by
-          // (1) using delV . delX instead of delV . (delX/r) and
-          // (2) using f[i][0] += delx * fpair instead of f[i][0] += (delx/r) * fpair
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
-        } else {
-          // Lucy Kernel, 2d
-          wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
         }
 
         // function call to LJ EOS
@@ -164,7 +210,7 @@ void PairSPHLJ::compute(int eflag, int vflag) {
         // change in thermal energy
         de[i] += deltaE;
 
-        if (newton_pair || j < nlocal) {
+        if (NEWTON_PAIR || j < nlocal) {
           f[j][0] -= delx * fpair;
           f[j][1] -= dely * fpair;
           f[j][2] -= delz * fpair;
@@ -172,13 +218,11 @@ void PairSPHLJ::compute(int eflag, int vflag) {
           drho[j] += imass * delVdotDelR * wfd;
         }
 
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
+        if (EVFLAG)
+          ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
       }
     }
   }
-
-  if (vflag_fdotr) virial_fdotr_compute();
 }
 
 /* ----------------------------------------------------------------------
@@ -200,14 +244,53 @@ void PairSPHLJ::allocate() {
   memory->create(viscosity, n + 1, n + 1, "pair:viscosity");
 }
 
+/* ----------------------------------------------------------------------
+   neighbor callback to inform pair style of neighbor list to use
+   the kernel cache is looked up again on the next compute
+------------------------------------------------------------------------- */
+
+void PairSPHLJ::init_list(int id, NeighList *ptr) {
+  list = ptr;
+  kc = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   offer own kernel cache to other SPH sub-styles of pair hybrid
+------------------------------------------------------------------------- */
+
+void *PairSPHLJ::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"sph_kernel_cache") == 0 && kc == kcache)
+    return (void *) kcache;
+  return NULL;
+}
+
 /* ----------------------------------------------------------------------
  global settings
  ------------------------------------------------------------------------- */
 
 void PairSPHLJ::settings(int narg, char **arg) {
-  if (narg != 0)
-    error->all(FLERR,
-        "Illegal number of setting arguments for pair_style sph/lj");
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/lj command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sph/lj command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cache") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/lj command");
+      if (strcmp(arg[iarg+1],"yes") == 0) cacheflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) cacheflag = 0;
+      else error->all(FLERR,"Illegal pair_style sph/lj command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/lj command");
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -33,13 +33,24 @@ class PairSPHLJ : public Pair {
   void coeff(int, char **);
   virtual double init_one(int, int);
   virtual double single(int, int, int, int, double, double, double, double &);
+  void init_list(int, class NeighList *);
+  void *extract(char *, int &);
   //double LJEOS(int);
   void LJEOS2(double, double, double, double *, double *);
 
  protected:
   double **cut,**viscosity;
+  int kernel;                   // SPH kernel, see sph_kernel.h
+  int cacheflag;                // 1 to use a shared kernel cache
+  class SPHKernelCache *kcache; // own cache, NULL if none
+  class SPHKernelCache *kc;     // cache in use, own or of other style
+  int kfill;                    // 1 if this style stores the cache values
 
   void allocate();
+
+ private:
+  template <int KERNEL, int DIM> void eval_kernel();
+  template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR> void eval();
 };
 
 }
@@ -13,6 +13,7 @@
 
 #include "math.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_sph_rhosum.h"
 #include "atom.h"
 #include "force.h"
@@ -24,7 +25,9 @@
 #include "neighbor.h"
 #include "update.h"
 #include "domain.h"
-#include <iostream>
+#include "modify.h"
+#include "fix.h"
+#include "sph_kernel.h"
 
 using namespace LAMMPS_NS;
 
@@ -38,6 +41,8 @@ PairSPHRhoSum::PairSPHRhoSum(LAMMPS *lmp) : Pair(lmp)
 
   comm_forward = 1;
   first = 1;
+  kernel = SPHKernel::LUCY;
+  adaptive = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -56,33 +61,38 @@ PairSPHRhoSum::~PairSPHRhoSum() {
  ------------------------------------------------------------------------- */
 
 void PairSPHRhoSum::init_style() {
-  // need a full neighbor list
+  // per-atom smoothing length if fix meso/hsml is defined
+
+  adaptive = 0;
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"meso/hsml") == 0) adaptive = 1;
+
+  // need a full neighbor list, or a half list with per-atom cutoffs
+  // where the grad-h correction is summed along with the density
+
   int irequest = neighbor->request(this);
-  neighbor->requests[irequest]->half = 0;
-  neighbor->requests[irequest]->full = 1;
+  if (adaptive) {
+    neighbor->requests[irequest]->size = 1;
+    comm_forward = 2;
+    comm_reverse = 2;
+  } else {
+    neighbor->requests[irequest]->half = 0;
+    neighbor->requests[irequest]->full = 1;
+    comm_forward = 1;
+    comm_reverse = 0;
+  }
 }
 
 /* ---------------------------------------------------------------------- */
 
 void PairSPHRhoSum::compute(int eflag, int vflag) {
-  int i, j, ii, jj, jnum, itype, jtype;
-  double xtmp, ytmp, ztmp, delx, dely, delz;
-  double r, rsq, imass, h, ih, ihsq;
-  int *jlist;
-  double wf;
-  // neighbor list variables
-  int inum, *ilist, *numneigh, **firstneigh;
+  int i, j;
 
   if (eflag || vflag)
     ev_setup(eflag, vflag);
   else
     evflag = vflag_fdotr = 0;
 
-  double **x = atom->x;
-  double *rho = atom->rho;
-  int *type = atom->type;
-  double *mass = atom->mass;
-
   // check consistency of pair coefficients
 
   if (first) {
@@ -102,95 +112,31 @@ void PairSPHRhoSum::compute(int eflag, int vflag) {
     first = 0;
   }
 
-  inum = list->inum;
-  ilist = list->ilist;
-  numneigh = list->numneigh;
-  firstneigh = list->firstneigh;
-
   // recompute density
-  // we use a full neighborlist here
 
   if (nstep != 0) {
     if ((update->ntimestep % nstep) == 0) {
+      if (adaptive) {
+        SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_adaptive, ());
 
-      // initialize density with self-contribution,
-      for (ii = 0; ii < inum; ii++) {
-        i = ilist[ii];
-        itype = type[i];
-        imass = mass[itype];
-
-        h = cut[itype][itype];
-        if (domain->dimension == 3) {
-          // Lucy kernel, 3d
-          wf = 2.0889086280811262819e0 / (h * h * h);
-
-          // quadric kernel, 3d
-          //wf = 2.1541870227086614782 / (h * h * h);
-        } else {
-          // Lucy kernel, 2d
-          wf = 1.5915494309189533576e0 / (h * h);
-
-          // quadric kernel, 2d
-          //wf = 1.5915494309189533576e0 / (h * h);
-        }
-        
-        rho[i] = imass * wf;
-      }
+        // sum ghost contributions, then turn dW/dh sum into grad-h factor
+        // gradh = 1 / (1 + h/(dim rho) drho/dh), Price, JCP, 231, 759 (2012)
 
-      // add density at each atom via kernel function overlap
-      for (ii = 0; ii < inum; ii++) {
-        i = ilist[ii];
-        xtmp = x[i][0];
-        ytmp = x[i][1];
-        ztmp = x[i][2];
-        itype = type[i];
-        jlist = firstneigh[i];
-        jnum = numneigh[i];
-
-        for (jj = 0; jj < jnum; jj++) {
-          j = jlist[jj];
-          j &= NEIGHMASK;
-
-          jtype = type[j];
-          delx = xtmp - x[j][0];
-          dely = ytmp - x[j][1];
-          delz = ztmp - x[j][2];
-          rsq = delx * delx + dely * dely + delz * delz;
-
-          if (rsq < cutsq[itype][jtype]) {
-            h = cut[itype][jtype];
-            ih = 1.0 / h;
-            ihsq = ih * ih;
-
-            if (domain->dimension == 3) {
-              
-              // Lucy kernel, 3d
-              r = sqrt(rsq);
-              wf = (h - r) * ihsq;
-              wf =  2.0889086280811262819e0 * (h + 3. * r) * wf * wf * wf * ih;
-
-              // quadric kernel, 3d
-              //wf = 1.0 - rsq * ihsq;
-              //wf = wf * wf;
-              //wf = wf * wf;
-              //wf = 2.1541870227086614782e0 * wf * ihsq * ih;
-            } else {
-              // Lucy kernel, 2d
-              r = sqrt(rsq);
-              wf = (h - r) * ihsq;
-              wf = 1.5915494309189533576e0 * (h + 3. * r) * wf * wf * wf;
-
-              // quadric kernel, 2d
-              //wf = 1.0 - rsq * ihsq;
-              //wf = wf * wf;
-              //wf = wf * wf;
-              //wf = 1.5915494309189533576e0 * wf * ihsq;
-            }
+        if (force->newton_pair) comm->reverse_comm_pair(this);
 
-            rho[i] += mass[jtype] * wf;
-          }
+        double *rho = atom->rho;
+        double *hsml = atom->hsml;
+        double *gradh = atom->gradh;
+        int nlocal = atom->nlocal;
+        int dim = domain->dimension;
+        double omega;
 
+        for (i = 0; i < nlocal; i++) {
+          omega = 1.0 + hsml[i] / (dim * rho[i]) * gradh[i];
+          gradh[i] = (omega > 0.0) ? 1.0 / omega : 1.0;
         }
+      } else {
+        SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval, ());
       }
     }
   }
@@ -199,6 +145,152 @@ void PairSPHRhoSum::compute(int eflag, int vflag) {
   comm->forward_comm_pair(this);
 }
 
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHRhoSum::eval() {
+  int i, j, ii, jj, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz;
+  double rsq, imass, h;
+  int *jlist;
+  double wf;
+  // neighbor list variables
+  int inum, *ilist, *numneigh, **firstneigh;
+
+  double **x = atom->x;
+  double *rho = atom->rho;
+  int *type = atom->type;
+  double *mass = atom->mass;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // we use a full neighborlist here
+
+  // initialize density with self-contribution,
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    itype = type[i];
+    imass = mass[itype];
+
+    h = cut[itype][itype];
+    wf = SPHKernel::Kernel<KERNEL,DIM>::w(0.0, h);
+
+    rho[i] = imass * wf;
+  }
+
+  // add density at each atom via kernel function overlap
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      jtype = type[j];
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+
+      if (rsq < cutsq[itype][jtype]) {
+        h = cut[itype][jtype];
+        wf = SPHKernel::Kernel<KERNEL,DIM>::w(sqrt(rsq), h);
+        rho[i] += mass[jtype] * wf;
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   density with the per-atom smoothing length h of fix meso/hsml
+   rho_i = sum_j m_j W(r_ij,h_i) over a half list, so each pair adds to
+     both atoms, each with its own h
+   drho_i/dh_i is summed into gradh and converted by compute()
+------------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHRhoSum::eval_adaptive() {
+  int i, j, ii, jj, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz;
+  double rsq, r, imass, jmass, hi, hj;
+  int *jlist;
+  // neighbor list variables
+  int inum, *ilist, *numneigh, **firstneigh;
+
+  double **x = atom->x;
+  double *rho = atom->rho;
+  double *hsml = atom->hsml;
+  double *dhsum = atom->gradh;
+  int *type = atom->type;
+  double *mass = atom->mass;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  int newton_pair = force->newton_pair;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // initialize owned atoms with self-contribution, ghosts with zero
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    imass = mass[type[i]];
+    hi = hsml[i];
+    rho[i] = imass * SPHKernel::Kernel<KERNEL,DIM>::w(0.0, hi);
+    dhsum[i] = imass * SPHKernel::dwdh<KERNEL,DIM>(0.0, hi);
+  }
+
+  if (newton_pair)
+    for (i = nlocal; i < nall; i++) rho[i] = dhsum[i] = 0.0;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    imass = mass[itype];
+    hi = hsml[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      r = sqrt(rsq);
+      jtype = type[j];
+      jmass = mass[jtype];
+      hj = hsml[j];
+
+      if (r < hi) {
+        rho[i] += jmass * SPHKernel::Kernel<KERNEL,DIM>::w(r, hi);
+        dhsum[i] += jmass * SPHKernel::dwdh<KERNEL,DIM>(r, hi);
+      }
+
+      if (r < hj && (newton_pair || j < nlocal)) {
+        rho[j] += imass * SPHKernel::Kernel<KERNEL,DIM>::w(r, hj);
+        dhsum[j] += imass * SPHKernel::dwdh<KERNEL,DIM>(r, hj);
+      }
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------
  allocate all arrays
  ------------------------------------------------------------------------- */
@@ -222,10 +314,23 @@ void PairSPHRhoSum::allocate() {
  ------------------------------------------------------------------------- */
 
 void PairSPHRhoSum::settings(int narg, char **arg) {
-  if (narg != 1)
+  if (narg < 1)
     error->all(FLERR,
         "Illegal number of setting arguments for pair_style sph/rhosum");
   nstep = force->inumeric(arg[0]);
+
+  kernel = SPHKernel::LUCY;
+  int iarg = 1;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/rhosum command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sph/rhosum command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/rhosum command");
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -288,12 +393,15 @@ int PairSPHRhoSum::pack_comm(int n, int *list, double *buf, int pbc_flag,
   int i, j, m;
   double *rho = atom->rho;
 
+  double *gradh = atom->gradh;
+
   m = 0;
   for (i = 0; i < n; i++) {
     j = list[i];
     buf[m++] = rho[j];
+    if (adaptive) buf[m++] = gradh[j];
   }
-  return 1;
+  return comm_forward;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -302,9 +410,54 @@ void PairSPHRhoSum::unpack_comm(int n, int first, double *buf) {
   int i, m, last;
   double *rho = atom->rho;
 
+  double *gradh = atom->gradh;
+
   m = 0;
   last = first + n;
-  for (i = first; i < last; i++)
+  for (i = first; i < last; i++) {
     rho[i] = buf[m++];
+    if (adaptive) gradh[i] = buf[m++];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int PairSPHRhoSum::pack_reverse_comm(int n, int first, double *buf) {
+  int i, m, last;
+  double *rho = atom->rho;
+  double *gradh = atom->gradh;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) {
+    buf[m++] = rho[i];
+    buf[m++] = gradh[i];
+  }
+  return 2;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHRhoSum::unpack_reverse_comm(int n, int *list, double *buf) {
+  int i, j, m;
+  double *rho = atom->rho;
+  double *gradh = atom->gradh;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    rho[j] += buf[m++];
+    gradh[j] += buf[m++];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   non-NULL if this style supports the per-atom h of fix meso/hsml
+------------------------------------------------------------------------- */
+
+void *PairSPHRhoSum::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"hsml") == 0) return (void *) &adaptive;
+  return NULL;
 }
 
@@ -36,12 +36,21 @@ class PairSPHRhoSum : public Pair {
   virtual double single(int, int, int, int, double, double, double, double &);
   int pack_comm(int, int *, double *, int, int *);
   void unpack_comm(int, int, double *);
+  int pack_reverse_comm(int, int, double *);
+  void unpack_reverse_comm(int, int *, double *);
+  void *extract(char *, int &);
 
  protected:
   double **cut;
   int nstep, first;
+  int kernel;                   // SPH kernel, see sph_kernel.h
+  int adaptive;                 // 1 if fix meso/hsml sets per-atom h
 
   void allocate();
+
+ private:
+  template <int KERNEL, int DIM> void eval();
+  template <int KERNEL, int DIM> void eval_adaptive();
 };
 
 }
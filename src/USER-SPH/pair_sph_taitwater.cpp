@@ -13,14 +13,22 @@
 
 #include "math.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_sph_taitwater.h"
 #include "atom.h"
+#include "atom_vec_meso.h"
 #include "force.h"
 #include "comm.h"
+#include "neighbor.h"
 #include "neigh_list.h"
+#include "neigh_request.h"
+#include "modify.h"
+#include "fix.h"
 #include "memory.h"
 #include "error.h"
 #include "domain.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
 
 using namespace LAMMPS_NS;
 
@@ -29,8 +37,17 @@ using namespace LAMMPS_NS;
 PairSPHTaitwater::PairSPHTaitwater(LAMMPS *lmp) : Pair(lmp)
 {
   restartinfo = 0;
+  overlap_enable = 1;
 
   first = 1;
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+  kcache = kc = NULL;
+  kfill = 0;
+  avec = NULL;
+  pfac = NULL;
+  maxpfac = 0;
+  adaptive = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -46,34 +63,21 @@ PairSPHTaitwater::~PairSPHTaitwater() {
     memory->destroy(B);
     memory->destroy(viscosity);
   }
+
+  delete kcache;
+  memory->destroy(pfac);
 }
 
 /* ---------------------------------------------------------------------- */
 
 void PairSPHTaitwater::compute(int eflag, int vflag) {
-  int i, j, ii, jj, inum, jnum, itype, jtype;
-  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
-
-  int *ilist, *jlist, *numneigh, **firstneigh;
-  double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, fvisc, h, ih, ihsq;
-  double rsq, tmp, wfd, delVdotDelR, mu, deltaE;
+  int i, j;
 
   if (eflag || vflag)
     ev_setup(eflag, vflag);
   else
     evflag = vflag_fdotr = 0;
 
-  double **v = atom->vest;
-  double **x = atom->x;
-  double **f = atom->f;
-  double *rho = atom->rho;
-  double *mass = atom->mass;
-  double *de = atom->de;
-  double *drho = atom->drho;
-  int *type = atom->type;
-  int nlocal = atom->nlocal;
-  int newton_pair = force->newton_pair;
-
   // check consistency of pair coefficients
 
   if (first) {
@@ -93,84 +97,183 @@ void PairSPHTaitwater::compute(int eflag, int vflag) {
     first = 0;
   }
 
+  // kernel values shared with other SPH sub-styles of pair hybrid
+  // not used when called on a subset of the list, see Verlet::force_overlap(),
+  //   since they are stored in the order of the whole list
+
+  if (cacheflag && kc == NULL)
+    kc = SPHKernelCache::find(lmp,this,list,kernel,setflag,cut,kcache);
+  SPHKernelCache *kc_list = kc;
+  if (overlap_phase) kc = NULL;
+  else if (kc) kfill = kc->setup(kc == kcache);
+
+  // contiguous copies of positions, velocities and densities
+  // and the pressure term of each owned and ghost atom
+  // when called on subsets of the list, owned atoms are done before
+  //   ghosts are received and ghosts on the 1st call after they are
+
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  int lo = 0;
+  int hi = nall;
+  if (overlap_phase == 1) hi = nlocal;
+  else if (overlap_phase == 2) lo = nlocal;
+  else if (overlap_phase == 3) lo = nall;
+  avec->soa_update(lo,hi);
+
+  if (nall > maxpfac) {
+    maxpfac = atom->nmax;
+    memory->destroy(pfac);
+    memory->create(pfac, maxpfac, "pair:pfac");
+  }
+
+  double *rho = avec->rhos;
+  int *type = atom->type;
+  double tmp, p;
+  for (i = lo; i < hi; i++) {
+    tmp = rho[i] / rho0[type[i]];
+    p = tmp * tmp * tmp;
+    pfac[i] = B[type[i]] * (p * p * tmp - 1.0) / (rho[i] * rho[i]);
+  }
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel, ());
+
+  if (kc && kfill) kc->validate();
+  kc = kc_list;
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHTaitwater::eval_kernel() {
+  if (adaptive) {
+    if (evflag) {
+      if (force->newton_pair) eval_adaptive<KERNEL,DIM,1,1>();
+      else eval_adaptive<KERNEL,DIM,1,0>();
+    } else {
+      if (force->newton_pair) eval_adaptive<KERNEL,DIM,0,1>();
+      else eval_adaptive<KERNEL,DIM,0,0>();
+    }
+  } else if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>();
+    else eval<KERNEL,DIM,1,0>();
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>();
+    else eval<KERNEL,DIM,0,0>();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHTaitwater::eval() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, vxtmp, vytmp, vztmp;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double *kr, *kwfd;
+
+  // per-pair math in the precision selected by SPH_SCALAR,
+  // distances are taken in double precision before the conversion
+
+  SPH_SCALAR delx, dely, delz, rsq, r, h, wfd, delvx, delvy, delvz;
+  SPH_SCALAR delVdotDelR, mu, cvisc, rhoi, rhoj, imass, jmass, fi, fj;
+  SPH_SCALAR fvisc, fpair, deltaE;
+
+  const double * const xs = avec->xs;
+  const double * const ys = avec->ys;
+  const double * const zs = avec->zs;
+  const double * const vxs = avec->vxs;
+  const double * const vys = avec->vys;
+  const double * const vzs = avec->vzs;
+  const double * const rhos = avec->rhos;
+  const double * const p = pfac;
+
+  double **f = atom->f;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  double *drho = atom->drho;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
   inum = list->inum;
   ilist = list->ilist;
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
   // loop over neighbors of my atoms
 
   for (ii = 0; ii < inum; ii++) {
     i = ilist[ii];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    vxtmp = v[i][0];
-    vytmp = v[i][1];
-    vztmp = v[i][2];
+    xtmp = xs[i];
+    ytmp = ys[i];
+    ztmp = zs[i];
+    vxtmp = vxs[i];
+    vytmp = vys[i];
+    vztmp = vzs[i];
+    rhoi = rhos[i];
     itype = type[i];
     jlist = firstneigh[i];
     jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
 
     imass = mass[itype];
-
-    // compute pressure of atom i with Tait EOS
-    tmp = rho[i] / rho0[itype];
-    fi = tmp * tmp * tmp;
-    fi = B[itype] * (fi * fi * tmp - 1.0) / (rho[i] * rho[i]);
+    fi = p[i];
 
     for (jj = 0; jj < jnum; jj++) {
       j = jlist[jj];
       j &= NEIGHMASK;
 
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
+      delx = xtmp - xs[j];
+      dely = ytmp - ys[j];
+      delz = ztmp - zs[j];
       rsq = delx * delx + dely * dely + delz * delz;
       jtype = type[j];
-      jmass = mass[jtype];
 
       if (rsq < cutsq[itype][jtype]) {
-
+        jmass = mass[jtype];
         h = cut[itype][jtype];
-        ih = 1.0 / h;
-        ihsq = ih * ih;
-
-        wfd = h - sqrt(rsq);
-        if (domain->dimension == 3) {
-          // Lucy Kernel, 3d
-          // Note that wfd, the derivative of the weight function with respect to r,
-          // is lacking a factor of r.
-          // The missing factor of r is recovered by
-          // (1) using delV . delX instead of delV . (delX/r) and
-          // (2) using f[i][0] += delx * fpair instead of f[i][0] += (delx/r) * fpair
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
-        } else {
-          // Lucy Kernel, 2d
-          wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM,SPH_SCALAR>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
         }
 
-        // compute pressure  of atom j with Tait EOS
-        tmp = rho[j] / rho0[jtype];
-        fj = tmp * tmp * tmp;
-        fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[j] * rho[j]);
-
         // dot product of velocity delta and distance vector
-        delVdotDelR = delx * (vxtmp - v[j][0]) + dely * (vytmp - v[j][1])
-            + delz * (vztmp - v[j][2]);
+        delvx = vxtmp - vxs[j];
+        delvy = vytmp - vys[j];
+        delvz = vztmp - vzs[j];
+        delVdotDelR = delx * delvx + dely * delvy + delz * delvz;
 
         // artificial viscosity (Monaghan 1992)
         if (delVdotDelR < 0.) {
-          mu = h * delVdotDelR / (rsq + 0.01 * h * h);
-          fvisc = -viscosity[itype][jtype] * (soundspeed[itype]
-              + soundspeed[jtype]) * mu / (rho[i] + rho[j]);
+          mu = h * delVdotDelR / (rsq + SPH_SCALAR(0.01) * h * h);
+          cvisc = viscosity[itype][jtype] *
+            (soundspeed[itype] + soundspeed[jtype]);
+          rhoj = rhos[j];
+          fvisc = -cvisc * mu / (rhoi + rhoj);
         } else {
           fvisc = 0.;
         }
 
         // total pair force & thermal energy increment
+        fj = p[j];
         fpair = -imass * jmass * (fi + fj + fvisc) * wfd;
-        deltaE = -0.5 * fpair * delVdotDelR;
+        deltaE = SPH_SCALAR(-0.5) * fpair * delVdotDelR;
 
         f[i][0] += delx * fpair;
         f[i][1] += dely * fpair;
@@ -182,7 +285,7 @@ void PairSPHTaitwater::compute(int eflag, int vflag) {
         // change in thermal energy
         de[i] += deltaE;
 
-        if (newton_pair || j < nlocal) {
+        if (NEWTON_PAIR || j < nlocal) {
           f[j][0] -= delx * fpair;
           f[j][1] -= dely * fpair;
           f[j][2] -= delz * fpair;
@@ -190,13 +293,119 @@ void PairSPHTaitwater::compute(int eflag, int vflag) {
           drho[j] += imass * delVdotDelR * wfd;
         }
 
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
+        if (EVFLAG)
+          ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
       }
     }
   }
+}
 
-  if (vflag_fdotr) virial_fdotr_compute();
+/* ----------------------------------------------------------------------
+   pair forces with the per-atom smoothing length h of fix meso/hsml
+   same split of the pressure and viscosity terms as in sph/idealgas
+------------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHTaitwater::eval_adaptive() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double r, rsq, vxtmp, vytmp, vztmp, rhoi, imass, jmass, fi, fj, fvisc;
+  double hi, hj, h, wfdi, wfdj, wfd, delVdotDelR, mu;
+
+  const double * const xs = avec->xs;
+  const double * const ys = avec->ys;
+  const double * const zs = avec->zs;
+  const double * const vxs = avec->vxs;
+  const double * const vys = avec->vys;
+  const double * const vzs = avec->vzs;
+  const double * const rhos = avec->rhos;
+  const double * const p = pfac;
+
+  double **f = atom->f;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  double *drho = atom->drho;
+  double *hsml = atom->hsml;
+  double *gradh = atom->gradh;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = xs[i];
+    ytmp = ys[i];
+    ztmp = zs[i];
+    vxtmp = vxs[i];
+    vytmp = vys[i];
+    vztmp = vzs[i];
+    rhoi = rhos[i];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    imass = mass[itype];
+    hi = hsml[i];
+    fi = gradh[i] * p[i];
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - xs[j];
+      dely = ytmp - ys[j];
+      delz = ztmp - zs[j];
+      rsq = delx * delx + dely * dely + delz * delz;
+      r = sqrt(rsq);
+      hj = hsml[j];
+      if (r >= hi && r >= hj) continue;
+
+      jtype = type[j];
+      jmass = mass[jtype];
+
+      wfdi = (r < hi) ? SPHKernel::Kernel<KERNEL,DIM>::wfd(r, hi) : 0.0;
+      wfdj = (r < hj) ? SPHKernel::Kernel<KERNEL,DIM>::wfd(r, hj) : 0.0;
+      wfd = 0.5 * (wfdi + wfdj);
+      fj = gradh[j] * p[j];
+
+      delVdotDelR = delx * (vxtmp - vxs[j]) + dely * (vytmp - vys[j])
+          + delz * (vztmp - vzs[j]);
+
+      if (delVdotDelR < 0.) {
+        h = 0.5 * (hi + hj);
+        mu = h * delVdotDelR / (rsq + 0.01 * h * h);
+        fvisc = -viscosity[itype][jtype] * (soundspeed[itype]
+            + soundspeed[jtype]) * mu / (rhoi + rhos[j]);
+      } else {
+        fvisc = 0.;
+      }
+
+      fpair = -imass * jmass * (fi * wfdi + fj * wfdj + fvisc * wfd);
+
+      f[i][0] += delx * fpair;
+      f[i][1] += dely * fpair;
+      f[i][2] += delz * fpair;
+      drho[i] += jmass * delVdotDelR * gradh[i] * wfdi;
+      de[i] += imass * jmass * (fi * wfdi + 0.5 * fvisc * wfd) * delVdotDelR;
+
+      if (NEWTON_PAIR || j < nlocal) {
+        f[j][0] -= delx * fpair;
+        f[j][1] -= dely * fpair;
+        f[j][2] -= delz * fpair;
+        drho[j] += imass * delVdotDelR * gradh[j] * wfdj;
+        de[j] += imass * jmass * (fj * wfdj + 0.5 * fvisc * wfd) * delVdotDelR;
+      }
+
+      if (EVFLAG)
+        ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
+    }
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -221,14 +430,90 @@ void PairSPHTaitwater::allocate() {
   memory->create(viscosity, n + 1, n + 1, "pair:viscosity");
 }
 
+/* ----------------------------------------------------------------------
+ init specific to this pair style
+ ------------------------------------------------------------------------- */
+
+void PairSPHTaitwater::init_style() {
+  avec = (AtomVecMeso *) atom->style_match("meso");
+  if (!avec) error->all(FLERR,"Pair sph/taitwater requires atom style meso");
+
+  // per-atom smoothing length if fix meso/hsml is defined
+
+  adaptive = 0;
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"meso/hsml") == 0) adaptive = 1;
+
+  if (adaptive && cacheflag)
+    error->all(FLERR,
+               "Pair sph/taitwater cache cannot be used with fix meso/hsml");
+
+  int irequest = neighbor->request(this);
+  if (adaptive) neighbor->requests[irequest]->size = 1;
+}
+
+/* ----------------------------------------------------------------------
+   neighbor callback to inform pair style of neighbor list to use
+   the kernel cache is looked up again on the next compute
+------------------------------------------------------------------------- */
+
+void PairSPHTaitwater::init_list(int id, NeighList *ptr) {
+  list = ptr;
+  kc = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   offer own kernel cache to other SPH sub-styles of pair hybrid
+   non-NULL hsml if this style supports the per-atom h of fix meso/hsml
+   per-type EOS parameters and cutoffs for fix meso/dt
+------------------------------------------------------------------------- */
+
+void *PairSPHTaitwater::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"sph_kernel_cache") == 0 && kc == kcache)
+    return (void *) kcache;
+  if (strcmp(str,"hsml") == 0) return (void *) &adaptive;
+  if (strcmp(str,"rho0") == 0) {
+    dim = 1;
+    return (void *) rho0;
+  }
+  if (strcmp(str,"soundspeed") == 0) {
+    dim = 1;
+    return (void *) soundspeed;
+  }
+  if (strcmp(str,"cut") == 0) {
+    dim = 2;
+    return (void *) cut;
+  }
+  return NULL;
+}
+
 /* ----------------------------------------------------------------------
  global settings
  ------------------------------------------------------------------------- */
 
 void PairSPHTaitwater::settings(int narg, char **arg) {
-  if (narg != 0)
-    error->all(FLERR,
-        "Illegal number of setting arguments for pair_style sph/taitwater");
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/taitwater command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sph/taitwater command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cache") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/taitwater command");
+      if (strcmp(arg[iarg+1],"yes") == 0) cacheflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) cacheflag = 0;
+      else error->all(FLERR,"Illegal pair_style sph/taitwater command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/taitwater command");
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -299,3 +584,12 @@ double PairSPHTaitwater::single(int i, int j, int itype, int jtype,
 
   return 0.0;
 }
+
+/* ---------------------------------------------------------------------- */
+
+double PairSPHTaitwater::memory_usage()
+{
+  double bytes = Pair::memory_usage();
+  bytes += maxpfac * sizeof(double);
+  return bytes;
+}
@@ -33,13 +33,32 @@ class PairSPHTaitwater : public Pair {
   void coeff(int, char **);
   virtual double init_one(int, int);
   virtual double single(int, int, int, int, double, double, double, double &);
+  void init_style();
+  void init_list(int, class NeighList *);
+  void *extract(char *, int &);
+  virtual double memory_usage();
 
  protected:
   double *rho0, *soundspeed, *B;
   double **cut,**viscosity;
   int first;
+  int kernel;                   // SPH kernel, see sph_kernel.h
+  int cacheflag;                // 1 to use a shared kernel cache
+  class SPHKernelCache *kcache; // own cache, NULL if none
+  class SPHKernelCache *kc;     // cache in use, own or of other style
+  int kfill;                    // 1 if this style stores the cache values
+  class AtomVecMeso *avec;      // SoA copy of per-atom data
+  double *pfac;                 // pressure / rho^2 of each atom
+  int maxpfac;
+  int adaptive;                 // 1 if fix meso/hsml sets per-atom h
 
   void allocate();
+
+ private:
+  template <int KERNEL, int DIM> void eval_kernel();
+  template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR> void eval();
+  template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+    void eval_adaptive();
 };
 
 }
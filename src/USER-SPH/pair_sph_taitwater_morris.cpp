@@ -13,6 +13,7 @@
 
 #include "math.h"
 #include "stdlib.h"
+#include "string.h"
 #include "pair_sph_taitwater_morris.h"
 #include "atom.h"
 #include "force.h"
@@ -21,6 +22,8 @@
 #include "memory.h"
 #include "error.h"
 #include "domain.h"
+#include "sph_kernel.h"
+#include "sph_kernel_cache.h"
 
 using namespace LAMMPS_NS;
 
@@ -30,6 +33,10 @@ PairSPHTaitwaterMorris::PairSPHTaitwaterMorris(LAMMPS *lmp) : Pair(lmp)
 {
   restartinfo = 0;
   first = 1;
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+  kcache = kc = NULL;
+  kfill = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -45,33 +52,20 @@ PairSPHTaitwaterMorris::~PairSPHTaitwaterMorris() {
     memory->destroy(B);
     memory->destroy(viscosity);
   }
+
+  delete kcache;
 }
 
 /* ---------------------------------------------------------------------- */
 
 void PairSPHTaitwaterMorris::compute(int eflag, int vflag) {
-  int i, j, ii, jj, inum, jnum, itype, jtype;
-  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
-
-  int *ilist, *jlist, *numneigh, **firstneigh;
-  double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, fvisc, h, ih, ihsq, velx, vely, velz;
-  double rsq, tmp, wfd, delVdotDelR, deltaE;
+  int i, j;
 
   if (eflag || vflag)
     ev_setup(eflag, vflag);
   else
     evflag = vflag_fdotr = 0;
 
-  double **v = atom->vest;
-  double **x = atom->x;
-  double **f = atom->f;
-  double *rho = atom->rho;
-  double *mass = atom->mass;
-  double *de = atom->de;
-  double *drho = atom->drho;
-  int *type = atom->type;
-  int nlocal = atom->nlocal;
-  int newton_pair = force->newton_pair;
   // check consistency of pair coefficients
 
   if (first) {
@@ -91,11 +85,70 @@ void PairSPHTaitwaterMorris::compute(int eflag, int vflag) {
     first = 0;
   }
 
+  // kernel values shared with other SPH sub-styles of pair hybrid
+
+  if (cacheflag) {
+    if (kc == NULL)
+      kc = SPHKernelCache::find(lmp,this,list,kernel,setflag,cut,kcache);
+    kfill = kc->setup(kc == kcache);
+  }
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, eval_kernel, ());
+
+  if (kc && kfill) kc->validate();
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHTaitwaterMorris::eval_kernel() {
+  if (evflag) {
+    if (force->newton_pair) eval<KERNEL,DIM,1,1>();
+    else eval<KERNEL,DIM,1,0>();
+  } else {
+    if (force->newton_pair) eval<KERNEL,DIM,0,1>();
+    else eval<KERNEL,DIM,0,0>();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int EVFLAG, int NEWTON_PAIR>
+void PairSPHTaitwaterMorris::eval() {
+  int i, j, ii, jj, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, vxtmp, vytmp, vztmp, tmpi, pi;
+
+  int *ilist, *jlist, *numneigh, **firstneigh;
+  double *kr, *kwfd;
+
+  // per-pair math in the precision selected by SPH_SCALAR,
+  // distances are taken in double precision before the conversion
+
+  SPH_SCALAR delx, dely, delz, rsq, r, h, wfd, velx, vely, velz;
+  SPH_SCALAR delVdotDelR, tmp, rhoi, rhoj, imass, jmass, fi, fj;
+  SPH_SCALAR cvisc, fvisc, fpair, deltaE;
+
+  double **v = atom->vest;
+  double **x = atom->x;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  double *drho = atom->drho;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
   inum = list->inum;
   ilist = list->ilist;
   numneigh = list->numneigh;
   firstneigh = list->firstneigh;
 
+  // read kernel values from the cache, or compute and store them
+
+  const int kread = kc && !kfill;
+  kr = kwfd = NULL;
+
   // loop over neighbors of my atoms
 
   for (ii = 0; ii < inum; ii++) {
@@ -109,13 +162,18 @@ void PairSPHTaitwaterMorris::compute(int eflag, int vflag) {
     itype = type[i];
     jlist = firstneigh[i];
     jnum = numneigh[i];
+    if (kc) {
+      kr = kc->r + kc->offset[ii];
+      kwfd = kc->wfd + kc->offset[ii];
+    }
 
     imass = mass[itype];
 
     // compute pressure of atom i with Tait EOS
-    tmp = rho[i] / rho0[itype];
-    fi = tmp * tmp * tmp;
-    fi = B[itype] * (fi * fi * tmp - 1.0) / (rho[i] * rho[i]);
+    tmpi = rho[i] / rho0[itype];
+    pi = tmpi * tmpi * tmpi;
+    fi = B[itype] * (pi * pi * tmpi - 1.0) / (rho[i] * rho[i]);
+    rhoi = rho[i];
 
     for (jj = 0; jj < jnum; jj++) {
       j = jlist[jj];
@@ -130,27 +188,22 @@ void PairSPHTaitwaterMorris::compute(int eflag, int vflag) {
 
       if (rsq < cutsq[itype][jtype]) {
         h = cut[itype][jtype];
-        ih = 1.0 / h;
-        ihsq = ih * ih;
-
-        wfd = h - sqrt(rsq);
-        if (domain->dimension == 3) {
-          // Lucy Kernel, 3d
-          // Note that wfd, the derivative of the weight function with respect to r,
-          // is lacking a factor of r.
-          // The missing factor of r is recovered by
-          // (1) using delV . delX instead of delV . (delX/r) and
-          // (2) using f[i][0] += delx * fpair instead of f[i][0] += (delx/r) * fpair
-          wfd = -25.066903536973515383e0 * wfd * wfd * ihsq * ihsq * ihsq * ih;
-        } else {
-          // Lucy Kernel, 2d
-          wfd = -19.098593171027440292e0 * wfd * wfd * ihsq * ihsq * ihsq;
+        if (kread) wfd = kwfd[jj];
+        else {
+          r = sqrt(rsq);
+          wfd = SPHKernel::Kernel<KERNEL,DIM,SPH_SCALAR>::wfd(r, h);
+          if (kwfd) {
+            kr[jj] = r;
+            kwfd[jj] = wfd;
+          }
         }
 
         // compute pressure  of atom j with Tait EOS
-        tmp = rho[j] / rho0[jtype];
+        rhoj = rho[j];
+        tmp = rhoj / SPH_SCALAR(rho0[jtype]);
         fj = tmp * tmp * tmp;
-        fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[j] * rho[j]);
+        fj = SPH_SCALAR(B[jtype]) * (fj * fj * tmp - SPH_SCALAR(1.0)) /
+          (rhoj * rhoj);
 
         velx=vxtmp - v[j][0];
         vely=vytmp - v[j][1];
@@ -161,13 +214,15 @@ void PairSPHTaitwaterMorris::compute(int eflag, int vflag) {
 
         // Morris Viscosity (Morris, 1996)
 
-        fvisc = 2 * viscosity[itype][jtype] / (rho[i] * rho[j]);
+        cvisc = viscosity[itype][jtype];
+        fvisc = SPH_SCALAR(2.0) * cvisc / (rhoi * rhoj);
 
         fvisc *= imass * jmass * wfd;
 
         // total pair force & thermal energy increment
         fpair = -imass * jmass * (fi + fj) * wfd;
-        deltaE = -0.5 *(fpair * delVdotDelR + fvisc * (velx*velx + vely*vely + velz*velz));
+        deltaE = SPH_SCALAR(-0.5) * (fpair * delVdotDelR + fvisc *
+                                     (velx*velx + vely*vely + velz*velz));
 
        // printf("testvar= %f, %f \n", delx, dely);
 
@@ -181,7 +236,7 @@ void PairSPHTaitwaterMorris::compute(int eflag, int vflag) {
         // change in thermal energy
         de[i] += deltaE;
 
-        if (newton_pair || j < nlocal) {
+        if (NEWTON_PAIR || j < nlocal) {
           f[j][0] -= delx * fpair + velx * fvisc;
           f[j][1] -= dely * fpair + vely * fvisc;
           f[j][2] -= delz * fpair + velz * fvisc;
@@ -189,13 +244,11 @@ void PairSPHTaitwaterMorris::compute(int eflag, int vflag) {
           drho[j] += imass * delVdotDelR * wfd;
         }
 
-        if (evflag)
-          ev_tally(i, j, nlocal, newton_pair, 0.0, 0.0, fpair, delx, dely, delz);
+        if (EVFLAG)
+          ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
       }
     }
   }
-
-  if (vflag_fdotr) virial_fdotr_compute();
 }
 
 /* ----------------------------------------------------------------------
@@ -220,14 +273,71 @@ void PairSPHTaitwaterMorris::allocate() {
   memory->create(viscosity, n + 1, n + 1, "pair:viscosity");
 }
 
+/* ----------------------------------------------------------------------
+   neighbor callback to inform pair style of neighbor list to use
+   the kernel cache is looked up again on the next compute
+------------------------------------------------------------------------- */
+
+void PairSPHTaitwaterMorris::init_list(int id, NeighList *ptr) {
+  list = ptr;
+  kc = NULL;
+}
+
+/* ----------------------------------------------------------------------
+   offer own kernel cache to other SPH sub-styles of pair hybrid
+   per-type EOS parameters and cutoffs for fix meso/dt, and the
+     dynamic viscosity mu
+------------------------------------------------------------------------- */
+
+void *PairSPHTaitwaterMorris::extract(char *str, int &dim) {
+  dim = 0;
+  if (strcmp(str,"sph_kernel_cache") == 0 && kc == kcache)
+    return (void *) kcache;
+  if (strcmp(str,"rho0") == 0) {
+    dim = 1;
+    return (void *) rho0;
+  }
+  if (strcmp(str,"soundspeed") == 0) {
+    dim = 1;
+    return (void *) soundspeed;
+  }
+  if (strcmp(str,"cut") == 0) {
+    dim = 2;
+    return (void *) cut;
+  }
+  if (strcmp(str,"mu") == 0) {
+    dim = 2;
+    return (void *) viscosity;
+  }
+  return NULL;
+}
+
 /* ----------------------------------------------------------------------
  global settings
  ------------------------------------------------------------------------- */
 
 void PairSPHTaitwaterMorris::settings(int narg, char **arg) {
-  if (narg != 0)
-    error->all(FLERR,
-        "Illegal number of setting arguments for pair_style sph/taitwater/morris");
+  kernel = SPHKernel::LUCY;
+  cacheflag = 0;
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/taitwater/morris command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,"Unknown kernel in pair_style sph/taitwater/morris command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"cache") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/taitwater/morris command");
+      if (strcmp(arg[iarg+1],"yes") == 0) cacheflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) cacheflag = 0;
+      else error->all(FLERR,"Illegal pair_style sph/taitwater/morris command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/taitwater/morris command");
+  }
 }
 
 /* ----------------------------------------------------------------------
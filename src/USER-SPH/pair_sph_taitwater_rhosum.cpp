@@ -0,0 +1,586 @@
+/* ----------------------------------------------------------------------
+ LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+ http://lammps.sandia.gov, Sandia National Laboratories
+ Steve Plimpton, sjplimp@sandia.gov
+
+ Copyright (2003) Sandia Corporation.  Under the terms of Contract
+ DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+ certain rights in this software.  This software is distributed under
+ the GNU General Public License.
+
+ See the README file in the top-level LAMMPS directory.
+ ------------------------------------------------------------------------- */
+
+#include "math.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "pair_sph_taitwater_rhosum.h"
+#include "atom.h"
+#include "force.h"
+#include "comm.h"
+#include "neigh_list.h"
+#include "memory.h"
+#include "error.h"
+#include "update.h"
+#include "domain.h"
+#include "sph_kernel.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHTaitwaterRhoSum::PairSPHTaitwaterRhoSum(LAMMPS *lmp) : Pair(lmp)
+{
+  restartinfo = 0;
+
+  // set comm size needed by this Pair
+
+  comm_forward = 1;
+  comm_reverse = 1;
+
+  first = 1;
+  kernel = SPHKernel::LUCY;
+
+  nmax = 0;
+  rhosum = NULL;
+
+  maxlocal = maxpair = 0;
+  pfirst = pnum = pj = NULL;
+  pwfd = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairSPHTaitwaterRhoSum::~PairSPHTaitwaterRhoSum() {
+  if (allocated) {
+    memory->destroy(setflag);
+    memory->destroy(cutsq);
+
+    memory->destroy(cut);
+    memory->destroy(rho0);
+    memory->destroy(soundspeed);
+    memory->destroy(B);
+    memory->destroy(viscosity);
+    memory->destroy(sumflag);
+    memory->destroy(sumtype);
+  }
+
+  memory->destroy(rhosum);
+
+  memory->destroy(pfirst);
+  memory->destroy(pnum);
+  memory->destroy(pj);
+  memory->destroy(pwfd);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::compute(int eflag, int vflag) {
+  int i, j;
+
+  if (eflag || vflag)
+    ev_setup(eflag, vflag);
+  else
+    evflag = vflag_fdotr = 0;
+
+  // check consistency of pair coefficients
+
+  if (first) {
+    char str[256];
+    for (i = 1; i <= atom->ntypes; i++)
+      for (j = 1; j <= atom->ntypes; j++)
+        if (cutsq[i][j] > 1.e-32 && (!setflag[i][i] || !setflag[j][j]) &&
+            comm->me == 0) {
+          sprintf(str,"SPH particle types %d and %d interact with cutoff=%g, "
+                  "but not all of their single particle properties are set",
+                  i,j,sqrt(cutsq[i][j]));
+          error->warning(FLERR,str);
+        }
+    first = 0;
+  }
+
+  // grow density sum and pair cache if necessary
+
+  if (atom->nmax > nmax) {
+    memory->destroy(rhosum);
+    nmax = atom->nmax;
+    memory->create(rhosum,nmax,"pair:rhosum");
+  }
+  grow_cache();
+
+  // single pass over the neighbor list:
+  // store the pairs inside the cutoff with their kernel derivative,
+  // and sum up the density on steps where it is recomputed
+  // distances are cheap to recompute, sqrt() and kernel are not
+
+  int dosum = 0;
+  if (nstep != 0 && (update->ntimestep % nstep) == 0) dosum = 1;
+
+  SPH_KERNEL_DISPATCH(kernel, domain->dimension, build_kernel, (dosum));
+
+  // the forces need the new density of ghost atoms
+
+  if (dosum) {
+    double *rho = atom->rho;
+    int *type = atom->type;
+    int nlocal = atom->nlocal;
+
+    if (force->newton_pair) comm->reverse_comm_pair(this);
+
+    for (i = 0; i < nlocal; i++)
+      if (sumtype[type[i]]) rho[i] = rhosum[i];
+
+    comm->forward_comm_pair(this);
+  }
+
+  // pressure and viscous forces from the stored pairs
+
+  if (evflag) {
+    if (force->newton_pair) eval<1,1>();
+    else eval<1,0>();
+  } else {
+    if (force->newton_pair) eval<0,1>();
+    else eval<0,0>();
+  }
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM>
+void PairSPHTaitwaterRhoSum::build_kernel(int dosum) {
+  if (force->newton_pair) build<KERNEL,DIM,1>(dosum);
+  else build<KERNEL,DIM,0>(dosum);
+}
+
+/* ----------------------------------------------------------------------
+   store all pairs inside the cutoff and their kernel derivative
+   if dosum is set, also accumulate the density of each atom in rhosum
+------------------------------------------------------------------------- */
+
+template <int KERNEL, int DIM, int NEWTON_PAIR>
+void PairSPHTaitwaterRhoSum::build(int dosum) {
+  int i, j, ii, jj, n, inum, jnum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz;
+  double r, rsq, h, wf;
+  int *ilist, *jlist, *numneigh, **firstneigh;
+
+  double **x = atom->x;
+  double *mass = atom->mass;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // zero out density sum
+
+  if (dosum) {
+    if (NEWTON_PAIR) {
+      n = nlocal + atom->nghost;
+      for (i = 0; i < n; i++) rhosum[i] = 0.0;
+    } else for (i = 0; i < nlocal; i++) rhosum[i] = 0.0;
+  }
+
+  n = 0;
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    // self-contribution to the density
+
+    if (dosum && sumtype[itype])
+      rhosum[i] += mass[itype] *
+        SPHKernel::Kernel<KERNEL,DIM>::w(0.0, cut[itype][itype]);
+
+    pfirst[ii] = n;
+
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+
+      if (rsq < cutsq[itype][jtype]) {
+        h = cut[itype][jtype];
+        r = sqrt(rsq);
+
+        pj[n] = j;
+        pwfd[n] = SPHKernel::Kernel<KERNEL,DIM>::wfd(r, h);
+        n++;
+
+        if (dosum && sumflag[itype][jtype]) {
+          wf = SPHKernel::Kernel<KERNEL,DIM>::w(r, h);
+          rhosum[i] += mass[jtype] * wf;
+          if (NEWTON_PAIR || j < nlocal) rhosum[j] += mass[itype] * wf;
+        }
+      }
+    }
+
+    pnum[ii] = n - pfirst[ii];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   Tait EOS pressure and Monaghan artificial viscosity, same as
+   pair sph/taitwater, for the pairs stored by build()
+------------------------------------------------------------------------- */
+
+template <int EVFLAG, int NEWTON_PAIR>
+void PairSPHTaitwaterRhoSum::eval() {
+  int i, j, ii, n, nlast, inum, itype, jtype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, fpair;
+
+  int *ilist;
+  double vxtmp, vytmp, vztmp, imass, jmass, fi, fj, fvisc, h;
+  double rsq, tmp, wfd, delVdotDelR, mu, deltaE;
+  double fxtmp, fytmp, fztmp, drhotmp, detmp;
+
+  double **x = atom->x;
+  double **v = atom->vest;
+  double **f = atom->f;
+  double *rho = atom->rho;
+  double *mass = atom->mass;
+  double *de = atom->de;
+  double *drho = atom->drho;
+  int *type = atom->type;
+  int nlocal = atom->nlocal;
+
+  inum = list->inum;
+  ilist = list->ilist;
+
+  // loop over stored pairs of my atoms
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    vxtmp = v[i][0];
+    vytmp = v[i][1];
+    vztmp = v[i][2];
+    itype = type[i];
+    fxtmp = fytmp = fztmp = drhotmp = detmp = 0.0;
+
+    imass = mass[itype];
+
+    // compute pressure of atom i with Tait EOS
+    tmp = rho[i] / rho0[itype];
+    fi = tmp * tmp * tmp;
+    fi = B[itype] * (fi * fi * tmp - 1.0) / (rho[i] * rho[i]);
+
+    nlast = pfirst[ii] + pnum[ii];
+    for (n = pfirst[ii]; n < nlast; n++) {
+      j = pj[n];
+      wfd = pwfd[n];
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      jmass = mass[jtype];
+      h = cut[itype][jtype];
+
+      // compute pressure  of atom j with Tait EOS
+      tmp = rho[j] / rho0[jtype];
+      fj = tmp * tmp * tmp;
+      fj = B[jtype] * (fj * fj * tmp - 1.0) / (rho[j] * rho[j]);
+
+      // dot product of velocity delta and distance vector
+      delVdotDelR = delx * (vxtmp - v[j][0]) + dely * (vytmp - v[j][1])
+          + delz * (vztmp - v[j][2]);
+
+      // artificial viscosity (Monaghan 1992)
+      if (delVdotDelR < 0.) {
+        mu = h * delVdotDelR / (rsq + 0.01 * h * h);
+        fvisc = -viscosity[itype][jtype] * (soundspeed[itype]
+            + soundspeed[jtype]) * mu / (rho[i] + rho[j]);
+      } else {
+        fvisc = 0.;
+      }
+
+      // total pair force & thermal energy increment
+      fpair = -imass * jmass * (fi + fj + fvisc) * wfd;
+      deltaE = -0.5 * fpair * delVdotDelR;
+
+      fxtmp += delx * fpair;
+      fytmp += dely * fpair;
+      fztmp += delz * fpair;
+
+      // and change in density
+      drhotmp += jmass * delVdotDelR * wfd;
+
+      // change in thermal energy
+      detmp += deltaE;
+
+      if (NEWTON_PAIR || j < nlocal) {
+        f[j][0] -= delx * fpair;
+        f[j][1] -= dely * fpair;
+        f[j][2] -= delz * fpair;
+        de[j] += deltaE;
+        drho[j] += imass * delVdotDelR * wfd;
+      }
+
+      if (EVFLAG)
+        ev_tally(i, j, nlocal, NEWTON_PAIR, 0.0, 0.0, fpair, delx, dely, delz);
+    }
+
+    f[i][0] += fxtmp;
+    f[i][1] += fytmp;
+    f[i][2] += fztmp;
+    drho[i] += drhotmp;
+    de[i] += detmp;
+  }
+}
+
+/* ----------------------------------------------------------------------
+ grow the pair cache to hold all neighbors of the current list
+ ------------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::grow_cache() {
+  int ii;
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+
+  if (inum > maxlocal) {
+    maxlocal = atom->nmax;
+    memory->grow(pfirst,maxlocal,"pair:pfirst");
+    memory->grow(pnum,maxlocal,"pair:pnum");
+  }
+
+  int npair = 0;
+  for (ii = 0; ii < inum; ii++) npair += numneigh[ilist[ii]];
+
+  if (npair > maxpair) {
+    maxpair = npair + npair/10;
+    memory->grow(pj,maxpair,"pair:pj");
+    memory->grow(pwfd,maxpair,"pair:pwfd");
+  }
+}
+
+/* ----------------------------------------------------------------------
+ allocate all arrays
+ ------------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::allocate() {
+  allocated = 1;
+  int n = atom->ntypes;
+
+  memory->create(setflag, n + 1, n + 1, "pair:setflag");
+  for (int i = 1; i <= n; i++)
+    for (int j = i; j <= n; j++)
+      setflag[i][j] = 0;
+
+  memory->create(cutsq, n + 1, n + 1, "pair:cutsq");
+
+  memory->create(rho0, n + 1, "pair:rho0");
+  memory->create(soundspeed, n + 1, "pair:soundspeed");
+  memory->create(B, n + 1, "pair:B");
+  memory->create(cut, n + 1, n + 1, "pair:cut");
+  memory->create(viscosity, n + 1, n + 1, "pair:viscosity");
+  memory->create(sumflag, n + 1, n + 1, "pair:sumflag");
+  memory->create(sumtype, n + 1, "pair:sumtype");
+}
+
+/* ----------------------------------------------------------------------
+ global settings
+ ------------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::settings(int narg, char **arg) {
+  if (narg < 1)
+    error->all(FLERR,
+        "Illegal number of setting arguments for pair_style sph/taitwater/rhosum");
+  nstep = force->inumeric(arg[0]);
+
+  kernel = SPHKernel::LUCY;
+  int iarg = 1;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"kernel") == 0) {
+      if (iarg+2 > narg)
+        error->all(FLERR,"Illegal pair_style sph/taitwater/rhosum command");
+      kernel = SPHKernel::find(arg[iarg+1]);
+      if (kernel < 0)
+        error->all(FLERR,
+            "Unknown kernel in pair_style sph/taitwater/rhosum command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal pair_style sph/taitwater/rhosum command");
+  }
+}
+
+/* ----------------------------------------------------------------------
+ set coeffs for one or more type pairs
+ ------------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::coeff(int narg, char **arg) {
+  if (narg != 6 && narg != 7)
+    error->all(FLERR,
+        "Incorrect args for pair_style sph/taitwater/rhosum coefficients");
+  if (!allocated)
+    allocate();
+
+  int ilo, ihi, jlo, jhi;
+  force->bounds(arg[0], atom->ntypes, ilo, ihi);
+  force->bounds(arg[1], atom->ntypes, jlo, jhi);
+
+  double rho0_one = force->numeric(arg[2]);
+  double soundspeed_one = force->numeric(arg[3]);
+  double viscosity_one = force->numeric(arg[4]);
+  double cut_one = force->numeric(arg[5]);
+  double B_one = soundspeed_one * soundspeed_one * rho0_one / 7.0;
+  int sumflag_one = 1;
+  if (narg == 7) sumflag_one = force->inumeric(arg[6]);
+
+  int count = 0;
+  for (int i = ilo; i <= ihi; i++) {
+    rho0[i] = rho0_one;
+    soundspeed[i] = soundspeed_one;
+    B[i] = B_one;
+    for (int j = MAX(jlo,i); j <= jhi; j++) {
+      viscosity[i][j] = viscosity_one;
+      cut[i][j] = cut_one;
+      sumflag[i][j] = sumflag_one;
+
+      setflag[i][j] = 1;
+      count++;
+    }
+  }
+
+  if (count == 0)
+    error->all(FLERR,"Incorrect args for pair coefficients");
+}
+
+/* ----------------------------------------------------------------------
+ init specific to this pair style
+ ------------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::init_style() {
+  Pair::init_style();
+
+  // sumtype is set by init_one() for types with a summed pair
+
+  for (int i = 1; i <= atom->ntypes; i++) sumtype[i] = 0;
+}
+
+/* ----------------------------------------------------------------------
+ init for one type pair i,j and corresponding j,i
+ ------------------------------------------------------------------------- */
+
+double PairSPHTaitwaterRhoSum::init_one(int i, int j) {
+
+  if (setflag[i][j] == 0) {
+    error->all(FLERR,"Not all pair sph/taitwater/rhosum coeffs are set");
+  }
+
+  cut[j][i] = cut[i][j];
+  viscosity[j][i] = viscosity[i][j];
+  sumflag[j][i] = sumflag[i][j];
+  if (sumflag[i][j]) sumtype[i] = sumtype[j] = 1;
+
+  return cut[i][j];
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairSPHTaitwaterRhoSum::single(int i, int j, int itype, int jtype,
+    double rsq, double factor_coul, double factor_lj, double &fforce) {
+  fforce = 0.0;
+
+  return 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int PairSPHTaitwaterRhoSum::pack_comm(int n, int *list, double *buf,
+    int pbc_flag, int *pbc) {
+  int i, j, m;
+  double *rho = atom->rho;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    buf[m++] = rho[j];
+  }
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::unpack_comm(int n, int first, double *buf) {
+  int i, m, last;
+  double *rho = atom->rho;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++)
+    rho[i] = buf[m++];
+}
+
+/* ---------------------------------------------------------------------- */
+
+int PairSPHTaitwaterRhoSum::pack_reverse_comm(int n, int first, double *buf) {
+  int i, m, last;
+
+  m = 0;
+  last = first + n;
+  for (i = first; i < last; i++) buf[m++] = rhosum[i];
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairSPHTaitwaterRhoSum::unpack_reverse_comm(int n, int *list,
+    double *buf) {
+  int i, j, m;
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    j = list[i];
+    rhosum[j] += buf[m++];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   per-type EOS parameters and cutoffs for fix meso/dt
+------------------------------------------------------------------------- */
+
+void *PairSPHTaitwaterRhoSum::extract(char *str, int &dim) {
+  if (strcmp(str,"rho0") == 0) {
+    dim = 1;
+    return (void *) rho0;
+  }
+  if (strcmp(str,"soundspeed") == 0) {
+    dim = 1;
+    return (void *) soundspeed;
+  }
+  if (strcmp(str,"cut") == 0) {
+    dim = 2;
+    return (void *) cut;
+  }
+  dim = 0;
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+ memory usage of density sum and pair cache
+ ------------------------------------------------------------------------- */
+
+double PairSPHTaitwaterRhoSum::memory_usage() {
+  double bytes = nmax * sizeof(double);
+  bytes += 2 * maxlocal * sizeof(int);
+  bytes += maxpair * (sizeof(int) + sizeof(double));
+  return bytes;
+}
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+
+PairStyle(sph/taitwater/rhosum,PairSPHTaitwaterRhoSum)
+
+#else
+
+#ifndef LMP_PAIR_TAITWATER_RHOSUM_H
+#define LMP_PAIR_TAITWATER_RHOSUM_H
+
+#include "pair.h"
+
+namespace LAMMPS_NS {
+
+class PairSPHTaitwaterRhoSum : public Pair {
+ public:
+  PairSPHTaitwaterRhoSum(class LAMMPS *);
+  virtual ~PairSPHTaitwaterRhoSum();
+  virtual void compute(int, int);
+  void settings(int, char **);
+  void coeff(int, char **);
+  void init_style();
+  virtual double init_one(int, int);
+  virtual double single(int, int, int, int, double, double, double, double &);
+  int pack_comm(int, int *, double *, int, int *);
+  void unpack_comm(int, int, double *);
+  int pack_reverse_comm(int, int, double *);
+  void unpack_reverse_comm(int, int *, double *);
+  void *extract(char *, int &);
+  double memory_usage();
+
+ protected:
+  double *rho0, *soundspeed, *B;
+  double **cut,**viscosity;
+  int **sumflag;                // 1 if pair contributes to density sum
+  int *sumtype;                 // 1 if density of type is recomputed
+  int nstep, first;
+  int kernel;                   // SPH kernel, see sph_kernel.h
+
+  // per-atom density sum
+
+  int nmax;
+  double *rhosum;
+
+  // pairs inside the cutoff and their kernel derivative wfd,
+  // stored by the density pass for the force pass
+  // pairs of ilist[ii] are pfirst[ii] ... pfirst[ii]+pnum[ii]-1
+
+  int maxlocal, maxpair;
+  int *pfirst, *pnum, *pj;
+  double *pwfd;
+
+  void allocate();
+  void grow_cache();
+
+ private:
+  template <int KERNEL, int DIM> void build_kernel(int);
+  template <int KERNEL, int DIM, int NEWTON_PAIR> void build(int);
+  template <int EVFLAG, int NEWTON_PAIR> void eval();
+};
+
+}
+
+#endif
+#endif
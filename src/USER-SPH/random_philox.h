@@ -0,0 +1,98 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   Counter-based Philox4x32-10 random number generator
+   Salmon, Moraes, Dror, Shaw, "Parallel random numbers: as easy as
+   1, 2, 3", Proceedings of SC11 (2011)
+
+   the generator has no state: the same (key, counter) pair always
+   produces the same numbers, so results do not depend on which
+   processor or thread draws them or in which order
+------------------------------------------------------------------------- */
+
+#ifndef LMP_RANDOM_PHILOX_H
+#define LMP_RANDOM_PHILOX_H
+
+#include "math.h"
+#include "lmptype.h"
+
+namespace LAMMPS_NS {
+
+class RanPhilox {
+ public:
+  RanPhilox(uint32_t k0 = 0, uint32_t k1 = 0) { key[0] = k0; key[1] = k1; }
+
+  void set_key(uint32_t k0, uint32_t k1) { key[0] = k0; key[1] = k1; }
+
+  // four 32-bit random integers for counter (c0,c1,c2,c3)
+
+  void generate(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                uint32_t *out) const {
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+    uint32_t hi0, lo0, hi1, lo1;
+    uint64_t prod;
+
+    for (int r = 0; r < 10; r++) {
+      prod = (uint64_t) 0xD2511F53U * c0;
+      hi0 = (uint32_t) (prod >> 32);
+      lo0 = (uint32_t) prod;
+      prod = (uint64_t) 0xCD9E8D57U * c2;
+      hi1 = (uint32_t) (prod >> 32);
+      lo1 = (uint32_t) prod;
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = lo0;
+      k0 += 0x9E3779B9U;
+      k1 += 0xBB67AE85U;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+  }
+
+  // four uniform deviates in the open interval (0,1)
+
+  void uniform4(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                double *u) const {
+    uint32_t out[4];
+    generate(c0,c1,c2,c3,out);
+    for (int k = 0; k < 4; k++)
+      u[k] = (out[k] + 0.5) * 2.3283064365386962890625e-10;
+  }
+
+  // four standard normal deviates via the Box-Muller transform
+  // no rejection loop, so the cost per call is fixed
+
+  void gaussian4(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                 double *g) const {
+    double u[4],r,theta;
+    uniform4(c0,c1,c2,c3,u);
+    for (int k = 0; k < 4; k += 2) {
+      r = sqrt(-2.0 * log(u[k]));
+      theta = 6.283185307179586477 * u[k+1];
+      g[k] = r * cos(theta);
+      g[k+1] = r * sin(theta);
+    }
+  }
+
+ private:
+  uint32_t key[2];
+};
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   SPH smoothing kernels, all written in terms of the support radius h,
+   which is the pair cutoff, so W(r) = 0 for r >= h
+   w()   = kernel value W(r)
+   wfd() = derivative dW/dr, lacking a factor of r, i.e. (dW/dr) / r
+   the pair styles recover the missing factor of r by
+   (1) using delV . delX instead of delV . (delX/r) and
+   (2) using f[i][0] += delx * fpair instead of f[i][0] += (delx/r) * fpair
+   the dimension is a template parameter, so the normalization is
+   resolved at compile time
+   the floating point type T is a template parameter as well, all
+   constants are converted to T, so float kernels use float math only
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SPH_KERNEL_H
+#define LMP_SPH_KERNEL_H
+
+#include "string.h"
+
+// precision of the per-pair math of the SPH pair styles
+// with -DSPH_SINGLE, the pair geometry, kernel and equation of state
+//   terms are evaluated in single precision, while positions and the
+//   force, drho and de accumulators stay in double precision
+
+#ifdef SPH_SINGLE
+typedef float SPH_SCALAR;
+#else
+typedef double SPH_SCALAR;
+#endif
+
+namespace LAMMPS_NS {
+
+namespace SPHKernel {
+
+enum{LUCY,CUBIC,QUINTIC,WENDLAND2,WENDLAND4,WENDLAND6};
+
+// kernel index of a pair_style kernel keyword value, -1 if unknown
+
+inline int find(const char *name)
+{
+  if (strcmp(name,"lucy") == 0) return LUCY;
+  if (strcmp(name,"cubic") == 0) return CUBIC;
+  if (strcmp(name,"quintic") == 0) return QUINTIC;
+  if (strcmp(name,"wendland2") == 0) return WENDLAND2;
+  if (strcmp(name,"wendland4") == 0) return WENDLAND4;
+  if (strcmp(name,"wendland6") == 0) return WENDLAND6;
+  return -1;
+}
+
+template <int KERNEL, int DIM, class T = double> struct Kernel;
+
+// Lucy quartic kernel, Lucy, Astron J, 82, 1013 (1977)
+
+template <int DIM, class T> struct Kernel<LUCY,DIM,T> {
+  static inline T w(T r, T h) {
+    const T ih = T(1.0) / h;
+    const T ihsq = ih * ih;
+    const T wf = (h - r) * ihsq;
+    if (DIM == 3)
+      return T(2.0889086280811262819e0) * (h + T(3.0)*r) * wf*wf*wf * ih;
+    return T(1.5915494309189533576e0) * (h + T(3.0)*r) * wf*wf*wf;
+  }
+  static inline T wfd(T r, T h) {
+    const T ih = T(1.0) / h;
+    const T ihsq = ih * ih;
+    const T wfd = h - r;
+    if (DIM == 3)
+      return -T(25.066903536973515383e0) * wfd*wfd * ihsq*ihsq*ihsq * ih;
+    return -T(19.098593171027440292e0) * wfd*wfd * ihsq*ihsq*ihsq;
+  }
+};
+
+// M4 cubic spline, support h = 2 * smoothing length
+// Monaghan and Lattanzio, Astron Astrophys, 149, 135 (1985)
+
+template <int DIM, class T> struct Kernel<CUBIC,DIM,T> {
+  static inline T norm(T h) {
+    if (DIM == 3) return T(2.5464790894703255297e0) / (h*h*h);
+    return T(1.8189136353359467435e0) / (h*h);
+  }
+  static inline T w(T r, T h) {
+    const T s = T(2.0) * r / h;
+    if (s < T(1.0)) return norm(h) * (T(1.0) - T(1.5)*s*s + T(0.75)*s*s*s);
+    const T t = T(2.0) - s;
+    return norm(h) * T(0.25) * t*t*t;
+  }
+  static inline T wfd(T r, T h) {
+    const T s = T(2.0) * r / h;
+    const T c = T(4.0) * norm(h) / (h*h);
+    if (s < T(1.0)) return c * (-T(3.0) + T(2.25)*s);
+    const T t = T(2.0) - s;
+    return -T(0.75) * c * t*t / s;
+  }
+};
+
+// M6 quintic spline, support h = 3 * smoothing length
+// Morris, Fox, and Zhu, J Comp Phys, 136, 214 (1997)
+
+template <int DIM, class T> struct Kernel<QUINTIC,DIM,T> {
+  static inline T norm(T h) {
+    if (DIM == 3) return T(7.1619724391352904136e-2) / (h*h*h);
+    return T(4.1952976630918022150e-2) / (h*h);
+  }
+  static inline T w(T r, T h) {
+    const T s = T(3.0) * r / h;
+    const T t3 = T(3.0) - s;
+    const T t2 = T(2.0) - s;
+    const T t1 = T(1.0) - s;
+    T wf = t3*t3*t3*t3*t3;
+    if (s < T(2.0)) wf -= T(6.0) * t2*t2*t2*t2*t2;
+    if (s < T(1.0)) wf += T(15.0) * t1*t1*t1*t1*t1;
+    return norm(h) * wf;
+  }
+  static inline T wfd(T r, T h) {
+    const T s = T(3.0) * r / h;
+    const T c = -T(45.0) * norm(h) / (h*h);
+
+    // expanded polynomial for s < 1, so r = 0 is well defined
+
+    if (s < T(1.0)) return c * ((T(10.0)*s - T(24.0))*s*s + T(24.0));
+    const T t3 = T(3.0) - s;
+    const T t2 = T(2.0) - s;
+    T wfd = t3*t3*t3*t3;
+    if (s < T(2.0)) wfd -= T(6.0) * t2*t2*t2*t2;
+    return c * wfd / s;
+  }
+};
+
+// Wendland C2, C4 and C6 kernels, Dehnen and Aly, MNRAS, 425, 1068 (2012)
+
+template <int DIM, class T> struct Kernel<WENDLAND2,DIM,T> {
+  static inline T norm(T h) {
+    if (DIM == 3) return T(3.3422538049298022855e0) / (h*h*h);
+    return T(2.2281692032865350050e0) / (h*h);
+  }
+  static inline T w(T r, T h) {
+    const T q = r / h;
+    const T t = T(1.0) - q;
+    const T tsq = t*t;
+    return norm(h) * tsq*tsq * (T(1.0) + T(4.0)*q);
+  }
+  static inline T wfd(T r, T h) {
+    const T t = T(1.0) - r / h;
+    return -T(20.0) * norm(h) / (h*h) * t*t*t;
+  }
+};
+
+template <int DIM, class T> struct Kernel<WENDLAND4,DIM,T> {
+  static inline T norm(T h) {
+    if (DIM == 3) return T(4.9238560519055125653e0) / (h*h*h);
+    return T(2.8647889756541160544e0) / (h*h);
+  }
+  static inline T w(T r, T h) {
+    const T q = r / h;
+    const T t = T(1.0) - q;
+    const T t3 = t*t*t;
+    return norm(h) * t3*t3 *
+      (T(1.0) + T(6.0)*q + T(11.666666666666666667e0)*q*q);
+  }
+  static inline T wfd(T r, T h) {
+    const T q = r / h;
+    const T t = T(1.0) - q;
+    const T tsq = t*t;
+    return -T(18.666666666666666667e0) * norm(h) / (h*h) *
+      tsq*tsq*t * (T(1.0) + T(5.0)*q);
+  }
+};
+
+template <int DIM, class T> struct Kernel<WENDLAND6,DIM,T> {
+  static inline T norm(T h) {
+    if (DIM == 3) return T(6.7889530412636602819e0) / (h*h*h);
+    return T(3.5468815889050961943e0) / (h*h);
+  }
+  static inline T w(T r, T h) {
+    const T q = r / h;
+    const T t = T(1.0) - q;
+    const T tsq = t*t;
+    const T t4 = tsq*tsq;
+    return norm(h) * t4*t4 * (T(1.0) + (T(8.0) + (T(25.0) + T(32.0)*q)*q)*q);
+  }
+  static inline T wfd(T r, T h) {
+    const T q = r / h;
+    const T t = T(1.0) - q;
+    const T tsq = t*t;
+    return -T(22.0) * norm(h) / (h*h) *
+      tsq*tsq*tsq*t * (T(1.0) + (T(7.0) + T(16.0)*q)*q);
+  }
+};
+
+// derivative dW/dh for a per-atom support radius, as used by the grad-h
+// terms of fix meso/hsml, valid for all kernels since W = h^-DIM f(r/h)
+
+template <int KERNEL, int DIM>
+inline double dwdh(double r, double h)
+{
+  return -(DIM * Kernel<KERNEL,DIM>::w(r,h) +
+           r*r * Kernel<KERNEL,DIM>::wfd(r,h)) / h;
+}
+
+}
+
+}
+
+/* ----------------------------------------------------------------------
+   call the member function template FUNC<KERNEL,DIM> with the argument
+   list ARGS for a kernel index and dimension known only at run time,
+   so the pair loop in FUNC is free of kernel and dimension branches
+------------------------------------------------------------------------- */
+
+#define SPH_KERNEL_DIM(KERNEL,dim,FUNC,ARGS)                          \
+  if (dim == 3) FUNC<KERNEL,3> ARGS;                                  \
+  else FUNC<KERNEL,2> ARGS
+
+#define SPH_KERNEL_DISPATCH(kernel,dim,FUNC,ARGS)                     \
+  switch (kernel) {                                                   \
+  case LAMMPS_NS::SPHKernel::LUCY:                                    \
+    SPH_KERNEL_DIM(LAMMPS_NS::SPHKernel::LUCY,dim,FUNC,ARGS); break;  \
+  case LAMMPS_NS::SPHKernel::CUBIC:                                   \
+    SPH_KERNEL_DIM(LAMMPS_NS::SPHKernel::CUBIC,dim,FUNC,ARGS); break; \
+  case LAMMPS_NS::SPHKernel::QUINTIC:                                 \
+    SPH_KERNEL_DIM(LAMMPS_NS::SPHKernel::QUINTIC,dim,FUNC,ARGS);      \
+    break;                                                            \
+  case LAMMPS_NS::SPHKernel::WENDLAND2:                               \
+    SPH_KERNEL_DIM(LAMMPS_NS::SPHKernel::WENDLAND2,dim,FUNC,ARGS);    \
+    break;                                                            \
+  case LAMMPS_NS::SPHKernel::WENDLAND4:                               \
+    SPH_KERNEL_DIM(LAMMPS_NS::SPHKernel::WENDLAND4,dim,FUNC,ARGS);    \
+    break;                                                            \
+  case LAMMPS_NS::SPHKernel::WENDLAND6:                               \
+    SPH_KERNEL_DIM(LAMMPS_NS::SPHKernel::WENDLAND6,dim,FUNC,ARGS);    \
+    break;                                                            \
+  }
+
+#endif
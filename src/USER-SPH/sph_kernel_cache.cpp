@@ -0,0 +1,202 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdlib.h"
+#include "sph_kernel_cache.h"
+#include "atom.h"
+#include "force.h"
+#include "pair.h"
+#include "pair_hybrid.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+/* ----------------------------------------------------------------------
+   list a copy list was made from, copy lists share their pair storage
+------------------------------------------------------------------------- */
+
+static NeighList *root(NeighList *list)
+{
+  while (list->listcopy) list = list->listcopy;
+  return list;
+}
+
+/* ---------------------------------------------------------------------- */
+
+SPHKernelCache::SPHKernelCache(LAMMPS *lmp) : Pointers(lmp)
+{
+  offset = NULL;
+  r = wfd = NULL;
+  list = NULL;
+  kernel = -1;
+  ntypes = 0;
+  cut = NULL;
+  valid = 0;
+  ncalls = -1;
+  maxlocal = maxpair = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+SPHKernelCache::~SPHKernelCache()
+{
+  memory->destroy(offset);
+  memory->destroy(r);
+  memory->destroy(wfd);
+  memory->destroy(cut);
+}
+
+/* ----------------------------------------------------------------------
+   set neighbor list, kernel and cutoffs of the pair style owning the cache
+   cutoffs of pairs without setflag are set to 0.0, so they match no style
+   called every run, so values from a previous run are discarded
+------------------------------------------------------------------------- */
+
+void SPHKernelCache::init(NeighList *ptr, int kernel_one,
+                          int **setflag, double **cut_one)
+{
+  list = ptr;
+  kernel = kernel_one;
+
+  if (atom->ntypes != ntypes) {
+    memory->destroy(cut);
+    ntypes = atom->ntypes;
+    memory->create(cut,ntypes+1,ntypes+1,"sph_kernel_cache:cut");
+  }
+
+  for (int i = 1; i <= ntypes; i++)
+    for (int j = i; j <= ntypes; j++) {
+      if (setflag[i][j]) cut[i][j] = cut_one[i][j];
+      else cut[i][j] = 0.0;
+      cut[j][i] = cut[i][j];
+    }
+
+  valid = 0;
+  ncalls = -1;
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if a pair style with this neighbor list, kernel and cutoffs
+   can use the cached values, 0 if not
+------------------------------------------------------------------------- */
+
+int SPHKernelCache::match(NeighList *ptr, int kernel_one,
+                          int **setflag, double **cut_one)
+{
+  if (list == NULL || root(ptr) != root(list)) return 0;
+  if (kernel_one != kernel) return 0;
+
+  for (int i = 1; i <= ntypes; i++)
+    for (int j = i; j <= ntypes; j++)
+      if (setflag[i][j] && cut_one[i][j] != cut[i][j]) return 0;
+
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   prepare for storing the values of the current force evaluation
+   own = 1 if called by the pair style owning the cache
+     it is computed first in every force evaluation, so it discards the
+     values, atoms may have moved without the timestep or neighbor
+     list changing, e.g. in the line search of a minimization
+   recompute offsets and grow arrays if the neighbor list was rebuilt
+   return 1 if the calling pair style needs to compute and store values,
+     0 if they are current and can be read
+------------------------------------------------------------------------- */
+
+int SPHKernelCache::setup(int own)
+{
+  if (own) valid = 0;
+  else if (valid) return 0;
+  if (ncalls == neighbor->ncalls) return 1;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+
+  if (inum+1 > maxlocal) {
+    maxlocal = atom->nmax + 1;
+    memory->destroy(offset);
+    memory->create(offset,maxlocal,"sph_kernel_cache:offset");
+  }
+
+  int npair = 0;
+  for (int ii = 0; ii < inum; ii++) {
+    offset[ii] = npair;
+    npair += numneigh[ilist[ii]];
+  }
+  offset[inum] = npair;
+
+  if (npair > maxpair) {
+    maxpair = npair + npair/10;
+    memory->destroy(r);
+    memory->destroy(wfd);
+    memory->create(r,maxpair,"sph_kernel_cache:r");
+    memory->create(wfd,maxpair,"sph_kernel_cache:wfd");
+  }
+
+  ncalls = neighbor->ncalls;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   mark values as current, after the pair style that stores them is done
+------------------------------------------------------------------------- */
+
+void SPHKernelCache::validate()
+{
+  valid = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double SPHKernelCache::memory_usage()
+{
+  double bytes = maxlocal * sizeof(int);
+  bytes += 2 * maxpair * sizeof(double);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   return the cache a pair style should use
+   if the style is a sub-style of pair hybrid, use the cache of an earlier
+     sub-style that matches its neighbor list, kernel and cutoffs
+   else use own cache, which is created if necessary
+   sub-styles offer their own cache via extract("sph_kernel_cache")
+------------------------------------------------------------------------- */
+
+SPHKernelCache *SPHKernelCache::find(LAMMPS *lmp, Pair *requestor,
+                                     NeighList *list, int kernel,
+                                     int **setflag, double **cut,
+                                     SPHKernelCache *&own)
+{
+  Pair *pair = lmp->force->pair;
+
+  if (pair != requestor && lmp->force->pair_match("hybrid",0)) {
+    PairHybrid *hybrid = (PairHybrid *) pair;
+    char str[] = "sph_kernel_cache";
+    int dim;
+    for (int m = 0; m < hybrid->nstyles; m++) {
+      if (hybrid->styles[m] == requestor) break;
+      SPHKernelCache *ptr =
+        (SPHKernelCache *) hybrid->styles[m]->extract(str,dim);
+      if (ptr && ptr->match(list,kernel,setflag,cut)) return ptr;
+    }
+  }
+
+  if (own == NULL) own = new SPHKernelCache(lmp);
+  own->init(list,kernel,setflag,cut);
+  return own;
+}
@@ -0,0 +1,63 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   per-pair cache of the distance r and kernel derivative wfd = (dW/dr)/r
+   of the pairs in a half neighbor list, computed once per force evaluation
+   values of pair jj of atom ilist[ii] are at index offset[ii] + jj,
+     i.e. in the same order as firstneigh[ilist[ii]][jj]
+   the pair style owning the cache stores the values of all
+     pairs inside the cutoff, the others read them
+   values of pairs outside the cutoff are undefined
+   SPH sub-styles of pair hybrid that use the same neighbor list,
+     kernel and cutoffs share one cache, see find()
+------------------------------------------------------------------------- */
+
+#ifndef LMP_SPH_KERNEL_CACHE_H
+#define LMP_SPH_KERNEL_CACHE_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class SPHKernelCache : protected Pointers {
+ public:
+  int *offset;                  // index of 1st pair of ilist[ii]
+  double *r;                    // pair distance
+  double *wfd;                  // kernel derivative
+
+  SPHKernelCache(class LAMMPS *);
+  ~SPHKernelCache();
+  void init(class NeighList *, int, int **, double **);
+  int match(class NeighList *, int, int **, double **);
+  int setup(int);
+  void validate();
+  double memory_usage();
+
+  static SPHKernelCache *find(class LAMMPS *, class Pair *, class NeighList *,
+                              int, int **, double **, SPHKernelCache *&);
+
+ private:
+  class NeighList *list;
+  int kernel;
+  int ntypes;
+  double **cut;
+
+  int valid;                    // 1 if values of this force evaluation
+  int ncalls;                   // neighbor build the offsets belong to
+  int maxlocal,maxpair;
+};
+
+}
+
+#endif
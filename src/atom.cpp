@@ -42,6 +42,25 @@ using namespace LAMMPS_NS;
 #define DELTA_MEMSTR 1024
 #define EPSILON 1.0e-6
 #define CUDA_CHUNK 3000
+#define SORTRATIO 1.5
+
+enum{XYZ,MORTON,HILBERT};         // order of sort bins
+
+// curve index of a sort bin and the bin, sorted by qsort()
+
+struct OrderKey {
+  bigint key;
+  int ibin;
+};
+
+static int compare_keys(const void *a, const void *b)
+{
+  const OrderKey *ka = (const OrderKey *) a;
+  const OrderKey *kb = (const OrderKey *) b;
+  if (ka->key < kb->key) return -1;
+  if (ka->key > kb->key) return 1;
+  return 0;
+}
 
 /* ---------------------------------------------------------------------- */
 
@@ -58,9 +77,14 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   firstgroupname = NULL;
   sortfreq = 1000;
   nextsort = 0;
+  sortauto = 0;
+  sortcurve = XYZ;
+  ordercurve = -1;
+  orderx = ordery = orderz = 0;
+  sortdist0 = -1.0;
   userbinsize = 0.0;
   maxbin = maxnext = 0;
-  binhead = NULL;
+  binhead = binorder = NULL;
   next = permute = NULL;
 
   // initialize atom arrays
@@ -85,6 +109,7 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
   e = de = NULL;
   cv = NULL;
   vest = NULL;
+  hsml = gradh = NULL;
 
   maxspecial = 1;
   nspecial = NULL;
@@ -162,6 +187,7 @@ Atom::~Atom()
 
   delete [] firstgroupname;
   memory->destroy(binhead);
+  memory->destroy(binorder);
   memory->destroy(next);
   memory->destroy(permute);
 
@@ -193,6 +219,8 @@ Atom::~Atom()
   memory->destroy(eradius);
   memory->destroy(ervel);
   memory->destroy(erforce);
+  memory->destroy(hsml);
+  memory->destroy(gradh);
 
   memory->destroy(molecule);
 
@@ -419,7 +447,13 @@ void Atom::modify_params(int narg, char **arg)
       iarg += 2;
     } else if (strcmp(arg[iarg],"sort") == 0) {
       if (iarg+3 > narg) error->all(FLERR,"Illegal atom_modify command");
-      sortfreq = atoi(arg[iarg+1]);
+      if (strcmp(arg[iarg+1],"auto") == 0) {
+	sortauto = 1;
+	sortfreq = 1000;
+      } else {
+	sortauto = 0;
+	sortfreq = atoi(arg[iarg+1]);
+      }
       userbinsize = atof(arg[iarg+2]);
       if (sortfreq < 0 || userbinsize < 0.0)
 	error->all(FLERR,"Illegal atom_modify command");
@@ -427,6 +461,13 @@ void Atom::modify_params(int narg, char **arg)
 	error->all(FLERR,"Atom_modify sort and first options "
 		   "cannot be used together");
       iarg += 3;
+    } else if (strcmp(arg[iarg],"curve") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal atom_modify command");
+      if (strcmp(arg[iarg+1],"xyz") == 0) sortcurve = XYZ;
+      else if (strcmp(arg[iarg+1],"morton") == 0) sortcurve = MORTON;
+      else if (strcmp(arg[iarg+1],"hilbert") == 0) sortcurve = HILBERT;
+      else error->all(FLERR,"Illegal atom_modify command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal atom_modify command");
   }
 }
@@ -787,16 +828,16 @@ void Atom::data_atoms(int n, char *buf)
   }
 
   if (domain->xperiodic) {
-    if (comm->myloc[0] == 0) sublo[0] -= EPSILON;
-    if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] += EPSILON;
+    if (comm->mysplit[0][0] == 0.0) sublo[0] -= EPSILON;
+    if (comm->mysplit[0][1] == 1.0) subhi[0] += EPSILON;
   }
   if (domain->yperiodic) {
-    if (comm->myloc[1] == 0) sublo[1] -= EPSILON;
-    if (comm->myloc[1] == comm->procgrid[1]-1) subhi[1] += EPSILON;
+    if (comm->mysplit[1][0] == 0.0) sublo[1] -= EPSILON;
+    if (comm->mysplit[1][1] == 1.0) subhi[1] += EPSILON;
   }
   if (domain->zperiodic) {
-    if (comm->myloc[2] == 0) sublo[2] -= EPSILON;
-    if (comm->myloc[2] == comm->procgrid[2]-1) subhi[2] += EPSILON;
+    if (comm->mysplit[2][0] == 0.0) sublo[2] -= EPSILON;
+    if (comm->mysplit[2][1] == 1.0) subhi[2] += EPSILON;
   }
 
   // xptr = which word in line starts xyz coords
@@ -1343,8 +1384,11 @@ void Atom::sort()
   int i,m,n,ix,iy,iz,ibin,empty;
 
   // set next timestep for sorting to take place
+  // for auto sorting, sort_check() will set it when order has degraded
 
-  nextsort = (update->ntimestep/sortfreq)*sortfreq + sortfreq;
+  if (sortauto) nextsort = MAXBIGINT;
+  else nextsort = (update->ntimestep/sortfreq)*sortfreq + sortfreq;
+  sortdist0 = -1.0;
 
   // download data from GPU if necessary
 
@@ -1390,10 +1434,12 @@ void Atom::sort()
 
   // permute = desired permutation of atoms
   // permute[I] = J means Ith new atom will be Jth old atom
+  // bins are visited in order of the sort curve
 
   n = 0;
   for (m = 0; m < nbins; m++) {
-    i = binhead[m];
+    if (sortcurve == XYZ) i = binhead[m];
+    else i = binhead[binorder[m]];
     while (i >= 0) {
       permute[n++] = i;
       i = next[i];
@@ -1506,9 +1552,106 @@ void Atom::setup_sort_bins()
 
   if (nbins > maxbin) {
     memory->destroy(binhead);
+    memory->destroy(binorder);
     maxbin = nbins;
     memory->create(binhead,maxbin,"atom:binhead");
+    memory->create(binorder,maxbin,"atom:binorder");
+    ordercurve = -1;
   }
+
+  if (sortcurve != XYZ) setup_sort_order();
+}
+
+/* ----------------------------------------------------------------------
+   order sort bins along a Morton (Z-order) or Hilbert curve
+   binorder[M] = bin which is Mth along the curve
+   curve spans 2^b bins in each dim, bins outside my nbin xyz are skipped
+   Hilbert index is from J. Skilling, AIP Conf Proc, 707, 381 (2004)
+------------------------------------------------------------------------- */
+
+void Atom::setup_sort_order()
+{
+  if (ordercurve == sortcurve && orderx == nbinx &&
+      ordery == nbiny && orderz == nbinz) return;
+
+  int dim = domain->dimension;
+  int nmax = MAX(nbinx,nbiny);
+  if (dim == 3) nmax = MAX(nmax,nbinz);
+  int b = 1;
+  while ((1 << b) < nmax) b++;
+  if (dim*b > 62) error->one(FLERR,"Too many atom sorting bins for curve");
+
+  OrderKey *keys = (OrderKey *)
+    memory->smalloc(nbins*sizeof(OrderKey),"atom:keys");
+
+  int ix,iy,iz,i,q,ibin;
+  int c[3];
+  int t,p,mq;
+  bigint key;
+
+  ibin = 0;
+  for (iz = 0; iz < nbinz; iz++)
+    for (iy = 0; iy < nbiny; iy++)
+      for (ix = 0; ix < nbinx; ix++) {
+	c[0] = ix;
+	c[1] = iy;
+	c[2] = iz;
+
+	// transform coords to transposed Hilbert index
+
+	if (sortcurve == HILBERT) {
+	  mq = 1 << (b-1);
+	  for (q = mq; q > 1; q >>= 1) {
+	    p = q - 1;
+	    for (i = 0; i < dim; i++)
+	      if (c[i] & q) c[0] ^= p;
+	      else {
+		t = (c[0] ^ c[i]) & p;
+		c[0] ^= t;
+		c[i] ^= t;
+	      }
+	  }
+	  for (i = 1; i < dim; i++) c[i] ^= c[i-1];
+	  t = 0;
+	  for (q = mq; q > 1; q >>= 1)
+	    if (c[dim-1] & q) t ^= q - 1;
+	  for (i = 0; i < dim; i++) c[i] ^= t;
+	}
+
+	// interleave bits, most significant first
+
+	key = 0;
+	for (q = b-1; q >= 0; q--)
+	  for (i = 0; i < dim; i++)
+	    key = (key << 1) | ((c[i] >> q) & 1);
+
+	keys[ibin].key = key;
+	keys[ibin].ibin = ibin;
+	ibin++;
+      }
+
+  qsort(keys,nbins,sizeof(OrderKey),compare_keys);
+  for (i = 0; i < nbins; i++) binorder[i] = keys[i].ibin;
+  memory->sfree(keys);
+
+  ordercurve = sortcurve;
+  orderx = nbinx;
+  ordery = nbiny;
+  orderz = nbinz;
+}
+
+/* ----------------------------------------------------------------------
+   decide if atoms need sorting, called by Neighbor after each build
+   dist = avg index distance |i-j| of owned neighbor pairs in a pair list
+   1st value after a sort is the reference, sort at next reneighboring
+     once dist has grown by SORTRATIO, since more x[j] will miss the cache
+------------------------------------------------------------------------- */
+
+void Atom::sort_check(double dist)
+{
+  if (sortdist0 < 0.0) sortdist0 = dist;
+  else if (sortdist0 > 0.0 && dist > SORTRATIO*sortdist0)
+    nextsort = update->ntimestep;
 }
 
 /* ----------------------------------------------------------------------
@@ -1638,6 +1781,7 @@ bigint Atom::memory_usage()
     bytes += memory->usage(next,maxnext);
     bytes += memory->usage(permute,maxnext);
   }
+  if (maxbin && sortcurve != XYZ) bytes += memory->usage(binorder,maxbin);
 
   return bytes;
 }
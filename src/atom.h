@@ -60,6 +60,7 @@ class Atom : protected Pointers {
   double *e, *de;
   double **vest;
   double *cv;
+  double *hsml, *gradh;
 
   int **nspecial;               // 0,1,2 = cummulative # of 1-2,1-3,1-4 neighs
   int **special;                // IDs of 1-2,1-3,1-4 neighs of each atom
@@ -116,6 +117,7 @@ class Atom : protected Pointers {
 
   int sortfreq;             // sort atoms every this many steps, 0 = off
   bigint nextsort;          // next timestep to sort on
+  int sortauto;             // 1 if sorting is triggered by sort_check()
 
   // functions
 
@@ -157,6 +159,7 @@ class Atom : protected Pointers {
 
   void first_reorder();
   void sort();
+  void sort_check(double);
 
   void add_callback(int);
   void delete_callback(const char *, int);
@@ -215,6 +218,11 @@ class Atom : protected Pointers {
   int *binhead;                   // 1st atom in each bin
   int *next;                      // next atom in bin
   int *permute;                   // permutation vector
+  int *binorder;                  // bins in order of the sort curve
+  int sortcurve;                  // XYZ, MORTON, HILBERT order of bins
+  int ordercurve;                 // curve and bins binorder was made for
+  int orderx,ordery,orderz;
+  double sortdist0;               // neighbor index distance after last sort
   double userbinsize;             // requested sort bin size
   double bininvx,bininvy,bininvz; // inverse actual bin sizes
   double bboxlo[3],bboxhi[3];     // bounding box of my sub-domain
@@ -223,6 +231,7 @@ class Atom : protected Pointers {
   char *memstr;                   // string of array names already counted
 
   void setup_sort_bins();
+  void setup_sort_order();
 };
 
 }
@@ -0,0 +1,702 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "lmptype.h"
+#include "mpi.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "balance.h"
+#include "atom.h"
+#include "comm.h"
+#include "comm_tiled.h"
+#include "domain.h"
+#include "force.h"
+#include "irregular.h"
+#include "timer.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{UNIFORM,SHIFT,RCB};
+enum{COUNT,TIME};
+
+#define BIG 1.0e20
+#define NBIN 64
+#define NPASS 4
+
+/* ---------------------------------------------------------------------- */
+
+Balance::Balance(LAMMPS *lmp) : Pointers(lmp)
+{
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  atomcost = 1.0;
+  niter = 0;
+  ndim = 0;
+  maxiter = 0;
+  stopthresh = 1.0;
+
+  nmax = 0;
+  target = lo = hi = cut = best = onecost = allcost = NULL;
+  order = NULL;
+  maxatom = 0;
+  agroup = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+Balance::~Balance()
+{
+  memory->destroy(target);
+  memory->destroy(lo);
+  memory->destroy(hi);
+  memory->destroy(cut);
+  memory->destroy(best);
+  memory->destroy(onecost);
+  memory->destroy(allcost);
+  memory->destroy(order);
+  memory->destroy(agroup);
+}
+
+/* ----------------------------------------------------------------------
+   called as balance command in input script
+------------------------------------------------------------------------- */
+
+void Balance::command(int narg, char **arg)
+{
+  if (domain->box_exist == 0) 
+    error->all(FLERR,"Balance command before simulation box is defined");
+  if (narg < 2) error->all(FLERR,"Illegal balance command");
+
+  double thresh = atof(arg[0]);
+  if (thresh < 1.0) error->all(FLERR,"Illegal balance command");
+
+  int style = 0;
+  int iarg = 0;
+  if (strcmp(arg[1],"uniform") == 0) {
+    style = UNIFORM;
+    iarg = 2;
+  } else if (strcmp(arg[1],"shift") == 0) {
+    if (narg < 5) error->all(FLERR,"Illegal balance command");
+    style = SHIFT;
+    shift_setup(arg[2],atoi(arg[3]),atof(arg[4]));
+    iarg = 5;
+  } else if (strcmp(arg[1],"rcb") == 0) {
+    style = RCB;
+    iarg = 2;
+  } else error->all(FLERR,"Illegal balance command");
+
+  int wtflag = COUNT;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"weight") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal balance command");
+      if (strcmp(arg[iarg+1],"count") == 0) wtflag = COUNT;
+      else if (strcmp(arg[iarg+1],"time") == 0) wtflag = TIME;
+      else error->all(FLERR,"Illegal balance command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal balance command");
+  }
+
+  if (force->kspace) 
+    error->all(FLERR,"Cannot use balance command with kspace");
+  if (style == RCB && comm->tiled == 0)
+    error->all(FLERR,"Balance rcb requires comm_style tiled");
+  if (style == RCB && domain->triclinic)
+    error->all(FLERR,"Balance rcb does not yet support triclinic boxes");
+
+  // cost of each atom = pair + neighbor time of previous run on this proc
+  //   divided by its # of atoms, else each atom costs the same
+
+  atomcost = 1.0;
+  if (wtflag == TIME) {
+    double mytime = timer->array[TIME_PAIR] + timer->array[TIME_NEIGHBOR];
+    double alltime;
+    MPI_Allreduce(&mytime,&alltime,1,MPI_DOUBLE,MPI_SUM,world);
+    if (alltime > 0.0) {
+      if (atom->nlocal) atomcost = mytime/atom->nlocal;
+    } else if (me == 0)
+      error->warning(FLERR,"Balance weight time without previous run, "
+		     "using weight count");
+  }
+
+  double maxinit,maxfinal;
+  double imbinit = imbalance_factor(maxinit);
+  double imbfinal = imbinit;
+  maxfinal = maxinit;
+
+  niter = 0;
+  if (style == UNIFORM) {
+    int *procgrid = comm->procgrid;
+    for (int i = 0; i < procgrid[0]; i++) comm->xsplit[i] = i * 1.0/procgrid[0];
+    for (int i = 0; i < procgrid[1]; i++) comm->ysplit[i] = i * 1.0/procgrid[1];
+    for (int i = 0; i < procgrid[2]; i++) comm->zsplit[i] = i * 1.0/procgrid[2];
+    comm->uniform = 1;
+    comm->rcb = 0;
+    imbfinal = imbalance_splits(maxfinal);
+    migrate();
+  } else if (imbinit > thresh) {
+    if (style == SHIFT) shift();
+    else rcb();
+    imbfinal = imbalance_splits(maxfinal);
+    migrate();
+  }
+
+  dumpout(imbinit,imbfinal,maxinit,maxfinal);
+}
+
+/* ----------------------------------------------------------------------
+   set dims to balance and iteration limits for shift()
+   dimstr = any of x,y,z, balanced in the order given
+------------------------------------------------------------------------- */
+
+void Balance::shift_setup(char *dimstr, int nitermax, double thresh)
+{
+  ndim = 0;
+  for (int i = 0; i < strlen(dimstr); i++) {
+    if (ndim == 3) error->all(FLERR,"Illegal balance shift dimensions");
+    if (dimstr[i] == 'x') bdim[ndim] = 0;
+    else if (dimstr[i] == 'y') bdim[ndim] = 1;
+    else if (dimstr[i] == 'z') bdim[ndim] = 2;
+    else error->all(FLERR,"Illegal balance shift dimensions");
+    for (int j = 0; j < ndim; j++)
+      if (bdim[j] == bdim[ndim]) 
+	error->all(FLERR,"Illegal balance shift dimensions");
+    if (bdim[ndim] == 2 && domain->dimension == 2)
+      error->all(FLERR,"Cannot balance in z for 2d simulation");
+    ndim++;
+  }
+
+  maxiter = nitermax;
+  stopthresh = thresh;
+  if (maxiter < 1 || stopthresh < 1.0)
+    error->all(FLERR,"Illegal balance shift parameters");
+}
+
+/* ----------------------------------------------------------------------
+   imbalance factor = max cost on any proc / average cost per proc
+   also return max cost on any proc
+------------------------------------------------------------------------- */
+
+double Balance::imbalance_factor(double &maxcost)
+{
+  double mycost = atomcost*atom->nlocal;
+  double totalcost;
+  MPI_Allreduce(&mycost,&maxcost,1,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(&mycost,&totalcost,1,MPI_DOUBLE,MPI_SUM,world);
+
+  double imbalance = 1.0;
+  if (totalcost > 0.0) imbalance = maxcost * nprocs / totalcost;
+  return imbalance;
+}
+
+/* ----------------------------------------------------------------------
+   imbalance factor and max cost for sub-domains set by comm xyz split
+     or RCB tiles, before atoms are migrated to them
+   each atom keeps the cost assigned on its current proc
+------------------------------------------------------------------------- */
+
+double Balance::imbalance_splits(double &maxcost)
+{
+  int *procgrid = comm->procgrid;
+  int ***grid2proc = comm->grid2proc;
+  double *boxlo = domain->boxlo;
+  double *prd = domain->prd;
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+  int triclinic = domain->triclinic;
+
+  double *proccost = new double[nprocs];
+  double *allproccost = new double[nprocs];
+  for (int i = 0; i < nprocs; i++) proccost[i] = 0.0;
+
+  double lamda[3];
+  int ix,iy,iz;
+  for (int i = 0; i < nlocal; i++) {
+    if (triclinic) domain->x2lamda(x[i],lamda);
+    else {
+      lamda[0] = (x[i][0] - boxlo[0]) / prd[0];
+      lamda[1] = (x[i][1] - boxlo[1]) / prd[1];
+      lamda[2] = (x[i][2] - boxlo[2]) / prd[2];
+    }
+    if (comm->rcb) {
+      proccost[((CommTiled *) comm)->point2proc(lamda)] += atomcost;
+      continue;
+    }
+    ix = binary(lamda[0],procgrid[0],comm->xsplit);
+    iy = binary(lamda[1],procgrid[1],comm->ysplit);
+    iz = binary(lamda[2],procgrid[2],comm->zsplit);
+    proccost[grid2proc[ix][iy][iz]] += atomcost;
+  }
+
+  MPI_Allreduce(proccost,allproccost,nprocs,MPI_DOUBLE,MPI_SUM,world);
+
+  double totalcost = 0.0;
+  maxcost = 0.0;
+  for (int i = 0; i < nprocs; i++) {
+    totalcost += allproccost[i];
+    maxcost = MAX(maxcost,allproccost[i]);
+  }
+
+  delete [] proccost;
+  delete [] allproccost;
+
+  double imbalance = 1.0;
+  if (totalcost > 0.0) imbalance = maxcost * nprocs / totalcost;
+  return imbalance;
+}
+
+/* ----------------------------------------------------------------------
+   move sub-domain cuts in each balanced dim so that each slab of procs
+     between two cuts holds an equal share of the total atom cost
+   cuts are set in comm xyz split, atoms are not moved
+------------------------------------------------------------------------- */
+
+void Balance::shift()
+{
+  int *procgrid = comm->procgrid;
+  int n = MAX(procgrid[0],procgrid[1]);
+  n = MAX(n,procgrid[2]) + 1;
+
+  if (n > nmax) {
+    nmax = n;
+    memory->destroy(target);
+    memory->destroy(lo);
+    memory->destroy(hi);
+    memory->destroy(cut);
+    memory->destroy(best);
+    memory->destroy(onecost);
+    memory->destroy(allcost);
+    memory->destroy(order);
+    memory->create(target,nmax,"balance:target");
+    memory->create(lo,nmax,"balance:lo");
+    memory->create(hi,nmax,"balance:hi");
+    memory->create(cut,nmax,"balance:cut");
+    memory->create(best,nmax,"balance:best");
+    memory->create(onecost,nmax,"balance:onecost");
+    memory->create(allcost,nmax,"balance:allcost");
+    memory->create(order,nmax,"balance:order");
+  }
+
+  niter = 0;
+  for (int idim = 0; idim < ndim; idim++) {
+    int dim = bdim[idim];
+    if (procgrid[dim] == 1) continue;
+    if (dim == 0) shift_dim(dim,procgrid[dim],comm->xsplit);
+    else if (dim == 1) shift_dim(dim,procgrid[dim],comm->ysplit);
+    else shift_dim(dim,procgrid[dim],comm->zsplit);
+    comm->uniform = 0;
+  }
+  comm->rcb = 0;
+}
+
+/* ----------------------------------------------------------------------
+   recursive coordinate bisection of the box into one tile per proc
+   a group of n procs is cut across its longest dim into groups of
+     n/2 and n - n/2 procs, so the cost on each side is proportional
+   all groups of a level are cut together, each cut is found by NPASS
+     histogram passes of NBIN bins with one Allreduce per pass
+   resulting cut tree and tiles are stored in comm, atoms are not moved
+------------------------------------------------------------------------- */
+
+void Balance::rcb()
+{
+  int i,j,g,b,pass,dim;
+  double lamda[3];
+
+  CommTiled *ctiled = (CommTiled *) comm;
+  ctiled->allocate_rcb();
+  int *rcbdim = ctiled->rcbdim;
+  double *rcbcut = ctiled->rcbcut;
+  double **rcbbox = ctiled->rcbbox;
+
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+  double *boxlo = domain->boxlo;
+  double *prd = domain->prd;
+  int dimension = domain->dimension;
+
+  if (nlocal > maxatom) {
+    maxatom = atom->nmax;
+    memory->destroy(agroup);
+    memory->create(agroup,maxatom,"balance:agroup");
+  }
+
+  // groups of procs, one per proc at the last level
+  // group g = procs glo[g] to glo[g]+gnum[g]-1 with fractional box gbox[g]
+
+  int *glo = new int[nprocs];
+  int *gnum = new int[nprocs];
+  int *gdim = new int[nprocs];
+  double **gbox;
+  memory->create(gbox,nprocs,6,"balance:gbox");
+  double *glo_cut = new double[nprocs];
+  double *ghi_cut = new double[nprocs];
+  double *gbelow = new double[nprocs];
+  double *gtarget = new double[nprocs];
+  double *mybin,*allbin;
+  memory->create(mybin,nprocs*NBIN,"balance:mybin");
+  memory->create(allbin,nprocs*NBIN,"balance:allbin");
+
+  int ngroup = 1;
+  glo[0] = 0;
+  gnum[0] = nprocs;
+  for (i = 0; i < 3; i++) {
+    gbox[0][i] = 0.0;
+    gbox[0][3+i] = 1.0;
+  }
+  for (i = 0; i < nlocal; i++) agroup[i] = 0;
+
+  niter = 0;
+
+  while (ngroup < nprocs) {
+
+    // each group with more than one proc is cut across its longest dim
+    // bracket of the cut starts as the extent of the group's box
+
+    for (g = 0; g < ngroup; g++) {
+      if (gnum[g] == 1) continue;
+      dim = 0;
+      for (i = 1; i < dimension; i++)
+	if ((gbox[g][3+i]-gbox[g][i])*prd[i] > 
+	    (gbox[g][3+dim]-gbox[g][dim])*prd[dim]) dim = i;
+      gdim[g] = dim;
+      glo_cut[g] = gbox[g][dim];
+      ghi_cut[g] = gbox[g][3+dim];
+      gbelow[g] = 0.0;
+    }
+
+    for (pass = 0; pass < NPASS; pass++) {
+
+      // histogram cost of atoms in current bracket of each group's cut
+      // on 1st pass, atoms round-off outside the group's box go to end bins
+
+      for (j = 0; j < ngroup*NBIN; j++) mybin[j] = 0.0;
+
+      for (i = 0; i < nlocal; i++) {
+	g = agroup[i];
+	if (gnum[g] == 1 || glo_cut[g] == ghi_cut[g]) continue;
+	dim = gdim[g];
+	lamda[dim] = (x[i][dim]-boxlo[dim]) / prd[dim];
+	b = static_cast<int> (NBIN * (lamda[dim]-glo_cut[g]) / 
+			      (ghi_cut[g]-glo_cut[g]));
+	if (pass == 0) {
+	  b = MAX(b,0);
+	  b = MIN(b,NBIN-1);
+	} else if (lamda[dim] < glo_cut[g] || lamda[dim] >= ghi_cut[g]) continue;
+	else b = MIN(b,NBIN-1);
+	mybin[g*NBIN+b] += atomcost;
+      }
+
+      MPI_Allreduce(mybin,allbin,ngroup*NBIN,MPI_DOUBLE,MPI_SUM,world);
+      niter++;
+
+      // narrow each bracket to the bin where cost crosses its target
+      // groups with no cost are cut geometrically
+
+      for (g = 0; g < ngroup; g++) {
+	if (gnum[g] == 1) continue;
+	double *bin = &allbin[g*NBIN];
+	if (pass == 0) {
+	  double total = 0.0;
+	  for (b = 0; b < NBIN; b++) total += bin[b];
+	  gtarget[g] = total * (gnum[g]/2) / gnum[g];
+	  if (total == 0.0) {
+	    double mid = glo_cut[g] + 
+	      (ghi_cut[g]-glo_cut[g]) * (gnum[g]/2) / gnum[g];
+	    glo_cut[g] = ghi_cut[g] = mid;
+	    continue;
+	  }
+	}
+	if (glo_cut[g] == ghi_cut[g]) continue;
+
+	double width = (ghi_cut[g]-glo_cut[g]) / NBIN;
+	double sum = gbelow[g];
+	for (b = 0; b < NBIN-1; b++) {
+	  if (sum + bin[b] >= gtarget[g]) break;
+	  sum += bin[b];
+	}
+	gbelow[g] = sum;
+	glo_cut[g] += b*width;
+	ghi_cut[g] = glo_cut[g] + width;
+      }
+    }
+
+    // split each group at the middle of its final bracket
+    // upper half of group g becomes a new group appended to the list
+
+    int nnew = ngroup;
+    int *gnew = new int[ngroup];
+    for (g = 0; g < ngroup; g++) {
+      gnew[g] = -1;
+      if (gnum[g] == 1) continue;
+      int n1 = gnum[g]/2;
+      double onecut = 0.5*(glo_cut[g]+ghi_cut[g]);
+      dim = gdim[g];
+
+      glo[nnew] = glo[g] + n1;
+      gnum[nnew] = gnum[g] - n1;
+      for (i = 0; i < 6; i++) gbox[nnew][i] = gbox[g][i];
+      gbox[nnew][dim] = onecut;
+      gbox[g][3+dim] = onecut;
+      gnum[g] = n1;
+
+      rcbdim[glo[nnew]] = dim;
+      rcbcut[glo[nnew]] = onecut;
+      glo_cut[g] = onecut;
+      gnew[g] = nnew++;
+    }
+
+    for (i = 0; i < nlocal; i++) {
+      g = agroup[i];
+      if (gnew[g] < 0) continue;
+      dim = gdim[g];
+      if ((x[i][dim]-boxlo[dim]) / prd[dim] >= glo_cut[g]) agroup[i] = gnew[g];
+    }
+
+    delete [] gnew;
+    ngroup = nnew;
+  }
+
+  // tile of each proc = box of the group it ended up as
+
+  for (g = 0; g < ngroup; g++)
+    for (i = 0; i < 6; i++) rcbbox[glo[g]][i] = gbox[g][i];
+
+  comm->rcb = 1;
+  comm->uniform = 0;
+
+  delete [] glo;
+  delete [] gnum;
+  delete [] gdim;
+  memory->destroy(gbox);
+  delete [] glo_cut;
+  delete [] ghi_cut;
+  delete [] gbelow;
+  delete [] gtarget;
+  memory->destroy(mybin);
+  memory->destroy(allbin);
+}
+
+/* ----------------------------------------------------------------------
+   balance one dim with n slabs, split = n+1 fractional bounds
+   each cut is bisected between the closest cuts evaluated so far
+     whose cost below is smaller or not smaller than its target,
+   all cuts are tallied together with one Allreduce per iteration
+   keep the best of all evaluated sets of cuts, starting with current one
+   return imbalance factor of slabs in this dim
+------------------------------------------------------------------------- */
+
+double Balance::shift_dim(int dim, int n, double *split)
+{
+  int i,j,iter;
+
+  double mycost = atomcost*atom->nlocal;
+  double totalcost;
+  MPI_Allreduce(&mycost,&totalcost,1,MPI_DOUBLE,MPI_SUM,world);
+  if (totalcost == 0.0) return 1.0;
+
+  for (i = 1; i < n; i++) {
+    target[i] = totalcost * i / n;
+    lo[i] = 0.0;
+    hi[i] = 1.0;
+    cut[i] = split[i];
+  }
+
+  double imbalance,slab;
+  double bestimb = BIG;
+
+  for (iter = 0; iter <= maxiter; iter++) {
+
+    // allcost[i] = cost of atoms below cut[i]
+    // order = cut indices in ascending order of cuts
+
+    tally(dim,n,cut,allcost);
+
+    imbalance = 0.0;
+    for (j = 0; j < n; j++) {
+      if (j == 0) slab = allcost[order[0]];
+      else if (j == n-1) slab = totalcost - allcost[order[n-2]];
+      else slab = allcost[order[j]] - allcost[order[j-1]];
+      imbalance = MAX(imbalance,slab);
+    }
+    imbalance *= n/totalcost;
+
+    if (imbalance < bestimb) {
+      bestimb = imbalance;
+      for (j = 0; j < n-1; j++) best[j+1] = cut[order[j]];
+    }
+    if (bestimb <= stopthresh || iter == maxiter) break;
+
+    // tighten bracket of each cut with all evaluated cuts, then bisect
+
+    for (i = 1; i < n; i++) {
+      for (j = 1; j < n; j++) {
+	if (allcost[j] < target[i]) lo[i] = MAX(lo[i],cut[j]);
+	else hi[i] = MIN(hi[i],cut[j]);
+      }
+    }
+    for (i = 1; i < n; i++) cut[i] = 0.5*(lo[i]+hi[i]);
+  }
+
+  niter += iter;
+  for (i = 1; i < n; i++) split[i] = best[i];
+  return bestimb;
+}
+
+/* ----------------------------------------------------------------------
+   sum cost of atoms below each of the n-1 cuts in dim
+   cuts may be in any order, order[] is set to ascending order
+   atoms are binned between sorted cuts, then summed across procs
+------------------------------------------------------------------------- */
+
+void Balance::tally(int dim, int n, double *cuts, double *sum)
+{
+  int i,j,k,m,mid;
+  double coord,lamda[3];
+
+  // insertion sort of cut indices 1 to n-1
+
+  for (i = 0; i < n-1; i++) {
+    k = i+1;
+    for (j = i; j > 0 && cuts[order[j-1]] > cuts[k]; j--)
+      order[j] = order[j-1];
+    order[j] = k;
+  }
+
+  for (j = 0; j < n; j++) onecost[j] = 0.0;
+
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+  int triclinic = domain->triclinic;
+  double boxlo = domain->boxlo[dim];
+  double prd = domain->prd[dim];
+
+  for (i = 0; i < nlocal; i++) {
+    if (triclinic) {
+      domain->x2lamda(x[i],lamda);
+      coord = lamda[dim];
+    } else coord = (x[i][dim] - boxlo) / prd;
+
+    // m = # of sorted cuts <= coord
+
+    k = 0;
+    m = n-1;
+    while (k < m) {
+      mid = (k+m) / 2;
+      if (coord < cuts[order[mid]]) m = mid;
+      else k = mid+1;
+    }
+    onecost[k] += atomcost;
+  }
+
+  MPI_Allreduce(onecost,allcost,n,MPI_DOUBLE,MPI_SUM,world);
+
+  double cum = 0.0;
+  for (j = 0; j < n-1; j++) {
+    cum += allcost[j];
+    onecost[order[j]] = cum;
+  }
+  for (j = 0; j < n-1; j++) sum[order[j]] = onecost[order[j]];
+}
+
+/* ----------------------------------------------------------------------
+   index i of slab with split[i] <= value < split[i+1]
+   split = n+1 ascending bounds, values outside map to 1st or last
+------------------------------------------------------------------------- */
+
+int Balance::binary(double value, int n, double *split)
+{
+  int lo = 0;
+  int hi = n;
+  while (hi - lo > 1) {
+    int mid = (lo+hi) / 2;
+    if (value < split[mid]) hi = mid;
+    else lo = mid;
+  }
+  return lo;
+}
+
+/* ----------------------------------------------------------------------
+   reset sub-domain bounds from comm xyz split or RCB tiles and
+     move atoms to their new procs
+   atoms are in box coords before and after
+------------------------------------------------------------------------- */
+
+void Balance::migrate()
+{
+  comm->set_mysplit();
+  if (domain->triclinic) domain->set_lamda_box();
+  domain->set_local_box();
+
+  double **x = atom->x;
+  int *image = atom->image;
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) domain->remap(x[i],image[i]);
+
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  domain->reset_box();
+  Irregular *irregular = new Irregular(lmp);
+  irregular->migrate_atoms();
+  delete irregular;
+  if (domain->triclinic) domain->lamda2x(atom->nlocal);
+
+  // check if any atoms were lost
+
+  bigint natoms;
+  bigint nblocal = atom->nlocal;
+  MPI_Allreduce(&nblocal,&natoms,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  if (natoms != atom->natoms) {
+    char str[128];
+    sprintf(str,"Lost atoms via balance: original " BIGINT_FORMAT 
+	    " current " BIGINT_FORMAT,atom->natoms,natoms);
+    error->all(FLERR,str);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   print balancing statistics and resulting cuts to screen and logfile
+------------------------------------------------------------------------- */
+
+void Balance::dumpout(double imbinit, double imbfinal,
+		      double maxinit, double maxfinal)
+{
+  if (me) return;
+
+  FILE *fp[2];
+  fp[0] = screen;
+  fp[1] = logfile;
+  int *procgrid = comm->procgrid;
+  double *split[3];
+  split[0] = comm->xsplit;
+  split[1] = comm->ysplit;
+  split[2] = comm->zsplit;
+  const char *name[3] = {"x","y","z"};
+
+  for (int m = 0; m < 2; m++) {
+    if (fp[m] == NULL) continue;
+    fprintf(fp[m],"  iteration count = %d\n",niter);
+    fprintf(fp[m],"  initial/final max load/proc = %g %g\n",maxinit,maxfinal);
+    fprintf(fp[m],"  initial/final imbalance factor = %g %g\n",
+	    imbinit,imbfinal);
+    if (comm->rcb) continue;
+    for (int dim = 0; dim < domain->dimension; dim++) {
+      fprintf(fp[m],"  %s cuts:",name[dim]);
+      for (int i = 0; i <= procgrid[dim]; i++)
+	fprintf(fp[m]," %g",split[dim][i]);
+      fprintf(fp[m],"\n");
+    }
+  }
+}
@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMMAND_CLASS
+
+CommandStyle(balance,Balance)
+
+#else
+
+#ifndef LMP_BALANCE_H
+#define LMP_BALANCE_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class Balance : protected Pointers {
+ public:
+  double atomcost;                 // cost of each owned atom
+  int niter;                       // iterations used by last shift()
+
+  Balance(class LAMMPS *);
+  ~Balance();
+  void command(int, char **);
+  void shift_setup(char *, int, double);
+  double imbalance_factor(double &);
+  double imbalance_splits(double &);
+  void shift();
+  void rcb();
+  void migrate();
+  void dumpout(double, double, double, double);
+
+ private:
+  int me,nprocs;
+  int ndim;                        // # of dims to balance, in bdim order
+  int bdim[3];                     // dims to balance, 0,1,2 = x,y,z
+  int maxiter;                     // max iterations per dim
+  double stopthresh;               // stop when dim imbalance is below this
+
+  int nmax;                        // size of per-split arrays
+  double *target,*lo,*hi,*cut,*best;
+  double *onecost,*allcost;
+  int *order;
+
+  int maxatom;                     // size of per-atom RCB group index
+  int *agroup;
+
+  double shift_dim(int, int, double *);
+  void tally(int, int, double *, double *);
+  int binary(double, int, double *);
+};
+
+}
+
+#endif
+#endif
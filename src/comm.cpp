@@ -61,6 +61,11 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
 
   user_procgrid[0] = user_procgrid[1] = user_procgrid[2] = 0;
   grid2proc = NULL;
+  uniform = 1;
+  xsplit = ysplit = zsplit = NULL;
+  tiled = 0;
+  rcb = 0;
+  overlap = 0;
 
   bordergroup = 0;
   style = SINGLE;
@@ -68,6 +73,11 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
   cutghostmulti = NULL;
   cutghostuser = 0.0;
   ghost_velocity = 0;
+  dimorder[0] = 0;
+  dimorder[1] = 1;
+  dimorder[2] = 2;
+  le_image = NULL;
+  maxle_image = 0;
 
   // use of OpenMP threads
   // query OpenMP for number of threads/process set by user at run-time
@@ -111,6 +121,9 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
 Comm::~Comm()
 {
   if (grid2proc) memory->destroy(grid2proc);
+  delete [] xsplit;
+  delete [] ysplit;
+  delete [] zsplit;
 
   free_swap();
   if (style == MULTI) {
@@ -124,6 +137,7 @@ Comm::~Comm()
 
   memory->destroy(buf_send);
   memory->destroy(buf_recv);
+  memory->destroy(le_image);
 }
 
 /* ----------------------------------------------------------------------
@@ -169,6 +183,24 @@ void Comm::set_procs()
 
   MPI_Comm_free(&cartesian);
 
+  // sub-domains are uniform until changed by the balance command
+  // xyz split = fractional bounds of sub-domains in each dim
+
+  uniform = 1;
+  delete [] xsplit;
+  delete [] ysplit;
+  delete [] zsplit;
+  xsplit = new double[procgrid[0]+1];
+  ysplit = new double[procgrid[1]+1];
+  zsplit = new double[procgrid[2]+1];
+
+  for (i = 0; i < procgrid[0]; i++) xsplit[i] = i * 1.0/procgrid[0];
+  for (i = 0; i < procgrid[1]; i++) ysplit[i] = i * 1.0/procgrid[1];
+  for (i = 0; i < procgrid[2]; i++) zsplit[i] = i * 1.0/procgrid[2];
+  xsplit[procgrid[0]] = ysplit[procgrid[1]] = zsplit[procgrid[2]] = 1.0;
+  rcb = 0;
+  set_mysplit();
+
   // set lamda box params after procs are assigned
 
   if (domain->triclinic) domain->set_lamda_box();
@@ -232,6 +264,21 @@ void Comm::init()
 
   if (force->newton == 0) maxreverse = 0;
 
+  // Lees-Edwards ghosts are shifted in x after the y swaps,
+  //   this requires that the y swaps are done 1st and see the whole x range
+
+  if (domain->le_flag) {
+    if (procgrid[0] != 1)
+      error->all(FLERR,"Fix lees/edwards requires 1 processor in x");
+    if (domain->yperiodic == 0)
+      error->all(FLERR,"Fix lees/edwards requires periodic y boundaries");
+    dimorder[0] = 1;
+    dimorder[1] = 0;
+  } else {
+    dimorder[0] = 0;
+    dimorder[1] = 1;
+  }
+
   // memory for multi-style communication
 
   if (style == MULTI && multilo == NULL) {
@@ -305,11 +352,19 @@ void Comm::setup()
   }
 
   // need = # of procs I need atoms from in each dim based on max cutoff
+  // for non-uniform sub-domains, max over all procs and both directions,
+  //   so all procs perform the same swaps
   // for 2d, don't communicate in z
 
-  need[0] = static_cast<int> (cutghost[0] * procgrid[0] / prd[0]) + 1;
-  need[1] = static_cast<int> (cutghost[1] * procgrid[1] / prd[1]) + 1;
-  need[2] = static_cast<int> (cutghost[2] * procgrid[2] / prd[2]) + 1;
+  if (uniform) {
+    need[0] = static_cast<int> (cutghost[0] * procgrid[0] / prd[0]) + 1;
+    need[1] = static_cast<int> (cutghost[1] * procgrid[1] / prd[1]) + 1;
+    need[2] = static_cast<int> (cutghost[2] * procgrid[2] / prd[2]) + 1;
+  } else {
+    need[0] = need_split(procgrid[0],xsplit,cutghost[0]/prd[0]);
+    need[1] = need_split(procgrid[1],ysplit,cutghost[1]/prd[1]);
+    need[2] = need_split(procgrid[2],zsplit,cutghost[2]/prd[2]);
+  }
   if (domain->dimension == 2) need[2] = 0;
 
   // if non-periodic, do not communicate further than procgrid-1 away
@@ -344,10 +399,11 @@ void Comm::setup()
   // 1st part of if statement is sending to the west/south/down
   // 2nd part of if statement is sending to the east/north/up
 
-  int dim,ineed;
+  int idim,dim,ineed;
 
   int iswap = 0;
-  for (dim = 0; dim < 3; dim++) {
+  for (idim = 0; idim < 3; idim++) {
+    dim = dimorder[idim];
     for (ineed = 0; ineed < 2*need[dim]; ineed++) {
       pbc_flag[iswap] = 0;
       pbc[iswap][0] = pbc[iswap][1] = pbc[iswap][2] =
@@ -419,6 +475,36 @@ void Comm::setup()
   }
 }
 
+/* ----------------------------------------------------------------------
+   # of procs away in one dim whose atoms are needed within cutoff cut
+   split = n+1 fractional bounds of sub-domains, cut is also fractional
+   max over all procs and both directions, wrapping around periodically
+   as for uniform grid, a neighbor exactly cut away is still included
+------------------------------------------------------------------------- */
+
+int Comm::need_split(int n, double *split, double cut)
+{
+  int i,k,m,nmax;
+  double sum;
+
+  nmax = 1;
+  for (i = 0; i < n; i++) {
+    sum = 0.0;
+    for (k = 1; sum <= cut; k++) {
+      m = (i+k) % n;
+      sum += split[m+1] - split[m];
+    }
+    nmax = MAX(nmax,k-1);
+    sum = 0.0;
+    for (k = 1; sum <= cut; k++) {
+      m = ((i-k) % n + n) % n;
+      sum += split[m+1] - split[m];
+    }
+    nmax = MAX(nmax,k-1);
+  }
+  return nmax;
+}
+
 /* ----------------------------------------------------------------------
    forward communication of atom coords every timestep
    other per-atom attributes may also be sent via pack/unpack routines
@@ -482,6 +568,8 @@ void Comm::forward_comm(int dummy)
 	avec->unpack_comm(recvnum[iswap],firstrecv[iswap],buf_send);
       }
     }
+
+    if (domain->le_flag && pbc[iswap][1]) le_shift(iswap,0);
   }
 }
 
@@ -535,6 +623,22 @@ void Comm::reverse_comm()
   }
 }
 
+/* ----------------------------------------------------------------------
+   split forward/reverse comm, so work can be done while messages are sent
+   brick swaps pass on ghosts received in earlier swaps, so the whole
+     comm is done in start and finish does nothing
+------------------------------------------------------------------------- */
+
+void Comm::forward_comm_start()
+{
+  forward_comm();
+}
+
+void Comm::reverse_comm_start()
+{
+  reverse_comm();
+}
+
 /* ----------------------------------------------------------------------
    exchange: move atoms to correct processors
    atoms exchanged with all 6 stencil neighbors
@@ -657,7 +761,7 @@ void Comm::exchange()
 
 void Comm::borders()
 {
-  int i,n,itype,iswap,dim,ineed,maxneed,smax,rmax;
+  int i,n,itype,iswap,idim,dim,ineed,maxneed,smax,rmax;
   int nsend,nrecv,nfirst,nlast,ngroup;
   double lo,hi;
   int *type;
@@ -677,7 +781,8 @@ void Comm::borders()
   iswap = 0;
   smax = rmax = 0;
 
-  for (dim = 0; dim < 3; dim++) {
+  for (idim = 0; idim < 3; idim++) {
+    dim = dimorder[idim];
     nlast = 0;
     maxneed = 2*need[dim];
     for (ineed = 0; ineed < maxneed; ineed++) {
@@ -806,6 +911,7 @@ void Comm::borders()
       size_reverse_recv[iswap] = nsend*size_reverse;
       firstrecv[iswap] = atom->nlocal + atom->nghost;
       atom->nghost += nrecv;
+      if (domain->le_flag && pbc[iswap][1]) le_shift(iswap,1);
       iswap++;
     }
   }
@@ -1211,6 +1317,61 @@ void Comm::cross(double ax, double ay, double az,
   cz = ax*by - ay*bx;
 }
 
+/* ----------------------------------------------------------------------
+   Lees-Edwards shift of the ghosts received in a swap across y boundary
+   the image above the box is shifted by le_offset in x and moves with
+     le_vshear, the image below by the opposite amounts
+   border = 1: called from borders(), wrap shifted x into the box and
+     store the x image of each ghost in le_image
+   border = 0: called from forward_comm(), shift by the current offset
+     and the stored image, so ghosts move continuously between borders()
+   v and vest are only shifted if they were part of the communication
+------------------------------------------------------------------------- */
+
+void Comm::le_shift(int iswap, int border)
+{
+  int i,k;
+
+  double **x = atom->x;
+  double **v = atom->v;
+  double **vest = atom->vest;
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+  int first = firstrecv[iswap];
+  int last = first + recvnum[iswap];
+
+  int sign = pbc[iswap][1];
+  double xprd = domain->xprd;
+  double shift = sign*domain->le_offset;
+  int nwrap = sign*domain->le_nwrap;
+
+  if (border) {
+    if (last-nlocal > maxle_image) {
+      maxle_image = static_cast<int> (BUFFACTOR * (last-nlocal));
+      memory->grow(le_image,maxle_image,"comm:le_image");
+    }
+    double xlo = domain->boxlo[0];
+    for (i = first; i < last; i++) {
+      x[i][0] += shift;
+      k = static_cast<int> (floor((x[i][0]-xlo)/xprd));
+      x[i][0] -= k*xprd;
+      le_image[i-nlocal] = k + nwrap;
+    }
+  } else {
+    for (i = first; i < last; i++)
+      x[i][0] += shift - (le_image[i-nlocal] - nwrap)*xprd;
+  }
+
+  int groupbit = domain->le_groupbit;
+  double dv = sign*domain->le_vshear;
+  if (ghost_velocity) 
+    for (i = first; i < last; i++)
+      if (mask[i] & groupbit) v[i][0] += dv;
+  if (atom->vest_flag && (border || !comm_x_only))
+    for (i = first; i < last; i++)
+      if (mask[i] & groupbit) vest[i][0] += dv;
+}
+
 /* ----------------------------------------------------------------------
    realloc the size of the send buffer as needed with BUFFACTOR & BUFEXTRA 
    if flag = 1, realloc
@@ -1367,10 +1528,47 @@ void Comm::set(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) ghost_velocity = 0;
       else error->all(FLERR,"Illegal communicate command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"overlap") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal communicate command");
+      if (strcmp(arg[iarg+1],"yes") == 0) overlap = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) overlap = 0;
+      else error->all(FLERR,"Illegal communicate command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal communicate command");
   }
 }
 
+/* ----------------------------------------------------------------------
+   set fractional bounds of my sub-domain from the xyz split of the grid
+------------------------------------------------------------------------- */
+
+void Comm::set_mysplit()
+{
+  mysplit[0][0] = xsplit[myloc[0]];
+  mysplit[0][1] = xsplit[myloc[0]+1];
+  mysplit[1][0] = ysplit[myloc[1]];
+  mysplit[1][1] = ysplit[myloc[1]+1];
+  mysplit[2][0] = zsplit[myloc[2]];
+  mysplit[2][1] = zsplit[myloc[2]+1];
+}
+
+/* ----------------------------------------------------------------------
+   copy settings made by user commands from comm being replaced
+   called by comm_style before the box exists, so no grid is copied
+------------------------------------------------------------------------- */
+
+void Comm::copy_settings(Comm *old)
+{
+  user_procgrid[0] = old->user_procgrid[0];
+  user_procgrid[1] = old->user_procgrid[1];
+  user_procgrid[2] = old->user_procgrid[2];
+  ghost_velocity = old->ghost_velocity;
+  overlap = old->overlap;
+  cutghostuser = old->cutghostuser;
+  bordergroup = old->bordergroup;
+  style = old->style;
+}
+
 /* ----------------------------------------------------------------------
    return # of bytes of allocated memory 
 ------------------------------------------------------------------------- */
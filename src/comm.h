@@ -30,6 +30,12 @@ class Comm : protected Pointers {
   double cutghostuser;              // user-specified ghost cutoff
   int ***grid2proc;                 // which proc owns i,j,k loc in 3d grid
   int nthreads;                     // OpenMP threads per MPI process
+  int uniform;                      // 1 = equal sub-domains, 0 = balanced
+  double *xsplit,*ysplit,*zsplit;   // fractional (0-1) sub-domain bounds
+  int tiled;                        // 1 if comm supports non-brick tiles
+  int rcb;                          // 1 if sub-domains are RCB tiles
+  double mysplit[3][2];             // fractional bounds of my sub-domain
+  int overlap;                      // 1 to overlap comm with pair compute
 
   Comm(class LAMMPS *);
   virtual ~Comm();
@@ -39,6 +45,10 @@ class Comm : protected Pointers {
   virtual void setup();                     // setup 3d communication pattern
   virtual void forward_comm(int dummy = 0); // forward communication of atom coords
   virtual void reverse_comm();              // reverse communication of forces
+  virtual void forward_comm_start();        // post forward comm, no wait
+  virtual void forward_comm_finish() {}     // complete posted forward comm
+  virtual void reverse_comm_start();        // post reverse comm, no wait
+  virtual void reverse_comm_finish() {}     // complete posted reverse comm
   virtual void exchange();                  // move atoms to new procs
   virtual void borders();                   // setup list of atoms to communicate
 
@@ -52,6 +62,8 @@ class Comm : protected Pointers {
   virtual void reverse_comm_dump(class Dump *);    // reverse comm from a Dump
 
   virtual void set(int, char **);           // set communication style
+  virtual void set_mysplit();               // set mysplit from xyz split
+  void copy_settings(Comm *);               // copy user settings of old comm
   virtual bigint memory_usage();
 
  protected:
@@ -76,6 +88,9 @@ class Comm : protected Pointers {
   int comm_x_only,comm_f_only;      // 1 if only exchange x,f in for/rev comm
   int map_style;                    // non-0 if global->local mapping is done
   int bordergroup;                  // only communicate this group in borders
+  int dimorder[3];                  // order of dims in swaps, y 1st for L-E
+  int *le_image;                    // x image of ghosts shifted by L-E
+  int maxle_image;                  // size of le_image
 
   int *firstrecv;                   // where to put 1st recv atom in each swap
   int **sendlist;                   // list of atoms to send in each swap
@@ -87,6 +102,7 @@ class Comm : protected Pointers {
   int maxforward,maxreverse;        // max # of datums in forward/reverse comm
 
   virtual void procs2box();                 // map procs to 3d box
+  int need_split(int, double *, double);    // swaps needed for split bounds
   virtual void cross(double, double, double,
 	     double, double, double,
 	     double &, double &, double &);    // cross product
@@ -98,6 +114,7 @@ class Comm : protected Pointers {
   virtual void allocate_multi(int);         // allocate multi arrays
   virtual void free_swap();                 // free swap arrays
   virtual void free_multi();                // free multi arrays
+  void le_shift(int, int);                  // Lees-Edwards shift of ghosts
 };
 
 }
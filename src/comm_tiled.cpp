@@ -0,0 +1,985 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "lmptype.h"
+#include "mpi.h"
+#include "string.h"
+#include "comm_tiled.h"
+#include "atom.h"
+#include "atom_vec.h"
+#include "force.h"
+#include "pair.h"
+#include "domain.h"
+#include "neighbor.h"
+#include "fix.h"
+#include "compute.h"
+#include "dump.h"
+#include "error.h"
+#include "memory.h"
+
+using namespace LAMMPS_NS;
+
+#define BUFFACTOR 1.5
+#define BUFMIN 1000
+#define BUFEXTRA 1000
+#define BIG 1.0e20
+
+enum{SINGLE,MULTI};
+
+/* ----------------------------------------------------------------------
+   communication for sub-domains that are not a regular 3d grid of bricks
+   each proc sends ghosts directly to every proc (or periodic image of one)
+     whose sub-domain extended by the ghost cutoff overlaps its own,
+     instead of the 6 swaps of the brick stencil
+------------------------------------------------------------------------- */
+
+CommTiled::CommTiled(LAMMPS *lmp) : Comm(lmp)
+{
+  tiled = 1;
+
+  rcbdim = NULL;
+  rcbcut = NULL;
+  rcbbox = NULL;
+
+  nsendswap = nrecvswap = nself = 0;
+  sendbox = NULL;
+  procbox = NULL;
+  cut = 0.0;
+
+  nexchange = 0;
+  exchdest = exchlist = NULL;
+  maxexchdest = 0;
+  bordlist = NULL;
+  maxbord = 0;
+
+  maxreq = nrequest = 0;
+  selfsend = selfrecv = NULL;
+  exchproc = exchnum = exchrecv = NULL;
+  recvoffset = NULL;
+  requests = NULL;
+  statuses = NULL;
+  grow_tiled(maxswap);
+}
+
+/* ---------------------------------------------------------------------- */
+
+CommTiled::~CommTiled()
+{
+  memory->destroy(rcbdim);
+  memory->destroy(rcbcut);
+  memory->destroy(rcbbox);
+  memory->destroy(procbox);
+
+  memory->destroy(selfsend);
+  memory->destroy(selfrecv);
+  memory->destroy(sendbox);
+  memory->destroy(exchproc);
+  memory->destroy(exchnum);
+  memory->destroy(exchrecv);
+  memory->destroy(recvoffset);
+  delete [] requests;
+  delete [] statuses;
+
+  memory->destroy(exchdest);
+  memory->destroy(exchlist);
+  memory->destroy(bordlist);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void CommTiled::init()
+{
+  Comm::init();
+
+  if (triclinic)
+    error->all(FLERR,"Comm_style tiled does not yet support triclinic boxes");
+  if (style == MULTI)
+    error->all(FLERR,"Comm_style tiled does not support communicate multi");
+  if (bordergroup)
+    error->all(FLERR,"Comm_style tiled does not support communicate group");
+  if (domain->le_flag)
+    error->all(FLERR,"Comm_style tiled does not support fix lees/edwards");
+}
+
+/* ----------------------------------------------------------------------
+   setup tiled communication pattern
+   function of neighbor cutoff & cutghostuser & current sub-domains
+   a send to proc q with periodic image s is made if my sub-domain overlaps
+     q's sub-domain extended by the cutoff and shifted back by image s
+   sends and recvs are enumerated in the same canonical order on all procs,
+     so that messages between a pair of procs match without extra tags
+------------------------------------------------------------------------- */
+
+void CommTiled::setup()
+{
+  int i,p,n;
+  int s[3],ilo[3],ihi[3];
+
+  cut = MAX(neighbor->cutneighmax,cutghostuser);
+  cutghost[0] = cutghost[1] = cutghost[2] = cut;
+
+  int *periodicity = domain->periodicity;
+  double *prd = domain->prd;
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+  int dimension = domain->dimension;
+
+  for (i = 0; i < 3; i++) {
+    if (periodicity[i] && (i < 2 || dimension == 3)) {
+      if (cut >= prd[i])
+	error->all(FLERR,"Ghost cutoff exceeds periodic box length "
+		   "for comm_style tiled");
+      ilo[i] = -1;
+      ihi[i] = 1;
+    } else ilo[i] = ihi[i] = 0;
+  }
+
+  set_procbox();
+
+  // count sends and recvs to size the swap arrays
+
+  nsendswap = nrecvswap = 0;
+  for (p = 0; p < nprocs; p++)
+    for (s[0] = ilo[0]; s[0] <= ihi[0]; s[0]++)
+      for (s[1] = ilo[1]; s[1] <= ihi[1]; s[1]++)
+	for (s[2] = ilo[2]; s[2] <= ihi[2]; s[2]++) {
+	  if (p == me && s[0] == 0 && s[1] == 0 && s[2] == 0) continue;
+	  if (overlap(me,p,s)) nsendswap++;
+	  if (overlap(p,me,s)) nrecvswap++;
+	}
+
+  n = MAX(nsendswap,nrecvswap);
+  if (n > maxswap) grow_swap(n);
+  if (n > maxreq) grow_tiled(n);
+  nswap = nsendswap;
+
+  // sendbox = atoms in my sub-domain that are ghosts of proc p, image s
+  // sendbox is unbounded at non-periodic box faces, like the brick slabs
+  // pbc = image that is added to their coords when they are sent
+
+  nsendswap = nrecvswap = 0;
+  int nselfsend = 0;
+  int nselfrecv = 0;
+
+  for (p = 0; p < nprocs; p++)
+    for (s[0] = ilo[0]; s[0] <= ihi[0]; s[0]++)
+      for (s[1] = ilo[1]; s[1] <= ihi[1]; s[1]++)
+	for (s[2] = ilo[2]; s[2] <= ihi[2]; s[2]++) {
+	  if (p == me && s[0] == 0 && s[1] == 0 && s[2] == 0) continue;
+
+	  if (overlap(me,p,s)) {
+	    n = nsendswap++;
+	    sendproc[n] = p;
+	    pbc_flag[n] = (s[0] || s[1] || s[2]) ? 1 : 0;
+	    for (i = 0; i < 3; i++) {
+	      pbc[n][i] = s[i];
+	      pbc[n][3+i] = 0;
+	      sendbox[n][i] = procbox[p][i] - cut - s[i]*prd[i];
+	      sendbox[n][3+i] = procbox[p][3+i] + cut - s[i]*prd[i];
+	      if (periodicity[i] == 0) {
+		if (procbox[p][i] == boxlo[i]) sendbox[n][i] = -BIG;
+		if (procbox[p][3+i] == boxhi[i]) sendbox[n][3+i] = BIG;
+	      }
+	    }
+	    if (p == me) selfsend[nselfsend++] = n;
+	  }
+
+	  if (overlap(p,me,s)) {
+	    n = nrecvswap++;
+	    recvproc[n] = p;
+	    if (p == me) selfrecv[nselfrecv++] = n;
+	  }
+	}
+
+  nself = nselfsend;
+
+  // procs that atoms can migrate to = unique procs of my sends, ascending
+
+  nexchange = 0;
+  for (n = 0; n < nsendswap; n++) {
+    p = sendproc[n];
+    if (p == me) continue;
+    if (nexchange && exchproc[nexchange-1] == p) continue;
+    exchproc[nexchange++] = p;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   set box-coord bounds of every proc's sub-domain
+   from the RCB tiles if balanced that way, else from the brick splits
+   upper bounds at the box edge are boxhi, as in Domain::set_local_box()
+------------------------------------------------------------------------- */
+
+void CommTiled::set_procbox()
+{
+  int i,j,k,p;
+
+  if (procbox == NULL) memory->create(procbox,nprocs,6,"comm:procbox");
+
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+  double *prd = domain->prd;
+
+  if (rcb) {
+    for (p = 0; p < nprocs; p++)
+      for (i = 0; i < 3; i++) {
+	procbox[p][i] = boxlo[i] + prd[i]*rcbbox[p][i];
+	if (rcbbox[p][3+i] < 1.0)
+	  procbox[p][3+i] = boxlo[i] + prd[i]*rcbbox[p][3+i];
+	else procbox[p][3+i] = boxhi[i];
+      }
+    return;
+  }
+
+  for (i = 0; i < procgrid[0]; i++)
+    for (j = 0; j < procgrid[1]; j++)
+      for (k = 0; k < procgrid[2]; k++) {
+	p = grid2proc[i][j][k];
+	procbox[p][0] = boxlo[0] + prd[0]*xsplit[i];
+	procbox[p][3] = boxlo[0] + prd[0]*xsplit[i+1];
+	procbox[p][1] = boxlo[1] + prd[1]*ysplit[j];
+	procbox[p][4] = boxlo[1] + prd[1]*ysplit[j+1];
+	procbox[p][2] = boxlo[2] + prd[2]*zsplit[k];
+	procbox[p][5] = boxlo[2] + prd[2]*zsplit[k+1];
+	if (i == procgrid[0]-1) procbox[p][3] = boxhi[0];
+	if (j == procgrid[1]-1) procbox[p][4] = boxhi[1];
+	if (k == procgrid[2]-1) procbox[p][5] = boxhi[2];
+      }
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if sub-domain of proc p shifted by periodic image s
+     overlaps sub-domain of proc q extended by the ghost cutoff
+------------------------------------------------------------------------- */
+
+int CommTiled::overlap(int p, int q, int *s)
+{
+  double *prd = domain->prd;
+  double *pbox = procbox[p];
+  double *qbox = procbox[q];
+
+  for (int i = 0; i < 3; i++) {
+    if (pbox[i] + s[i]*prd[i] > qbox[3+i] + cut) return 0;
+    if (pbox[3+i] + s[i]*prd[i] < qbox[i] - cut) return 0;
+  }
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   forward communication of atom coords every timestep
+------------------------------------------------------------------------- */
+
+void CommTiled::forward_comm(int dummy)
+{
+  forward_comm_start();
+  forward_comm_finish();
+}
+
+/* ----------------------------------------------------------------------
+   post all recvs and sends of forward comm, do self copies
+   send buffer holds all sends, so none has to complete before return
+   ghost coords must not be used until forward_comm_finish()
+------------------------------------------------------------------------- */
+
+void CommTiled::forward_comm_start()
+{
+  int i,m,n,r;
+  AtomVec *avec = atom->avec;
+  double **x = atom->x;
+  double *buf;
+
+  // if comm_x_only set, recv or copy directly into x, don't unpack
+
+  nrequest = 0;
+  m = 0;
+  for (r = 0; r < nrecvswap; r++) {
+    recvoffset[r] = m;
+    m += recvnum[r]*size_forward;
+    if (recvproc[r] == me) continue;
+    if (comm_x_only) {
+      if (recvnum[r]) buf = x[firstrecv[r]];
+      else buf = NULL;
+    } else buf = &buf_recv[recvoffset[r]];
+    MPI_Irecv(buf,recvnum[r]*size_forward,MPI_DOUBLE,
+	      recvproc[r],0,world,&requests[nrequest++]);
+  }
+
+  m = 0;
+  for (i = 0; i < nsendswap; i++) {
+    if (sendproc[i] == me) continue;
+    buf = &buf_send[m];
+    if (ghost_velocity)
+      n = avec->pack_comm_vel(sendnum[i],sendlist[i],buf,pbc_flag[i],pbc[i]);
+    else
+      n = avec->pack_comm(sendnum[i],sendlist[i],buf,pbc_flag[i],pbc[i]);
+    MPI_Isend(buf,n,MPI_DOUBLE,sendproc[i],0,world,&requests[nrequest++]);
+    m += n;
+  }
+
+  for (int k = 0; k < nself; k++) {
+    i = selfsend[k];
+    r = selfrecv[k];
+    if (comm_x_only) {
+      if (sendnum[i])
+	avec->pack_comm(sendnum[i],sendlist[i],
+			x[firstrecv[r]],pbc_flag[i],pbc[i]);
+    } else if (ghost_velocity)
+      avec->pack_comm_vel(sendnum[i],sendlist[i],
+			  &buf_recv[recvoffset[r]],pbc_flag[i],pbc[i]);
+    else
+      avec->pack_comm(sendnum[i],sendlist[i],
+		      &buf_recv[recvoffset[r]],pbc_flag[i],pbc[i]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   wait for forward comm posted by forward_comm_start(), unpack ghosts
+------------------------------------------------------------------------- */
+
+void CommTiled::forward_comm_finish()
+{
+  AtomVec *avec = atom->avec;
+
+  if (nrequest) MPI_Waitall(nrequest,requests,statuses);
+  nrequest = 0;
+  if (comm_x_only) return;
+
+  for (int r = 0; r < nrecvswap; r++) {
+    if (ghost_velocity)
+      avec->unpack_comm_vel(recvnum[r],firstrecv[r],&buf_recv[recvoffset[r]]);
+    else
+      avec->unpack_comm(recvnum[r],firstrecv[r],&buf_recv[recvoffset[r]]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   reverse communication of forces on atoms every timestep
+------------------------------------------------------------------------- */
+
+void CommTiled::reverse_comm()
+{
+  reverse_comm_start();
+  reverse_comm_finish();
+}
+
+/* ----------------------------------------------------------------------
+   post all recvs and sends of reverse comm, do self sums
+   the reverse of each recv in forward comm is a send, and vice versa
+   ghost forces must not change until reverse_comm_finish()
+------------------------------------------------------------------------- */
+
+void CommTiled::reverse_comm_start()
+{
+  int i,m,n,r;
+  AtomVec *avec = atom->avec;
+  double **f = atom->f;
+  double *buf;
+
+  // if comm_f_only set, send or copy directly from f, don't pack
+
+  nrequest = 0;
+  m = 0;
+  for (i = 0; i < nsendswap; i++) {
+    recvoffset[i] = m;
+    m += sendnum[i]*size_reverse;
+    if (sendproc[i] == me) continue;
+    MPI_Irecv(&buf_recv[recvoffset[i]],sendnum[i]*size_reverse,MPI_DOUBLE,
+	      sendproc[i],0,world,&requests[nrequest++]);
+  }
+
+  m = 0;
+  for (r = 0; r < nrecvswap; r++) {
+    if (recvproc[r] == me) continue;
+    if (comm_f_only) {
+      if (recvnum[r]) buf = f[firstrecv[r]];
+      else buf = NULL;
+      n = recvnum[r]*size_reverse;
+    } else {
+      buf = &buf_send[m];
+      n = avec->pack_reverse(recvnum[r],firstrecv[r],buf);
+      m += n;
+    }
+    MPI_Isend(buf,n,MPI_DOUBLE,recvproc[r],0,world,&requests[nrequest++]);
+  }
+
+  for (int k = 0; k < nself; k++) {
+    i = selfsend[k];
+    r = selfrecv[k];
+    if (comm_f_only) {
+      if (sendnum[i])
+	avec->unpack_reverse(sendnum[i],sendlist[i],f[firstrecv[r]]);
+    } else {
+      avec->pack_reverse(recvnum[r],firstrecv[r],&buf_send[m]);
+      avec->unpack_reverse(sendnum[i],sendlist[i],&buf_send[m]);
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   wait for reverse comm posted by reverse_comm_start(), sum into owners
+------------------------------------------------------------------------- */
+
+void CommTiled::reverse_comm_finish()
+{
+  AtomVec *avec = atom->avec;
+
+  if (nrequest) MPI_Waitall(nrequest,requests,statuses);
+  nrequest = 0;
+
+  for (int i = 0; i < nsendswap; i++) {
+    if (sendproc[i] == me) continue;
+    avec->unpack_reverse(sendnum[i],sendlist[i],&buf_recv[recvoffset[i]]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   exchange: move atoms to correct processors
+   atoms are sent directly to the proc whose sub-domain they are now in
+   atoms will be lost if that proc is not one I exchange ghosts with
+     can happen if atom moves outside of non-periodic bounary
+     or if atom moves further than the ghost cutoff
+   this routine called before every reneighboring
+------------------------------------------------------------------------- */
+
+void CommTiled::exchange()
+{
+  int i,k,m,n,p,nlocal,nleave,nsend,nrecv,nreq;
+  double lamda[3];
+  AtomVec *avec = atom->avec;
+
+  if (map_style) atom->map_clear();
+
+  double **x = atom->x;
+  double *sublo = domain->sublo;
+  double *subhi = domain->subhi;
+  double *boxlo = domain->boxlo;
+  double *boxhi = domain->boxhi;
+  double *prd = domain->prd;
+  int *periodicity = domain->periodicity;
+  nlocal = atom->nlocal;
+
+  if (nlocal > maxexchdest) {
+    maxexchdest = static_cast<int> (BUFFACTOR * nlocal);
+    memory->destroy(exchdest);
+    memory->destroy(exchlist);
+    memory->create(exchdest,maxexchdest,"comm:exchdest");
+    memory->create(exchlist,maxexchdest,"comm:exchlist");
+  }
+
+  // exchdest = exchproc index of atoms leaving my sub-domain, using < and >=
+  // -1 if atom stays, -2 if it is lost:
+  //   outside a non-periodic boundary, as with the brick stencil,
+  //   or its new owner is not a neighbor
+
+  for (k = 0; k < nexchange; k++) exchnum[k] = 0;
+  nleave = 0;
+
+  for (i = 0; i < nlocal; i++) {
+    exchdest[i] = -1;
+    if (x[i][0] >= sublo[0] && x[i][0] < subhi[0] &&
+	x[i][1] >= sublo[1] && x[i][1] < subhi[1] &&
+	x[i][2] >= sublo[2] && x[i][2] < subhi[2]) continue;
+    nleave++;
+    if ((!periodicity[0] && (x[i][0] < boxlo[0] || x[i][0] >= boxhi[0])) ||
+	(!periodicity[1] && (x[i][1] < boxlo[1] || x[i][1] >= boxhi[1])) ||
+	(!periodicity[2] && (x[i][2] < boxlo[2] || x[i][2] >= boxhi[2]))) {
+      exchdest[i] = -2;
+      continue;
+    }
+    lamda[0] = (x[i][0]-boxlo[0]) / prd[0];
+    lamda[1] = (x[i][1]-boxlo[1]) / prd[1];
+    lamda[2] = (x[i][2]-boxlo[2]) / prd[2];
+    p = point2proc(lamda);
+    if (p == me) {
+      nleave--;
+      continue;
+    }
+    k = find_exchange(p);
+    if (k >= 0) {
+      exchdest[i] = k;
+      exchnum[k]++;
+    } else exchdest[i] = -2;
+  }
+
+  // order leaving atoms by destination and pack them
+  // exchnum = # of datums sent to each exchange proc
+
+  m = 0;
+  for (k = 0; k < nexchange; k++) {
+    n = exchnum[k];
+    exchnum[k] = m;
+    m += n;
+  }
+  for (i = 0; i < nlocal; i++)
+    if (exchdest[i] >= 0) exchlist[exchnum[exchdest[i]]++] = i;
+
+  nsend = m = 0;
+  for (k = 0; k < nexchange; k++) {
+    n = nsend;
+    for (; m < exchnum[k]; m++) {
+      if (nsend > maxsend) grow_send(nsend,1);
+      nsend += avec->pack_exchange(exchlist[m],&buf_send[nsend]);
+    }
+    exchnum[k] = nsend - n;
+  }
+
+  // delete leaving atoms, filling each with the last atom
+  // loop from the end so the filling atom has always been checked
+
+  if (nleave) {
+    for (i = nlocal-1; i >= 0; i--)
+      if (exchdest[i] != -1) {
+	avec->copy(nlocal-1,i,1);
+	nlocal--;
+      }
+    atom->nlocal = nlocal;
+  }
+
+  // send/recv counts, then atoms, with all exchange procs
+
+  nreq = 0;
+  for (k = 0; k < nexchange; k++)
+    MPI_Irecv(&exchrecv[k],1,MPI_INT,exchproc[k],0,world,&requests[nreq++]);
+  for (k = 0; k < nexchange; k++)
+    MPI_Send(&exchnum[k],1,MPI_INT,exchproc[k],0,world);
+  if (nreq) MPI_Waitall(nreq,requests,statuses);
+
+  nrecv = 0;
+  for (k = 0; k < nexchange; k++) nrecv += exchrecv[k];
+  if (nrecv > maxrecv) grow_recv(nrecv);
+
+  nreq = 0;
+  m = 0;
+  for (k = 0; k < nexchange; k++) {
+    MPI_Irecv(&buf_recv[m],exchrecv[k],MPI_DOUBLE,exchproc[k],0,
+	      world,&requests[nreq++]);
+    m += exchrecv[k];
+  }
+  m = 0;
+  for (k = 0; k < nexchange; k++) {
+    MPI_Send(&buf_send[m],exchnum[k],MPI_DOUBLE,exchproc[k],0,world);
+    m += exchnum[k];
+  }
+  if (nreq) MPI_Waitall(nreq,requests,statuses);
+
+  // all incoming atoms are in my sub-domain
+
+  m = 0;
+  while (m < nrecv) m += avec->unpack_exchange(&buf_recv[m]);
+
+  if (atom->firstgroupname) atom->first_reorder();
+}
+
+/* ----------------------------------------------------------------------
+   borders: list nearby atoms to send to neighboring procs at every timestep
+   one list is created for every send, then all ghosts are exchanged
+   this does equivalent of a communicate (so don't need to explicitly
+     call communicate routine on reneighboring timestep)
+   this routine is called before every reneighboring
+------------------------------------------------------------------------- */
+
+void CommTiled::borders()
+{
+  int i,j,m,n,r,nb,nsend,nreq,smax,stotal,rtotal;
+  double *box;
+  AtomVec *avec = atom->avec;
+
+  atom->nghost = 0;
+  atom->avec->clear_bonus();
+
+  double **x = atom->x;
+  int nlocal = atom->nlocal;
+  double *sublo = domain->sublo;
+  double *subhi = domain->subhi;
+
+  // bordlist = owned atoms within cutoff of a face of my sub-domain
+  // only they can be in a sendbox, since other tiles don't overlap mine
+  // z is skipped in 2d, every atom is within cutoff of the thin z faces
+
+  if (nlocal > maxbord) {
+    maxbord = static_cast<int> (BUFFACTOR * nlocal);
+    memory->destroy(bordlist);
+    memory->create(bordlist,maxbord,"comm:bordlist");
+  }
+
+  nb = 0;
+  if (domain->dimension == 3) {
+    for (i = 0; i < nlocal; i++)
+      if (x[i][0] <= sublo[0]+cut || x[i][0] >= subhi[0]-cut ||
+	  x[i][1] <= sublo[1]+cut || x[i][1] >= subhi[1]-cut ||
+	  x[i][2] <= sublo[2]+cut || x[i][2] >= subhi[2]-cut)
+	bordlist[nb++] = i;
+  } else {
+    for (i = 0; i < nlocal; i++)
+      if (x[i][0] <= sublo[0]+cut || x[i][0] >= subhi[0]-cut ||
+	  x[i][1] <= sublo[1]+cut || x[i][1] >= subhi[1]-cut)
+	bordlist[nb++] = i;
+  }
+
+  // find atoms within each sendbox using <= and >=
+
+  smax = stotal = 0;
+  for (i = 0; i < nsendswap; i++) {
+    box = sendbox[i];
+    nsend = 0;
+    for (m = 0; m < nb; m++) {
+      j = bordlist[m];
+      if (x[j][0] >= box[0] && x[j][0] <= box[3] &&
+	  x[j][1] >= box[1] && x[j][1] <= box[4] &&
+	  x[j][2] >= box[2] && x[j][2] <= box[5]) {
+	if (nsend == maxsendlist[i]) grow_list(i,nsend);
+	sendlist[i][nsend++] = j;
+      }
+    }
+    sendnum[i] = nsend;
+    smax = MAX(smax,nsend);
+    stotal += nsend;
+  }
+
+  // exchange send counts, self recvs match self sends
+
+  nreq = 0;
+  for (r = 0; r < nrecvswap; r++)
+    if (recvproc[r] != me)
+      MPI_Irecv(&recvnum[r],1,MPI_INT,recvproc[r],0,world,&requests[nreq++]);
+  for (i = 0; i < nsendswap; i++)
+    if (sendproc[i] != me)
+      MPI_Send(&sendnum[i],1,MPI_INT,sendproc[i],0,world);
+  for (int k = 0; k < nself; k++) recvnum[selfrecv[k]] = sendnum[selfsend[k]];
+  if (nreq) MPI_Waitall(nreq,requests,statuses);
+
+  rtotal = 0;
+  for (r = 0; r < nrecvswap; r++) {
+    recvoffset[r] = rtotal*size_border;
+    rtotal += recvnum[r];
+  }
+
+  if (smax*size_border > maxsend) grow_send(smax*size_border,0);
+  if (rtotal*size_border > maxrecv) grow_recv(rtotal*size_border);
+
+  // exchange border atoms, pack self sends directly into their recv slot
+
+  nreq = 0;
+  for (r = 0; r < nrecvswap; r++)
+    if (recvproc[r] != me)
+      MPI_Irecv(&buf_recv[recvoffset[r]],recvnum[r]*size_border,MPI_DOUBLE,
+		recvproc[r],0,world,&requests[nreq++]);
+
+  for (i = 0; i < nsendswap; i++) {
+    if (sendproc[i] != me) {
+      if (ghost_velocity)
+	n = avec->pack_border_vel(sendnum[i],sendlist[i],buf_send,
+				  pbc_flag[i],pbc[i]);
+      else
+	n = avec->pack_border(sendnum[i],sendlist[i],buf_send,
+			      pbc_flag[i],pbc[i]);
+      MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[i],0,world);
+    }
+  }
+
+  for (int k = 0; k < nself; k++) {
+    i = selfsend[k];
+    r = selfrecv[k];
+    if (ghost_velocity)
+      avec->pack_border_vel(sendnum[i],sendlist[i],&buf_recv[recvoffset[r]],
+			    pbc_flag[i],pbc[i]);
+    else
+      avec->pack_border(sendnum[i],sendlist[i],&buf_recv[recvoffset[r]],
+			pbc_flag[i],pbc[i]);
+  }
+
+  if (nreq) MPI_Waitall(nreq,requests,statuses);
+
+  // put incoming ghosts at end of my atom arrays in recv order
+
+  for (r = 0; r < nrecvswap; r++) {
+    firstrecv[r] = atom->nlocal + atom->nghost;
+    if (ghost_velocity)
+      avec->unpack_border_vel(recvnum[r],firstrecv[r],
+			      &buf_recv[recvoffset[r]]);
+    else
+      avec->unpack_border(recvnum[r],firstrecv[r],&buf_recv[recvoffset[r]]);
+    atom->nghost += recvnum[r];
+  }
+
+  // insure send/recv buffers are long enough for all forward & reverse comm
+  // both buffers hold all messages of one comm at once
+
+  int max = MAX(maxforward*stotal,maxreverse*rtotal);
+  if (max > maxsend) grow_send(max,0);
+  max = MAX(maxforward*rtotal,maxreverse*stotal);
+  if (max > maxrecv) grow_recv(max);
+
+  if (map_style) atom->map_set();
+}
+
+/* ----------------------------------------------------------------------
+   forward/reverse communication invoked by a Pair, Fix, Compute, Dump
+------------------------------------------------------------------------- */
+
+void CommTiled::forward_comm_pair(Pair *pair)
+{
+  forward_comm_obj(pair);
+}
+
+void CommTiled::reverse_comm_pair(Pair *pair)
+{
+  reverse_comm_obj(pair);
+}
+
+void CommTiled::forward_comm_fix(Fix *fix)
+{
+  forward_comm_obj(fix);
+}
+
+void CommTiled::reverse_comm_fix(Fix *fix)
+{
+  reverse_comm_obj(fix);
+}
+
+void CommTiled::forward_comm_compute(Compute *compute)
+{
+  forward_comm_obj(compute);
+}
+
+void CommTiled::reverse_comm_compute(Compute *compute)
+{
+  reverse_comm_obj(compute);
+}
+
+void CommTiled::forward_comm_dump(Dump *dump)
+{
+  forward_comm_obj(dump);
+}
+
+void CommTiled::reverse_comm_dump(Dump *dump)
+{
+  reverse_comm_obj(dump);
+}
+
+/* ----------------------------------------------------------------------
+   forward comm of a Pair, Fix, Compute, Dump
+   obj->comm_forward bounds the per-atom size of each recv
+------------------------------------------------------------------------- */
+
+template <class T>
+void CommTiled::forward_comm_obj(T *obj)
+{
+  int i,m,n,r,nreq;
+  int nsize = obj->comm_forward;
+
+  nreq = 0;
+  m = 0;
+  for (r = 0; r < nrecvswap; r++) {
+    recvoffset[r] = m;
+    m += recvnum[r]*nsize;
+    if (recvproc[r] == me) continue;
+    MPI_Irecv(&buf_recv[recvoffset[r]],recvnum[r]*nsize,MPI_DOUBLE,
+	      recvproc[r],0,world,&requests[nreq++]);
+  }
+
+  for (i = 0; i < nsendswap; i++) {
+    if (sendproc[i] == me) continue;
+    n = obj->pack_comm(sendnum[i],sendlist[i],buf_send,pbc_flag[i],pbc[i]);
+    MPI_Send(buf_send,n*sendnum[i],MPI_DOUBLE,sendproc[i],0,world);
+  }
+
+  for (int k = 0; k < nself; k++) {
+    i = selfsend[k];
+    r = selfrecv[k];
+    obj->pack_comm(sendnum[i],sendlist[i],&buf_recv[recvoffset[r]],
+		   pbc_flag[i],pbc[i]);
+  }
+
+  if (nreq) MPI_Waitall(nreq,requests,statuses);
+
+  for (r = 0; r < nrecvswap; r++)
+    obj->unpack_comm(recvnum[r],firstrecv[r],&buf_recv[recvoffset[r]]);
+}
+
+/* ----------------------------------------------------------------------
+   reverse comm of a Pair, Fix, Compute, Dump
+   obj->comm_reverse bounds the per-atom size of each recv
+------------------------------------------------------------------------- */
+
+template <class T>
+void CommTiled::reverse_comm_obj(T *obj)
+{
+  int i,m,n,r,nreq;
+  int nsize = obj->comm_reverse;
+
+  nreq = 0;
+  m = 0;
+  for (i = 0; i < nsendswap; i++) {
+    recvoffset[i] = m;
+    m += sendnum[i]*nsize;
+    if (sendproc[i] == me) continue;
+    MPI_Irecv(&buf_recv[recvoffset[i]],sendnum[i]*nsize,MPI_DOUBLE,
+	      sendproc[i],0,world,&requests[nreq++]);
+  }
+
+  for (r = 0; r < nrecvswap; r++) {
+    if (recvproc[r] == me) continue;
+    n = obj->pack_reverse_comm(recvnum[r],firstrecv[r],buf_send);
+    MPI_Send(buf_send,n*recvnum[r],MPI_DOUBLE,recvproc[r],0,world);
+  }
+
+  for (int k = 0; k < nself; k++) {
+    i = selfsend[k];
+    r = selfrecv[k];
+    obj->pack_reverse_comm(recvnum[r],firstrecv[r],&buf_recv[recvoffset[i]]);
+  }
+
+  if (nreq) MPI_Waitall(nreq,requests,statuses);
+
+  for (i = 0; i < nsendswap; i++)
+    obj->unpack_reverse_comm(sendnum[i],sendlist[i],&buf_recv[recvoffset[i]]);
+}
+
+/* ----------------------------------------------------------------------
+   set fractional bounds of my sub-domain from my RCB tile or the grid
+------------------------------------------------------------------------- */
+
+void CommTiled::set_mysplit()
+{
+  if (!rcb) {
+    Comm::set_mysplit();
+    return;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    mysplit[i][0] = rcbbox[me][i];
+    mysplit[i][1] = rcbbox[me][3+i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   allocate the RCB tree and tiles, called by the balance command
+------------------------------------------------------------------------- */
+
+void CommTiled::allocate_rcb()
+{
+  if (rcbdim) return;
+  memory->create(rcbdim,nprocs,"comm:rcbdim");
+  memory->create(rcbcut,nprocs,"comm:rcbcut");
+  memory->create(rcbbox,nprocs,6,"comm:rcbbox");
+}
+
+/* ----------------------------------------------------------------------
+   return proc that owns fractional (0-1) point lamda
+   for RCB tiles, descend the cut tree:
+     node of procs lo to lo+n-1 is split at mid = lo + n/2,
+     by cut rcbcut[mid] in dim rcbdim[mid]
+   else look up the brick that contains the point
+   points outside the box map to the nearest tile
+------------------------------------------------------------------------- */
+
+int CommTiled::point2proc(double *lamda)
+{
+  if (rcb) {
+    int lo = 0;
+    int n = nprocs;
+    while (n > 1) {
+      int n1 = n/2;
+      int mid = lo + n1;
+      if (lamda[rcbdim[mid]] < rcbcut[mid]) n = n1;
+      else {
+	lo = mid;
+	n -= n1;
+      }
+    }
+    return lo;
+  }
+
+  int i = binary(lamda[0],procgrid[0],xsplit);
+  int j = binary(lamda[1],procgrid[1],ysplit);
+  int k = binary(lamda[2],procgrid[2],zsplit);
+  return grid2proc[i][j][k];
+}
+
+/* ----------------------------------------------------------------------
+   index of exchange proc p in exchproc, -1 if not one
+------------------------------------------------------------------------- */
+
+int CommTiled::find_exchange(int p)
+{
+  int lo = 0;
+  int hi = nexchange-1;
+  while (lo <= hi) {
+    int mid = (lo+hi) / 2;
+    if (exchproc[mid] == p) return mid;
+    if (exchproc[mid] < p) lo = mid+1;
+    else hi = mid-1;
+  }
+  return -1;
+}
+
+/* ----------------------------------------------------------------------
+   index i of sub-domain with split[i] <= value < split[i+1]
+   split = n+1 ascending bounds, values outside map to 1st or last
+------------------------------------------------------------------------- */
+
+int CommTiled::binary(double value, int n, double *split)
+{
+  int lo = 0;
+  int hi = n;
+  while (hi - lo > 1) {
+    int mid = (lo+hi) / 2;
+    if (value < split[mid]) hi = mid;
+    else lo = mid;
+  }
+  return lo;
+}
+
+/* ----------------------------------------------------------------------
+   realloc the per-send and per-recv arrays of the tiled pattern
+------------------------------------------------------------------------- */
+
+void CommTiled::grow_tiled(int n)
+{
+  maxreq = n;
+  memory->destroy(selfsend);
+  memory->destroy(selfrecv);
+  memory->destroy(sendbox);
+  memory->destroy(exchproc);
+  memory->destroy(exchnum);
+  memory->destroy(exchrecv);
+  memory->destroy(recvoffset);
+  delete [] requests;
+  delete [] statuses;
+
+  memory->create(selfsend,n,"comm:selfsend");
+  memory->create(selfrecv,n,"comm:selfrecv");
+  memory->create(sendbox,n,6,"comm:sendbox");
+  memory->create(exchproc,n,"comm:exchproc");
+  memory->create(exchnum,n,"comm:exchnum");
+  memory->create(exchrecv,n,"comm:exchrecv");
+  memory->create(recvoffset,n,"comm:recvoffset");
+  requests = new MPI_Request[2*n];
+  statuses = new MPI_Status[2*n];
+}
+
+/* ----------------------------------------------------------------------
+   return # of bytes of allocated memory
+------------------------------------------------------------------------- */
+
+bigint CommTiled::memory_usage()
+{
+  bigint bytes = Comm::memory_usage();
+  bytes += memory->usage(exchdest,maxexchdest);
+  bytes += memory->usage(exchlist,maxexchdest);
+  bytes += memory->usage(bordlist,maxbord);
+  if (procbox) bytes += memory->usage(procbox,nprocs,6);
+  if (rcbbox) bytes += memory->usage(rcbbox,nprocs,6);
+  return bytes;
+}
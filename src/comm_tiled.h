@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_COMM_TILED_H
+#define LMP_COMM_TILED_H
+
+#include "comm.h"
+
+namespace LAMMPS_NS {
+
+class CommTiled : public Comm {
+ public:
+  int *rcbdim;                      // RCB cut dim of node split at proc p
+  double *rcbcut;                   // fractional RCB cut of that node
+  double **rcbbox;                  // fractional tile of each proc, lo/hi
+
+  CommTiled(class LAMMPS *);
+  ~CommTiled();
+
+  void init();
+  void setup();
+  void forward_comm(int dummy = 0);
+  void reverse_comm();
+  void forward_comm_start();
+  void forward_comm_finish();
+  void reverse_comm_start();
+  void reverse_comm_finish();
+  void exchange();
+  void borders();
+
+  void forward_comm_pair(class Pair *);
+  void reverse_comm_pair(class Pair *);
+  void forward_comm_fix(class Fix *);
+  void reverse_comm_fix(class Fix *);
+  void forward_comm_compute(class Compute *);
+  void reverse_comm_compute(class Compute *);
+  void forward_comm_dump(class Dump *);
+  void reverse_comm_dump(class Dump *);
+
+  void set_mysplit();
+  void allocate_rcb();
+  int point2proc(double *);
+  bigint memory_usage();
+
+ private:
+  int nsendswap,nrecvswap;          // # of sends and recvs, incl self
+  int nself;                        // # of sends to self = recvs from self
+  int *selfsend,*selfrecv;          // matching send/recv indices to self
+  double **sendbox;                 // region of atoms sent in each send
+  double **procbox;                 // sub-domain of each proc in box coords
+  double cut;                       // ghost cutoff
+
+  int nexchange;                    // # of procs atoms may migrate to
+  int *exchproc;                    // those procs, ascending
+  int *exchnum,*exchrecv;           // # of datums sent to/recv from each
+  int *exchdest;                    // exchproc index of each leaving atom
+  int *exchlist;                    // leaving atoms ordered by destination
+  int maxexchdest;
+
+  int *bordlist;                    // owned atoms within cut of my tile
+  int maxbord;
+
+  int *recvoffset;                  // offset of each recv in buf_recv
+  MPI_Request *requests;            // sized for all recvs + sends
+  MPI_Status *statuses;
+  int maxreq;
+  int nrequest;                     // # of requests pending between
+                                    //   start and finish of a comm
+
+  void set_procbox();
+  int overlap(int, int, int *);
+  void grow_tiled(int);
+  int find_exchange(int);
+  int binary(double, int, double *);
+
+  template <class T> void forward_comm_obj(T *);
+  template <class T> void reverse_comm_obj(T *);
+};
+
+}
+
+#endif
@@ -426,16 +426,16 @@ void CreateAtoms::add_lattice()
   }
 
   if (domain->xperiodic) {
-    if (comm->myloc[0] == 0) sublo[0] -= epsilon[0];
-    if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] -= 2.0*epsilon[0];
+    if (comm->mysplit[0][0] == 0.0) sublo[0] -= epsilon[0];
+    if (comm->mysplit[0][1] == 1.0) subhi[0] -= 2.0*epsilon[0];
   }
   if (domain->yperiodic) {
-    if (comm->myloc[1] == 0) sublo[1] -= epsilon[1];
-    if (comm->myloc[1] == comm->procgrid[1]-1) subhi[1] -= 2.0*epsilon[1];
+    if (comm->mysplit[1][0] == 0.0) sublo[1] -= epsilon[1];
+    if (comm->mysplit[1][1] == 1.0) subhi[1] -= 2.0*epsilon[1];
   }
   if (domain->zperiodic) {
-    if (comm->myloc[2] == 0) sublo[2] -= epsilon[2];
-    if (comm->myloc[2] == comm->procgrid[2]-1) subhi[2] -= 2.0*epsilon[2];
+    if (comm->mysplit[2][0] == 0.0) sublo[2] -= epsilon[2];
+    if (comm->mysplit[2][1] == 1.0) subhi[2] -= 2.0*epsilon[2];
   }
 
   // iterate on 3d periodic lattice of unit cells using loop bounds
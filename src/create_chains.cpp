@@ -0,0 +1,662 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "lmptype.h"
+#include "mpi.h"
+#include "stdlib.h"
+#include "string.h"
+#include "create_chains.h"
+#include "atom.h"
+#include "atom_vec.h"
+#include "domain.h"
+#include "comm.h"
+#include "force.h"
+#include "group.h"
+#include "special.h"
+#include "random_park.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{LATTICE,RANDOM};
+
+#define MAXNEXT 1024
+
+// sort image records by chain, then by position in the chain
+
+static int compare_records(const void *a, const void *b)
+{
+  const int *ra = (const int *) a;
+  const int *rb = (const int *) b;
+  if (ra[0] != rb[0]) return ra[0] < rb[0] ? -1 : 1;
+  if (ra[1] != rb[1]) return ra[1] < rb[1] ? -1 : 1;
+  return 0;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+  int ia = *(const int *) a;
+  int ib = *(const int *) b;
+  if (ia < ib) return -1;
+  if (ia > ib) return 1;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+CreateChains::CreateChains(LAMMPS *lmp) : Pointers(lmp)
+{
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void CreateChains::command(int narg, char **arg)
+{
+  if (domain->box_exist == 0) 
+    error->all(FLERR,"Create_chains command before simulation box is defined");
+  if (atom->natoms == 0)
+    error->all(FLERR,"Create_chains command with no atoms existing");
+  if (atom->molecular == 0 || atom->avec->bonds_allow == 0)
+    error->all(FLERR,"Cannot use create_chains with atom style without bonds");
+  if (atom->tag_enable == 0)
+    error->all(FLERR,"Cannot use create_chains unless atoms have IDs");
+  if (narg < 5) error->all(FLERR,"Illegal create_chains command");
+
+  int igroup = group->find(arg[0]);
+  if (igroup == -1) error->all(FLERR,"Could not find create_chains group ID");
+  groupbit = group->bitmask[igroup];
+
+  nbead = atoi(arg[1]);
+  btype = atoi(arg[2]);
+  if (nbead < 2 || btype <= 0)
+    error->all(FLERR,"Illegal create_chains command");
+
+  int style = 0;
+  int iarg = 0;
+  if (strcmp(arg[3],"lattice") == 0) {
+    if (narg < 6) error->all(FLERR,"Illegal create_chains command");
+    style = LATTICE;
+    nskip = atoi(arg[4]);
+    cutoff = atof(arg[5]);
+    if (nskip < 0 || cutoff <= 0.0)
+      error->all(FLERR,"Illegal create_chains command");
+    iarg = 6;
+  } else if (strcmp(arg[3],"random") == 0) {
+    if (narg < 7) error->all(FLERR,"Illegal create_chains command");
+    style = RANDOM;
+    seed = atoi(arg[4]);
+    fraction = atof(arg[5]);
+    cutoff = atof(arg[6]);
+    if (seed <= 0 || fraction <= 0.0 || fraction > 1.0 || cutoff <= 0.0)
+      error->all(FLERR,"Illegal create_chains command");
+    iarg = 7;
+  } else error->all(FLERR,"Illegal create_chains command");
+
+  nchain = -1;
+  molflag = atom->molecule_flag;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"nchain") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal create_chains command");
+      nchain = atoi(arg[iarg+1]);
+      if (nchain < 0) error->all(FLERR,"Illegal create_chains command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"mol") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal create_chains command");
+      if (strcmp(arg[iarg+1],"yes") == 0) molflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) molflag = 0;
+      else error->all(FLERR,"Illegal create_chains command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal create_chains command");
+  }
+
+  if (molflag && atom->molecule_flag == 0)
+    error->all(FLERR,"Create_chains mol requires atom attribute molecule");
+  if (btype > atom->nbondtypes) {
+    if (force->bond)
+      error->all(FLERR,"Invalid bond type in create_chains command");
+    atom->nbondtypes = btype;
+  }
+
+  // init entire system since comm->borders is done
+  // comm::init needs neighbor::init needs pair::init needs kspace::init, etc
+
+  if (me == 0 && screen) fprintf(screen,"System init for create_chains ...\n");
+  lmp->init();
+
+  if (me == 0 && screen) fprintf(screen,"Creating chains ...\n");
+
+  // border swap with a ghost cutoff of at least the bond length,
+  //   so that the previous bead of each bead is a local or ghost atom
+  // enforce PBC before in case atoms are outside box
+
+  double cutghostuser = comm->cutghostuser;
+  comm->cutghostuser = MAX(cutghostuser,cutoff);
+
+  if (domain->triclinic) domain->x2lamda(atom->nlocal);
+  domain->pbc();
+  domain->reset_box();
+  comm->setup();
+  comm->exchange();
+  comm->borders();
+  if (domain->triclinic) domain->lamda2x(atom->nlocal+atom->nghost);
+
+  comm->cutghostuser = cutghostuser;
+
+  // assign chain, bead and chain neighbors to owned atoms
+
+  int nlocal = atom->nlocal;
+  chain = new int[nlocal];
+  bead = new int[nlocal];
+  prevtag = new int[nlocal];
+  nexttag = new int[nlocal];
+  for (int i = 0; i < nlocal; i++) {
+    chain[i] = -1;
+    bead[i] = prevtag[i] = nexttag[i] = 0;
+  }
+
+  if (style == LATTICE) lattice();
+  else random_walk();
+
+  // make chains continuous across periodic boundaries, then add the bonds
+
+  set_images();
+  add_bonds();
+
+  int nchain_all;
+  MPI_Allreduce(&nchain_local,&nchain_all,1,MPI_INT,MPI_SUM,world);
+
+  delete [] chain;
+  delete [] bead;
+  delete [] prevtag;
+  delete [] nexttag;
+
+  if (me == 0) {
+    if (screen) {
+      fprintf(screen,"  %d chains of %d beads\n",nchain_all,nbead);
+      fprintf(screen,"  " BIGINT_FORMAT " bonds\n",atom->nbonds);
+    }
+    if (logfile) {
+      fprintf(logfile,"  %d chains of %d beads\n",nchain_all,nbead);
+      fprintf(logfile,"  " BIGINT_FORMAT " bonds\n",atom->nbonds);
+    }
+  }
+
+  // rebuild special lists for the new topology
+
+  Special special(lmp);
+  special.build();
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if owned atom i can become a bead
+   it must be in the group and not already bonded
+------------------------------------------------------------------------- */
+
+int CreateChains::free_atom(int i)
+{
+  if (!(atom->mask[i] & groupbit)) return 0;
+  if (atom->num_bond[i] || atom->nspecial[i][0]) return 0;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   chains of consecutive atom IDs
+   chain c holds IDs c*(nbead+nskip) + 1 to c*(nbead+nskip) + nbead,
+     the nskip following IDs stay solvent
+   a chain is only created if all its beads are free atoms
+------------------------------------------------------------------------- */
+
+void CreateChains::lattice()
+{
+  int i,c,r;
+
+  int *tag = atom->tag;
+  int nlocal = atom->nlocal;
+
+  // IDs must be consecutive for the chains to be the path of create_atoms
+
+  int maxtag = 0;
+  for (i = 0; i < nlocal; i++) maxtag = MAX(maxtag,tag[i]);
+  int maxtag_all;
+  MPI_Allreduce(&maxtag,&maxtag_all,1,MPI_INT,MPI_MAX,world);
+  if (maxtag_all != atom->natoms)
+    error->all(FLERR,"Create_chains lattice requires consecutive atom IDs");
+
+  int period = nbead + nskip;
+  int npossible = (maxtag_all - nbead)/period + 1;
+  if (nchain >= 0) npossible = MIN(npossible,nchain);
+
+  // chains with a bead that is not a free atom are rejected
+  // the list of rejected chains is known to all procs
+
+  int nreject = 0;
+  int *reject = new int[nlocal+1];
+  for (i = 0; i < nlocal; i++) {
+    c = (tag[i]-1) / period;
+    r = (tag[i]-1) % period;
+    if (c >= npossible || r >= nbead) continue;
+    if (!free_atom(i)) reject[nreject++] = c;
+  }
+
+  int *recvcounts = new int[nprocs];
+  int *displs = new int[nprocs];
+  MPI_Allgather(&nreject,1,MPI_INT,recvcounts,1,MPI_INT,world);
+  int nreject_all = 0;
+  for (i = 0; i < nprocs; i++) {
+    displs[i] = nreject_all;
+    nreject_all += recvcounts[i];
+  }
+  int *reject_all = new int[nreject_all+1];
+  MPI_Allgatherv(reject,nreject,MPI_INT,reject_all,recvcounts,displs,
+                 MPI_INT,world);
+  qsort(reject_all,nreject_all,sizeof(int),compare_ints);
+  int n = 0;
+  for (i = 0; i < nreject_all; i++)
+    if (n == 0 || reject_all[i] != reject_all[n-1])
+      reject_all[n++] = reject_all[i];
+  nreject_all = n;
+
+  // chains are renumbered consecutively, skipping rejected ones
+
+  nchain_local = 0;
+  int lo,hi,mid;
+  for (i = 0; i < nlocal; i++) {
+    c = (tag[i]-1) / period;
+    r = (tag[i]-1) % period;
+    if (c >= npossible || r >= nbead) continue;
+
+    // lo = # of rejected chains < c
+
+    lo = 0;
+    hi = nreject_all;
+    while (lo < hi) {
+      mid = (lo+hi)/2;
+      if (reject_all[mid] < c) lo = mid+1;
+      else hi = mid;
+    }
+    if (lo < nreject_all && reject_all[lo] == c) continue;
+
+    chain[i] = c - lo;
+    bead[i] = r;
+    if (r > 0) prevtag[i] = tag[i] - 1;
+    if (r < nbead-1) nexttag[i] = tag[i] + 1;
+    if (r == 0) nchain_local++;
+  }
+
+  delete [] reject;
+  delete [] reject_all;
+  delete [] recvcounts;
+  delete [] displs;
+}
+
+/* ----------------------------------------------------------------------
+   chains grown as self-avoiding random walks through free atoms
+   each step moves to a random free atom within cutoff of the last bead
+   walks stay within the atoms owned by this proc, so no two procs
+     compete for an atom, a walk that gets stuck is undone
+------------------------------------------------------------------------- */
+
+void CreateChains::random_walk()
+{
+  int i,j,k,m,ix,iy,iz,jx,jy,jz;
+
+  double **x = atom->x;
+  int *tag = atom->tag;
+  int nlocal = atom->nlocal;
+  int dimension = domain->dimension;
+
+  // candidate atoms and their bounding box
+
+  int ncand = 0;
+  int *cand = new int[nlocal+1];
+  double lo[3],hi[3];
+  lo[0] = lo[1] = lo[2] = 0.0;
+  hi[0] = hi[1] = hi[2] = 0.0;
+  for (i = 0; i < nlocal; i++) {
+    if (!free_atom(i)) continue;
+    for (k = 0; k < 3; k++) {
+      if (ncand == 0 || x[i][k] < lo[k]) lo[k] = x[i][k];
+      if (ncand == 0 || x[i][k] > hi[k]) hi[k] = x[i][k];
+    }
+    cand[ncand++] = i;
+  }
+
+  // bins of at least cutoff, at most ~8 bins per candidate
+
+  double binsize = cutoff;
+  int nbinx,nbiny,nbinz;
+  while (1) {
+    nbinx = static_cast<int> ((hi[0]-lo[0])/binsize) + 1;
+    nbiny = static_cast<int> ((hi[1]-lo[1])/binsize) + 1;
+    nbinz = dimension == 3 ? static_cast<int> ((hi[2]-lo[2])/binsize) + 1 : 1;
+    if ((double) nbinx*nbiny*nbinz <= 8.0*ncand + 8.0) break;
+    binsize *= 2.0;
+  }
+  int nbins = nbinx*nbiny*nbinz;
+
+  int *binhead = new int[nbins];
+  int *bins = new int[nlocal+1];
+  int *binof = new int[nlocal+1];
+  for (m = 0; m < nbins; m++) binhead[m] = -1;
+  for (k = 0; k < ncand; k++) {
+    i = cand[k];
+    ix = MIN(static_cast<int> ((x[i][0]-lo[0])/binsize),nbinx-1);
+    iy = MIN(static_cast<int> ((x[i][1]-lo[1])/binsize),nbiny-1);
+    iz = dimension == 3 ?
+      MIN(static_cast<int> ((x[i][2]-lo[2])/binsize),nbinz-1) : 0;
+    m = (iz*nbiny + iy)*nbinx + ix;
+    binof[i] = m;
+    bins[i] = binhead[m];
+    binhead[m] = i;
+  }
+
+  // number of chains grown here, in proportion to the candidates
+
+  bigint ncand_local = ncand;
+  bigint ncand_all;
+  MPI_Allreduce(&ncand_local,&ncand_all,1,MPI_LMP_BIGINT,MPI_SUM,world);
+
+  int maxchain = static_cast<int> (fraction*ncand/nbead);
+  if (nchain >= 0 && ncand_all > 0) {
+    double share = (double) nchain * ncand / ncand_all;
+    maxchain = MIN(maxchain,static_cast<int> (share + 0.5));
+  }
+
+  // grow walks from random candidates
+  // stop after many stuck walks, the remaining free atoms are isolated
+
+  RanPark *random = new RanPark(lmp,seed + me);
+  for (i = 0; i < 100; i++) random->uniform();
+
+  char *used = new char[nlocal+1];
+  for (i = 0; i < nlocal; i++) used[i] = 0;
+  int *walk = new int[nbead];
+  int *next = new int[MAXNEXT];
+
+  double cutsq = cutoff*cutoff;
+  double delx,dely,delz;
+  int nwalk,nnext,nstuck,ncurrent;
+
+  nchain_local = 0;
+  nstuck = 0;
+  ncurrent = ncand;
+  while (nchain_local < maxchain && ncurrent > 0 && nstuck < 10*ncand + 100) {
+
+    // random unused candidate, used ones are removed from the list
+
+    k = static_cast<int> (random->uniform()*ncurrent);
+    if (k == ncurrent) k--;
+    i = cand[k];
+    if (used[i]) {
+      cand[k] = cand[--ncurrent];
+      continue;
+    }
+
+    walk[0] = i;
+    used[i] = 1;
+    for (nwalk = 1; nwalk < nbead; nwalk++) {
+      i = walk[nwalk-1];
+      ix = binof[i] % nbinx;
+      iy = (binof[i] / nbinx) % nbiny;
+      iz = binof[i] / (nbinx*nbiny);
+
+      nnext = 0;
+      for (jz = MAX(iz-1,0); jz <= MIN(iz+1,nbinz-1); jz++)
+        for (jy = MAX(iy-1,0); jy <= MIN(iy+1,nbiny-1); jy++)
+          for (jx = MAX(ix-1,0); jx <= MIN(ix+1,nbinx-1); jx++)
+            for (j = binhead[(jz*nbiny + jy)*nbinx + jx]; j >= 0; j = bins[j]) {
+              if (used[j] || nnext == MAXNEXT) continue;
+              delx = x[j][0] - x[i][0];
+              dely = x[j][1] - x[i][1];
+              delz = x[j][2] - x[i][2];
+              if (delx*delx + dely*dely + delz*delz <= cutsq) 
+                next[nnext++] = j;
+            }
+      if (nnext == 0) break;
+
+      k = static_cast<int> (random->uniform()*nnext);
+      if (k == nnext) k--;
+      walk[nwalk] = next[k];
+      used[next[k]] = 1;
+    }
+
+    // keep a complete walk, undo a stuck one but leave its 1st atom used
+    //   so it is not tried again
+
+    if (nwalk < nbead) {
+      for (k = 1; k < nwalk; k++) used[walk[k]] = 0;
+      nstuck++;
+      continue;
+    }
+
+    for (k = 0; k < nbead; k++) {
+      i = walk[k];
+      chain[i] = nchain_local;
+      bead[i] = k;
+      if (k > 0) prevtag[i] = tag[walk[k-1]];
+      if (k < nbead-1) nexttag[i] = tag[walk[k+1]];
+    }
+    nchain_local++;
+  }
+
+  // global chain index = offset of this proc + local index
+
+  MPI_Scan(&nchain_local,&chain_offset,1,MPI_INT,MPI_SUM,world);
+  chain_offset -= nchain_local;
+  for (i = 0; i < nlocal; i++)
+    if (chain[i] >= 0) chain[i] += chain_offset;
+
+  delete random;
+  delete [] cand;
+  delete [] binhead;
+  delete [] bins;
+  delete [] binof;
+  delete [] used;
+  delete [] walk;
+  delete [] next;
+}
+
+/* ----------------------------------------------------------------------
+   set image flags so that the unwrapped chains are continuous
+   the 1st bead keeps its image, each following bead gets the image of
+     the previous bead plus the periodic jump of their bond
+   only non-zero images of 1st beads and non-zero jumps are exchanged,
+     the image of a bead is the sum of its chain's records up to the bead
+------------------------------------------------------------------------- */
+
+void CreateChains::set_images()
+{
+  int i,j,k,m,n;
+  double xc[3];
+
+  double **x = atom->x;
+  int *image = atom->image;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  double cutsq = cutoff*cutoff;
+
+  // records of 5 ints: chain, bead, image or jump in x,y,z
+
+  int maxrec = 0;
+  for (i = 0; i < nlocal; i++) if (chain[i] >= 0) maxrec++;
+  int *rec = new int[5*maxrec+1];
+
+  int nrec = 0;
+  int flag = 0;
+  int img[3];
+  for (i = 0; i < nlocal; i++) {
+    if (chain[i] < 0) continue;
+    if (bead[i] == 0) {
+      img[0] = (image[i] & 1023) - 512;
+      img[1] = ((image[i] >> 10) & 1023) - 512;
+      img[2] = (image[i] >> 20) - 512;
+    } else {
+
+      // closest copy of the previous bead, wrapped back into the box
+      //   the change of its image is the jump across the boundary
+
+      j = atom->map(prevtag[i]);
+      if (j < 0 || j >= nall) {
+        flag = 1;
+        continue;
+      }
+      domain->closest_image(x[i],x[j],xc);
+      double delx = xc[0] - x[i][0];
+      double dely = xc[1] - x[i][1];
+      double delz = xc[2] - x[i][2];
+      if (delx*delx + dely*dely + delz*delz > cutsq) {
+        flag = 1;
+        continue;
+      }
+      int jimage = (512 << 20) | (512 << 10) | 512;
+      domain->remap(xc,jimage);
+      img[0] = 512 - (jimage & 1023);
+      img[1] = 512 - ((jimage >> 10) & 1023);
+      img[2] = 512 - (jimage >> 20);
+    }
+    if (img[0] == 0 && img[1] == 0 && img[2] == 0) continue;
+    rec[5*nrec] = chain[i];
+    rec[5*nrec+1] = bead[i];
+    rec[5*nrec+2] = img[0];
+    rec[5*nrec+3] = img[1];
+    rec[5*nrec+4] = img[2];
+    nrec++;
+  }
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) 
+    error->all(FLERR,"Create_chains bond atom missing or beyond cutoff");
+
+  int *recvcounts = new int[nprocs];
+  int *displs = new int[nprocs];
+  n = 5*nrec;
+  MPI_Allgather(&n,1,MPI_INT,recvcounts,1,MPI_INT,world);
+  int nrec_all = 0;
+  for (i = 0; i < nprocs; i++) {
+    displs[i] = nrec_all;
+    nrec_all += recvcounts[i];
+  }
+  int *rec_all = new int[nrec_all+1];
+  MPI_Allgatherv(rec,n,MPI_INT,rec_all,recvcounts,displs,MPI_INT,world);
+  nrec_all /= 5;
+  qsort(rec_all,nrec_all,5*sizeof(int),compare_records);
+
+  // image of each bead = sum of records of its chain up to the bead
+
+  int lo,hi,mid;
+  for (i = 0; i < nlocal; i++) {
+    if (chain[i] < 0) continue;
+
+    lo = 0;
+    hi = nrec_all;
+    while (lo < hi) {
+      mid = (lo+hi)/2;
+      if (rec_all[5*mid] < chain[i]) lo = mid+1;
+      else hi = mid;
+    }
+
+    img[0] = img[1] = img[2] = 0;
+    for (m = lo; m < nrec_all && rec_all[5*m] == chain[i] &&
+           rec_all[5*m+1] <= bead[i]; m++)
+      for (k = 0; k < 3; k++) img[k] += rec_all[5*m+2+k];
+
+    image[i] = (((img[2] + 512) & 1023) << 20) |
+      (((img[1] + 512) & 1023) << 10) | ((img[0] + 512) & 1023);
+  }
+
+  delete [] rec;
+  delete [] rec_all;
+  delete [] recvcounts;
+  delete [] displs;
+}
+
+/* ----------------------------------------------------------------------
+   add bond of each bead to the next bead, and to the previous bead if
+     newton_bond is off, so bonds are stored as by read_data
+   set molecule ID of beads to 1 more than largest existing ID + chain
+------------------------------------------------------------------------- */
+
+void CreateChains::add_bonds()
+{
+  int i,m;
+
+  int nlocal = atom->nlocal;
+  int newton_bond = force->newton_bond;
+
+  // grow bond arrays if needed, copying existing bonds
+
+  int maxbond = 0;
+  for (i = 0; i < nlocal; i++) {
+    m = atom->num_bond[i];
+    if (nexttag[i]) m++;
+    if (!newton_bond && prevtag[i]) m++;
+    maxbond = MAX(maxbond,m);
+  }
+  int maxbond_all;
+  MPI_Allreduce(&maxbond,&maxbond_all,1,MPI_INT,MPI_MAX,world);
+
+  if (maxbond_all > atom->bond_per_atom) {
+    int nmax = atom->nmax;
+    int **bond_type,**bond_atom;
+    memory->create(bond_type,nmax,maxbond_all,"atom:bond_type");
+    memory->create(bond_atom,nmax,maxbond_all,"atom:bond_atom");
+    for (i = 0; i < nlocal; i++)
+      for (m = 0; m < atom->num_bond[i]; m++) {
+        bond_type[i][m] = atom->bond_type[i][m];
+        bond_atom[i][m] = atom->bond_atom[i][m];
+      }
+    memory->destroy(atom->bond_type);
+    memory->destroy(atom->bond_atom);
+    atom->bond_type = bond_type;
+    atom->bond_atom = bond_atom;
+    atom->bond_per_atom = maxbond_all;
+    atom->avec->grow_reset();
+  }
+
+  int *num_bond = atom->num_bond;
+  int **bond_type = atom->bond_type;
+  int **bond_atom = atom->bond_atom;
+
+  for (i = 0; i < nlocal; i++) {
+    if (nexttag[i]) {
+      bond_type[i][num_bond[i]] = btype;
+      bond_atom[i][num_bond[i]] = nexttag[i];
+      num_bond[i]++;
+    }
+    if (!newton_bond && prevtag[i]) {
+      bond_type[i][num_bond[i]] = btype;
+      bond_atom[i][num_bond[i]] = prevtag[i];
+      num_bond[i]++;
+    }
+  }
+
+  bigint nbonds = 0;
+  for (i = 0; i < nlocal; i++) nbonds += num_bond[i];
+  MPI_Allreduce(&nbonds,&atom->nbonds,1,MPI_LMP_BIGINT,MPI_SUM,world);
+  if (!newton_bond) atom->nbonds /= 2;
+
+  if (molflag) {
+    int *molecule = atom->molecule;
+    int maxmol = 0;
+    for (i = 0; i < nlocal; i++) maxmol = MAX(maxmol,molecule[i]);
+    int maxmol_all;
+    MPI_Allreduce(&maxmol,&maxmol_all,1,MPI_INT,MPI_MAX,world);
+    for (i = 0; i < nlocal; i++)
+      if (chain[i] >= 0) molecule[i] = maxmol_all + chain[i] + 1;
+  }
+}
@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef COMMAND_CLASS
+
+CommandStyle(create_chains,CreateChains)
+
+#else
+
+#ifndef LMP_CREATE_CHAINS_H
+#define LMP_CREATE_CHAINS_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class CreateChains : protected Pointers {
+ public:
+  CreateChains(class LAMMPS *);
+  void command(int, char **);
+
+ private:
+  int me,nprocs;
+  int groupbit,nbead,btype,nskip,seed,nchain,molflag;
+  double fraction,cutoff;
+
+  int *chain;                   // chain of each owned atom, -1 if none
+  int *bead;                    // position of the atom in its chain
+  int *prevtag,*nexttag;        // neighbors of the atom in its chain, 0 if none
+  int nchain_local;             // chains with a first bead on this proc
+  int chain_offset;             // 1st global chain index of this proc
+
+  int free_atom(int);
+  void lattice();
+  void random_walk();
+  void set_images();
+  void add_bonds();
+};
+
+}
+
+#endif
+#endif
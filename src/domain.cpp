@@ -71,6 +71,10 @@ Domain::Domain(LAMMPS *lmp) : Pointers(lmp)
   h_rate[0] = h_rate[1] = h_rate[2] = 
     h_rate[3] = h_rate[4] = h_rate[5] = 0.0;
   h_ratelo[0] = h_ratelo[1] = h_ratelo[2] = 0.0;
+
+  le_flag = 0;
+  le_offset = le_vshear = 0.0;
+  le_nwrap = le_groupbit = 0;
   
   prd_lamda[0] = prd_lamda[1] = prd_lamda[2] = 1.0;
   prd_half_lamda[0] = prd_half_lamda[1] = prd_half_lamda[2] = 0.5;
@@ -115,6 +119,17 @@ void Domain::init()
       }
     }
 
+  // check for fix lees/edwards, which sets le_vshear and le_groupbit
+
+  le_flag = 0;
+  for (int i = 0; i < modify->nfix; i++)
+    if (strcmp(modify->fix[i]->style,"lees/edwards") == 0) {
+      if (le_flag) error->all(FLERR,"More than one fix lees/edwards");
+      le_flag = 1;
+    }
+  if (le_flag && triclinic)
+    error->all(FLERR,"Cannot use fix lees/edwards with triclinic box");
+
   // region inits
 
   for (int i = 0; i < nregion; i++) regions[i]->init();
@@ -212,6 +227,7 @@ void Domain::set_global_box()
 
 /* ----------------------------------------------------------------------
    set lamda box params, only need be done one time
+     unless sub-domains are changed by the balance command
    assumes global box is defined and proc assignment has been made by comm
    for uppermost proc, insure subhi = 1.0 (in case round-off occurs)
 ------------------------------------------------------------------------- */
@@ -221,6 +237,20 @@ void Domain::set_lamda_box()
   int *myloc = comm->myloc;
   int *procgrid = comm->procgrid;
 
+  if (comm->uniform == 0) {
+    double *xsplit = comm->xsplit;
+    double *ysplit = comm->ysplit;
+    double *zsplit = comm->zsplit;
+
+    sublo_lamda[0] = xsplit[myloc[0]];
+    subhi_lamda[0] = xsplit[myloc[0]+1];
+    sublo_lamda[1] = ysplit[myloc[1]];
+    subhi_lamda[1] = ysplit[myloc[1]+1];
+    sublo_lamda[2] = zsplit[myloc[2]];
+    subhi_lamda[2] = zsplit[myloc[2]+1];
+    return;
+  }
+
   sublo_lamda[0] = 1.0*myloc[0] / procgrid[0];
   sublo_lamda[1] = 1.0*myloc[1] / procgrid[1];
   sublo_lamda[2] = 1.0*myloc[2] / procgrid[2];
@@ -242,6 +272,8 @@ void Domain::set_lamda_box()
    set local subbox params
    assumes global box is defined and proc assignment has been made
    for uppermost proc, insure subhi = boxhi (in case round-off occurs)
+   non-uniform sub-domains are set from fractional bounds in comm
+   RCB tiles are not on a grid, use my fractional bounds directly
 ------------------------------------------------------------------------- */
 
 void Domain::set_local_box()
@@ -249,7 +281,35 @@ void Domain::set_local_box()
   int *myloc = comm->myloc;
   int *procgrid = comm->procgrid;
 
-  if (triclinic == 0) {
+  if (triclinic == 0 && comm->rcb) {
+    for (int i = 0; i < 3; i++) {
+      sublo[i] = boxlo[i] + prd[i]*comm->mysplit[i][0];
+      if (comm->mysplit[i][1] < 1.0)
+	subhi[i] = boxlo[i] + prd[i]*comm->mysplit[i][1];
+      else subhi[i] = boxhi[i];
+    }
+
+  } else if (triclinic == 0 && comm->uniform == 0) {
+    double *xsplit = comm->xsplit;
+    double *ysplit = comm->ysplit;
+    double *zsplit = comm->zsplit;
+
+    sublo[0] = boxlo[0] + xprd*xsplit[myloc[0]];
+    if (myloc[0] < procgrid[0]-1)
+      subhi[0] = boxlo[0] + xprd*xsplit[myloc[0]+1];
+    else subhi[0] = boxhi[0];
+
+    sublo[1] = boxlo[1] + yprd*ysplit[myloc[1]];
+    if (myloc[1] < procgrid[1]-1)
+      subhi[1] = boxlo[1] + yprd*ysplit[myloc[1]+1];
+    else subhi[1] = boxhi[1];
+
+    sublo[2] = boxlo[2] + zprd*zsplit[myloc[2]];
+    if (myloc[2] < procgrid[2]-1)
+      subhi[2] = boxlo[2] + zprd*zsplit[myloc[2]+1];
+    else subhi[2] = boxhi[2];
+
+  } else if (triclinic == 0) {
     sublo[0] = boxlo[0] + myloc[0] * xprd / procgrid[0];
     if (myloc[0] < procgrid[0]-1)
       subhi[0] = boxlo[0] + (myloc[0]+1) * xprd / procgrid[0];
@@ -378,7 +438,44 @@ void Domain::pbc()
     period = prd_lamda;
   }
 
+  double **vest = atom->vest;
+  int vest_flag = atom->vest_flag;
+
   for (i = 0; i < nlocal; i++) {
+
+    // with Lees-Edwards boundaries, the y images are shifted in x
+    // wrap y first, so the shifted x is wrapped below
+
+    if (le_flag) {
+      if (x[i][1] < lo[1]) {
+	x[i][1] += period[1];
+	x[i][0] += le_offset;
+	if (mask[i] & le_groupbit) {
+	  v[i][0] += le_vshear;
+	  if (vest_flag) vest[i][0] += le_vshear;
+	}
+	idim = (image[i] >> 10) & 1023;
+        otherdims = image[i] ^ (idim << 10);
+	idim--;
+	idim &= 1023;
+	image[i] = otherdims | (idim << 10);
+      }
+      if (x[i][1] >= hi[1]) {
+	x[i][1] -= period[1];
+	x[i][1] = MAX(x[i][1],lo[1]);
+	x[i][0] -= le_offset;
+	if (mask[i] & le_groupbit) {
+	  v[i][0] -= le_vshear;
+	  if (vest_flag) vest[i][0] -= le_vshear;
+	}
+	idim = (image[i] >> 10) & 1023;
+        otherdims = image[i] ^ (idim << 10);
+	idim++;
+	idim &= 1023;
+	image[i] = otherdims | (idim << 10);
+      }
+    }
+
     if (xperiodic) {
       if (x[i][0] < lo[0]) {
 	x[i][0] += period[0];
@@ -478,11 +575,12 @@ int Domain::minimum_image_check(double dx, double dy, double dz)
    minimum image convention
    use 1/2 of box size as test 
    for triclinic, also add/subtract tilt factors in other dims as needed
+   for Lees-Edwards, the x shift of the y images acts as the xy tilt
 ------------------------------------------------------------------------- */
 
 void Domain::minimum_image(double &dx, double &dy, double &dz)
 {
-  if (triclinic == 0) {
+  if (triclinic == 0 && le_flag == 0) {
     if (xperiodic) {
       if (fabs(dx) > xprd_half) {
 	if (dx < 0.0) dx += xprd;
@@ -503,6 +601,7 @@ void Domain::minimum_image(double &dx, double &dy, double &dz)
     }
 
   } else {
+    double sxy = le_flag ? le_offset : xy;
     if (zperiodic) {
       if (fabs(dz) > zprd_half) {
 	if (dz < 0.0) {
@@ -520,10 +619,10 @@ void Domain::minimum_image(double &dx, double &dy, double &dz)
       if (fabs(dy) > yprd_half) {
 	if (dy < 0.0) {
 	  dy += yprd;
-	  dx += xy;
+	  dx += sxy;
 	} else {
 	  dy -= yprd;
-	  dx -= xy;
+	  dx -= sxy;
 	}
       }
     }
@@ -544,7 +643,7 @@ void Domain::minimum_image(double &dx, double &dy, double &dz)
 
 void Domain::minimum_image(double *delta)
 {
-  if (triclinic == 0) {
+  if (triclinic == 0 && le_flag == 0) {
     if (xperiodic) {
       if (fabs(delta[0]) > xprd_half) {
 	if (delta[0] < 0.0) delta[0] += xprd;
@@ -565,6 +664,7 @@ void Domain::minimum_image(double *delta)
     }
 
   } else {
+    double sxy = le_flag ? le_offset : xy;
     if (zperiodic) {
       if (fabs(delta[2]) > zprd_half) {
 	if (delta[2] < 0.0) {
@@ -582,10 +682,10 @@ void Domain::minimum_image(double *delta)
       if (fabs(delta[1]) > yprd_half) {
 	if (delta[1] < 0.0) {
 	  delta[1] += yprd;
-	  delta[0] += xy;
+	  delta[0] += sxy;
 	} else {
 	  delta[1] -= yprd;
-	  delta[0] -= xy;
+	  delta[0] -= sxy;
 	}
       }
     }
@@ -601,13 +701,14 @@ void Domain::minimum_image(double *delta)
 /* ----------------------------------------------------------------------
    find Xj image = periodic image of Xj that is closest to Xi
    for triclinic, also add/subtract tilt factors in other dims as needed
+   for Lees-Edwards, the x shift of the y images acts as the xy tilt
 ------------------------------------------------------------------------- */
 
 void Domain::closest_image(const double * const xi, const double * const xj, double * const xjimage)
 {
   double dx,dy,dz;
 
-  if (triclinic == 0) {
+  if (triclinic == 0 && le_flag == 0) {
     if (xperiodic) {
       dx = xj[0] - xi[0];
       if (dx < 0.0) {
@@ -643,6 +744,7 @@ void Domain::closest_image(const double * const xi, const double * const xj, dou
     }
 
   } else {
+    double sxy = le_flag ? le_offset : xy;
     dx = xj[0] - xi[0];
     dy = xj[1] - xi[1];
     dz = xj[2] - xi[2];
@@ -676,20 +778,20 @@ void Domain::closest_image(const double * const xi, const double * const xj, dou
       if (dy < 0.0) {
 	while (dy < 0.0) {
 	  dy += yprd;
-	  dx += xy;
+	  dx += sxy;
 	}
 	if (dy > yprd_half) {
 	  dy -= yprd;
-	  dx -= xy;
+	  dx -= sxy;
 	}
       } else {
 	while (dy > 0.0) {
 	  dy -= yprd;
-	  dx -= xy;
+	  dx -= sxy;
 	}
 	if (dy < -yprd_half) {
 	  dy += yprd;
-	  dx += xy;
+	  dx += sxy;
 	}
       }
     }
@@ -737,6 +839,29 @@ void Domain::remap(double *x, int &image)
     coord = lamda;
   }
 
+  // with Lees-Edwards boundaries, wrap y first, since it shifts x
+
+  if (le_flag) {
+    while (coord[1] < lo[1]) {
+      coord[1] += period[1];
+      coord[0] += le_offset;
+      int idim = (image >> 10) & 1023;
+      int otherdims = image ^ (idim << 10);
+      idim--;
+      idim &= 1023;
+      image = otherdims | (idim << 10);
+    }
+    while (coord[1] >= hi[1]) {
+      coord[1] -= period[1];
+      coord[0] -= le_offset;
+      int idim = (image >> 10) & 1023;
+      int otherdims = image ^ (idim << 10);
+      idim++;
+      idim &= 1023;
+      image = otherdims | (idim << 10);
+    }
+  }
+
   if (xperiodic) {
     while (coord[0] < lo[0]) {
       coord[0] += period[0];
@@ -78,6 +78,13 @@ class Domain : protected Pointers {
   int deform_vremap;              // 1 if fix deform remaps v, else 0
   int deform_groupbit;            // atom group to perform v remap for
 
+                                  // Lees-Edwards boundaries in y
+  int le_flag;                    // 1 if fix lees/edwards exists, else 0
+  double le_offset;               // x shift of the image above, 0 to xprd
+  int le_nwrap;                   // # of times le_offset wrapped past xprd
+  double le_vshear;               // x velocity of the image above
+  int le_groupbit;                // atom group to perform v remap for
+
   class Lattice *lattice;                  // user-defined lattice
 
   int nregion;                             // # of defined Regions
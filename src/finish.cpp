@@ -502,6 +502,7 @@ void Finish::end(int flag)
     for (m = 0; m < neighbor->old_nrequest; m++)
       if ((neighbor->old_requests[m]->half || 
 	   neighbor->old_requests[m]->gran ||
+	   neighbor->old_requests[m]->size ||
 	   neighbor->old_requests[m]->respaouter ||
 	   neighbor->old_requests[m]->half_from_full) &&
 	  neighbor->old_requests[m]->skip == 0 &&
@@ -0,0 +1,760 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   multiple-tau correlator, see
+   Ramirez, Sukumaran, Vorselaars, Likhtman, J Chem Phys, 133, 154103 (2010)
+------------------------------------------------------------------------- */
+
+#include "lmptype.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_ave_correlate_long.h"
+#include "atom.h"
+#include "group.h"
+#include "update.h"
+#include "modify.h"
+#include "compute.h"
+#include "input.h"
+#include "variable.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{COMPUTE,FIX,VARIABLE,V};
+enum{AUTO,UPPER,LOWER,AUTOUPPER,AUTOLOWER,FULL};
+
+#define INVOKED_SCALAR 1
+#define INVOKED_VECTOR 2
+#define INVOKED_PERATOM 8
+
+#define MAXEXCHANGE 900       // per-atom state must fit in Comm::BUFEXTRA
+
+/* ---------------------------------------------------------------------- */
+
+FixAveCorrelateLong::FixAveCorrelateLong(LAMMPS * lmp, int narg, char **arg):
+  Fix (lmp, narg, arg)
+{
+  if (narg < 6) error->all(FLERR,"Illegal fix ave/correlate/long command");
+
+  MPI_Comm_rank(world,&me);
+
+  nevery = atoi(arg[3]);
+  nfreq = atoi(arg[4]);
+
+  global_freq = nfreq;
+  time_depend = 1;
+
+  // parse values until one isn't recognized
+
+  which = new int[narg-5];
+  argindex = new int[narg-5];
+  ids = new char*[narg-5];
+  value2index = new int[narg-5];
+  nvalues = 0;
+
+  int iarg = 5;
+  while (iarg < narg) {
+    ids[nvalues] = NULL;
+
+    if (strcmp(arg[iarg],"vx") == 0 || strcmp(arg[iarg],"vy") == 0 ||
+        strcmp(arg[iarg],"vz") == 0) {
+      which[nvalues] = V;
+      argindex[nvalues] = arg[iarg][1] - 'x';
+      nvalues++;
+      iarg++;
+
+    } else if (strncmp(arg[iarg],"c_",2) == 0 || 
+               strncmp(arg[iarg],"f_",2) == 0 || 
+               strncmp(arg[iarg],"v_",2) == 0) {
+      if (arg[iarg][0] == 'c') which[nvalues] = COMPUTE;
+      else if (arg[iarg][0] == 'f') which[nvalues] = FIX;
+      else if (arg[iarg][0] == 'v') which[nvalues] = VARIABLE;
+
+      int n = strlen(arg[iarg]);
+      char *suffix = new char[n];
+      strcpy(suffix,&arg[iarg][2]);
+
+      char *ptr = strchr(suffix,'[');
+      if (ptr) {
+        if (suffix[strlen(suffix)-1] != ']')
+          error->all(FLERR,"Illegal fix ave/correlate/long command");
+        argindex[nvalues] = atoi(ptr+1);
+        *ptr = '\0';
+      } else argindex[nvalues] = 0;
+
+      n = strlen(suffix) + 1;
+      ids[nvalues] = new char[n];
+      strcpy(ids[nvalues],suffix);
+      delete [] suffix;
+
+      nvalues++;
+      iarg++;
+    } else break;
+  }
+
+  // optional args
+
+  type = AUTO;
+  startstep = 0;
+  prefactor = 1.0;
+  atomflag = 0;
+  ncorr = 20;
+  plen = 16;
+  mblock = 2;
+  fp = NULL;
+
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"type") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      if (strcmp(arg[iarg+1],"auto") == 0) type = AUTO;
+      else if (strcmp(arg[iarg+1],"upper") == 0) type = UPPER;
+      else if (strcmp(arg[iarg+1],"lower") == 0) type = LOWER;
+      else if (strcmp(arg[iarg+1],"auto/upper") == 0) type = AUTOUPPER;
+      else if (strcmp(arg[iarg+1],"auto/lower") == 0) type = AUTOLOWER;
+      else if (strcmp(arg[iarg+1],"full") == 0) type = FULL;
+      else error->all(FLERR,"Illegal fix ave/correlate/long command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"atom") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      if (strcmp(arg[iarg+1],"yes") == 0) atomflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) atomflag = 0;
+      else error->all(FLERR,"Illegal fix ave/correlate/long command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"ncorr") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      ncorr = atoi(arg[iarg+1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"nlen") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      plen = atoi(arg[iarg+1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"ncount") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      mblock = atoi(arg[iarg+1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"start") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      startstep = atoi(arg[iarg+1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"prefactor") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      prefactor = atof(arg[iarg+1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"file") == 0) {
+      if (iarg+2 > narg) 
+        error->all(FLERR,"Illegal fix ave/correlate/long command");
+      if (me == 0) {
+        fp = fopen(arg[iarg+1],"w");
+        if (fp == NULL) {
+          char str[128];
+          sprintf(str,"Cannot open fix ave/correlate/long file %s",
+                  arg[iarg+1]);
+          error->one(FLERR,str);
+        }
+      }
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix ave/correlate/long command");
+  }
+
+  // setup and error check
+  // for fix inputs, check that fix frequency is acceptable
+
+  if (nevery <= 0 || nfreq <= 0 || nvalues == 0)
+    error->all(FLERR,"Illegal fix ave/correlate/long command");
+  if (nfreq % nevery)
+    error->all(FLERR,"Illegal fix ave/correlate/long command");
+  if (ncorr < 1 || mblock < 2 || plen < mblock || plen % mblock)
+    error->all(FLERR,"Illegal fix ave/correlate/long command");
+
+  for (int i = 0; i < nvalues; i++) {
+    if (which[i] == V) {
+      if (!atomflag)
+        error->all(FLERR,"Fix ave/correlate/long velocities require atom yes");
+
+    } else if (which[i] == COMPUTE) {
+      int icompute = modify->find_compute(ids[i]);
+      if (icompute < 0)
+        error->all(FLERR,"Compute ID for fix ave/correlate/long does not exist");
+      Compute *compute = modify->compute[icompute];
+      if (atomflag) {
+        if (compute->peratom_flag == 0)
+          error->all(FLERR,"Fix ave/correlate/long compute does not "
+                     "calculate per-atom values");
+        if (argindex[i] == 0 && compute->size_peratom_cols != 0)
+          error->all(FLERR,"Fix ave/correlate/long compute does not "
+                     "calculate a per-atom vector");
+        if (argindex[i] && compute->size_peratom_cols == 0)
+          error->all(FLERR,"Fix ave/correlate/long compute does not "
+                     "calculate a per-atom array");
+        if (argindex[i] && argindex[i] > compute->size_peratom_cols)
+          error->all(FLERR,"Fix ave/correlate/long compute vector "
+                     "is accessed out-of-range");
+      } else {
+        if (argindex[i] == 0 && compute->scalar_flag == 0)
+          error->all(FLERR,
+                     "Fix ave/correlate/long compute does not calculate a scalar");
+        if (argindex[i] && compute->vector_flag == 0)
+          error->all(FLERR,
+                     "Fix ave/correlate/long compute does not calculate a vector");
+        if (argindex[i] && argindex[i] > compute->size_vector)
+          error->all(FLERR,"Fix ave/correlate/long compute vector "
+                     "is accessed out-of-range");
+      }
+
+    } else if (which[i] == FIX) {
+      int ifix = modify->find_fix(ids[i]);
+      if (ifix < 0)
+        error->all(FLERR,"Fix ID for fix ave/correlate/long does not exist");
+      Fix *fix = modify->fix[ifix];
+      if (atomflag) {
+        if (fix->peratom_flag == 0)
+          error->all(FLERR,"Fix ave/correlate/long fix does not "
+                     "calculate per-atom values");
+        if (argindex[i] == 0 && fix->size_peratom_cols != 0)
+          error->all(FLERR,"Fix ave/correlate/long fix does not "
+                     "calculate a per-atom vector");
+        if (argindex[i] && fix->size_peratom_cols == 0)
+          error->all(FLERR,"Fix ave/correlate/long fix does not "
+                     "calculate a per-atom array");
+        if (argindex[i] && argindex[i] > fix->size_peratom_cols)
+          error->all(FLERR,"Fix ave/correlate/long fix vector "
+                     "is accessed out-of-range");
+        if (nevery % fix->peratom_freq)
+          error->all(FLERR,"Fix for fix ave/correlate/long "
+                     "not computed at compatible time");
+      } else {
+        if (argindex[i] == 0 && fix->scalar_flag == 0)
+          error->all(FLERR,
+                     "Fix ave/correlate/long fix does not calculate a scalar");
+        if (argindex[i] && fix->vector_flag == 0)
+          error->all(FLERR,
+                     "Fix ave/correlate/long fix does not calculate a vector");
+        if (argindex[i] && argindex[i] > fix->size_vector)
+          error->all(FLERR,"Fix ave/correlate/long fix vector "
+                     "is accessed out-of-range");
+        if (nevery % fix->global_freq)
+          error->all(FLERR,"Fix for fix ave/correlate/long "
+                     "not computed at compatible time");
+      }
+
+    } else if (which[i] == VARIABLE) {
+      int ivariable = input->variable->find(ids[i]);
+      if (ivariable < 0)
+        error->all(FLERR,
+                   "Variable name for fix ave/correlate/long does not exist");
+      if (atomflag && input->variable->atomstyle(ivariable) == 0)
+        error->all(FLERR,
+                   "Fix ave/correlate/long variable is not atom-style variable");
+      if (!atomflag && input->variable->equalstyle(ivariable) == 0)
+        error->all(FLERR,
+                   "Fix ave/correlate/long variable is not equal-style variable");
+    }
+  }
+
+  // correlation pairs (i,j) in the order of fix ave/correlate
+
+  int maxpair = nvalues*nvalues;
+  pairi = new int[maxpair];
+  pairj = new int[maxpair];
+  npair = 0;
+  for (int i = 0; i < nvalues; i++) {
+    if (type == AUTO) {
+      pairi[npair] = pairj[npair] = i;
+      npair++;
+      continue;
+    }
+    for (int j = 0; j < nvalues; j++) {
+      if ((type == UPPER && j > i) || (type == LOWER && j < i) ||
+          (type == AUTOUPPER && j >= i) || (type == AUTOLOWER && j <= i) ||
+          type == FULL) {
+        pairi[npair] = i;
+        pairj[npair] = j;
+        npair++;
+      }
+    }
+  }
+  if (npair == 0) error->all(FLERR,"Illegal fix ave/correlate/long command");
+
+  // output rows: all lags of level 0, lags >= plen/mblock of higher levels
+
+  dmin = plen/mblock;
+  nrows = plen + (ncorr-1)*(plen-dmin);
+  rowlevel = new int[nrows];
+  rowlag = new int[nrows];
+  int m = 0;
+  for (int k = 0; k < ncorr; k++)
+    for (int j = (k ? dmin : 0); j < plen; j++) {
+      rowlevel[m] = k;
+      rowlag[m++] = j;
+    }
+
+  // print file comment lines
+
+  if (fp && me == 0) {
+    fprintf(fp,"# Time-correlated data for fix %s\n",id);
+    fprintf(fp,"# Timestep Number-of-time-windows\n");
+    fprintf(fp,"# Index TimeDelta Ncount");
+    for (int i = 0; i < npair; i++)
+      fprintf(fp," %s*%s",arg[5+pairi[i]],arg[5+pairj[i]]);
+    fprintf(fp,"\n");
+  }
+
+  // allocate and initialize correlator
+  // the state of one correlator is the shift register of each value and
+  // level, then the accumulator of each value and level
+
+  nstate = nvalues*ncorr*(plen+1);
+  if (atomflag && nstate > MAXEXCHANGE)
+    error->all(FLERR,"Fix ave/correlate/long per-atom correlator is too large");
+
+  insert = new int[ncorr];
+  nfill = new int[ncorr];
+  naccum = new int[ncorr];
+  for (int k = 0; k < ncorr; k++) insert[k] = nfill[k] = naccum[k] = 0;
+
+  memory->create(ncount,ncorr*plen,"ave/correlate/long:ncount");
+  memory->create(corr,ncorr*plen,npair,"ave/correlate/long:corr");
+  for (int i = 0; i < ncorr*plen; i++) {
+    ncount[i] = 0.0;
+    for (int j = 0; j < npair; j++) corr[i][j] = 0.0;
+  }
+  memory->create(save,nrows,npair+2,"ave/correlate/long:save");
+  for (int i = 0; i < nrows; i++)
+    for (int j = 0; j < npair+2; j++) save[i][j] = 0.0;
+
+  memory->create(sample,nvalues,"ave/correlate/long:sample");
+  gstate = NULL;
+  astate = NULL;
+  maxstate = 0;
+  corr_all = NULL;
+  vatom = NULL;
+  maxatom = 0;
+
+  if (atomflag) {
+    memory->create(corr_all,ncorr*plen,npair,"ave/correlate/long:corr_all");
+    grow_arrays(atom->nmax);
+    atom->add_callback(0);
+  } else {
+    memory->create(gstate,nstate,"ave/correlate/long:gstate");
+    for (int j = 0; j < nstate; j++) gstate[j] = 0.0;
+  }
+
+  // this fix produces a global array
+
+  array_flag = 1;
+  size_array_rows = nrows;
+  size_array_cols = npair+2;
+  extarray = 0;
+
+  // nvalid = next step on which end_of_step does something
+  // add nvalid to all computes that store invocation times
+  // since don't know a priori which are invoked by this fix
+  // once in end_of_step() can set timestep for ones actually invoked
+
+  nvalid = nextvalid();
+  modify->addstep_compute_all(nvalid);
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixAveCorrelateLong::~FixAveCorrelateLong()
+{
+  // unregister callback to this fix from Atom class
+
+  if (atomflag) atom->delete_callback(id,0);
+
+  delete [] which;
+  delete [] argindex;
+  delete [] value2index;
+  for (int i = 0; i < nvalues; i++) delete [] ids[i];
+  delete [] ids;
+  delete [] pairi;
+  delete [] pairj;
+  delete [] rowlevel;
+  delete [] rowlag;
+  delete [] insert;
+  delete [] nfill;
+  delete [] naccum;
+
+  memory->destroy(ncount);
+  memory->destroy(corr);
+  memory->destroy(corr_all);
+  memory->destroy(save);
+  memory->destroy(sample);
+  memory->destroy(gstate);
+  memory->destroy(astate);
+  memory->destroy(vatom);
+
+  if (fp && me == 0) fclose(fp);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixAveCorrelateLong::setmask()
+{
+  int mask = 0;
+  mask |= END_OF_STEP;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixAveCorrelateLong::init()
+{
+  // set current indices for all computes,fixes,variables
+
+  for (int i = 0; i < nvalues; i++) {
+    if (which[i] == COMPUTE) {
+      int icompute = modify->find_compute(ids[i]);
+      if (icompute < 0)
+        error->all(FLERR,"Compute ID for fix ave/correlate/long does not exist");
+      value2index[i] = icompute;
+
+    } else if (which[i] == FIX) {
+      int ifix = modify->find_fix(ids[i]);
+      if (ifix < 0) 
+        error->all(FLERR,"Fix ID for fix ave/correlate/long does not exist");
+      value2index[i] = ifix;
+
+    } else if (which[i] == VARIABLE) {
+      int ivariable = input->variable->find(ids[i]);
+      if (ivariable < 0) 
+        error->all(FLERR,
+                   "Variable name for fix ave/correlate/long does not exist");
+      value2index[i] = ivariable;
+
+    } else value2index[i] = -1;
+  }
+
+  // need to reset nvalid if nvalid < ntimestep b/c minimize was performed
+
+  if (nvalid < update->ntimestep) {
+    nvalid = nextvalid();
+    modify->addstep_compute_all(nvalid);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   only does something if nvalid = current timestep
+------------------------------------------------------------------------- */
+
+void FixAveCorrelateLong::setup(int vflag)
+{
+  end_of_step();
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixAveCorrelateLong::end_of_step()
+{
+  int i,k,m,n;
+
+  // skip if not step which requires doing something
+
+  bigint ntimestep = update->ntimestep;
+  if (ntimestep != nvalid) return;
+
+  // collect values of computes,fixes,variables
+  // compute/fix/variable may invoke computes so wrap with clear/add
+
+  modify->clearstep_compute();
+
+  int *mask = atom->mask;
+  int nlocal = atom->nlocal;
+
+  // allocate at least one row so &vatom[0][i] is valid on an empty proc
+
+  if (atomflag && (nlocal > maxatom || vatom == NULL)) {
+    maxatom = MAX(atom->nmax,1);
+    memory->destroy(vatom);
+    memory->create(vatom,maxatom,nvalues,"ave/correlate/long:vatom");
+  }
+
+  for (i = 0; i < nvalues; i++) {
+    m = value2index[i];
+    n = argindex[i];
+
+    if (which[i] == V) {
+      double **v = atom->v;
+      for (int j = 0; j < nlocal; j++) vatom[j][i] = v[j][n];
+
+    // invoke compute if not previously invoked
+
+    } else if (which[i] == COMPUTE) {
+      Compute *compute = modify->compute[m];
+      if (atomflag) {
+        if (!(compute->invoked_flag & INVOKED_PERATOM)) {
+          compute->compute_peratom();
+          compute->invoked_flag |= INVOKED_PERATOM;
+        }
+        if (n == 0)
+          for (int j = 0; j < nlocal; j++)
+            vatom[j][i] = compute->vector_atom[j];
+        else
+          for (int j = 0; j < nlocal; j++)
+            vatom[j][i] = compute->array_atom[j][n-1];
+      } else if (n == 0) {
+        if (!(compute->invoked_flag & INVOKED_SCALAR)) {
+          compute->compute_scalar();
+          compute->invoked_flag |= INVOKED_SCALAR;
+        }
+        sample[i] = compute->scalar;
+      } else {
+        if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+          compute->compute_vector();
+          compute->invoked_flag |= INVOKED_VECTOR;
+        }
+        sample[i] = compute->vector[n-1];
+      }
+
+    // access fix fields, guaranteed to be ready
+
+    } else if (which[i] == FIX) {
+      Fix *fix = modify->fix[m];
+      if (atomflag) {
+        if (n == 0)
+          for (int j = 0; j < nlocal; j++) vatom[j][i] = fix->vector_atom[j];
+        else
+          for (int j = 0; j < nlocal; j++)
+            vatom[j][i] = fix->array_atom[j][n-1];
+      } else if (n == 0) sample[i] = fix->compute_scalar();
+      else sample[i] = fix->compute_vector(n-1);
+
+    // evaluate equal-style or atom-style variable
+
+    } else if (which[i] == VARIABLE) {
+      if (atomflag)
+        input->variable->compute_atom(m,igroup,&vatom[0][i],nvalues,0);
+      else sample[i] = input->variable->compute_equal(m);
+    }
+  }
+
+  nvalid += nevery;
+  modify->addstep_compute(nvalid);
+
+  // klast = highest level that receives a point from this sample
+  // level k+1 receives the average of mblock points of level k
+
+  int klast = 0;
+  while (klast < ncorr-1 && naccum[klast]+1 == mblock) klast++;
+
+  if (atomflag) {
+    for (i = 0; i < nlocal; i++)
+      if (mask[i] & groupbit) add(astate[i],vatom[i],klast);
+  } else add(gstate,sample,klast);
+
+  // advance the shared position of each level that received a point
+  // and count the samples of each lag
+
+  int jmin,jmax;
+  for (k = 0; k <= klast; k++) {
+    if (nfill[k] < plen) nfill[k]++;
+    jmin = k ? dmin : 0;
+    jmax = nfill[k];
+    for (int j = jmin; j < jmax; j++) ncount[k*plen+j] += 1.0;
+    insert[k]++;
+    if (insert[k] == plen) insert[k] = 0;
+    naccum[k]++;
+    if (naccum[k] == mblock) naccum[k] = 0;
+  }
+
+  if (ntimestep % nfreq == 0) output(ntimestep);
+}
+
+/* ----------------------------------------------------------------------
+   add the sample w to the correlator with the given state
+   levels 0 to klast receive a point, each higher level the average of
+     the last mblock points of the level below
+   the newest point of a level is correlated with all stored points of
+     the level, lags below dmin of levels above 0 are covered by the
+     level below
+------------------------------------------------------------------------- */
+
+void FixAveCorrelateLong::add(double *state, double *w, int klast)
+{
+  int i,j,k,ipair,inew,iold,jmin,jmax;
+  double *shift_i,*shift_j,*c;
+
+  double *shift = state;
+  double *accum = state + nvalues*ncorr*plen;
+  double invm = 1.0/mblock;
+
+  for (k = 0; k <= klast; k++) {
+
+    // store the new point of each value
+
+    inew = insert[k];
+    for (i = 0; i < nvalues; i++) {
+      double point = k ? accum[i*ncorr+k-1]*invm : w[i];
+      if (k) accum[i*ncorr+k-1] = 0.0;
+      shift[(i*ncorr+k)*plen+inew] = point;
+      accum[i*ncorr+k] += point;
+    }
+
+    // the last level has no level above to pass its average to
+
+    if (k == ncorr-1 && naccum[k]+1 == mblock)
+      for (i = 0; i < nvalues; i++) accum[i*ncorr+k] = 0.0;
+
+    // correlate with the stored points, nfill[k] is not yet advanced
+
+    jmin = k ? dmin : 0;
+    jmax = nfill[k] < plen ? nfill[k]+1 : plen;
+    for (j = jmin; j < jmax; j++) {
+      iold = inew - j;
+      if (iold < 0) iold += plen;
+      c = corr[k*plen+j];
+      for (ipair = 0; ipair < npair; ipair++) {
+        shift_i = shift + (pairi[ipair]*ncorr+k)*plen;
+        shift_j = shift + (pairj[ipair]*ncorr+k)*plen;
+        c[ipair] += shift_i[iold]*shift_j[inew];
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   normalize the correlations, save them for compute_array() and write
+     them to the file
+   correlations of per-atom values are summed over procs and averaged
+     over the atoms in the group
+------------------------------------------------------------------------- */
+
+void FixAveCorrelateLong::output(bigint ntimestep)
+{
+  int i,j,k,m;
+
+  double **c = corr;
+  double natoms = 1.0;
+  if (atomflag) {
+    MPI_Allreduce(&corr[0][0],&corr_all[0][0],ncorr*plen*npair,
+                  MPI_DOUBLE,MPI_SUM,world);
+    c = corr_all;
+    natoms = group->count(igroup);
+    if (natoms == 0.0) natoms = 1.0;
+  }
+
+  double lag = nevery;
+  for (m = 0; m < nrows; m++) {
+    k = rowlevel[m];
+    j = rowlag[m];
+    if (m && k != rowlevel[m-1]) lag *= mblock;
+    save[m][0] = j*lag;
+    save[m][1] = ncount[k*plen+j];
+    for (i = 0; i < npair; i++) {
+      if (save[m][1] > 0.0)
+        save[m][i+2] = prefactor*c[k*plen+j][i]/(save[m][1]*natoms);
+      else save[m][i+2] = 0.0;
+    }
+  }
+
+  if (fp && me == 0) {
+    fprintf(fp,BIGINT_FORMAT " %d\n",ntimestep,nrows);
+    for (m = 0; m < nrows; m++) {
+      fprintf(fp,"%d %g %g",m+1,save[m][0],save[m][1]);
+      for (i = 0; i < npair; i++) fprintf(fp," %g",save[m][i+2]);
+      fprintf(fp,"\n");
+    }
+    fflush(fp);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return I,J array value
+------------------------------------------------------------------------- */
+
+double FixAveCorrelateLong::compute_array(int i, int j)
+{
+  return save[i][j];
+}
+
+/* ----------------------------------------------------------------------
+   nvalid = next step on which end_of_step does something
+   this step if multiple of nevery, else next multiple
+   startstep is lower bound
+------------------------------------------------------------------------- */
+
+bigint FixAveCorrelateLong::nextvalid()
+{
+  bigint nvalid = update->ntimestep;
+  if (startstep > nvalid) nvalid = startstep;
+  if (nvalid % nevery) nvalid = (nvalid/nevery)*nevery + nevery;
+  return nvalid;
+}
+
+/* ----------------------------------------------------------------------
+   memory usage of correlators
+------------------------------------------------------------------------- */
+
+double FixAveCorrelateLong::memory_usage()
+{
+  double bytes = ncorr*plen * (npair+1) * sizeof(double);
+  bytes += nrows * (npair+2) * sizeof(double);
+  if (atomflag) {
+    bytes += ncorr*plen * npair * sizeof(double);
+    bytes += atom->nmax * nstate * sizeof(double);
+    bytes += maxatom * nvalues * sizeof(double);
+  } else bytes += nstate * sizeof(double);
+  return bytes;
+}
+
+/* ----------------------------------------------------------------------
+   allocate atom-based array
+   new atoms start with an empty correlator
+------------------------------------------------------------------------- */
+
+void FixAveCorrelateLong::grow_arrays(int nmax)
+{
+  memory->grow(astate,nmax,nstate,"ave/correlate/long:astate");
+  for (int i = maxstate; i < nmax; i++)
+    for (int j = 0; j < nstate; j++) astate[i][j] = 0.0;
+  maxstate = nmax;
+}
+
+/* ----------------------------------------------------------------------
+   copy values within atom-based array
+------------------------------------------------------------------------- */
+
+void FixAveCorrelateLong::copy_arrays(int i, int j)
+{
+  for (int m = 0; m < nstate; m++) astate[j][m] = astate[i][m];
+}
+
+/* ----------------------------------------------------------------------
+   pack values in local atom-based array for exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixAveCorrelateLong::pack_exchange(int i, double *buf)
+{
+  for (int m = 0; m < nstate; m++) buf[m] = astate[i][m];
+  return nstate;
+}
+
+/* ----------------------------------------------------------------------
+   unpack values in local atom-based array from exchange with another proc
+------------------------------------------------------------------------- */
+
+int FixAveCorrelateLong::unpack_exchange(int nlocal, double *buf)
+{
+  for (int m = 0; m < nstate; m++) astate[nlocal][m] = buf[m];
+  return nstate;
+}
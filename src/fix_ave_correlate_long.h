@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(ave/correlate/long,FixAveCorrelateLong)
+
+#else
+
+#ifndef LMP_FIX_AVE_CORRELATE_LONG_H
+#define LMP_FIX_AVE_CORRELATE_LONG_H
+
+#include "stdio.h"
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixAveCorrelateLong : public Fix {
+ public:
+  FixAveCorrelateLong(class LAMMPS *, int, char **);
+  ~FixAveCorrelateLong();
+  int setmask();
+  void init();
+  void setup(int);
+  void end_of_step();
+  double compute_array(int,int);
+  double memory_usage();
+
+  void grow_arrays(int);
+  void copy_arrays(int, int);
+  int pack_exchange(int, double *);
+  int unpack_exchange(int, double *);
+
+ private:
+  int me,nvalues;
+  int nfreq;
+  bigint nvalid;
+  int *which,*argindex,*value2index;
+  char **ids;
+  FILE *fp;
+
+  int type,startstep,atomflag;
+  double prefactor;
+
+  int npair;                    // number of correlation pairs to calculate
+  int *pairi,*pairj;            // values of each pair, C = <A_i(0) A_j(t)>
+
+  int ncorr;                    // number of correlator levels
+  int plen;                     // points per level
+  int mblock;                   // averaging factor between levels
+  int dmin;                     // first lag of levels above 0
+  int nstate;                   // size of the state of one correlator
+
+  int *insert;                  // position of next point in each level
+  int *nfill;                   // points stored in each level
+  int *naccum;                  // points accumulated for the next level
+  double *ncount;               // samples of each lag, ncorr*plen
+  double **corr;                // correlation sums, ncorr*plen by npair
+  double **corr_all;            // sums over procs, per-atom values only
+
+  double *gstate;               // correlator of global values
+  double **astate;              // correlator of each atom, per-atom values
+  int maxstate;                 // rows of astate, new rows are zeroed
+  double *sample;               // values of the current sample
+  double **vatom;               // per-atom values of the current sample
+  int maxatom;
+
+  int nrows;                    // output rows, lags with a distinct time
+  int *rowlevel,*rowlag;
+  double **save;                // last output, for compute_array()
+
+  void add(double *, double *, int);
+  void output(bigint);
+  bigint nextvalid();
+};
+
+}
+
+#endif
+#endif
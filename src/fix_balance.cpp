@@ -0,0 +1,175 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fix_balance.h"
+#include "balance.h"
+#include "atom.h"
+#include "comm.h"
+#include "domain.h"
+#include "force.h"
+#include "neighbor.h"
+#include "update.h"
+#include "timer.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (narg < 6) error->all(FLERR,"Illegal fix balance command");
+
+  scalar_flag = 1;
+  extscalar = 0;
+  vector_flag = 1;
+  size_vector = 3;
+  extvector = 0;
+  global_freq = 1;
+
+  nevery = atoi(arg[3]);
+  thresh = atof(arg[4]);
+  if (nevery <= 0 || thresh < 1.0) 
+    error->all(FLERR,"Illegal fix balance command");
+
+  balance = new Balance(lmp);
+
+  int iarg = 0;
+  if (strcmp(arg[5],"shift") == 0) {
+    if (narg < 9) error->all(FLERR,"Illegal fix balance command");
+    rcbflag = 0;
+    balance->shift_setup(arg[6],atoi(arg[7]),atof(arg[8]));
+    iarg = 9;
+  } else if (strcmp(arg[5],"rcb") == 0) {
+    if (comm->tiled == 0)
+      error->all(FLERR,"Fix balance rcb requires comm_style tiled");
+    if (domain->triclinic)
+      error->all(FLERR,"Fix balance rcb does not yet support triclinic boxes");
+    rcbflag = 1;
+    iarg = 6;
+  } else error->all(FLERR,"Illegal fix balance command");
+
+  wtflag = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"weight") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix balance command");
+      if (strcmp(arg[iarg+1],"count") == 0) wtflag = 0;
+      else if (strcmp(arg[iarg+1],"time") == 0) wtflag = 1;
+      else error->all(FLERR,"Illegal fix balance command");
+      iarg += 2;
+    } else error->all(FLERR,"Illegal fix balance command");
+  }
+
+  force_reneighbor = 1;
+  next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
+
+  imbnow = imbprev = 1.0;
+  maxload = 0.0;
+  itercount = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+FixBalance::~FixBalance()
+{
+  delete balance;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixBalance::setmask()
+{
+  int mask = 0;
+  mask |= PRE_EXCHANGE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixBalance::init()
+{
+  if (force->kspace) error->all(FLERR,"Cannot use fix balance with kspace");
+
+  // timers are reset at start of each run
+
+  tlast = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   shift sub-domain cuts or recompute RCB tiles if imbalance exceeds thresh
+     and migrate atoms
+   atoms may be slightly outside box, migrate() remaps them
+   comm and neighbor bins are reset for the new sub-domains
+------------------------------------------------------------------------- */
+
+void FixBalance::pre_exchange()
+{
+  if (update->ntimestep != next_reneighbor) return;
+  next_reneighbor = update->ntimestep + nevery;
+
+  // cost of each atom = pair + neighbor time on this proc
+  //   since last balance, divided by its # of atoms
+
+  balance->atomcost = 1.0;
+  if (wtflag) {
+    double tnow = timer->array[TIME_PAIR] + timer->array[TIME_NEIGHBOR];
+    double mytime = tnow - tlast;
+    double alltime;
+    MPI_Allreduce(&mytime,&alltime,1,MPI_DOUBLE,MPI_SUM,world);
+    if (alltime > 0.0 && atom->nlocal) balance->atomcost = mytime/atom->nlocal;
+    tlast = tnow;
+  }
+
+  double maxinit;
+  imbprev = balance->imbalance_factor(maxinit);
+  if (imbprev <= thresh) {
+    imbnow = imbprev;
+    maxload = maxinit;
+    itercount = 0;
+    return;
+  }
+
+  if (rcbflag) balance->rcb();
+  else balance->shift();
+  imbnow = balance->imbalance_splits(maxload);
+  itercount = balance->niter;
+
+  balance->migrate();
+  comm->setup();
+  if (neighbor->style) neighbor->setup_bins();
+}
+
+/* ----------------------------------------------------------------------
+   imbalance factor after last balance
+------------------------------------------------------------------------- */
+
+double FixBalance::compute_scalar()
+{
+  return imbnow;
+}
+
+/* ----------------------------------------------------------------------
+   max load on any proc after last balance, its # of iterations,
+   imbalance factor before last balance
+------------------------------------------------------------------------- */
+
+double FixBalance::compute_vector(int i)
+{
+  if (i == 0) return maxload;
+  if (i == 1) return (double) itercount;
+  return imbprev;
+}
@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef FIX_CLASS
+
+FixStyle(balance,FixBalance)
+
+#else
+
+#ifndef LMP_FIX_BALANCE_H
+#define LMP_FIX_BALANCE_H
+
+#include "fix.h"
+
+namespace LAMMPS_NS {
+
+class FixBalance : public Fix {
+ public:
+  FixBalance(class LAMMPS *, int, char **);
+  ~FixBalance();
+  int setmask();
+  void init();
+  void pre_exchange();
+  double compute_scalar();
+  double compute_vector(int);
+
+ private:
+  int nevery;
+  double thresh;
+  int rcbflag;                  // 1 if RCB tiles, 0 if shifted grid cuts
+  int wtflag;                   // 1 if atoms are weighted by time
+  double tlast;                 // pair + neighbor time at last balance
+  double imbnow;                // imbalance factor after last balance
+  double imbprev;               // imbalance factor before last balance
+  double maxload;               // max load on any proc after last balance
+  int itercount;                // iterations of last balance
+
+  class Balance *balance;
+};
+
+}
+
+#endif
+#endif
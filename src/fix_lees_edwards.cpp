@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdlib.h"
+#include "string.h"
+#include "fix_lees_edwards.h"
+#include "domain.h"
+#include "comm.h"
+#include "update.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+enum{ERATE,VEL};
+
+/* ---------------------------------------------------------------------- */
+
+FixLeesEdwards::FixLeesEdwards(LAMMPS *lmp, int narg, char **arg) :
+  Fix(lmp, narg, arg)
+{
+  if (narg != 5) error->all(FLERR,"Illegal fix lees/edwards command");
+
+  if (strcmp(arg[3],"erate") == 0) style = ERATE;
+  else if (strcmp(arg[3],"vel") == 0) style = VEL;
+  else error->all(FLERR,"Illegal fix lees/edwards command");
+  rate = atof(arg[4]);
+
+  if (domain->triclinic)
+    error->all(FLERR,"Cannot use fix lees/edwards with triclinic box");
+
+  scalar_flag = 1;
+  global_freq = 1;
+  extscalar = 0;
+  restart_global = 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int FixLeesEdwards::setmask()
+{
+  int mask = 0;
+  mask |= POST_INTEGRATE;
+  return mask;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixLeesEdwards::init()
+{
+  if (domain->yperiodic == 0 || domain->xperiodic == 0)
+    error->all(FLERR,"Fix lees/edwards requires periodic x and y boundaries");
+
+  if (style == ERATE) domain->le_vshear = rate * domain->yprd;
+  else domain->le_vshear = rate;
+  domain->le_groupbit = groupbit;
+}
+
+/* ----------------------------------------------------------------------
+   advance the shift of the images to the time of the new positions,
+     before they are communicated to ghosts
+------------------------------------------------------------------------- */
+
+void FixLeesEdwards::post_integrate()
+{
+  advance(domain->le_vshear * update->dt);
+}
+
+/* ----------------------------------------------------------------------
+   shift le_offset by delta, keep it in [0,xprd) and count the wraps
+------------------------------------------------------------------------- */
+
+void FixLeesEdwards::advance(double delta)
+{
+  double xprd = domain->xprd;
+  domain->le_offset += delta;
+  while (domain->le_offset >= xprd) {
+    domain->le_offset -= xprd;
+    domain->le_nwrap++;
+  }
+  while (domain->le_offset < 0.0) {
+    domain->le_offset += xprd;
+    domain->le_nwrap--;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   current x shift of the image above the box
+------------------------------------------------------------------------- */
+
+double FixLeesEdwards::compute_scalar()
+{
+  return domain->le_offset;
+}
+
+/* ----------------------------------------------------------------------
+   pack entire state of Fix into one write 
+------------------------------------------------------------------------- */
+
+void FixLeesEdwards::write_restart(FILE *fp)
+{
+  double list[2];
+  list[0] = domain->le_offset;
+  list[1] = domain->le_nwrap;
+
+  if (comm->me == 0) {
+    int size = 2 * sizeof(double);
+    fwrite(&size,sizeof(int),1,fp);
+    fwrite(list,sizeof(double),2,fp);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   use state info from restart file to restart the Fix
+------------------------------------------------------------------------- */
+
+void FixLeesEdwards::restart(char *buf)
+{
+  double *list = (double *) buf;
+  domain->le_offset = list[0];
+  domain->le_nwrap = static_cast<int> (list[1]);
+}
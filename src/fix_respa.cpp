@@ -32,6 +32,7 @@ FixRespa::FixRespa(LAMMPS *lmp, int narg, char **arg) :
   // register with Atom class
 
   f_level = NULL;
+  drho_level = de_level = NULL;
   grow_arrays(atom->nmax);
   atom->add_callback(0);
 }
@@ -47,6 +48,8 @@ FixRespa::~FixRespa()
   // delete locally stored arrays
 
   memory->destroy(f_level);
+  memory->destroy(drho_level);
+  memory->destroy(de_level);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -63,6 +66,8 @@ int FixRespa::setmask()
 double FixRespa::memory_usage()
 {
   double bytes = atom->nmax*nlevels*3 * sizeof(double);
+  if (atom->rho_flag) bytes += atom->nmax*nlevels * sizeof(double);
+  if (atom->e_flag) bytes += atom->nmax*nlevels * sizeof(double);
   return bytes;
 }
 
@@ -73,6 +78,10 @@ double FixRespa::memory_usage()
 void FixRespa::grow_arrays(int nmax)
 {
   memory->grow(f_level,nmax,nlevels,3,"fix_respa:f_level");
+  if (atom->rho_flag)
+    memory->grow(drho_level,nmax,nlevels,"fix_respa:drho_level");
+  if (atom->e_flag)
+    memory->grow(de_level,nmax,nlevels,"fix_respa:de_level");
 }
 
 /* ----------------------------------------------------------------------
@@ -86,6 +95,10 @@ void FixRespa::copy_arrays(int i, int j)
     f_level[j][k][1] = f_level[i][k][1];
     f_level[j][k][2] = f_level[i][k][2];
   }
+  if (drho_level)
+    for (int k = 0; k < nlevels; k++) drho_level[j][k] = drho_level[i][k];
+  if (de_level)
+    for (int k = 0; k < nlevels; k++) de_level[j][k] = de_level[i][k];
 }
 
 /* ----------------------------------------------------------------------
@@ -100,6 +113,10 @@ int FixRespa::pack_exchange(int i, double *buf)
     buf[m++] = f_level[i][k][1];
     buf[m++] = f_level[i][k][2];
   }
+  if (drho_level)
+    for (int k = 0; k < nlevels; k++) buf[m++] = drho_level[i][k];
+  if (de_level)
+    for (int k = 0; k < nlevels; k++) buf[m++] = de_level[i][k];
   return m;
 }
 
@@ -115,5 +132,9 @@ int FixRespa::unpack_exchange(int nlocal, double *buf)
     f_level[nlocal][k][1] = buf[m++];
     f_level[nlocal][k][2] = buf[m++];
   }
+  if (drho_level)
+    for (int k = 0; k < nlevels; k++) drho_level[nlocal][k] = buf[m++];
+  if (de_level)
+    for (int k = 0; k < nlevels; k++) de_level[nlocal][k] = buf[m++];
   return m;
 }
@@ -27,6 +27,7 @@ namespace LAMMPS_NS {
 class FixRespa : public Fix {
   friend class Respa;
   friend class FixShake;
+  friend class FixMeso;
 
  public:
   FixRespa(class LAMMPS *, int, char **);
@@ -43,6 +44,8 @@ class FixRespa : public Fix {
  private:
   int nlevels;
   double ***f_level;            // force at each rRESPA level
+  double **drho_level;          // density change at each level, if rho_flag
+  double **de_level;            // energy change at each level, if e_flag
 };
 
 }
@@ -24,6 +24,7 @@
 #include "atom.h"
 #include "atom_vec.h"
 #include "comm.h"
+#include "comm_tiled.h"
 #include "group.h"
 #include "domain.h"
 #include "output.h"
@@ -429,6 +430,7 @@ int Input::execute_command()
   else if (!strcmp(command,"bond_coeff")) bond_coeff();
   else if (!strcmp(command,"bond_style")) bond_style();
   else if (!strcmp(command,"boundary")) boundary();
+  else if (!strcmp(command,"comm_style")) comm_style();
   else if (!strcmp(command,"communicate")) communicate();
   else if (!strcmp(command,"compute")) compute();
   else if (!strcmp(command,"compute_modify")) compute_modify();
@@ -890,6 +892,29 @@ void Input::boundary()
 
 /* ---------------------------------------------------------------------- */
 
+void Input::comm_style()
+{
+  if (narg < 1) error->all(FLERR,"Illegal comm_style command");
+  if (domain->box_exist)
+    error->all(FLERR,"Comm_style command after simulation box is defined");
+
+  Comm *oldcomm = comm;
+  if (strcmp(arg[0],"brick") == 0) {
+    if (comm->tiled == 0) return;
+    comm = new Comm(lmp);
+  } else if (strcmp(arg[0],"tiled") == 0) {
+    if (comm->tiled) return;
+    if (lmp->cuda) error->all(FLERR,"Comm_style tiled is not supported "
+			      "with USER-CUDA");
+    comm = new CommTiled(lmp);
+  } else error->all(FLERR,"Illegal comm_style command");
+
+  comm->copy_settings(oldcomm);
+  delete oldcomm;
+}
+
+/* ---------------------------------------------------------------------- */
+
 void Input::communicate()
 {
   comm->set(narg,arg);
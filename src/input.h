@@ -68,6 +68,7 @@ class Input : protected Pointers {
   void bond_coeff();
   void bond_style();
   void boundary();
+  void comm_style();
   void communicate();
   void compute();
   void compute_modify();
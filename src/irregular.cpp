@@ -20,6 +20,7 @@
 #include "atom_vec.h"
 #include "domain.h"
 #include "comm.h"
+#include "comm_tiled.h"
 #include "memory.h"
 
 using namespace LAMMPS_NS;
@@ -603,12 +604,38 @@ void Irregular::destroy_data()
 /* ----------------------------------------------------------------------
    determine which proc owns atom with coord x[3]
    x will be in box (orthogonal) or lamda coords (triclinic)
+   for non-uniform sub-domains, search the fractional bounds in comm
+   for RCB tiles, comm descends its cut tree
 ------------------------------------------------------------------------- */
 
 int Irregular::coord2proc(double *x)
 {
   int loc[3];
-  if (triclinic == 0) {
+  if (comm->rcb) {
+    double *boxlo = domain->boxlo;
+    double *prd = domain->prd;
+    double lamda[3];
+    lamda[0] = (x[0]-boxlo[0]) / prd[0];
+    lamda[1] = (x[1]-boxlo[1]) / prd[1];
+    lamda[2] = (x[2]-boxlo[2]) / prd[2];
+    return ((CommTiled *) comm)->point2proc(lamda);
+  } else if (comm->uniform == 0) {
+    double lamda[3];
+    if (triclinic == 0) {
+      double *boxlo = domain->boxlo;
+      double *prd = domain->prd;
+      lamda[0] = (x[0]-boxlo[0]) / prd[0];
+      lamda[1] = (x[1]-boxlo[1]) / prd[1];
+      lamda[2] = (x[2]-boxlo[2]) / prd[2];
+    } else {
+      lamda[0] = x[0];
+      lamda[1] = x[1];
+      lamda[2] = x[2];
+    }
+    loc[0] = binary(lamda[0],procgrid[0],comm->xsplit);
+    loc[1] = binary(lamda[1],procgrid[1],comm->ysplit);
+    loc[2] = binary(lamda[2],procgrid[2],comm->zsplit);
+  } else if (triclinic == 0) {
     double *boxlo = domain->boxlo;
     double *boxhi = domain->boxhi;
     loc[0] = static_cast<int>
@@ -633,6 +660,23 @@ int Irregular::coord2proc(double *x)
   return grid2proc[loc[0]][loc[1]][loc[2]];
 }
 
+/* ----------------------------------------------------------------------
+   index i of sub-domain with split[i] <= value < split[i+1]
+   split = n+1 ascending bounds, values outside map to 1st or last
+------------------------------------------------------------------------- */
+
+int Irregular::binary(double value, int n, double *split)
+{
+  int lo = 0;
+  int hi = n;
+  while (hi - lo > 1) {
+    int mid = (lo+hi) / 2;
+    if (value < split[mid]) hi = mid;
+    else lo = mid;
+  }
+  return lo;
+}
+
 /* ----------------------------------------------------------------------
    realloc the size of the send buffer as needed with BUFFACTOR & BUFEXTRA 
    if flag = 1, realloc
@@ -81,6 +81,7 @@ class Irregular : protected Pointers {
   void exchange_atom(double *, int *, double *);
   void destroy_atom();
   int coord2proc(double *);
+  int binary(double, int, double *);
 
   void grow_send(int,int);          // reallocate send buffer
   void grow_recv(int);              // free/allocate recv buffer
@@ -548,12 +548,12 @@ void Min::force_clear()
 
   if (e_flag) {
     double *de = atom->de;
-    for (i = 0; i < nall; i++) de[i] = 0.0;
+    for (i = 0; i < ntot; i++) de[i] = 0.0;
   }
   
   if (rho_flag) {
     double *drho = atom->drho;
-    for (i = 0; i < nall; i++) drho[i] = 0.0;
+    for (i = 0; i < ntot; i++) drho[i] = 0.0;
   }
 }
 
@@ -13,7 +13,9 @@
 
 #include "neighbor.h"
 #include "neigh_list.h"
+#include "neigh_omp.h"
 #include "atom.h"
+#include "comm.h"
 #include "group.h"
 #include "error.h"
 
@@ -80,13 +82,13 @@ void Neighbor::full_nsq(NeighList *list)
       if (includegroup && !(mask[j] & bitmask)) continue;
       if (i == j) continue;
       jtype = type[j];
-      if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 
       delx = xtmp - x[j][0];
       dely = ytmp - x[j][1];
       delz = ztmp - x[j][2];
       rsq = delx*delx + dely*dely + delz*delz;
       if (rsq <= cutneighsq[itype][jtype]) {
+	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 	if (molecular) {
 	  which = find_special(special[i],nspecial[i],tag[j]);
 	  if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
@@ -164,13 +166,13 @@ void Neighbor::full_nsq_ghost(NeighList *list)
       for (j = 0; j < nall; j++) {
 	if (i == j) continue;
 	jtype = type[j];
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 	
 	delx = xtmp - x[j][0];
 	dely = ytmp - x[j][1];
 	delz = ztmp - x[j][2];
 	rsq = delx*delx + dely*dely + delz*delz;
 	if (rsq <= cutneighsq[itype][jtype]) {
+	  if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 	  if (molecular) {
 	    which = find_special(special[i],nspecial[i],tag[j]);
 	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
@@ -213,10 +215,6 @@ void Neighbor::full_nsq_ghost(NeighList *list)
 
 void Neighbor::full_bin(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr;
-
   // bin owned & ghost atoms
 
   bin_atoms();
@@ -236,68 +234,77 @@ void Neighbor::full_bin(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
   // loop over owned atoms, storing neighbors
 
-  for (i = 0; i < nlocal; i++) {
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
 
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
+      neighptr = &pages[npage][npnt];
+      n = 0;
 
-    neighptr = &pages[npage][npnt];
-    n = 0;
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
 
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-
-    // loop over all atoms in surrounding bins in stencil including self
-    // skip i = j
+      // loop over all atoms in surrounding bins in stencil including self
+      // skip i = j
 
-    ibin = coord2bin(x[i]);
+      ibin = coord2bin(x[i]);
 
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	if (i == j) continue;
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (i == j) continue;
 
-	jtype = type[j];
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	  jtype = type[j];
 
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
 
-	if (rsq <= cutneighsq[itype][jtype]) {
-	  if (molecular) {
-	    which = find_special(special[i],nspecial[i],tag[j]);
-	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	  } else neighptr[n++] = j;
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+	  }
 	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,
-		 "Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,
+		   "Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
   list->gnum = 0;
 }
 
@@ -309,11 +316,6 @@ void Neighbor::full_bin(NeighList *list)
 
 void Neighbor::full_bin_ghost(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int xbin,ybin,zbin,xbin2,ybin2,zbin2;
-  int *neighptr;
-
   // bin owned & ghost atoms
 
   bin_atoms();
@@ -333,97 +335,107 @@ void Neighbor::full_bin_ghost(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
   int **stencilxyz = list->stencilxyz;
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
   // loop over owned & ghost atoms, storing neighbors
 
-  for (i = 0; i < nall; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int xbin,ybin,zbin,xbin2,ybin2,zbin2;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nall);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
 
-    neighptr = &pages[npage][npnt];
-    n = 0;
+      neighptr = &pages[npage][npnt];
+      n = 0;
 
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
 
-    // loop over all atoms in surrounding bins in stencil including self
-    // when i is a ghost atom, must check if stencil bin is out of bounds
-    // skip i = j
+      // loop over all atoms in surrounding bins in stencil including self
+      // when i is a ghost atom, must check if stencil bin is out of bounds
+      // skip i = j
 
-    if (i < nlocal) {
-      ibin = coord2bin(x[i]);
-      for (k = 0; k < nstencil; k++) {
-	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	  if (i == j) continue;
+      if (i < nlocal) {
+	ibin = coord2bin(x[i]);
+	for (k = 0; k < nstencil; k++) {
+	  for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	    if (i == j) continue;
 	  
-	  jtype = type[j];
-	  if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	    jtype = type[j];
 	
-	  delx = xtmp - x[j][0];
-	  dely = ytmp - x[j][1];
-	  delz = ztmp - x[j][2];
-	  rsq = delx*delx + dely*dely + delz*delz;
+	    delx = xtmp - x[j][0];
+	    dely = ytmp - x[j][1];
+	    delz = ztmp - x[j][2];
+	    rsq = delx*delx + dely*dely + delz*delz;
 	
-	  if (rsq <= cutneighsq[itype][jtype]) {
-	    if (molecular) {
-	      which = find_special(special[i],nspecial[i],tag[j]);
-	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	    } else neighptr[n++] = j;
+	    if (rsq <= cutneighsq[itype][jtype]) {
+	      if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	      if (molecular) {
+		which = find_special(special[i],nspecial[i],tag[j]);
+		if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	      } else neighptr[n++] = j;
+	    }
 	  }
 	}
-      }
 
-    } else {
-      ibin = coord2bin(x[i],xbin,ybin,zbin);
-      for (k = 0; k < nstencil; k++) {
-	xbin2 = xbin + stencilxyz[k][0];
-	ybin2 = ybin + stencilxyz[k][1];
-	zbin2 = zbin + stencilxyz[k][2];
-	if (xbin2 < 0 || xbin2 >= mbinx ||
-	    ybin2 < 0 || ybin2 >= mbiny ||
-	    zbin2 < 0 || zbin2 >= mbinz) continue;
-	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	  if (i == j) continue;
+      } else {
+	ibin = coord2bin(x[i],xbin,ybin,zbin);
+	for (k = 0; k < nstencil; k++) {
+	  xbin2 = xbin + stencilxyz[k][0];
+	  ybin2 = ybin + stencilxyz[k][1];
+	  zbin2 = zbin + stencilxyz[k][2];
+	  if (xbin2 < 0 || xbin2 >= mbinx ||
+	      ybin2 < 0 || ybin2 >= mbiny ||
+	      zbin2 < 0 || zbin2 >= mbinz) continue;
+	  for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	    if (i == j) continue;
 	  
-	  jtype = type[j];
-	  if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	    jtype = type[j];
+	    if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 	
-	  delx = xtmp - x[j][0];
-	  dely = ytmp - x[j][1];
-	  delz = ztmp - x[j][2];
-	  rsq = delx*delx + dely*dely + delz*delz;
+	    delx = xtmp - x[j][0];
+	    dely = ytmp - x[j][1];
+	    delz = ztmp - x[j][2];
+	    rsq = delx*delx + dely*dely + delz*delz;
 
-	  if (rsq <= cutneighghostsq[itype][jtype])
-	    neighptr[n++] = j;
+	    if (rsq <= cutneighghostsq[itype][jtype])
+	      neighptr[n++] = j;
+	  }
 	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,
-		 "Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,
+		   "Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
   list->inum = atom->nlocal;
-  list->gnum = inum - atom->nlocal;
+  list->gnum = nall - atom->nlocal;
 }
 
 /* ----------------------------------------------------------------------
@@ -434,11 +446,6 @@ void Neighbor::full_bin_ghost(NeighList *list)
 
 void Neighbor::full_multi(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which,ns;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr,*s;
-  double *cutsq,*distsq;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -460,70 +467,80 @@ void Neighbor::full_multi(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int *nstencil_multi = list->nstencil_multi;
   int **stencil_multi = list->stencil_multi;
   double **distsq_multi = list->distsq_multi;
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which,ns;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr,*s;
+    double *cutsq,*distsq;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
 
-    neighptr = &pages[npage][npnt];
-    n = 0;
+      neighptr = &pages[npage][npnt];
+      n = 0;
 
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
 
-    // loop over all atoms in other bins in stencil, including self
-    // skip if i,j neighbor cutoff is less than bin distance
-    // skip i = j
+      // loop over all atoms in other bins in stencil, including self
+      // skip if i,j neighbor cutoff is less than bin distance
+      // skip i = j
 
-    ibin = coord2bin(x[i]);
-    s = stencil_multi[itype];
-    distsq = distsq_multi[itype];
-    cutsq = cutneighsq[itype];
-    ns = nstencil_multi[itype];
-    for (k = 0; k < ns; k++) {
-      for (j = binhead[ibin+s[k]]; j >= 0; j = bins[j]) {
-	jtype = type[j];
-	if (cutsq[jtype] < distsq[k]) continue;
-	if (i == j) continue;
+      ibin = coord2bin(x[i]);
+      s = stencil_multi[itype];
+      distsq = distsq_multi[itype];
+      cutsq = cutneighsq[itype];
+      ns = nstencil_multi[itype];
+      for (k = 0; k < ns; k++) {
+	for (j = binhead[ibin+s[k]]; j >= 0; j = bins[j]) {
+	  jtype = type[j];
+	  if (cutsq[jtype] < distsq[k]) continue;
+	  if (i == j) continue;
 
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
 
-	if (rsq <= cutneighsq[itype][jtype]) {
-	  if (molecular) {
-	    which = find_special(special[i],nspecial[i],tag[j]);
-	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	  } else neighptr[n++] = j;
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+	  }
 	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
   list->gnum = 0;
 }
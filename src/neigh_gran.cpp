@@ -13,7 +13,9 @@
 
 #include "neighbor.h"
 #include "neigh_list.h"
+#include "neigh_omp.h"
 #include "atom.h"
+#include "comm.h"
 #include "group.h"
 #include "fix_shear_history.h"
 #include "error.h"
@@ -272,19 +274,12 @@ void Neighbor::granular_nsq_newton(NeighList *list)
 
 void Neighbor::granular_bin_no_newton(NeighList *list)
 {
-  int i,j,k,m,n,nn,ibin;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  double radi,radsum,cutsq;
-  int *neighptr,*touchptr;
-  double *shearptr;
-
-  NeighList *listgranhistory;
-  int *npartner,**partner;
-  double ***shearpartner;
-  int **firsttouch;
-  double **firstshear;
-  int **pages_touch;
-  double **pages_shear;
+  NeighList *listgranhistory = NULL;
+  int *npartner = NULL;
+  int **partner = NULL;
+  double ***shearpartner = NULL;
+  int **firsttouch = NULL;
+  double **firstshear = NULL;
 
   // bin local & ghost atoms
 
@@ -304,7 +299,6 @@ void Neighbor::granular_bin_no_newton(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
@@ -316,103 +310,119 @@ void Neighbor::granular_bin_no_newton(NeighList *list)
     listgranhistory = list->listgranhistory;
     firsttouch = listgranhistory->firstneigh;
     firstshear = listgranhistory->firstdouble;
-    pages_touch = listgranhistory->pages;
-    pages_shear = listgranhistory->dpages;
   }
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) {
-	pages = list->add_pages();
-	if (fix_history) {
-	  pages_touch = listgranhistory->add_pages();
-	  pages_shear = listgranhistory->dpages;
-	}
-      }
-    }
-
-    n = 0;
-    neighptr = &pages[npage][npnt];
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,m,n,nn,ibin;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    double radi,radsum,cutsq;
+    int *neighptr,*touchptr;
+    double *shearptr;
+    int **pages_touch;
+    double **pages_shear;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
     if (fix_history) {
-      nn = 0;
-      touchptr = &pages_touch[npage][npnt];
-      shearptr = &pages_shear[npage][3*npnt];
+      pages_touch = listgranhistory->thread_pages(tid);
+      pages_shear = listgranhistory->thread_dpages(tid);
     }
+    int npage = 0;
+    int npnt = 0;
 
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    radi = radius[i];
-    ibin = coord2bin(x[i]);
-
-    // loop over all atoms in surrounding bins in stencil including self
-    // only store pair if i < j
-    // stores own/own pairs only once
-    // stores own/ghost pairs on both procs
-
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	if (j <= i) continue;
-	if (exclude && exclusion(i,j,type[i],type[j],mask,molecule)) continue;
+    for (i = ifrom; i < ito; i++) {
 
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
-	radsum = radi + radius[j];
-	cutsq = (radsum+skin) * (radsum+skin);
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) {
+	  pages = list->add_pages(tid);
+	  if (fix_history) {
+	    pages_touch = listgranhistory->add_pages(tid);
+	    pages_shear = listgranhistory->thread_dpages(tid);
+	  }
+	}
+      }
 
-	if (rsq <= cutsq) {
-	  neighptr[n] = j;
+      n = 0;
+      neighptr = &pages[npage][npnt];
+      if (fix_history) {
+	nn = 0;
+	touchptr = &pages_touch[npage][npnt];
+	shearptr = &pages_shear[npage][3*npnt];
+      }
 
-	  if (fix_history) {
-	    if (rsq < radsum*radsum) {
-	      for (m = 0; m < npartner[i]; m++)
-		if (partner[i][m] == tag[j]) break;
-	      if (m < npartner[i]) {
-		touchptr[n] = 1;
-		shearptr[nn++] = shearpartner[i][m][0];
-		shearptr[nn++] = shearpartner[i][m][1];
-		shearptr[nn++] = shearpartner[i][m][2];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      radi = radius[i];
+      ibin = coord2bin(x[i]);
+
+      // loop over all atoms in surrounding bins in stencil including self
+      // only store pair if i < j
+      // stores own/own pairs only once
+      // stores own/ghost pairs on both procs
+
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (j <= i) continue;
+	  if (exclude && exclusion(i,j,type[i],type[j],mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+	  radsum = radi + radius[j];
+	  cutsq = (radsum+skin) * (radsum+skin);
+
+	  if (rsq <= cutsq) {
+	    neighptr[n] = j;
+
+	    if (fix_history) {
+	      if (rsq < radsum*radsum) {
+		for (m = 0; m < npartner[i]; m++)
+		  if (partner[i][m] == tag[j]) break;
+		if (m < npartner[i]) {
+		  touchptr[n] = 1;
+		  shearptr[nn++] = shearpartner[i][m][0];
+		  shearptr[nn++] = shearpartner[i][m][1];
+		  shearptr[nn++] = shearpartner[i][m][2];
+		} else {
+		  touchptr[n] = 0;
+		  shearptr[nn++] = 0.0;
+		  shearptr[nn++] = 0.0;
+		  shearptr[nn++] = 0.0;
+		}
 	      } else {
 		touchptr[n] = 0;
 		shearptr[nn++] = 0.0;
 		shearptr[nn++] = 0.0;
 		shearptr[nn++] = 0.0;
 	      }
-	    } else {
-	      touchptr[n] = 0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
-	      shearptr[nn++] = 0.0;
 	    }
-	  }
 
-	  n++;
+	    n++;
+	  }
 	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    if (fix_history) {
-      firsttouch[i] = touchptr;
-      firstshear[i] = shearptr;
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      if (fix_history) {
+	firsttouch[i] = touchptr;
+	firstshear[i] = shearptr;
+      }
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
     }
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
 }
 
 /* ----------------------------------------------------------------------
@@ -425,11 +435,6 @@ void Neighbor::granular_bin_no_newton(NeighList *list)
 
 void Neighbor::granular_bin_newton(NeighList *list)
 {
-  int i,j,k,n,ibin;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  double radi,radsum,cutsq;
-  int *neighptr;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -447,60 +452,52 @@ void Neighbor::granular_bin_newton(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
-
-    n = 0;
-    neighptr = &pages[npage][npnt];
-
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    radi = radius[i];
-
-    // loop over rest of atoms in i's bin, ghosts are at end of linked list
-    // if j is owned atom, store it, since j is beyond i in linked list
-    // if j is ghost, only store if j coords are "above and to the right" of i
-
-    for (j = bins[i]; j >= 0; j = bins[j]) {
-      if (j >= nlocal) {
-	if (x[j][2] < ztmp) continue;
-	if (x[j][2] == ztmp) {
-	  if (x[j][1] < ytmp) continue;
-	  if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
-	}
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,ibin;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    double radi,radsum,cutsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
       }
 
-      if (exclude && exclusion(i,j,type[i],type[j],mask,molecule)) continue;
+      n = 0;
+      neighptr = &pages[npage][npnt];
 
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
-      rsq = delx*delx + dely*dely + delz*delz;
-      radsum = radi + radius[j];
-      cutsq = (radsum+skin) * (radsum+skin);
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      radi = radius[i];
 
-      if (rsq <= cutsq) neighptr[n++] = j;
-    }
+      // loop over rest of atoms in i's bin, ghosts are at end of linked list
+      // if j is owned atom, store it, since j is beyond i in linked list
+      // if j is ghost, only store if j coords are "above and to the right" of i
 
-    // loop over all atoms in other bins in stencil, store every pair
+      for (j = bins[i]; j >= 0; j = bins[j]) {
+	if (j >= nlocal) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+	  }
+	}
 
-    ibin = coord2bin(x[i]);
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
 	if (exclude && exclusion(i,j,type[i],type[j],mask,molecule)) continue;
 
 	delx = xtmp - x[j][0];
@@ -512,17 +509,35 @@ void Neighbor::granular_bin_newton(NeighList *list)
 
 	if (rsq <= cutsq) neighptr[n++] = j;
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      // loop over all atoms in other bins in stencil, store every pair
+
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (exclude && exclusion(i,j,type[i],type[j],mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+	  radsum = radi + radius[j];
+	  cutsq = (radsum+skin) * (radsum+skin);
+
+	  if (rsq <= cutsq) neighptr[n++] = j;
+	}
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
 }
 
 /* ----------------------------------------------------------------------
@@ -535,11 +550,6 @@ void Neighbor::granular_bin_newton(NeighList *list)
 
 void Neighbor::granular_bin_newton_tri(NeighList *list)
 {
-  int i,j,k,n,ibin;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  double radi,radsum,cutsq;
-  int *neighptr;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -557,68 +567,78 @@ void Neighbor::granular_bin_newton_tri(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
-  for (i = 0; i < nlocal; i++) {
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,ibin;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    double radi,radsum,cutsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
 
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
+      n = 0;
+      neighptr = &pages[npage][npnt];
 
-    n = 0;
-    neighptr = &pages[npage][npnt];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      radi = radius[i];
 
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    radi = radius[i];
+      // loop over all atoms in bins in stencil
+      // pairs for atoms j "below" i are excluded
+      // below = lower z or (equal z and lower y) or (equal zy and lower x)
+      //         (equal zyx and j <= i)
+      // latter excludes self-self interaction but allows superposed atoms
 
-    // loop over all atoms in bins in stencil
-    // pairs for atoms j "below" i are excluded
-    // below = lower z or (equal z and lower y) or (equal zy and lower x)
-    //         (equal zyx and j <= i)
-    // latter excludes self-self interaction but allows superposed atoms
-
-    ibin = coord2bin(x[i]);
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	if (x[j][2] < ztmp) continue;
-	if (x[j][2] == ztmp) {
-	  if (x[j][1] < ytmp) continue;
-	  if (x[j][1] == ytmp) {
-	    if (x[j][0] < xtmp) continue;
-	    if (x[j][0] == xtmp && j <= i) continue;
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp) {
+	      if (x[j][0] < xtmp) continue;
+	      if (x[j][0] == xtmp && j <= i) continue;
+	    }
 	  }
-	}
 
-	if (exclude && exclusion(i,j,type[i],type[j],mask,molecule)) continue;
+	  if (exclude && exclusion(i,j,type[i],type[j],mask,molecule)) continue;
 
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
-	radsum = radi + radius[j];
-	cutsq = (radsum+skin) * (radsum+skin);
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+	  radsum = radi + radius[j];
+	  cutsq = (radsum+skin) * (radsum+skin);
 
-	if (rsq <= cutsq) neighptr[n++] = j;
+	  if (rsq <= cutsq) neighptr[n++] = j;
+	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
 }
@@ -13,7 +13,9 @@
 
 #include "neighbor.h"
 #include "neigh_list.h"
+#include "neigh_omp.h"
 #include "atom.h"
+#include "comm.h"
 #include "error.h"
 
 using namespace LAMMPS_NS;
@@ -27,10 +29,6 @@ using namespace LAMMPS_NS;
 
 void Neighbor::half_bin_no_newton(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -52,67 +50,76 @@ void Neighbor::half_bin_no_newton(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
-  for (i = 0; i < nlocal; i++) {
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
 
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
+      neighptr = &pages[npage][npnt];
+      n = 0;
 
-    neighptr = &pages[npage][npnt];
-    n = 0;
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
 
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
+      // loop over all atoms in other bins in stencil including self
+      // only store pair if i < j
+      // stores own/own pairs only once
+      // stores own/ghost pairs on both procs
 
-    // loop over all atoms in other bins in stencil including self
-    // only store pair if i < j
-    // stores own/own pairs only once
-    // stores own/ghost pairs on both procs
+      ibin = coord2bin(x[i]);
 
-    ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (j <= i) continue;
 
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	if (j <= i) continue;
+	  jtype = type[j];
 
-	jtype = type[j];
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
 
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
-
-	if (rsq <= cutneighsq[itype][jtype]) {
-	  if (molecular) {
-	    which = find_special(special[i],nspecial[i],tag[j]);
-	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	  } else neighptr[n++] = j;
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+	  }
 	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
 }
 
 /* ----------------------------------------------------------------------
@@ -123,10 +130,6 @@ void Neighbor::half_bin_no_newton(NeighList *list)
 
 void Neighbor::half_bin_newton(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -148,66 +151,52 @@ void Neighbor::half_bin_newton(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
   
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
-
-    neighptr = &pages[npage][npnt];
-    n = 0;
-
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-
-    // loop over rest of atoms in i's bin, ghosts are at end of linked list
-    // if j is owned atom, store it, since j is beyond i in linked list
-    // if j is ghost, only store if j coords are "above and to the right" of i
-
-    for (j = bins[i]; j >= 0; j = bins[j]) {
-      if (j >= nlocal) {
-	if (x[j][2] < ztmp) continue;
-	if (x[j][2] == ztmp) {
-	  if (x[j][1] < ytmp) continue;
-	  if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
-	}
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
       }
 
-      jtype = type[j];
-      if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+      neighptr = &pages[npage][npnt];
+      n = 0;
 
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
-      rsq = delx*delx + dely*dely + delz*delz;
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
 
-      if (rsq <= cutneighsq[itype][jtype]) {
-	if (molecular) {
-	  which = find_special(special[i],nspecial[i],tag[j]);
-	  if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	} else neighptr[n++] = j;
-      }
-    }
+      // loop over rest of atoms in i's bin, ghosts are at end of linked list
+      // if j is owned atom, store it, since j is beyond i in linked list
+      // if j is ghost, only store if j coords are "above and to the right" of i
 
-    // loop over all atoms in other bins in stencil, store every pair
+      for (j = bins[i]; j >= 0; j = bins[j]) {
+	if (j >= nlocal) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+	  }
+	}
 
-    ibin = coord2bin(x[i]);
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
 	jtype = type[j];
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 
 	delx = xtmp - x[j][0];
 	dely = ytmp - x[j][1];
@@ -215,23 +204,46 @@ void Neighbor::half_bin_newton(NeighList *list)
 	rsq = delx*delx + dely*dely + delz*delz;
 
 	if (rsq <= cutneighsq[itype][jtype]) {
+	  if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 	  if (molecular) {
 	    which = find_special(special[i],nspecial[i],tag[j]);
 	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
 	  } else neighptr[n++] = j;
 	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      // loop over all atoms in other bins in stencil, store every pair
+
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  jtype = type[j];
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+	  }
+	}
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
 }
 
 /* ----------------------------------------------------------------------
@@ -242,10 +254,6 @@ void Neighbor::half_bin_newton(NeighList *list)
 
 void Neighbor::half_bin_newton_tri(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -267,72 +275,81 @@ void Neighbor::half_bin_newton_tri(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
 
-    neighptr = &pages[npage][npnt];
-    n = 0;
-
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-
-    // loop over all atoms in bins in stencil
-    // pairs for atoms j "below" i are excluded
-    // below = lower z or (equal z and lower y) or (equal zy and lower x)
-    //         (equal zyx and j <= i)
-    // latter excludes self-self interaction but allows superposed atoms
-
-    ibin = coord2bin(x[i]);
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	if (x[j][2] < ztmp) continue;
-	if (x[j][2] == ztmp) {
-	  if (x[j][1] < ytmp) continue;
-	  if (x[j][1] == ytmp) {
-	    if (x[j][0] < xtmp) continue;
-	    if (x[j][0] == xtmp && j <= i) continue;
+      neighptr = &pages[npage][npnt];
+      n = 0;
+
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+
+      // loop over all atoms in bins in stencil
+      // pairs for atoms j "below" i are excluded
+      // below = lower z or (equal z and lower y) or (equal zy and lower x)
+      //         (equal zyx and j <= i)
+      // latter excludes self-self interaction but allows superposed atoms
+
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp) {
+	      if (x[j][0] < xtmp) continue;
+	      if (x[j][0] == xtmp && j <= i) continue;
+	    }
 	  }
-	}
 
-	jtype = type[j];
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	  jtype = type[j];
 
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
 
-	if (rsq <= cutneighsq[itype][jtype]) {
-	  if (molecular) {
-	    which = find_special(special[i],nspecial[i],tag[j]);
-	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	  } else neighptr[n++] = j;
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+	  }
 	}
       }
-    }
 
-    ilist[inum++] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
   }
 
-  list->inum = inum;
+  list->inum = nlocal;
 }
@@ -45,6 +45,11 @@ NeighList::NeighList(LAMMPS *lmp, int size) : Pointers(lmp)
   dpages = NULL;
   dnum = 0;
 
+  npool = 1;
+  maxpage_thr = NULL;
+  pages_thr = NULL;
+  dpages_thr = NULL;
+
   iskip = NULL;
   ijskip = NULL;
 
@@ -84,8 +89,21 @@ NeighList::~NeighList()
       for (int i = 0; i < maxpage; i++) memory->destroy(dpages[i]);
       memory->sfree(dpages);
     }
+
+    for (int tid = 1; tid < npool; tid++) {
+      for (int i = 0; i < maxpage_thr[tid]; i++) {
+	memory->destroy(pages_thr[tid][i]);
+	if (dnum) memory->destroy(dpages_thr[tid][i]);
+      }
+      memory->sfree(pages_thr[tid]);
+      memory->sfree(dpages_thr[tid]);
+    }
   }
 
+  delete [] maxpage_thr;
+  delete [] pages_thr;
+  delete [] dpages_thr;
+
   delete [] iskip;
   memory->destroy(ijskip);
 
@@ -201,6 +219,74 @@ int **NeighList::add_pages()
   return pages;
 }
 
+/* ----------------------------------------------------------------------
+   add PGDELTA pages to page pool of thread tid
+   called by each thread for its own pool only, so no locking is needed
+------------------------------------------------------------------------- */
+
+int **NeighList::add_pages(int tid)
+{
+  if (tid == 0) return add_pages();
+
+  int toppage = maxpage_thr[tid];
+  maxpage_thr[tid] += PGDELTA;
+  int n = maxpage_thr[tid];
+
+  pages_thr[tid] = (int **) 
+    memory->srealloc(pages_thr[tid],n*sizeof(int *),"neighlist:pages");
+  for (int i = toppage; i < n; i++)
+    memory->create(pages_thr[tid][i],pgsize,"neighlist:pages[i]");
+
+  if (dnum) {
+    dpages_thr[tid] = (double **) 
+      memory->srealloc(dpages_thr[tid],n*sizeof(double *),"neighlist:dpages");
+    for (int i = toppage; i < n; i++)
+      memory->create(dpages_thr[tid][i],dnum*pgsize,"neighlist:dpages[i]");
+  }
+
+  return pages_thr[tid];
+}
+
+/* ----------------------------------------------------------------------
+   insure there is a page pool for each of nthreads threads
+   pools are only added, in case a later run uses fewer threads
+------------------------------------------------------------------------- */
+
+void NeighList::setup_threads(int nthreads)
+{
+  if (nthreads <= npool) return;
+
+  int *maxpage_new = new int[nthreads];
+  int ***pages_new = new int**[nthreads];
+  double ***dpages_new = new double**[nthreads];
+
+  maxpage_new[0] = 0;
+  pages_new[0] = NULL;
+  dpages_new[0] = NULL;
+  for (int tid = 1; tid < nthreads; tid++) {
+    if (tid < npool) {
+      maxpage_new[tid] = maxpage_thr[tid];
+      pages_new[tid] = pages_thr[tid];
+      dpages_new[tid] = dpages_thr[tid];
+    } else {
+      maxpage_new[tid] = 0;
+      pages_new[tid] = NULL;
+      dpages_new[tid] = NULL;
+    }
+  }
+
+  delete [] maxpage_thr;
+  delete [] pages_thr;
+  delete [] dpages_thr;
+  maxpage_thr = maxpage_new;
+  pages_thr = pages_new;
+  dpages_thr = dpages_new;
+
+  int oldpool = npool;
+  npool = nthreads;
+  for (int tid = oldpool; tid < npool; tid++) add_pages(tid);
+}
+
 /* ----------------------------------------------------------------------
    copy skip info from request rq into list's iskip,ijskip
 ------------------------------------------------------------------------- */
@@ -278,6 +364,12 @@ bigint NeighList::memory_usage()
     bytes += memory->usage(dpages,maxpage,dnum*pgsize);
   }
 
+  for (int tid = 1; tid < npool; tid++) {
+    bytes += memory->usage(pages_thr[tid],maxpage_thr[tid],pgsize);
+    if (dnum)
+      bytes += memory->usage(dpages_thr[tid],maxpage_thr[tid],dnum*pgsize);
+  }
+
   if (maxstencil) bytes += memory->usage(stencil,maxstencil);
   if (ghostflag) bytes += memory->usage(stencilxyz,maxstencil,3);
 
@@ -43,6 +43,14 @@ class NeighList : protected Pointers {
   double **dpages;                 // neighbor list pages for doubles
   int dnum;                        // # of doubles for each pair (0 if none)
 
+  // page pools of threads 1 to npool-1 for threaded builds
+  // thread 0 uses pages,dpages above
+
+  int npool;                       // # of threads with a page pool
+  int *maxpage_thr;                // # of pages in each thread's pool
+  int ***pages_thr;                // int pages of each thread
+  double ***dpages_thr;            // double pages of each thread
+
   // atom types to skip when building list
   // iskip,ijskip are just ptrs to corresponding request
 
@@ -80,6 +88,11 @@ class NeighList : protected Pointers {
   void grow(int);                       // grow maxlocal
   void stencil_allocate(int, int);      // allocate stencil arrays
   int **add_pages();                    // add pages to neigh list
+  int **add_pages(int);                 // add pages to a thread's pool
+  void setup_threads(int);              // create page pools for N threads
+  int **thread_pages(int tid) {return tid ? pages_thr[tid] : pages;}
+  double **thread_dpages(int tid) {return tid ? dpages_thr[tid] : dpages;}
+  int thread_maxpage(int tid) {return tid ? maxpage_thr[tid] : maxpage;}
   void copy_skip_info(int *, int **);   // copy skip info from a neigh request
   void print_attributes();              // debug routine
   int get_maxlocal() {return maxatoms;}
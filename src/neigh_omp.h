@@ -0,0 +1,41 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_NEIGH_OMP_H
+#define LMP_NEIGH_OMP_H
+
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
+// threaded neighbor list builds
+// each thread in a parallel region of a build function loops over
+//   a contiguous chunk ifrom to ito-1 of the num atoms
+// it stores their neighbors in its own page pool of the list,
+//   so threads never share a page or a page cursor
+
+#if defined(_OPENMP)
+#define NEIGH_OMP_TID omp_get_thread_num()
+#define NEIGH_OMP_NTHREADS omp_get_num_threads()
+#else
+#define NEIGH_OMP_TID 0
+#define NEIGH_OMP_NTHREADS 1
+#endif
+
+#define NEIGH_OMP_CHUNK(num)					\
+  const int tid = NEIGH_OMP_TID;				\
+  const int idelta = 1 + (num)/NEIGH_OMP_NTHREADS;		\
+  const int ifrom = MIN(tid*idelta,(num));			\
+  const int ito = MIN(ifrom+idelta,(num))
+
+#endif
@@ -35,6 +35,7 @@ NeighRequest::NeighRequest(LAMMPS *lmp) : Pointers(lmp)
   half = 1;
   full = 0;
   gran = granhistory = 0;
+  size = 0;
   respainner = respamiddle = respaouter = 0;
   half_from_full = 0;
   ghost = 0;
@@ -93,6 +94,7 @@ int NeighRequest::identical(NeighRequest *other)
   if (full != other->full) same = 0;
   if (gran != other->gran) same = 0;
   if (granhistory != other->granhistory) same = 0;
+  if (size != other->size) same = 0;
   if (respainner != other->respainner) same = 0;
   if (respamiddle != other->respamiddle) same = 0;
   if (respaouter != other->respaouter) same = 0;
@@ -126,6 +128,7 @@ int NeighRequest::same_kind(NeighRequest *other)
   if (full != other->full) same = 0;
   if (gran != other->gran) same = 0;
   if (granhistory != other->granhistory) same = 0;
+  if (size != other->size) same = 0;
   if (respainner != other->respainner) same = 0;
   if (respamiddle != other->respamiddle) same = 0;
   if (respaouter != other->respaouter) same = 0;
@@ -174,6 +177,7 @@ void NeighRequest::copy_request(NeighRequest *other)
   if (other->full) full = 1;
   if (other->gran) gran = 1;
   if (other->granhistory) granhistory = 1;
+  if (other->size) size = 1;
   if (other->respainner) respainner = 1;
   if (other->respamiddle) respamiddle = 1;
   if (other->respaouter) respaouter = 1;
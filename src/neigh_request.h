@@ -39,6 +39,7 @@ class NeighRequest : protected Pointers {
 
   int gran;              // 1 if granular list
   int granhistory;       // 1 if granular history list
+  int size;              // 1 if cutoff is set by larger per-atom radius
 
   int respainner;        // 1 if a rRESPA inner list        
   int respamiddle;       // 1 if a rRESPA middle list
@@ -13,7 +13,9 @@
 
 #include "neighbor.h"
 #include "neigh_list.h"
+#include "neigh_omp.h"
 #include "atom.h"
+#include "comm.h"
 #include "group.h"
 #include "error.h"
 
@@ -364,10 +366,6 @@ void Neighbor::respa_nsq_newton(NeighList *list)
 
 void Neighbor::respa_bin_no_newton(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which,n_inner,n_middle;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr,*neighptr_inner,*neighptr_middle;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -389,7 +387,6 @@ void Neighbor::respa_bin_no_newton(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
@@ -397,131 +394,143 @@ void Neighbor::respa_bin_no_newton(NeighList *list)
   int *ilist_inner = listinner->ilist;
   int *numneigh_inner = listinner->numneigh;
   int **firstneigh_inner = listinner->firstneigh;
-  int **pages_inner = listinner->pages;
 
-  NeighList *listmiddle;
-  int *ilist_middle,*numneigh_middle,**firstneigh_middle,**pages_middle;
+  NeighList *listmiddle = NULL;
+  int *ilist_middle = NULL;
+  int *numneigh_middle = NULL;
+  int **firstneigh_middle = NULL;
   int respamiddle = list->respamiddle;
   if (respamiddle) {
     listmiddle = list->listmiddle;
     ilist_middle = listmiddle->ilist;
     numneigh_middle = listmiddle->numneigh;
     firstneigh_middle = listmiddle->firstneigh;
-    pages_middle = listmiddle->pages;
   }
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-  int npage_inner = 0;
-  int npnt_inner = 0;
-  int npage_middle = 0;
-  int npnt_middle = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
-    neighptr = &pages[npage][npnt];
-    n = 0;
-
-    if (pgsize - npnt_inner < oneatom) {
-      npnt_inner = 0;
-      npage_inner++;
-      if (npage_inner == listinner->maxpage)
-	pages_inner = listinner->add_pages();
-    }
-    neighptr_inner = &pages_inner[npage_inner][npnt_inner];
-    n_inner = 0;
-
-    if (respamiddle) {
-      if (pgsize - npnt_middle < oneatom) {
-	npnt_middle = 0;
-	npage_middle++;
-	if (npage_middle == listmiddle->maxpage)
-	  pages_middle = listmiddle->add_pages();
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which,n_inner,n_middle;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr,*neighptr_inner,*neighptr_middle;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int **pages_inner = listinner->thread_pages(tid);
+    int **pages_middle;
+    if (respamiddle) pages_middle = listmiddle->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+    int npage_inner = 0;
+    int npnt_inner = 0;
+    int npage_middle = 0;
+    int npnt_middle = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
+      neighptr = &pages[npage][npnt];
+      n = 0;
+
+      if (pgsize - npnt_inner < oneatom) {
+	npnt_inner = 0;
+	npage_inner++;
+	if (npage_inner == listinner->thread_maxpage(tid))
+	  pages_inner = listinner->add_pages(tid);
+      }
+      neighptr_inner = &pages_inner[npage_inner][npnt_inner];
+      n_inner = 0;
+
+      if (respamiddle) {
+	if (pgsize - npnt_middle < oneatom) {
+	  npnt_middle = 0;
+	  npage_middle++;
+	  if (npage_middle == listmiddle->thread_maxpage(tid))
+	    pages_middle = listmiddle->add_pages(tid);
+	}
+	neighptr_middle = &pages_middle[npage_middle][npnt_middle];
+	n_middle = 0;
       }
-      neighptr_middle = &pages_middle[npage_middle][npnt_middle];
-      n_middle = 0;
-    }
-
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-    ibin = coord2bin(x[i]);
-
-    // loop over all atoms in surrounding bins in stencil including self
-    // only store pair if i < j
-    // stores own/own pairs only once
-    // stores own/ghost pairs on both procs
-
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	if (j <= i) continue;
-
-	jtype = type[j];
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
-
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
-
-	if (rsq <= cutneighsq[itype][jtype]) {
-	  if (molecular) {
-	    which = find_special(special[i],nspecial[i],tag[j]);
-	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	  } else neighptr[n++] = j;
-
-	  if (rsq < cut_inner_sq) {
-	    if (which == 0) neighptr_inner[n_inner++] = j;
-	    else if (which > 0) 
-	      neighptr_inner[n_inner++] = j ^ (which << SBBITS);
-	  }
 
-	  if (respamiddle && 
-	      rsq < cut_middle_sq && rsq > cut_middle_inside_sq) {
-	    if (which == 0) neighptr_middle[n_middle++] = j;
-	    else if (which > 0) 
-	      neighptr_middle[n_middle++] = j ^ (which << SBBITS);
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      ibin = coord2bin(x[i]);
+
+      // loop over all atoms in surrounding bins in stencil including self
+      // only store pair if i < j
+      // stores own/own pairs only once
+      // stores own/ghost pairs on both procs
+
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (j <= i) continue;
+
+	  jtype = type[j];
+	  if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+
+	    if (rsq < cut_inner_sq) {
+	      if (which == 0) neighptr_inner[n_inner++] = j;
+	      else if (which > 0) 
+		neighptr_inner[n_inner++] = j ^ (which << SBBITS);
+	    }
+
+	    if (respamiddle && 
+		rsq < cut_middle_sq && rsq > cut_middle_inside_sq) {
+	      if (which == 0) neighptr_middle[n_middle++] = j;
+	      else if (which > 0) 
+		neighptr_middle[n_middle++] = j ^ (which << SBBITS);
+	    }
 	  }
 	}
       }
-    }
-
-    ilist[inum] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
 
-    ilist_inner[inum] = i;
-    firstneigh_inner[i] = neighptr_inner;
-    numneigh_inner[i] = n_inner;
-    npnt_inner += n_inner;
-    if (npnt_inner >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
 
-    if (respamiddle) {
-      ilist_middle[inum] = i;
-      firstneigh_middle[i] = neighptr_middle;
-      numneigh_middle[i] = n_middle;
-      npnt_middle += n_middle;
-      if (npnt_middle >= pgsize)
+      ilist_inner[i] = i;
+      firstneigh_inner[i] = neighptr_inner;
+      numneigh_inner[i] = n_inner;
+      npnt_inner += n_inner;
+      if (npnt_inner >= pgsize)
 	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
-    }
 
-    inum++;
+      if (respamiddle) {
+	ilist_middle[i] = i;
+	firstneigh_middle[i] = neighptr_middle;
+	numneigh_middle[i] = n_middle;
+	npnt_middle += n_middle;
+	if (npnt_middle >= pgsize)
+	  error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      }
+
+    }
   }
 
-  list->inum = inum;
-  listinner->inum = inum;
-  if (respamiddle) listmiddle->inum = inum;
+  list->inum = nlocal;
+  listinner->inum = nlocal;
+  if (respamiddle) listmiddle->inum = nlocal;
 }
       
 /* ----------------------------------------------------------------------
@@ -533,10 +542,6 @@ void Neighbor::respa_bin_no_newton(NeighList *list)
 
 void Neighbor::respa_bin_newton(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which,n_inner,n_middle;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr,*neighptr_inner,*neighptr_middle;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -558,7 +563,6 @@ void Neighbor::respa_bin_newton(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
@@ -566,108 +570,87 @@ void Neighbor::respa_bin_newton(NeighList *list)
   int *ilist_inner = listinner->ilist;
   int *numneigh_inner = listinner->numneigh;
   int **firstneigh_inner = listinner->firstneigh;
-  int **pages_inner = listinner->pages;
 
-  NeighList *listmiddle;
-  int *ilist_middle,*numneigh_middle,**firstneigh_middle,**pages_middle;
+  NeighList *listmiddle = NULL;
+  int *ilist_middle = NULL;
+  int *numneigh_middle = NULL;
+  int **firstneigh_middle = NULL;
   int respamiddle = list->respamiddle;
   if (respamiddle) {
     listmiddle = list->listmiddle;
     ilist_middle = listmiddle->ilist;
     numneigh_middle = listmiddle->numneigh;
     firstneigh_middle = listmiddle->firstneigh;
-    pages_middle = listmiddle->pages;
   }
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-  int npage_inner = 0;
-  int npnt_inner = 0;
-  int npage_middle = 0;
-  int npnt_middle = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
-    neighptr = &pages[npage][npnt];
-    n = 0;
-
-    if (pgsize - npnt_inner < oneatom) {
-      npnt_inner = 0;
-      npage_inner++;
-      if (npage_inner == listinner->maxpage)
-	pages_inner = listinner->add_pages();
-    }
-    neighptr_inner = &pages_inner[npage_inner][npnt_inner];
-    n_inner = 0;
-
-    if (respamiddle) {
-      if (pgsize - npnt_middle < oneatom) {
-	npnt_middle = 0;
-	npage_middle++;
-	if (npage_middle == listmiddle->maxpage)
-	  pages_middle = listmiddle->add_pages();
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which,n_inner,n_middle;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr,*neighptr_inner,*neighptr_middle;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int **pages_inner = listinner->thread_pages(tid);
+    int **pages_middle;
+    if (respamiddle) pages_middle = listmiddle->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+    int npage_inner = 0;
+    int npnt_inner = 0;
+    int npage_middle = 0;
+    int npnt_middle = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
       }
-      neighptr_middle = &pages_middle[npage_middle][npnt_middle];
-      n_middle = 0;
-    }
-
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-
-    // loop over rest of atoms in i's bin, ghosts are at end of linked list
-    // if j is owned atom, store it, since j is beyond i in linked list
-    // if j is ghost, only store if j coords are "above and to the right" of i
-
-    for (j = bins[i]; j >= 0; j = bins[j]) {
-      if (j >= nlocal) {
-	if (x[j][2] < ztmp) continue;
-	if (x[j][2] == ztmp) {
-	  if (x[j][1] < ytmp) continue;
-	  if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+      neighptr = &pages[npage][npnt];
+      n = 0;
+
+      if (pgsize - npnt_inner < oneatom) {
+	npnt_inner = 0;
+	npage_inner++;
+	if (npage_inner == listinner->thread_maxpage(tid))
+	  pages_inner = listinner->add_pages(tid);
+      }
+      neighptr_inner = &pages_inner[npage_inner][npnt_inner];
+      n_inner = 0;
+
+      if (respamiddle) {
+	if (pgsize - npnt_middle < oneatom) {
+	  npnt_middle = 0;
+	  npage_middle++;
+	  if (npage_middle == listmiddle->thread_maxpage(tid))
+	    pages_middle = listmiddle->add_pages(tid);
 	}
+	neighptr_middle = &pages_middle[npage_middle][npnt_middle];
+	n_middle = 0;
       }
 
-      jtype = type[j];
-      if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
-
-      delx = xtmp - x[j][0];
-      dely = ytmp - x[j][1];
-      delz = ztmp - x[j][2];
-      rsq = delx*delx + dely*dely + delz*delz;
-
-      if (rsq <= cutneighsq[itype][jtype]) {
-	if (molecular) {
-	  which = find_special(special[i],nspecial[i],tag[j]);
-	  if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	} else neighptr[n++] = j;
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
 
-        if (rsq < cut_inner_sq) {
-	  if (which == 0) neighptr_inner[n_inner++] = j;
-	  else if (which > 0) neighptr_inner[n_inner++] = j ^ (which << SBBITS);
-        }
+      // loop over rest of atoms in i's bin, ghosts are at end of linked list
+      // if j is owned atom, store it, since j is beyond i in linked list
+      // if j is ghost, only store if j coords are "above and to the right" of i
 
-        if (respamiddle && 
-	    rsq < cut_middle_sq && rsq > cut_middle_inside_sq) {
-	  if (which == 0) neighptr_middle[n_middle++] = j;
-	  else if (which > 0) 
-	    neighptr_middle[n_middle++] = j ^ (which << SBBITS);
-        }
-      }
-    }
-
-    // loop over all atoms in other bins in stencil, store every pair
+      for (j = bins[i]; j >= 0; j = bins[j]) {
+	if (j >= nlocal) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+	  }
+	}
 
-    ibin = coord2bin(x[i]);
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
 	jtype = type[j];
 	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
 
@@ -684,8 +667,7 @@ void Neighbor::respa_bin_newton(NeighList *list)
 
 	  if (rsq < cut_inner_sq) {
 	    if (which == 0) neighptr_inner[n_inner++] = j;
-	    else if (which > 0) 
-	      neighptr_inner[n_inner++] = j ^ (which << SBBITS);
+	    else if (which > 0) neighptr_inner[n_inner++] = j ^ (which << SBBITS);
 	  }
 
 	  if (respamiddle && 
@@ -696,37 +678,71 @@ void Neighbor::respa_bin_newton(NeighList *list)
 	  }
 	}
       }
-    }
 
-    ilist[inum] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      // loop over all atoms in other bins in stencil, store every pair
+
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  jtype = type[j];
+	  if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+
+	    if (rsq < cut_inner_sq) {
+	      if (which == 0) neighptr_inner[n_inner++] = j;
+	      else if (which > 0) 
+		neighptr_inner[n_inner++] = j ^ (which << SBBITS);
+	    }
+
+	    if (respamiddle && 
+		rsq < cut_middle_sq && rsq > cut_middle_inside_sq) {
+	      if (which == 0) neighptr_middle[n_middle++] = j;
+	      else if (which > 0) 
+		neighptr_middle[n_middle++] = j ^ (which << SBBITS);
+	    }
+	  }
+	}
+      }
 
-    ilist_inner[inum] = i;
-    firstneigh_inner[i] = neighptr_inner;
-    numneigh_inner[i] = n_inner;
-    npnt_inner += n_inner;
-    if (npnt_inner >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
 
-    if (respamiddle) {
-      ilist_middle[inum] = i;
-      firstneigh_middle[i] = neighptr_middle;
-      numneigh_middle[i] = n_middle;
-      npnt_middle += n_middle;
-      if (npnt_middle >= pgsize)
+      ilist_inner[i] = i;
+      firstneigh_inner[i] = neighptr_inner;
+      numneigh_inner[i] = n_inner;
+      npnt_inner += n_inner;
+      if (npnt_inner >= pgsize)
 	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
-    }
 
-    inum++;
+      if (respamiddle) {
+	ilist_middle[i] = i;
+	firstneigh_middle[i] = neighptr_middle;
+	numneigh_middle[i] = n_middle;
+	npnt_middle += n_middle;
+	if (npnt_middle >= pgsize)
+	  error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      }
+
+    }
   }
 
-  list->inum = inum;
-  listinner->inum = inum;
-  if (respamiddle) listmiddle->inum = inum;
+  list->inum = nlocal;
+  listinner->inum = nlocal;
+  if (respamiddle) listmiddle->inum = nlocal;
 }
 
 /* ----------------------------------------------------------------------
@@ -738,10 +754,6 @@ void Neighbor::respa_bin_newton(NeighList *list)
 
 void Neighbor::respa_bin_newton_tri(NeighList *list)
 {
-  int i,j,k,n,itype,jtype,ibin,which,n_inner,n_middle;
-  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
-  int *neighptr,*neighptr_inner,*neighptr_middle;
-
   // bin local & ghost atoms
 
   bin_atoms();
@@ -763,7 +775,6 @@ void Neighbor::respa_bin_newton_tri(NeighList *list)
   int *ilist = list->ilist;
   int *numneigh = list->numneigh;
   int **firstneigh = list->firstneigh;
-  int **pages = list->pages;
   int nstencil = list->nstencil;
   int *stencil = list->stencil;
 
@@ -771,137 +782,149 @@ void Neighbor::respa_bin_newton_tri(NeighList *list)
   int *ilist_inner = listinner->ilist;
   int *numneigh_inner = listinner->numneigh;
   int **firstneigh_inner = listinner->firstneigh;
-  int **pages_inner = listinner->pages;
 
-  NeighList *listmiddle;
-  int *ilist_middle,*numneigh_middle,**firstneigh_middle,**pages_middle;
+  NeighList *listmiddle = NULL;
+  int *ilist_middle = NULL;
+  int *numneigh_middle = NULL;
+  int **firstneigh_middle = NULL;
   int respamiddle = list->respamiddle;
   if (respamiddle) {
     listmiddle = list->listmiddle;
     ilist_middle = listmiddle->ilist;
     numneigh_middle = listmiddle->numneigh;
     firstneigh_middle = listmiddle->firstneigh;
-    pages_middle = listmiddle->pages;
   }
 
-  int inum = 0;
-  int npage = 0;
-  int npnt = 0;
-  int npage_inner = 0;
-  int npnt_inner = 0;
-  int npage_middle = 0;
-  int npnt_middle = 0;
-
-  for (i = 0; i < nlocal; i++) {
-
-    if (pgsize - npnt < oneatom) {
-      npnt = 0;
-      npage++;
-      if (npage == list->maxpage) pages = list->add_pages();
-    }
-    neighptr = &pages[npage][npnt];
-    n = 0;
-
-    if (pgsize - npnt_inner < oneatom) {
-      npnt_inner = 0;
-      npage_inner++;
-      if (npage_inner == listinner->maxpage)
-	pages_inner = listinner->add_pages();
-    }
-    neighptr_inner = &pages_inner[npage_inner][npnt_inner];
-    n_inner = 0;
-
-    if (respamiddle) {
-      if (pgsize - npnt_middle < oneatom) {
-	npnt_middle = 0;
-	npage_middle++;
-	if (npage_middle == listmiddle->maxpage)
-	  pages_middle = listmiddle->add_pages();
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,jtype,ibin,which,n_inner,n_middle;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    int *neighptr,*neighptr_inner,*neighptr_middle;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int **pages_inner = listinner->thread_pages(tid);
+    int **pages_middle;
+    if (respamiddle) pages_middle = listmiddle->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+    int npage_inner = 0;
+    int npnt_inner = 0;
+    int npage_middle = 0;
+    int npnt_middle = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
       }
-      neighptr_middle = &pages_middle[npage_middle][npnt_middle];
-      n_middle = 0;
-    }
-
-    itype = type[i];
-    xtmp = x[i][0];
-    ytmp = x[i][1];
-    ztmp = x[i][2];
-
-    // loop over all atoms in bins in stencil
-    // pairs for atoms j "below" i are excluded
-    // below = lower z or (equal z and lower y) or (equal zy and lower x)
-    //         (equal zyx and j <= i)
-    // latter excludes self-self interaction but allows superposed atoms
-
-    ibin = coord2bin(x[i]);
-    for (k = 0; k < nstencil; k++) {
-      for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
-	if (x[j][2] < ztmp) continue;
-	if (x[j][2] == ztmp) {
-	  if (x[j][1] < ytmp) continue;
-	  if (x[j][1] == ytmp) {
-	    if (x[j][0] < xtmp) continue;
-	    if (x[j][0] == xtmp && j <= i) continue;
-	  }
+      neighptr = &pages[npage][npnt];
+      n = 0;
+
+      if (pgsize - npnt_inner < oneatom) {
+	npnt_inner = 0;
+	npage_inner++;
+	if (npage_inner == listinner->thread_maxpage(tid))
+	  pages_inner = listinner->add_pages(tid);
+      }
+      neighptr_inner = &pages_inner[npage_inner][npnt_inner];
+      n_inner = 0;
+
+      if (respamiddle) {
+	if (pgsize - npnt_middle < oneatom) {
+	  npnt_middle = 0;
+	  npage_middle++;
+	  if (npage_middle == listmiddle->thread_maxpage(tid))
+	    pages_middle = listmiddle->add_pages(tid);
 	}
+	neighptr_middle = &pages_middle[npage_middle][npnt_middle];
+	n_middle = 0;
+      }
 
-	jtype = type[j];
-	if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
-
-	delx = xtmp - x[j][0];
-	dely = ytmp - x[j][1];
-	delz = ztmp - x[j][2];
-	rsq = delx*delx + dely*dely + delz*delz;
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
 
-	if (rsq <= cutneighsq[itype][jtype]) {
-	  if (molecular) {
-	    which = find_special(special[i],nspecial[i],tag[j]);
-	    if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
-	  } else neighptr[n++] = j;
+      // loop over all atoms in bins in stencil
+      // pairs for atoms j "below" i are excluded
+      // below = lower z or (equal z and lower y) or (equal zy and lower x)
+      //         (equal zyx and j <= i)
+      // latter excludes self-self interaction but allows superposed atoms
 
-	  if (rsq < cut_inner_sq) {
-	    if (which == 0) neighptr_inner[n_inner++] = j;
-	    else if (which > 0) 
-	      neighptr_inner[n_inner++] = j ^ (which << SBBITS);
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp) {
+	      if (x[j][0] < xtmp) continue;
+	      if (x[j][0] == xtmp && j <= i) continue;
+	    }
 	  }
 
-	  if (respamiddle &&
-	      rsq < cut_middle_sq && rsq > cut_middle_inside_sq) {
-	    if (which == 0) neighptr_middle[n_middle++] = j;
-	    else if (which > 0) 
-	      neighptr_middle[n_middle++] = j ^ (which << SBBITS);
+	  jtype = type[j];
+	  if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+
+	  if (rsq <= cutneighsq[itype][jtype]) {
+	    if (molecular) {
+	      which = find_special(special[i],nspecial[i],tag[j]);
+	      if (which >= 0) neighptr[n++] = j ^ (which << SBBITS);
+	    } else neighptr[n++] = j;
+
+	    if (rsq < cut_inner_sq) {
+	      if (which == 0) neighptr_inner[n_inner++] = j;
+	      else if (which > 0) 
+		neighptr_inner[n_inner++] = j ^ (which << SBBITS);
+	    }
+
+	    if (respamiddle &&
+		rsq < cut_middle_sq && rsq > cut_middle_inside_sq) {
+	      if (which == 0) neighptr_middle[n_middle++] = j;
+	      else if (which > 0) 
+		neighptr_middle[n_middle++] = j ^ (which << SBBITS);
+	    }
 	  }
 	}
       }
-    }
-
-    ilist[inum] = i;
-    firstneigh[i] = neighptr;
-    numneigh[i] = n;
-    npnt += n;
-    if (n > oneatom || npnt >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
 
-    ilist_inner[inum] = i;
-    firstneigh_inner[i] = neighptr_inner;
-    numneigh_inner[i] = n_inner;
-    npnt_inner += n_inner;
-    if (npnt_inner >= pgsize)
-      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
 
-    if (respamiddle) {
-      ilist_middle[inum] = i;
-      firstneigh_middle[i] = neighptr_middle;
-      numneigh_middle[i] = n_middle;
-      npnt_middle += n_middle;
-      if (npnt_middle >= pgsize)
+      ilist_inner[i] = i;
+      firstneigh_inner[i] = neighptr_inner;
+      numneigh_inner[i] = n_inner;
+      npnt_inner += n_inner;
+      if (npnt_inner >= pgsize)
 	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
-    }
 
-    inum++;
+      if (respamiddle) {
+	ilist_middle[i] = i;
+	firstneigh_middle[i] = neighptr_middle;
+	numneigh_middle[i] = n_middle;
+	npnt_middle += n_middle;
+	if (npnt_middle >= pgsize)
+	  error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+      }
+
+    }
   }
 
-  list->inum = inum;
-  listinner->inum = inum;
-  if (respamiddle) listmiddle->inum = inum;
+  list->inum = nlocal;
+  listinner->inum = nlocal;
+  if (respamiddle) listmiddle->inum = nlocal;
 }
@@ -0,0 +1,519 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under 
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_omp.h"
+#include "atom.h"
+#include "comm.h"
+#include "group.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ----------------------------------------------------------------------
+   particles with per-atom interaction radius, e.g. SPH smoothing length
+   pair is stored if rsq <= (max(radius[i],radius[j]) + skin)^2
+     and within the neighbor cutoff of the type pair
+   N^2 / 2 search for neighbor pairs with partial Newton's 3rd law
+   pair added to list if atoms i and j are both owned and i < j
+   pair added if j is ghost (also stored by proc owning j)
+------------------------------------------------------------------------- */
+
+void Neighbor::size_nsq_no_newton(NeighList *list)
+{
+  int i,j,n,itype;
+  int bitmask = 0;
+  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+  double radi,radmax,cutsq;
+  int *neighptr;
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  if (includegroup) {
+    nlocal = atom->nfirst;
+    bitmask = group->bitmask[includegroup];
+  }
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int **pages = list->pages;
+
+  int inum = 0;
+  int npage = 0;
+  int npnt = 0;
+
+  for (i = 0; i < nlocal; i++) {
+
+    if (pgsize - npnt < oneatom) {
+      npnt = 0;
+      npage++;
+      if (npage == list->maxpage) pages = list->add_pages();
+    }
+
+    n = 0;
+    neighptr = &pages[npage][npnt];
+
+    itype = type[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    radi = radius[i];
+
+    // loop over remaining atoms, owned and ghost
+
+    for (j = i+1; j < nall; j++) {
+      if (includegroup && !(mask[j] & bitmask)) continue;
+      if (exclude && exclusion(i,j,itype,type[j],mask,molecule)) continue;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      radmax = MAX(radi,radius[j]);
+      cutsq = (radmax+skin) * (radmax+skin);
+
+      if (rsq <= cutsq && rsq <= cutneighsq[itype][type[j]]) neighptr[n++] = j;
+    }
+
+    ilist[inum++] = i;
+    firstneigh[i] = neighptr;
+    numneigh[i] = n;
+    npnt += n;
+    if (n > oneatom || npnt >= pgsize)
+      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+  }
+
+  list->inum = inum;
+}
+
+/* ----------------------------------------------------------------------
+   particles with per-atom interaction radius
+   N^2 / 2 search for neighbor pairs with full Newton's 3rd law
+   pair added to list if atoms i and j are both owned and i < j
+   if j is ghost only me or other proc adds pair
+   decision based on itag,jtag tests
+------------------------------------------------------------------------- */
+
+void Neighbor::size_nsq_newton(NeighList *list)
+{
+  int i,j,n,itype,itag,jtag;
+  int bitmask = 0;
+  double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+  double radi,radmax,cutsq;
+  int *neighptr;
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *tag = atom->tag;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  int nall = nlocal + atom->nghost;
+  if (includegroup) {
+    nlocal = atom->nfirst;
+    bitmask = group->bitmask[includegroup];
+  }
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int **pages = list->pages;
+
+  int inum = 0;
+  int npage = 0;
+  int npnt = 0;
+
+  for (i = 0; i < nlocal; i++) {
+
+    if (pgsize - npnt < oneatom) {
+      npnt = 0;
+      npage++;
+      if (npage == list->maxpage) pages = list->add_pages();
+    }
+
+    n = 0;
+    neighptr = &pages[npage][npnt];
+
+    itag = tag[i];
+    itype = type[i];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    radi = radius[i];
+
+    // loop over remaining atoms, owned and ghost
+
+    for (j = i+1; j < nall; j++) {
+      if (includegroup && !(mask[j] & bitmask)) continue;
+
+      if (j >= nlocal) {
+	jtag = tag[j];
+	if (itag > jtag) {
+	  if ((itag+jtag) % 2 == 0) continue;
+	} else if (itag < jtag) {
+	  if ((itag+jtag) % 2 == 1) continue;
+	} else {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+	  }
+	}
+      }
+
+      if (exclude && exclusion(i,j,itype,type[j],mask,molecule)) continue;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+      rsq = delx*delx + dely*dely + delz*delz;
+      radmax = MAX(radi,radius[j]);
+      cutsq = (radmax+skin) * (radmax+skin);
+
+      if (rsq <= cutsq && rsq <= cutneighsq[itype][type[j]]) neighptr[n++] = j;
+    }
+
+    ilist[inum++] = i;
+    firstneigh[i] = neighptr;
+    numneigh[i] = n;
+    npnt += n;
+    if (n > oneatom || npnt >= pgsize)
+      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+  }
+
+  list->inum = inum;
+}
+
+/* ----------------------------------------------------------------------
+   particles with per-atom interaction radius
+   binned neighbor list construction with partial Newton's 3rd law
+   each owned atom i checks own bin and surrounding bins in non-Newton stencil
+   pair stored once if i,j are both owned and i < j
+   pair stored by me if j is ghost (also stored by proc owning j)
+------------------------------------------------------------------------- */
+
+void Neighbor::size_bin_no_newton(NeighList *list)
+{
+  // bin local & ghost atoms
+
+  bin_atoms();
+
+  // loop over each atom, storing neighbors
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,ibin;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    double radi,radmax,cutsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
+
+      n = 0;
+      neighptr = &pages[npage][npnt];
+
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      radi = radius[i];
+      ibin = coord2bin(x[i]);
+
+      // loop over all atoms in surrounding bins in stencil including self
+      // only store pair if i < j
+      // stores own/own pairs only once
+      // stores own/ghost pairs on both procs
+
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (j <= i) continue;
+	  if (exclude && exclusion(i,j,itype,type[j],mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+	  radmax = MAX(radi,radius[j]);
+	  cutsq = (radmax+skin) * (radmax+skin);
+
+	  if (rsq <= cutsq && rsq <= cutneighsq[itype][type[j]])
+	    neighptr[n++] = j;
+	}
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
+  }
+
+  list->inum = nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   particles with per-atom interaction radius
+   binned neighbor list construction with full Newton's 3rd law
+   each owned atom i checks its own bin and other bins in Newton stencil
+   every pair stored exactly once by some processor
+------------------------------------------------------------------------- */
+
+void Neighbor::size_bin_newton(NeighList *list)
+{
+  // bin local & ghost atoms
+
+  bin_atoms();
+
+  // loop over each atom, storing neighbors
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,ibin;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    double radi,radmax,cutsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
+
+      n = 0;
+      neighptr = &pages[npage][npnt];
+
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      radi = radius[i];
+
+      // loop over rest of atoms in i's bin, ghosts are at end of linked list
+      // if j is owned atom, store it, since j is beyond i in linked list
+      // if j is ghost, only store if j coords are "above and to the right" of i
+
+      for (j = bins[i]; j >= 0; j = bins[j]) {
+	if (j >= nlocal) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp && x[j][0] < xtmp) continue;
+	  }
+	}
+
+	if (exclude && exclusion(i,j,itype,type[j],mask,molecule)) continue;
+
+	delx = xtmp - x[j][0];
+	dely = ytmp - x[j][1];
+	delz = ztmp - x[j][2];
+	rsq = delx*delx + dely*dely + delz*delz;
+	radmax = MAX(radi,radius[j]);
+	cutsq = (radmax+skin) * (radmax+skin);
+
+	if (rsq <= cutsq && rsq <= cutneighsq[itype][type[j]]) neighptr[n++] = j;
+      }
+
+      // loop over all atoms in other bins in stencil, store every pair
+
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (exclude && exclusion(i,j,itype,type[j],mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+	  radmax = MAX(radi,radius[j]);
+	  cutsq = (radmax+skin) * (radmax+skin);
+
+	  if (rsq <= cutsq && rsq <= cutneighsq[itype][type[j]])
+	    neighptr[n++] = j;
+	}
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
+  }
+
+  list->inum = nlocal;
+}
+
+/* ----------------------------------------------------------------------
+   particles with per-atom interaction radius
+   binned neighbor list construction with Newton's 3rd law for triclinic
+   each owned atom i checks its own bin and other bins in triclinic stencil
+   every pair stored exactly once by some processor
+------------------------------------------------------------------------- */
+
+void Neighbor::size_bin_newton_tri(NeighList *list)
+{
+  // bin local & ghost atoms
+
+  bin_atoms();
+
+  // loop over each atom, storing neighbors
+
+  double **x = atom->x;
+  double *radius = atom->radius;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  int *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+
+#if defined(_OPENMP)
+#pragma omp parallel default(shared) num_threads(comm->nthreads)
+#endif
+  {
+    int i,j,k,n,itype,ibin;
+    double xtmp,ytmp,ztmp,delx,dely,delz,rsq;
+    double radi,radmax,cutsq;
+    int *neighptr;
+
+    NEIGH_OMP_CHUNK(nlocal);
+    int **pages = list->thread_pages(tid);
+    int npage = 0;
+    int npnt = 0;
+
+    for (i = ifrom; i < ito; i++) {
+
+      if (pgsize - npnt < oneatom) {
+	npnt = 0;
+	npage++;
+	if (npage == list->thread_maxpage(tid)) pages = list->add_pages(tid);
+      }
+
+      n = 0;
+      neighptr = &pages[npage][npnt];
+
+      itype = type[i];
+      xtmp = x[i][0];
+      ytmp = x[i][1];
+      ztmp = x[i][2];
+      radi = radius[i];
+
+      // loop over all atoms in bins in stencil
+      // pairs for atoms j "below" i are excluded
+      // below = lower z or (equal z and lower y) or (equal zy and lower x)
+      //         (equal zyx and j <= i)
+      // latter excludes self-self interaction but allows superposed atoms
+
+      ibin = coord2bin(x[i]);
+      for (k = 0; k < nstencil; k++) {
+	for (j = binhead[ibin+stencil[k]]; j >= 0; j = bins[j]) {
+	  if (x[j][2] < ztmp) continue;
+	  if (x[j][2] == ztmp) {
+	    if (x[j][1] < ytmp) continue;
+	    if (x[j][1] == ytmp) {
+	      if (x[j][0] < xtmp) continue;
+	      if (x[j][0] == xtmp && j <= i) continue;
+	    }
+	  }
+
+	  if (exclude && exclusion(i,j,itype,type[j],mask,molecule)) continue;
+
+	  delx = xtmp - x[j][0];
+	  dely = ytmp - x[j][1];
+	  delz = ztmp - x[j][2];
+	  rsq = delx*delx + dely*dely + delz*delz;
+	  radmax = MAX(radi,radius[j]);
+	  cutsq = (radmax+skin) * (radmax+skin);
+
+	  if (rsq <= cutsq && rsq <= cutneighsq[itype][type[j]])
+	    neighptr[n++] = j;
+	}
+      }
+
+      ilist[i] = i;
+      firstneigh[i] = neighptr;
+      numneigh[i] = n;
+      npnt += n;
+      if (n > oneatom || npnt >= pgsize)
+	error->one(FLERR,"Neighbor list overflow, boost neigh_modify one or page");
+    }
+  }
+
+  list->inum = nlocal;
+}
@@ -36,6 +36,7 @@
 #include "update.h"
 #include "respa.h"
 #include "output.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -48,6 +49,8 @@ using namespace LAMMPS_NS;
 #define SMALL 1.0e-6
 #define BIG 1.0e20
 #define CUT2BIN_RATIO 100
+#define NAUTOBUILD 10           // builds per autoskin timing window
+#define AUTOSKINMIN 0.05        // smallest autoskin skin / neighbor skin
 
 enum{NSQ,BIN,MULTI};     // also in neigh_list.cpp
 
@@ -68,6 +71,10 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
   oneatom = 2000;
   binsizeflag = 0;
   build_once = 0;
+  autoskin = 0;
+  skin_active = -1.0;
+  cutneigh_change = 0;
+  auto_nbuild = 0;
 
   cutneighsq = NULL;
   cutneighghostsq = NULL;
@@ -79,6 +86,8 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
 
   maxhold = 0;
   xhold = NULL;
+  le_offset_hold = 0.0;
+  le_nwrap_hold = 0;
 
   // binning
 
@@ -215,9 +224,19 @@ void Neighbor::init()
   // trigger determines when atoms migrate and neighbor lists are rebuilt
   //   needs to be non-zero for migration distance check
   //   even if pair = NULL and no neighbor lists are used
-  // cutneigh = force cutoff + skin if cutforce > 0, else cutneigh = 0
+  // with autoskin, a skin tuned in a previous run is kept if still valid,
+  //   and lists are always rebuilt based on the distance check
+
+  if (autoskin) {
+    if (skin == 0.0) error->all(FLERR,"Neighbor autoskin requires skin > 0");
+    if (update->whichflag == 1 && strcmp(update->integrate_style,"verlet") != 0)
+      error->all(FLERR,"Neighbor autoskin requires run_style verlet");
+    if (skin_active <= 0.0 || skin_active > skin) skin_active = skin;
+    dist_check = 1;
+    delay = 0;
+  } else skin_active = skin;
+  auto_step0 = -1;
 
-  triggersq = 0.25*skin*skin;
   boxcheck = 0;
   if (domain->box_change && (domain->xperiodic || domain->yperiodic || 
 			     (dimension == 3 && domain->zperiodic)))
@@ -231,32 +250,7 @@ void Neighbor::init()
     cuttypesq = new double[n+1];
   }
 
-  double cutoff,delta,cut;
-  cutneighmin = BIG;
-  cutneighmax = 0.0;
-
-  for (i = 1; i <= n; i++) {
-    cuttype[i] = cuttypesq[i] = 0.0;
-    for (j = 1; j <= n; j++) {
-      if (force->pair) cutoff = sqrt(force->pair->cutsq[i][j]);
-      else cutoff = 0.0;
-      if (cutoff > 0.0) delta = skin;
-      else delta = 0.0;
-      cut = cutoff + delta;
-
-      cutneighsq[i][j] = cut*cut;
-      cuttype[i] = MAX(cuttype[i],cut);
-      cuttypesq[i] = MAX(cuttypesq[i],cut*cut);
-      cutneighmin = MIN(cutneighmin,cut);
-      cutneighmax = MAX(cutneighmax,cut);
-
-      if (force->pair && force->pair->ghostneigh) {
-	cut = force->pair->cutghost[i][j] + skin;
-	cutneighghostsq[i][j] = cut*cut;
-      }
-    }
-  }
-  cutneighmaxsq = cutneighmax * cutneighmax;
+  set_cutneigh();
 
   // check other classes that can induce reneighboring in decide()
   // don't check if build_once is set
@@ -593,12 +587,14 @@ void Neighbor::init()
 #endif
 
     // allocate atom arrays and 1st pages of lists that store them
+    // binned lists are built by all threads, each needs its own pages
 
     maxatom = atom->nmax;
     for (i = 0; i < nlist; i++)
       if (lists[i]->growflag) {
 	lists[i]->grow(maxatom);
 	lists[i]->add_pages();
+	lists[i]->setup_threads(comm->nthreads);
       }
 
     // setup 3 vectors of pairwise neighbor lists
@@ -795,7 +791,7 @@ int Neighbor::request(void *requestor)
    skip -> granular function if gran with granhistory,
            respa function if respaouter,
 	   skip_from function for everything else
-   half_from_full, half, full, gran, respaouter ->
+   half_from_full, half, full, gran, size, respaouter ->
      choose by newton and rq->newton and tri settings
      style NSQ options = newton off, newton on
      style BIN options = newton off, newton on and not tri, newton on and tri
@@ -877,6 +873,17 @@ void Neighbor::choose_build(int index, NeighRequest *rq)
     } else if (style == MULTI)
       error->all(FLERR,"Neighbor multi not yet enabled for granular");
 
+  } else if (rq->size) {
+    if (style == NSQ) {
+      if (newton_pair == 0) pb = &Neighbor::size_nsq_no_newton;
+      else if (newton_pair == 1) pb = &Neighbor::size_nsq_newton;
+    } else if (style == BIN) {
+      if (newton_pair == 0) pb = &Neighbor::size_bin_no_newton;
+      else if (triclinic == 0) pb = &Neighbor::size_bin_newton;
+      else if (triclinic == 1) pb = &Neighbor::size_bin_newton_tri;
+    } else if (style == MULTI)
+      error->all(FLERR,"Neighbor multi not yet enabled for per-atom radius");
+
   } else if (rq->respaouter) {
     if (style == NSQ) {
       if (newton_pair == 0) pb = &Neighbor::respa_nsq_no_newton;
@@ -901,7 +908,7 @@ void Neighbor::choose_build(int index, NeighRequest *rq)
    determine which stencil_create function each neigh list needs
    based on settings of neigh request, only called if style != NSQ
    skip or copy or half_from_full -> no stencil
-   half, gran, respaouter, full -> choose by newton and tri and dimension
+   half, gran, size, respaouter, full -> choose by newton and tri and dimension
    if none of these, ptr = NULL since this list needs no stencils
    use "else if" b/c skip,copy can be set in addition to half,full,etc
 ------------------------------------------------------------------------- */
@@ -912,7 +919,7 @@ void Neighbor::choose_stencil(int index, NeighRequest *rq)
 
   if (rq->skip || rq->copy || rq->half_from_full) sc = NULL;
 
-  else if (rq->half || rq->gran || rq->respaouter) {
+  else if (rq->half || rq->gran || rq->size || rq->respaouter) {
     if (style == BIN) {
       if (rq->newton == 0) {
 	if (newton_pair == 0) {
@@ -1024,6 +1031,121 @@ void Neighbor::print_lists_of_lists()
   }
 }
 
+/* ----------------------------------------------------------------------
+   set neighbor cutoffs and trigger distance from current skin_active
+   cutneigh = force cutoff + skin if cutforce > 0, else cutneigh = 0
+------------------------------------------------------------------------- */
+
+void Neighbor::set_cutneigh()
+{
+  int n = atom->ntypes;
+  double cutoff,delta,cut;
+
+  triggersq = 0.25*skin_active*skin_active;
+  cutneighmin = BIG;
+  cutneighmax = 0.0;
+
+  for (int i = 1; i <= n; i++) {
+    cuttype[i] = cuttypesq[i] = 0.0;
+    for (int j = 1; j <= n; j++) {
+      if (force->pair) cutoff = sqrt(force->pair->cutsq[i][j]);
+      else cutoff = 0.0;
+      if (cutoff > 0.0) delta = skin_active;
+      else delta = 0.0;
+      cut = cutoff + delta;
+
+      cutneighsq[i][j] = cut*cut;
+      cuttype[i] = MAX(cuttype[i],cut);
+      cuttypesq[i] = MAX(cuttypesq[i],cut*cut);
+      cutneighmin = MIN(cutneighmin,cut);
+      cutneighmax = MAX(cutneighmax,cut);
+
+      if (force->pair && force->pair->ghostneigh) {
+	cut = force->pair->cutghost[i][j] + skin_active;
+	cutneighghostsq[i][j] = cut*cut;
+      }
+    }
+  }
+  cutneighmaxsq = cutneighmax * cutneighmax;
+}
+
+/* ----------------------------------------------------------------------
+   adapt skin_active and every to the measured pair and neighbor cost
+   called by decide() when a rebuild is due, NAUTOBUILD builds per window
+   per-step cost ~ (rc+s)^dim * (a + c/s) with
+     a = pair time per step per neighbor volume
+     c = build time per neighbor volume * distance moved per step
+   minimum is the positive root of dim*a s^2 + (dim-1)*c s - c*rc = 0
+   step towards it geometrically and by at most a factor of 2 per window,
+   never above the skin of the neighbor command,
+   so cutoffs set from it in init() by other classes remain valid
+------------------------------------------------------------------------- */
+
+void Neighbor::autotune()
+{
+  bigint ntimestep = update->ntimestep;
+
+  if (auto_step0 < 0) {
+    auto_step0 = ntimestep;
+    auto_nbuild0 = auto_nbuild;
+    auto_pair0 = timer->array[TIME_PAIR];
+    auto_neigh0 = timer->array[TIME_NEIGHBOR];
+    return;
+  }
+
+  int nbuild = auto_nbuild - auto_nbuild0;
+  if (nbuild < NAUTOBUILD) return;
+
+  double nsteps = ntimestep - auto_step0;
+  double tlocal[2],tall[2];
+  tlocal[0] = timer->array[TIME_PAIR] - auto_pair0;
+  tlocal[1] = timer->array[TIME_NEIGHBOR] - auto_neigh0;
+  MPI_Allreduce(tlocal,tall,2,MPI_DOUBLE,MPI_SUM,world);
+
+  auto_step0 = ntimestep;
+  auto_nbuild0 = auto_nbuild;
+  auto_pair0 = timer->array[TIME_PAIR];
+  auto_neigh0 = timer->array[TIME_NEIGHBOR];
+
+  double tpair = tall[0]/comm->nprocs / nsteps;
+  double tneigh = tall[1]/comm->nprocs / nbuild;
+  double interval = nsteps/nbuild;
+
+  double s = skin_active;
+  double rc = cutneighmax - s;
+  if (tpair <= 0.0 || tneigh <= 0.0 || rc <= 0.0) return;
+
+  double d = dimension;
+  double vol = pow(rc+s,d);
+  double a = tpair/vol;
+  double c = tneigh/vol * s/interval;
+  double sopt = (-(d-1.0)*c + sqrt((d-1.0)*(d-1.0)*c*c + 4.0*d*a*c*rc)) / 
+    (2.0*d*a);
+
+  double snew = sqrt(s*sopt);
+  snew = MAX(snew,0.5*s);
+  snew = MIN(snew,2.0*s);
+  snew = MAX(snew,AUTOSKINMIN*skin);
+  snew = MIN(snew,skin);
+  int everynew = MAX(1,static_cast<int> (0.1*interval*snew/s));
+
+  if (fabs(snew-s) <= 0.05*s && everynew == every) return;
+
+  skin_active = snew;
+  every = everynew;
+  set_cutneigh();
+  cutneigh_change = 1;
+
+  if (comm->me == 0) {
+    char str[128];
+    sprintf(str,"Neighbor auto: skin = %g, every = %d at step " BIGINT_FORMAT
+	    " (pair %g, neigh %g secs/step)\n",
+	    skin_active,every,ntimestep,tpair,tneigh/interval);
+    if (screen) fputs(str,screen);
+    if (logfile) fputs(str,logfile);
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 int Neighbor::decide()
@@ -1039,7 +1161,9 @@ int Neighbor::decide()
   if (ago >= delay && ago % every == 0) {
     if (build_once) return 0;
     if (dist_check == 0) return 1;
-    return check_distance();
+    if (check_distance() == 0) return 0;
+    if (autoskin && update->whichflag == 1) autotune();
+    return 1;
   } else return 0;
 }
 
@@ -1069,7 +1193,7 @@ int Neighbor::check_distance()
       dely = bboxhi[1] - boxhi_hold[1];
       delz = bboxhi[2] - boxhi_hold[2];
       delta2 = sqrt(delx*delx + dely*dely + delz*delz);
-      delta = 0.5 * (skin - (delta1+delta2));
+      delta = 0.5 * (skin_active - (delta1+delta2));
       deltasq = delta*delta;
     } else {
       domain->box_corners();
@@ -1082,11 +1206,22 @@ int Neighbor::check_distance()
 	if (delta > delta1) delta1 = delta;
 	else if (delta > delta2) delta2 = delta;
       }
-      delta = 0.5 * (skin - (delta1+delta2));
+      delta = 0.5 * (skin_active - (delta1+delta2));
       deltasq = delta*delta;
     }
   } else deltasq = triggersq;
 
+  // Lees-Edwards images move with respect to the box,
+  //   their displacement reduces the distance owned atoms may move
+
+  if (domain->le_flag) {
+    double dle = domain->le_offset - le_offset_hold + 
+      (domain->le_nwrap - le_nwrap_hold)*domain->xprd;
+    delta = sqrt(deltasq) - 0.5*fabs(dle);
+    if (delta > 0.0) deltasq = delta*delta;
+    else deltasq = -1.0;
+  }
+
   double **x = atom->x;
   int nlocal = atom->nlocal;
   if (includegroup) nlocal = atom->nfirst;
@@ -1117,6 +1252,8 @@ void Neighbor::build()
 
   ago = 0;
   ncalls++;
+  auto_nbuild++;
+  cutneigh_change = 0;
 
   // store current atom positions and box size if needed
 
@@ -1134,6 +1271,8 @@ void Neighbor::build()
       xhold[i][1] = x[i][1];
       xhold[i][2] = x[i][2];
     }
+    le_offset_hold = domain->le_offset;
+    le_nwrap_hold = domain->le_nwrap;
     if (boxcheck) {
       if (triclinic == 0) {
 	boxlo_hold[0] = bboxlo[0];
@@ -1192,6 +1331,47 @@ void Neighbor::build()
     if (force->dihedral) (this->*dihedral_build)();
     if (force->improper) (this->*improper_build)();
   }
+
+  // let Atom decide when to sort from memory locality of 1st pair list
+
+  if (atom->sortfreq > 0 && atom->sortauto && nblist)
+    atom->sort_check(index_distance(lists[blist[0]]));
+}
+
+/* ----------------------------------------------------------------------
+   average index distance |i-j| between owned atoms I,J in a pair list
+   proxy for cache misses when gathering x[j] in a pair loop
+------------------------------------------------------------------------- */
+
+double Neighbor::index_distance(NeighList *list)
+{
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  if (inum == 0 || firstneigh == NULL) return 0.0;
+
+  int nlocal = atom->nlocal;
+  double dsum = 0.0;
+  double npair = 0.0;
+
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) num_threads(comm->nthreads) reduction(+:dsum,npair)
+#endif
+  for (int ii = 0; ii < inum; ii++) {
+    int i = ilist[ii];
+    int *jlist = firstneigh[i];
+    int jnum = numneigh[i];
+    for (int jj = 0; jj < jnum; jj++) {
+      int j = jlist[jj] & NEIGHMASK;
+      if (j >= nlocal) continue;
+      dsum += abs(i-j);
+      npair += 1.0;
+    }
+  }
+
+  if (npair == 0.0) return 0.0;
+  return dsum/npair;
 }
 
 /* ----------------------------------------------------------------------
@@ -1456,6 +1636,7 @@ void Neighbor::set(int narg, char **arg)
 
   skin = atof(arg[0]);
   if (skin < 0.0) error->all(FLERR,"Illegal neighbor command");
+  skin_active = -1.0;
 
   if (strcmp(arg[1],"nsq") == 0) style = NSQ;
   else if (strcmp(arg[1],"bin") == 0) style = BIN;
@@ -1487,6 +1668,12 @@ void Neighbor::modify_params(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) dist_check = 0;
       else error->all(FLERR,"Illegal neigh_modify command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"auto") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) autoskin = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) autoskin = 0;
+      else error->all(FLERR,"Illegal neigh_modify command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"once") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
       if (strcmp(arg[iarg+1],"yes") == 0) build_once = 1;
@@ -1533,16 +1720,11 @@ void Neighbor::modify_params(int narg, char **arg)
 
       } else if (strcmp(arg[iarg+1],"group") == 0) {
 	if (iarg+4 > narg) error->all(FLERR,"Illegal neigh_modify command");
-	if (nex_group == maxex_group) {
-	  maxex_group += EXDELTA;
-	  memory->grow(ex1_group,maxex_group,"neigh:ex1_group");
-	  memory->grow(ex2_group,maxex_group,"neigh:ex2_group");
-	}
-	ex1_group[nex_group] = group->find(arg[iarg+2]);
-	ex2_group[nex_group] = group->find(arg[iarg+3]);
-	if (ex1_group[nex_group] == -1 || ex2_group[nex_group] == -1)
+	int igroup1 = group->find(arg[iarg+2]);
+	int igroup2 = group->find(arg[iarg+3]);
+	if (igroup1 == -1 || igroup2 == -1)
 	  error->all(FLERR,"Invalid group ID in neigh_modify command");
-	nex_group++;
+	exclusion_group_group(igroup1,igroup2);
 	iarg += 4;
 
       } else if (strcmp(arg[iarg+1],"molecule") == 0) {
@@ -1571,6 +1753,44 @@ void Neighbor::modify_params(int narg, char **arg)
   }
 }
 
+/* ----------------------------------------------------------------------
+   exclude pairs of atoms in groups igroup1 and igroup2 from all lists
+   used by neigh_modify exclude group and by fixes that own the exclusion
+   takes effect at the next init()
+------------------------------------------------------------------------- */
+
+void Neighbor::exclusion_group_group(int igroup1, int igroup2)
+{
+  if (nex_group == maxex_group) {
+    maxex_group += EXDELTA;
+    memory->grow(ex1_group,maxex_group,"neigh:ex1_group");
+    memory->grow(ex2_group,maxex_group,"neigh:ex2_group");
+  }
+  ex1_group[nex_group] = igroup1;
+  ex2_group[nex_group] = igroup2;
+  nex_group++;
+}
+
+/* ----------------------------------------------------------------------
+   remove one exclusion of pairs of atoms in groups igroup1 and igroup2
+   does nothing if there is none, e.g. after neigh_modify exclude none
+------------------------------------------------------------------------- */
+
+void Neighbor::exclusion_group_group_delete(int igroup1, int igroup2)
+{
+  int m;
+  for (m = 0; m < nex_group; m++)
+    if ((ex1_group[m] == igroup1 && ex2_group[m] == igroup2) ||
+        (ex1_group[m] == igroup2 && ex2_group[m] == igroup1)) break;
+  if (m == nex_group) return;
+
+  for (; m < nex_group-1; m++) {
+    ex1_group[m] = ex1_group[m+1];
+    ex2_group[m] = ex2_group[m+1];
+  }
+  nex_group--;
+}
+
 /* ----------------------------------------------------------------------
    bin owned and ghost atoms
 ------------------------------------------------------------------------- */
@@ -1581,7 +1801,8 @@ void Neighbor::bin_atoms()
 
   for (i = 0; i < mbins; i++) binhead[i] = -1;
 
-  // bin in reverse order so linked list will be in forward order
+  // find bin of each atom in parallel, store it in bins temporarily
+  // then bin in reverse order so linked list will be in forward order
   // also puts ghost atoms at end of list, which is necessary
 
   double **x = atom->x;
@@ -1589,24 +1810,29 @@ void Neighbor::bin_atoms()
   int nlocal = atom->nlocal;
   int nall = nlocal + atom->nghost;
 
+#if defined(_OPENMP)
+#pragma omp parallel for default(shared) num_threads(comm->nthreads) schedule(static)
+#endif
+  for (i = 0; i < nall; i++) bins[i] = coord2bin(x[i]);
+
   if (includegroup) {
     int bitmask = group->bitmask[includegroup];
     for (i = nall-1; i >= nlocal; i--) {
       if (mask[i] & bitmask) {
-	ibin = coord2bin(x[i]);
+	ibin = bins[i];
 	bins[i] = binhead[ibin];
 	binhead[ibin] = i;
       }
     }
     for (i = atom->nfirst-1; i >= 0; i--) {
-      ibin = coord2bin(x[i]);
+      ibin = bins[i];
       bins[i] = binhead[ibin];
       binhead[ibin] = i;
     }
 
   } else {
     for (i = nall-1; i >= 0; i--) {
-      ibin = coord2bin(x[i]);
+      ibin = bins[i];
       bins[i] = binhead[ibin];
       binhead[ibin] = i;
     }
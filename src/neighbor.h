@@ -34,6 +34,9 @@ class Neighbor : protected Pointers {
   int cudable;                     // GPU <-> CPU communication flag for CUDA
 
   double skin;                     // skin distance
+  int autoskin;                    // 1 if skin and every are tuned in runs
+  double skin_active;              // skin in use, at most skin if autoskin
+  int cutneigh_change;             // 1 if cutoffs changed since last build
   double cutneighmin;              // min neighbor cutoff for all type pairs
   double cutneighmax;              // max neighbor cutoff for all type pairs
   double *cuttype;                 // for each type, max neigh cut w/ others
@@ -74,6 +77,8 @@ class Neighbor : protected Pointers {
   void build_one(int);              // create a single neighbor list
   void set(int, char **);           // set neighbor style and skin distance
   void modify_params(int, char**);  // modify parameters that control builds
+  void exclusion_group_group(int, int);         // add/remove a group pair
+  void exclusion_group_group_delete(int, int);  //   exclusion
   bigint memory_usage();
   
  protected:
@@ -95,11 +100,17 @@ class Neighbor : protected Pointers {
 
   double triggersq;                // trigger = build when atom moves this dist
 
+  bigint auto_step0;               // start of autoskin timing window, -1 if
+  int auto_nbuild,auto_nbuild0;    //   none yet, builds and times at start
+  double auto_pair0,auto_neigh0;
+
   double **xhold;                      // atom coords at last neighbor build
   int maxhold;                         // size of xhold array
   int boxcheck;                        // 1 if need to store box size
   double boxlo_hold[3],boxhi_hold[3];  // box size at last neighbor build
   double corners_hold[8][3];           // box corners at last neighbor build
+  double le_offset_hold;               // Lees-Edwards shift at last build
+  int le_nwrap_hold;
 
   int nbinx,nbiny,nbinz;           // # of global bins
   int *bins;                       // ptr to next atom in each bin
@@ -163,8 +174,11 @@ class Neighbor : protected Pointers {
   double bin_distance(int, int, int);   // distance between binx
   int coord2bin(double *);              // mapping atom coord to a bin
   int coord2bin(double *, int &, int &, int&); // ditto
+  double index_distance(class NeighList *);  // avg |i-j| of owned pairs
 
   int exclusion(int, int, int, int, int *, int *) const;  // test for pair exclusion
+  void set_cutneigh();                  // neighbor cutoffs from skin_active
+  void autotune();                      // adapt skin_active and every
   virtual void choose_build(int, class NeighRequest *);
   void choose_stencil(int, class NeighRequest *);
 
@@ -203,6 +217,12 @@ class Neighbor : protected Pointers {
   void granular_bin_newton(class NeighList *);
   void granular_bin_newton_tri(class NeighList *);
 
+  void size_nsq_no_newton(class NeighList *);
+  void size_nsq_newton(class NeighList *);
+  void size_bin_no_newton(class NeighList *);
+  void size_bin_newton(class NeighList *);
+  void size_bin_newton_tri(class NeighList *);
+
   void respa_nsq_no_newton(class NeighList *);
   void respa_nsq_newton(class NeighList *);
   void respa_bin_no_newton(class NeighList *);
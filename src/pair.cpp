@@ -55,6 +55,8 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
   one_coeff = 0;
   no_virial_fdotr_compute = 0;
   ghostneigh = 0;
+  overlap_enable = 0;
+  overlap_phase = 0;
 
   nextra = 0;
   pvector = NULL;
@@ -44,6 +44,12 @@ class Pair : protected Pointers {
   int one_coeff;                 // 1 if allows only one coeff * * call
   int no_virial_fdotr_compute;   // 1 if does not invoke virial_fdotr_compute()
   int ghostneigh;                // 1 if pair style needs neighbors of ghosts
+  int overlap_enable;            // 1 if compute() may be called separately
+                                 //   on subsets of list->ilist, see Verlet
+  int overlap_phase;             // 0 if compute() is on the whole list, else
+                                 //   1 = 1st subset of a step, before ghosts
+                                 //   2 = 1st subset after ghosts are received
+                                 //   3 = later subsets of the step
   double **cutghost;             // cutoff for each ghost pair
 
   int tail_flag;                 // pair_modify flag for LJ tail correction
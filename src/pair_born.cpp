@@ -33,7 +33,10 @@ using namespace MathConst;
 
 /* ---------------------------------------------------------------------- */
 
-PairBorn::PairBorn(LAMMPS *lmp) : Pair(lmp) {}
+PairBorn::PairBorn(LAMMPS *lmp) : Pair(lmp)
+{
+  overlap_enable = 1;
+}
 
 /* ---------------------------------------------------------------------- */
 
@@ -29,7 +29,10 @@ using namespace MathConst;
 
 /* ---------------------------------------------------------------------- */
 
-PairBuck::PairBuck(LAMMPS *lmp) : Pair(lmp) {}
+PairBuck::PairBuck(LAMMPS *lmp) : Pair(lmp)
+{
+  overlap_enable = 1;
+}
 
 /* ---------------------------------------------------------------------- */
 
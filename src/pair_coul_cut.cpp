@@ -28,7 +28,10 @@ using namespace LAMMPS_NS;
 
 /* ---------------------------------------------------------------------- */
 
-PairCoulCut::PairCoulCut(LAMMPS *lmp) : Pair(lmp) {}
+PairCoulCut::PairCoulCut(LAMMPS *lmp) : Pair(lmp)
+{
+  overlap_enable = 1;
+}
 
 /* ---------------------------------------------------------------------- */
 
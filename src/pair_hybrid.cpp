@@ -200,6 +200,7 @@ void PairHybrid::settings(int narg, char **arg)
   // exception is 1st two args of buck/coul, which are non-numeric
   // exception is 1st arg of reax/c style, which is non-numeric
   // execption is 1st 6 args of gran styles, which can have NULLs
+  // exception is kernel, cache, implicit keywords of SPH styles, followed by a word
   // need a better way to skip these exceptions
 
   nstyles = 0;
@@ -212,7 +213,12 @@ void PairHybrid::settings(int narg, char **arg)
     if (strstr(arg[i],"gran/hooke")) i += 6;
     if (strstr(arg[i],"gran/hertz")) i += 6;
     i++;
-    while (i < narg && !isalpha(arg[i][0])) i++;
+    while (i < narg) {
+      if ((strcmp(arg[i],"kernel") == 0 || strcmp(arg[i],"cache") == 0 ||
+           strcmp(arg[i],"implicit") == 0) && i+1 < narg) i += 2;
+      else if (!isalpha(arg[i][0])) i++;
+      else break;
+    }
     nstyles++;
   }
 
@@ -228,6 +234,7 @@ void PairHybrid::settings(int narg, char **arg)
   // exception is 1st two args of buck/coul, which are non-numeric
   // exception is 1st arg of reax/c style, which is non-numeric
   // execption is 1st 6 args of gran styles, which can have NULLs
+  // exception is kernel, cache, implicit keywords of SPH styles, followed by a word
   // need a better way to skip these exceptions
 
   int dummy;
@@ -253,7 +260,12 @@ void PairHybrid::settings(int narg, char **arg)
     if (strstr(arg[i],"gran/hooke")) i += 6;
     if (strstr(arg[i],"gran/hertz")) i += 6;
     i++;
-    while (i < narg && !isalpha(arg[i][0])) i++;
+    while (i < narg) {
+      if ((strcmp(arg[i],"kernel") == 0 || strcmp(arg[i],"cache") == 0 ||
+           strcmp(arg[i],"implicit") == 0) && i+1 < narg) i += 2;
+      else if (!isalpha(arg[i][0])) i++;
+      else break;
+    }
     styles[nstyles]->settings(i-istyle-1,&arg[istyle+1]);
     nstyles++;
   }
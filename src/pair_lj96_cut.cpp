@@ -41,6 +41,7 @@ using namespace MathConst;
 PairLJ96Cut::PairLJ96Cut(LAMMPS *lmp) : Pair(lmp)
 {
   respa_enable = 1;
+  overlap_enable = 1;
 }
 
 /* ---------------------------------------------------------------------- */
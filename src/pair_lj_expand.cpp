@@ -28,7 +28,10 @@ using namespace MathConst;
 
 /* ---------------------------------------------------------------------- */
 
-PairLJExpand::PairLJExpand(LAMMPS *lmp) : Pair(lmp) {}
+PairLJExpand::PairLJExpand(LAMMPS *lmp) : Pair(lmp)
+{
+  overlap_enable = 1;
+}
 
 /* ---------------------------------------------------------------------- */
 
@@ -222,16 +222,16 @@ void Replicate::command(int narg, char **arg)
   }
 
   if (domain->xperiodic) {
-    if (comm->myloc[0] == 0) sublo[0] -= EPSILON;
-    if (comm->myloc[0] == comm->procgrid[0]-1) subhi[0] += EPSILON;
+    if (comm->mysplit[0][0] == 0.0) sublo[0] -= EPSILON;
+    if (comm->mysplit[0][1] == 1.0) subhi[0] += EPSILON;
   }
   if (domain->yperiodic) {
-    if (comm->myloc[1] == 0) sublo[1] -= EPSILON;
-    if (comm->myloc[1] == comm->procgrid[1]-1) subhi[1] += EPSILON;
+    if (comm->mysplit[1][0] == 0.0) sublo[1] -= EPSILON;
+    if (comm->mysplit[1][1] == 1.0) subhi[1] += EPSILON;
   }
   if (domain->zperiodic) {
-    if (comm->myloc[2] == 0) sublo[2] -= EPSILON;
-    if (comm->myloc[2] == comm->procgrid[2]-1) subhi[2] += EPSILON;
+    if (comm->mysplit[2][0] == 0.0) sublo[2] -= EPSILON;
+    if (comm->mysplit[2][1] == 1.0) subhi[2] += EPSILON;
   }
 
   // loop over all procs
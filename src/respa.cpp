@@ -632,17 +632,18 @@ void Respa::force_clear(int newtonflag)
 
   if (e_flag) {
     double *de = atom->de;
-    for (i = 0; i < nall; i++) de[i] = 0.0;
+    for (i = 0; i < ntot; i++) de[i] = 0.0;
   }
   
   if (rho_flag) {
     double *drho = atom->drho;
-    for (i = 0; i < nall; i++) drho[i] = 0.0;
+    for (i = 0; i < ntot; i++) drho[i] = 0.0;
   }
 }
 
 /* ----------------------------------------------------------------------
    copy force components from atom->f to FixRespa->f_level
+   also drho and de, so SPH fixes integrate each level's own changes
 ------------------------------------------------------------------------- */
 
 void Respa::copy_f_flevel(int ilevel)
@@ -656,6 +657,20 @@ void Respa::copy_f_flevel(int ilevel)
     f_level[i][ilevel][1] = f[i][1];
     f_level[i][ilevel][2] = f[i][2];
   }
+
+  // density and energy changes of SPH atom styles, e.g. meso
+
+  if (rho_flag) {
+    double **drho_level = fix_respa->drho_level;
+    double *drho = atom->drho;
+    for (int i = 0; i < n; i++) drho_level[i][ilevel] = drho[i];
+  }
+
+  if (e_flag) {
+    double **de_level = fix_respa->de_level;
+    double *de = atom->de;
+    for (int i = 0; i < n; i++) de_level[i][ilevel] = de[i];
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -673,6 +688,18 @@ void Respa::copy_flevel_f(int ilevel)
     f[i][1] = f_level[i][ilevel][1];
     f[i][2] = f_level[i][ilevel][2];
   }
+
+  if (rho_flag) {
+    double **drho_level = fix_respa->drho_level;
+    double *drho = atom->drho;
+    for (int i = 0; i < n; i++) drho[i] = drho_level[i][ilevel];
+  }
+
+  if (e_flag) {
+    double **de_level = fix_respa->de_level;
+    double *de = atom->de;
+    for (int i = 0; i < n; i++) de[i] = de_level[i][ilevel];
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -694,4 +721,18 @@ void Respa::sum_flevel_f()
       f[i][2] += f_level[i][ilevel][2];
     }
   }
+
+  if (rho_flag) {
+    double **drho_level = fix_respa->drho_level;
+    double *drho = atom->drho;
+    for (int ilevel = 1; ilevel < nlevels; ilevel++)
+      for (int i = 0; i < n; i++) drho[i] += drho_level[i][ilevel];
+  }
+
+  if (e_flag) {
+    double **de_level = fix_respa->de_level;
+    double *de = atom->de;
+    for (int ilevel = 1; ilevel < nlevels; ilevel++)
+      for (int i = 0; i < n; i++) de[i] += de_level[i][ilevel];
+  }
 }
@@ -14,6 +14,7 @@
 #include "string.h"
 #include "verlet.h"
 #include "neighbor.h"
+#include "neigh_list.h"
 #include "domain.h"
 #include "comm.h"
 #include "atom.h"
@@ -38,7 +39,19 @@ using namespace LAMMPS_NS;
 /* ---------------------------------------------------------------------- */
 
 Verlet::Verlet(LAMMPS *lmp, int narg, char **arg) :
-  Integrate(lmp, narg, arg) {}
+  Integrate(lmp, narg, arg)
+{
+  overlapflag = 0;
+  ninterior = nsplit = maxsplit = 0;
+  ilist_split = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+Verlet::~Verlet()
+{
+  memory->destroy(ilist_split);
+}
 
 /* ----------------------------------------------------------------------
    initialization before run
@@ -77,6 +90,11 @@ void Verlet::init()
   // orthogonal vs triclinic simulation box
 
   triclinic = domain->triclinic;
+
+  // overlapped communication needs swaps that are independent of each other
+
+  if (comm->overlap && !comm->tiled)
+    error->all(FLERR,"Communicate overlap requires comm_style tiled");
 }
 
 /* ----------------------------------------------------------------------
@@ -106,6 +124,8 @@ void Verlet::setup()
   if (triclinic) domain->lamda2x(atom->nlocal+atom->nghost);
   neighbor->build();
   neighbor->ncalls = 0;
+  setup_overlap();
+  if (overlapflag) split_list();
 
   // compute all forces
 
@@ -160,6 +180,8 @@ void Verlet::setup_minimal(int flag)
     neighbor->build();
     neighbor->ncalls = 0;
   }
+  setup_overlap();
+  if (overlapflag) split_list();
 
   // compute all forces
 
@@ -194,7 +216,7 @@ void Verlet::setup_minimal(int flag)
 void Verlet::run(int n)
 {
   bigint ntimestep;
-  int nflag,sortflag;
+  int nflag,sortflag,splitflag;
 
   int n_post_integrate = modify->n_post_integrate;
   int n_pre_exchange = modify->n_pre_exchange;
@@ -220,7 +242,17 @@ void Verlet::run(int n)
 
     nflag = neighbor->decide();
 
-    if (nflag == 0) {
+    // overlap ghost comm with pair forces on steps with no energy or virial
+    // interior atoms are computed while ghost coords are in flight
+
+    splitflag = 0;
+    if (overlapflag && nflag == 0 && eflag == 0 && vflag == 0) splitflag = 1;
+
+    if (splitflag) {
+      timer->stamp();
+      comm->forward_comm_start();
+      timer->stamp(TIME_COMM);
+    } else if (nflag == 0) {
       timer->stamp();
       comm->forward_comm();
       timer->stamp(TIME_COMM);
@@ -232,6 +264,9 @@ void Verlet::run(int n)
 	domain->reset_box();
 	comm->setup();
 	if (neighbor->style) neighbor->setup_bins();
+      } else if (neighbor->cutneigh_change) {
+	comm->setup();
+	if (neighbor->style) neighbor->setup_bins();
       }
       timer->stamp();
       comm->exchange();
@@ -241,6 +276,7 @@ void Verlet::run(int n)
       timer->stamp(TIME_COMM);
       if (n_pre_neighbor) modify->pre_neighbor();
       neighbor->build();
+      if (overlapflag) split_list();
       timer->stamp(TIME_NEIGHBOR);
     }
 
@@ -251,29 +287,33 @@ void Verlet::run(int n)
 
     timer->stamp();
 
-    if (force->pair) {
-      force->pair->compute(eflag,vflag);
-      timer->stamp(TIME_PAIR);
-    }
+    if (splitflag) {
+      force_overlap();
+    } else {
+      if (force->pair) {
+        force->pair->compute(eflag,vflag);
+        timer->stamp(TIME_PAIR);
+      }
 
-    if (atom->molecular) {
-      if (force->bond) force->bond->compute(eflag,vflag);
-      if (force->angle) force->angle->compute(eflag,vflag);
-      if (force->dihedral) force->dihedral->compute(eflag,vflag);
-      if (force->improper) force->improper->compute(eflag,vflag);
-      timer->stamp(TIME_BOND);
-    }
+      if (atom->molecular) {
+        if (force->bond) force->bond->compute(eflag,vflag);
+        if (force->angle) force->angle->compute(eflag,vflag);
+        if (force->dihedral) force->dihedral->compute(eflag,vflag);
+        if (force->improper) force->improper->compute(eflag,vflag);
+        timer->stamp(TIME_BOND);
+      }
 
-    if (force->kspace) {
-      force->kspace->compute(eflag,vflag);
-      timer->stamp(TIME_KSPACE);
-    }
+      if (force->kspace) {
+        force->kspace->compute(eflag,vflag);
+        timer->stamp(TIME_KSPACE);
+      }
 
-    // reverse communication of forces
+      // reverse communication of forces
 
-    if (force->newton) {
-      comm->reverse_comm();
-      timer->stamp(TIME_COMM);
+      if (force->newton) {
+        comm->reverse_comm();
+        timer->stamp(TIME_COMM);
+      }
     }
 
     // force modifications, final time integration, diagnostics
@@ -292,6 +332,143 @@ void Verlet::run(int n)
   }
 }
 
+/* ----------------------------------------------------------------------
+   force computation of one step with ghost comm in flight
+   forward comm was started by run(), eflag = vflag = 0
+   interior atoms are split in two halves so that the 2nd half
+     overlaps the reverse comm of ghost forces
+------------------------------------------------------------------------- */
+
+void Verlet::force_overlap()
+{
+  int nfirst = ninterior;
+  if (force->newton) nfirst = ninterior/2;
+
+  pair_subset(0,nfirst,1);
+  timer->stamp(TIME_PAIR);
+
+  comm->forward_comm_finish();
+  timer->stamp(TIME_COMM);
+
+  pair_subset(ninterior,nsplit,2);
+  timer->stamp(TIME_PAIR);
+
+  if (atom->molecular) {
+    if (force->bond) force->bond->compute(eflag,vflag);
+    if (force->angle) force->angle->compute(eflag,vflag);
+    if (force->dihedral) force->dihedral->compute(eflag,vflag);
+    if (force->improper) force->improper->compute(eflag,vflag);
+    timer->stamp(TIME_BOND);
+  }
+
+  if (force->kspace) {
+    force->kspace->compute(eflag,vflag);
+    timer->stamp(TIME_KSPACE);
+  }
+
+  if (force->newton) {
+    comm->reverse_comm_start();
+    timer->stamp(TIME_COMM);
+  }
+
+  pair_subset(nfirst,ninterior,3);
+  timer->stamp(TIME_PAIR);
+
+  if (force->newton) {
+    comm->reverse_comm_finish();
+    timer->stamp(TIME_COMM);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   decide if forces can be overlapped with comm during this run
+   requires a pair style whose compute() works on any subset of its list
+     and no pre_force fixes, which may need ghost values
+------------------------------------------------------------------------- */
+
+void Verlet::setup_overlap()
+{
+  overlapflag = 0;
+  if (!comm->overlap) return;
+
+  Pair *pair = force->pair;
+  if (pair && pair->overlap_enable && pair->list && modify->n_pre_force == 0)
+    overlapflag = 1;
+  else if (comm->me == 0)
+    error->warning(FLERR,"Communication is not overlapped with forces");
+}
+
+/* ----------------------------------------------------------------------
+   reorder pair list so interior atoms, with only owned neighbors, are first
+   boundary atoms with one or more ghost neighbors follow
+   done after every reneighboring
+------------------------------------------------------------------------- */
+
+void Verlet::split_list()
+{
+  int i,ii,jj,jnum,nboundary;
+  int *jlist;
+
+  NeighList *list = force->pair->list;
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nlocal = atom->nlocal;
+
+  if (inum > maxsplit) {
+    maxsplit = atom->nmax;
+    if (inum > maxsplit) maxsplit = inum;
+    memory->destroy(ilist_split);
+    memory->create(ilist_split,maxsplit,"verlet:ilist_split");
+  }
+
+  // interior atoms fill the front of ilist_split, boundary atoms the back
+  // boundary atoms are reversed afterwards to keep the original order
+
+  ninterior = 0;
+  nboundary = 0;
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    for (jj = 0; jj < jnum; jj++)
+      if ((jlist[jj] & NEIGHMASK) >= nlocal) break;
+    if (jj == jnum) ilist_split[ninterior++] = i;
+    else ilist_split[inum - ++nboundary] = i;
+  }
+
+  int tmp;
+  for (ii = 0; ii < nboundary/2; ii++) {
+    tmp = ilist_split[ninterior+ii];
+    ilist_split[ninterior+ii] = ilist_split[inum-1-ii];
+    ilist_split[inum-1-ii] = tmp;
+  }
+
+  nsplit = inum;
+}
+
+/* ----------------------------------------------------------------------
+   compute pair forces on atoms lo to hi-1 of the split list
+   phase tells the pair style which part of the step this is, see Pair
+   called even if lo = hi, so per-atom terms are set up in every phase
+------------------------------------------------------------------------- */
+
+void Verlet::pair_subset(int lo, int hi, int phase)
+{
+  NeighList *list = force->pair->list;
+  int *ilist = list->ilist;
+  int inum = list->inum;
+
+  list->ilist = &ilist_split[lo];
+  list->inum = hi - lo;
+  force->pair->overlap_phase = phase;
+  force->pair->compute(eflag,vflag);
+  force->pair->overlap_phase = 0;
+  list->ilist = ilist;
+  list->inum = inum;
+}
+
 /* ---------------------------------------------------------------------- */
 
 void Verlet::cleanup()
@@ -342,12 +519,12 @@ void Verlet::force_clear()
 
     if (e_flag) {
       double *de = atom->de;
-      for (i = 0; i < nall; i++) de[i] = 0.0;
+      for (i = 0; i < ntot; i++) de[i] = 0.0;
     }
 
     if (rho_flag) {
       double *drho = atom->drho;
-      for (i = 0; i < nall; i++) drho[i] = 0.0;
+      for (i = 0; i < ntot; i++) drho[i] = 0.0;
     }
 
   // neighbor includegroup flag is set
@@ -27,7 +27,7 @@ namespace LAMMPS_NS {
 class Verlet : public Integrate {
  public:
   Verlet(class LAMMPS *, int, char **);
-  virtual ~Verlet() {}
+  virtual ~Verlet();
   void init();
   void setup();
   void setup_minimal(int);
@@ -39,7 +39,15 @@ class Verlet : public Integrate {
   int torqueflag,erforceflag;
   int e_flag,rho_flag;
 
+  int overlapflag;                  // 1 if comm is overlapped with pair
+  int ninterior,nsplit,maxsplit;    // # of interior atoms, total in list
+  int *ilist_split;                 // pair ilist with interior atoms first
+
   void force_clear();
+  void split_list();
+  void pair_subset(int, int, int);
+  void setup_overlap();
+  void force_overlap();
 };
 
 }